@@ -0,0 +1,69 @@
+/**
+ * @file
+ * Benchmark corpus access functions implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "corpus.hpp"
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+#include <glibmm/regex.h>
+
+/**
+ * Namespace used by the benchmarks.
+ */
+namespace Bench
+{
+
+/**
+ * Gets the path of a corpus file.
+ * @param name Corpus file name.
+ * @return Path inside the corpus directory given at build time.
+ */
+std::string get_corpus_path(const std::string &name)
+{
+    return Glib::build_filename(BENCH_CORPUS_DIR, name);
+}
+
+/**
+ * Reads a whole corpus file.
+ * @param name Corpus file name.
+ * @return File contents.
+ */
+Glib::ustring read_corpus(const std::string &name)
+{
+    return Glib::file_get_contents(get_corpus_path(name));
+}
+
+/**
+ * Reads the non empty lines of a corpus file.
+ * @param name Corpus file name.
+ * @return File lines.
+ */
+std::vector<Glib::ustring> read_corpus_lines(const std::string &name)
+{
+    std::vector<Glib::ustring> lines;
+
+    for (auto &line : Glib::Regex::split_simple("\n", read_corpus(name))) {
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+
+    return lines;
+}
+
+/**
+ * Gets a path in the temporary directory for the files written by the
+ * benchmarks.
+ * @param name File name.
+ * @return Path in the temporary directory.
+ */
+std::string get_temp_path(const std::string &name)
+{
+    return Glib::build_filename(Glib::get_tmp_dir(), "dosboxgtk_bench_" + name);
+}
+
+} // Bench
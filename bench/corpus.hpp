@@ -0,0 +1,29 @@
+/**
+ * @file
+ * Benchmark corpus access functions declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+#include <glibmm/ustring.h>
+#include <string>
+#include <vector>
+
+/**
+ * Namespace used by the benchmarks.
+ */
+namespace Bench
+{
+
+std::string get_corpus_path(const std::string &name);
+Glib::ustring read_corpus(const std::string &name);
+std::vector<Glib::ustring> read_corpus_lines(const std::string &name);
+std::string get_temp_path(const std::string &name);
+
+} // Bench
+
+#endif // CORPUS_HPP
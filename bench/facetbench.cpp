@@ -0,0 +1,150 @@
+/**
+ * @file
+ * Benchmarks of the profile facet index.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profilefacetindex.h"
+#include <benchmark/benchmark.h>
+#include <iterator>
+
+using namespace DOSBoxGTK;
+
+static const char *s_companies[] = {"Sierra", "LucasArts", "id Software", "Apogee", "Origin", "Westwood", "MicroProse", "Psygnosis",
+                                    "Epyx", "Accolade", "Brøderbund", "Infocom", "SSI", "Interplay", "Electronic Arts", "Activision"}; ///< Developers and publishers.
+static const char *s_genres[] = {"Adventure", "Action", "Role-Playing (RPG)", "Strategy", "Simulation", "Puzzle"}; ///< Game genres.
+static const char *s_machines[] = {"svga_s3", "vgaonly", "ega", "cga", "tandy", "hercules"}; ///< Emulated machines.
+static const char *s_cores[] = {"auto", "normal", "dynamic", "simple"}; ///< CPU cores.
+static const char *s_sbtypes[] = {"sb16", "sbpro2", "sb1", "none"}; ///< Sound Blaster types.
+
+/**
+ * Creates a snapshot of a synthetic library.
+ * @param count Number of profiles.
+ * @return Library snapshot.
+ */
+static ProfileSnapshotPtr get_library(unsigned count)
+{
+    std::vector<ProfilePtr> profiles;
+
+    for (unsigned i = 0; i < count; ++i) {
+        auto profile = std::make_shared<Profile>();
+
+        profile->id        = Glib::ustring::compose("%1", i);
+        profile->title     = Glib::ustring::compose("Game %1", i);
+        profile->developer = s_companies[i % std::size(s_companies)];
+        profile->publisher = s_companies[(i / 3) % std::size(s_companies)];
+        profile->genre     = s_genres[i % std::size(s_genres)];
+        profile->year      = Glib::ustring::compose("%1", 1985 + i % 15);
+        profiles.push_back(profile);
+    }
+
+    return std::make_shared<ProfileSnapshot>()->with_profiles(profiles);
+}
+
+/**
+ * Gets the settings the validator would read from a profile config file.
+ * @param i Profile number.
+ * @return Profile settings.
+ */
+static ProfileSettings get_settings(unsigned i)
+{
+    ProfileSettings settings;
+
+    settings.machine     = s_machines[i % std::size(s_machines)];
+    settings.core        = s_cores[(i / 7) % std::size(s_cores)];
+    settings.sbtype      = s_sbtypes[(i / 5) % std::size(s_sbtypes)];
+    settings.has_booter  = i % 20 == 0;
+    settings.has_program = !settings.has_booter;
+
+    return settings;
+}
+
+/**
+ * Indexes a whole library and its settings, as done when the main window
+ * opens and the library has been validated.
+ * @param state Benchmark state. Its range is the number of profiles.
+ */
+static void BM_FacetIndexBuild(benchmark::State &state)
+{
+    auto snapshot = get_library(state.range(0));
+
+    for (auto _ : state) {
+        ProfileFacetIndex index;
+
+        index.sync(snapshot);
+
+        for (unsigned i = 0; i < snapshot->size(); ++i) {
+            index.set_settings(Glib::ustring::compose("%1", i), get_settings(i));
+        }
+
+        benchmark::DoNotOptimize(index.evaluate(ProfileFacetFilter()).cardinality());
+    }
+
+    state.SetItemsProcessed(state.iterations() * snapshot->size());
+}
+BENCHMARK(BM_FacetIndexBuild)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Evaluates a filter and counts the values of every facet, as done on each
+ * change of the facets box.
+ * @param state Benchmark state. Its first range is the number of profiles
+ * and the second one the number of chosen facets.
+ */
+static void BM_FacetFilterAndCount(benchmark::State &state)
+{
+    auto snapshot = get_library(state.range(0));
+    ProfileFacetIndex index;
+    ProfileFacetFilter filter;
+
+    index.sync(snapshot);
+
+    for (unsigned i = 0; i < snapshot->size(); ++i) {
+        index.set_settings(Glib::ustring::compose("%1", i), get_settings(i));
+    }
+
+    if (state.range(1) > 0) {
+        filter.values[static_cast<int>(ProfileFacet::GENRE)] = {"adventure", "action"};
+    }
+
+    if (state.range(1) > 1) {
+        filter.year_from = 1990;
+        filter.year_to   = 1995;
+    }
+
+    if (state.range(1) > 2) {
+        filter.values[static_cast<int>(ProfileFacet::MACHINE)] = {"svga_s3", "vgaonly"};
+    }
+
+    for (auto _ : state) {
+        auto docs = index.evaluate(filter);
+
+        for (int facet = 0; facet < PROFILE_FACET_COUNT; ++facet) {
+            benchmark::DoNotOptimize(index.count(static_cast<ProfileFacet>(facet), filter).size());
+        }
+
+        benchmark::DoNotOptimize(docs.cardinality());
+    }
+}
+BENCHMARK(BM_FacetFilterAndCount)->ArgsProduct({{100000}, {0, 1, 2, 3}})->Unit(benchmark::kMicrosecond);
+
+/**
+ * Moves a profile to other facet values, as done when the validator reads
+ * its changed config file.
+ * @param state Benchmark state. Its range is the number of profiles.
+ */
+static void BM_FacetIndexUpdate(benchmark::State &state)
+{
+    auto snapshot = get_library(state.range(0));
+    ProfileFacetIndex index;
+    unsigned i = 0;
+
+    index.sync(snapshot);
+
+    for (auto _ : state) {
+        index.set_settings(Glib::ustring::compose("%1", i % snapshot->size()), get_settings(i + 1));
+        ++i;
+    }
+}
+BENCHMARK(BM_FacetIndexUpdate)->Arg(100000);
@@ -0,0 +1,58 @@
+/**
+ * @file
+ * Synthetic library generator tool.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "librarygenerator.hpp"
+#include <glibmm/init.h>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+/**
+ * Generates a synthetic library. Usage:
+ * @code
+ * dosboxgtk_genlibrary [--profiles=N] [--seed=N] [--no-games] DIR
+ * @endcode
+ * Point the "profiles-path" setting to DIR/profiles to open it.
+ * @param argc Number of arguments.
+ * @param argv Arguments array.
+ * @return Process status.
+ */
+int main(int argc, char **argv)
+{
+    Bench::LibraryOptions options;
+    std::string root;
+
+    Glib::init();
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--profiles=", 11) == 0) {
+            options.profiles = std::strtoul(argv[i] + 11, nullptr, 10);
+        } else if (std::strncmp(argv[i], "--seed=", 7) == 0) {
+            options.seed = std::strtoul(argv[i] + 7, nullptr, 10);
+        } else if (std::strcmp(argv[i], "--no-games") == 0) {
+            options.create_games = false;
+        } else if (argv[i][0] != '-' && root.empty()) {
+            root = argv[i];
+        } else {
+            root.clear();
+            break;
+        }
+    }
+
+    if (root.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--profiles=N] [--seed=N] [--no-games] DIR" << std::endl;
+        return 1;
+    }
+
+    Bench::LibraryGenerator generator(root, options);
+
+    generator.generate();
+    std::cout << options.profiles << " profiles written to " << generator.get_profiles_path() << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file
+ * Benchmarks of the HTTP client against a local stand-in server.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "corpus.hpp"
+#include "httpstandin.hpp"
+#include "httpclient.hpp"
+#include <curl/curl.h>
+#include <benchmark/benchmark.h>
+
+using namespace Tools;
+
+/**
+ * libcurl write callback discarding the body.
+ * @param data Received bytes.
+ * @param size Always 1.
+ * @param nmemb Number of bytes.
+ * @param user_data Unused.
+ * @return Number of bytes taken.
+ */
+static std::size_t discard(char *data, std::size_t size, std::size_t nmemb, void *user_data)
+{
+    return size * nmemb;
+}
+
+/**
+ * Downloads a page with a new easy handle, and so a new connection, per
+ * request, as the application did before HttpClient, as a baseline.
+ * @param state Benchmark state.
+ */
+static void BM_FetchNewConnection(benchmark::State &state)
+{
+    Bench::HttpStandIn server(Bench::read_corpus("mobygames.html"));
+    auto url = server.get_url("/game/dos/x");
+
+    for (auto _ : state) {
+        auto handle = curl_easy_init();
+
+        curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, discard);
+        curl_easy_perform(handle);
+        curl_easy_cleanup(handle);
+    }
+
+    state.counters["connections"] = benchmark::Counter(server.get_connections(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_FetchNewConnection);
+
+/**
+ * Downloads a page with HttpClient, reusing its connection. Streamed
+ * requests are not cached, so the whole page is downloaded every time.
+ * @param state Benchmark state.
+ */
+static void BM_FetchReused(benchmark::State &state)
+{
+    Bench::HttpStandIn server(Bench::read_corpus("mobygames.html"));
+    auto url = server.get_url("/game/dos/x");
+    HttpClient client;
+    CancellationToken token;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(client.fetch_stream(token, url, std::string(), [](const char*, std::size_t) {}));
+    }
+
+    state.counters["connections"] = benchmark::Counter(server.get_connections(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_FetchReused);
+
+/**
+ * Downloads a cached page with HttpClient. The server answers 304 Not
+ * Modified and the body is taken from the cache.
+ * @param state Benchmark state.
+ */
+static void BM_FetchNotModified(benchmark::State &state)
+{
+    Bench::HttpStandIn server(Bench::read_corpus("mobygames.html"));
+    auto url = server.get_url("/game/dos/x");
+    HttpClient client;
+    CancellationToken token;
+
+    client.fetch(token, url);
+
+    for (auto _ : state) {
+        auto response = client.fetch(token, url);
+
+        if (!response.from_cache) {
+            state.SkipWithError("The page was downloaded again");
+            break;
+        }
+    }
+
+    state.counters["connections"] = benchmark::Counter(server.get_connections(), benchmark::Counter::kAvgIterations);
+}
+BENCHMARK(BM_FetchNotModified);
+
+/**
+ * Downloads a page with HttpClient from several threads at once. The
+ * connections are shared, so there are at most as many as threads.
+ * @param state Benchmark state.
+ */
+static void BM_FetchReusedThreads(benchmark::State &state)
+{
+    static Bench::HttpStandIn *server = nullptr;
+    static HttpClient *client = nullptr;
+    CancellationToken token;
+
+    if (state.thread_index() == 0) {
+        server = new Bench::HttpStandIn(Bench::read_corpus("mobygames.html"));
+        client = new HttpClient();
+    }
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(client->fetch_stream(token, server->get_url("/game/dos/x"), std::string(), [](const char*, std::size_t) {}));
+    }
+
+    if (state.thread_index() == 0) {
+        state.counters["connections"] = server->get_connections();
+        delete client;
+        delete server;
+    }
+}
+BENCHMARK(BM_FetchReusedThreads)->Threads(4)->UseRealTime();
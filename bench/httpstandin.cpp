@@ -0,0 +1,209 @@
+/**
+ * @file
+ * HttpStandIn class definition.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "httpstandin.hpp"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <functional>
+#include <stdexcept>
+#include <strings.h>
+
+/**
+ * Namespace used by the benchmarks.
+ */
+namespace Bench
+{
+
+/**
+ * Accepts connections until the listening socket is shut down.
+ */
+void HttpStandIn::accept_connections()
+{
+    int client;
+
+    while ((client = accept(this->m_socket, nullptr, nullptr)) >= 0) {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+
+        ++this->m_connections;
+        this->m_client_sockets.push_back(client);
+        this->m_clients.emplace_back(&HttpStandIn::serve, this, client);
+    }
+}
+
+/**
+ * Answers the requests of a connection until the client closes it.
+ * @param client Connection socket.
+ */
+void HttpStandIn::serve(int client)
+{
+    std::string input;
+    char buffer[16384];
+
+    for (;;) {
+        auto header_end = input.find("\r\n\r\n");
+
+        if (header_end == std::string::npos) {
+            auto size = recv(client, buffer, sizeof(buffer), 0);
+
+            if (size <= 0) {
+                break;
+            }
+
+            input.append(buffer, size);
+            continue;
+        }
+
+        // Only the headers used by HttpClient are looked at.
+        std::size_t content_length = 0;
+        bool has_etag = false,
+             etag_matches = false,
+             date_matches = false;
+        auto headers = input.substr(0, header_end + 2);
+
+        for (std::size_t begin = headers.find("\r\n") + 2, end; (end = headers.find("\r\n", begin)) != std::string::npos; begin = end + 2) {
+            auto line = headers.substr(begin, end - begin);
+
+            if (strncasecmp(line.c_str(), "Content-Length:", 15) == 0) {
+                content_length = std::strtoul(line.c_str() + 15, nullptr, 10);
+            } else if (strncasecmp(line.c_str(), "If-None-Match:", 14) == 0) {
+                has_etag = true;
+                etag_matches = !this->m_etag.empty() && line.find(this->m_etag, 14) != std::string::npos;
+            } else if (strncasecmp(line.c_str(), "If-Modified-Since:", 18) == 0) {
+                date_matches = line.find(this->m_last_modified, 18) != std::string::npos;
+            }
+        }
+
+        // As in RFC 7232, the date is only looked at without an ETag.
+        bool not_modified = has_etag ? etag_matches : date_matches;
+
+        if (input.size() < header_end + 4 + content_length) {
+            auto size = recv(client, buffer, sizeof(buffer), 0);
+
+            if (size <= 0) {
+                break;
+            }
+
+            input.append(buffer, size);
+            continue;
+        }
+
+        input.erase(0, header_end + 4 + content_length);
+
+        std::string response = not_modified ? "HTTP/1.1 304 Not Modified\r\n" : "HTTP/1.1 200 OK\r\n";
+
+        if (!this->m_etag.empty()) {
+            response += "ETag: " + this->m_etag + "\r\n";
+        }
+
+        response += "Last-Modified: " + this->m_last_modified + "\r\n";
+
+        if (not_modified) {
+            response += "\r\n";
+        } else {
+            response += "Content-Type: text/html; charset=UTF-8\r\nContent-Length: " + std::to_string(this->m_body.size()) + "\r\n\r\n" + this->m_body;
+        }
+
+        for (std::size_t sent = 0; sent < response.size();) {
+            auto size = send(client, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+
+            if (size <= 0) {
+                return;
+            }
+
+            sent += size;
+        }
+
+        ++this->m_requests;
+    }
+}
+
+/**
+ * Constructor. Starts listening.
+ * @param body Page served.
+ * @param use_etag Whether the page has an ETag. Without it the page is only
+ * revalidated by its Last-Modified date.
+ */
+HttpStandIn::HttpStandIn(const std::string &body, bool use_etag) :
+    m_body(body),
+    m_etag(use_etag ? "\"" + std::to_string(std::hash<std::string>()(body)) + "\"" : std::string()),
+    m_last_modified("Mon, 01 Dec 2014 10:00:00 GMT")
+{
+    sockaddr_in address = {};
+    socklen_t length = sizeof(address);
+
+    address.sin_family      = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    this->m_socket = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (this->m_socket < 0 || bind(this->m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(this->m_socket, SOMAXCONN) != 0 || getsockname(this->m_socket, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+        if (this->m_socket >= 0) {
+            close(this->m_socket);
+        }
+
+        throw std::runtime_error("Can not start the HTTP stand-in");
+    }
+
+    this->m_port   = ntohs(address.sin_port);
+    this->m_thread = std::thread(&HttpStandIn::accept_connections, this);
+}
+
+/**
+ * Destructor. Closes every connection.
+ */
+HttpStandIn::~HttpStandIn()
+{
+    shutdown(this->m_socket, SHUT_RDWR);
+    this->m_thread.join();
+    close(this->m_socket);
+
+    for (auto client : this->m_client_sockets) {
+        shutdown(client, SHUT_RDWR);
+    }
+
+    for (auto &thread : this->m_clients) {
+        thread.join();
+    }
+
+    for (auto client : this->m_client_sockets) {
+        close(client);
+    }
+}
+
+/**
+ * Gets the URL of a page of the server.
+ * @param path Page path.
+ * @return URL.
+ */
+std::string HttpStandIn::get_url(const std::string &path) const
+{
+    return "http://127.0.0.1:" + std::to_string(this->m_port) + path;
+}
+
+/**
+ * Gets the number of connections accepted.
+ * @return Number of connections.
+ */
+unsigned HttpStandIn::get_connections() const
+{
+    return this->m_connections;
+}
+
+/**
+ * Gets the number of requests answered.
+ * @return Number of requests.
+ */
+unsigned HttpStandIn::get_requests() const
+{
+    return this->m_requests;
+}
+
+} // Bench
@@ -0,0 +1,63 @@
+/**
+ * @file
+ * HttpStandIn class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef HTTPSTANDIN_HPP
+#define HTTPSTANDIN_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Namespace used by the benchmarks.
+ */
+namespace Bench
+{
+
+/**
+ * Minimal local HTTP/1.1 server standing in for the game information sites.
+ * It answers every GET and POST request with the same page, its ETag and
+ * its Last-Modified date, keeps the connections alive and answers 304 Not
+ * Modified to the requests revalidating them. It counts the accepted
+ * connections so the connection reuse of the client can be checked.
+ * It listens on a free port of the loopback interface.
+ */
+class HttpStandIn final
+{
+private:
+    std::string m_body,                       ///< Page served.
+                m_etag,                       ///< ETag of the page, empty for none.
+                m_last_modified;              ///< Last-Modified date of the page.
+    int m_socket = -1;                        ///< Listening socket.
+    unsigned short m_port = 0;                ///< Listening port.
+    std::thread m_thread;                     ///< Accepts the connections.
+    std::mutex m_mutex;                       ///< Protects m_clients.
+    std::vector<std::thread> m_clients;       ///< Connection threads.
+    std::vector<int> m_client_sockets;        ///< Connection sockets, closed when stopping.
+    std::atomic<unsigned> m_connections{0},   ///< Accepted connections.
+                          m_requests{0};      ///< Answered requests.
+
+    void accept_connections();
+    void serve(int client);
+
+public:
+    explicit HttpStandIn(const std::string &body, bool use_etag = true);
+    HttpStandIn(const HttpStandIn&) = delete;
+    HttpStandIn &operator=(const HttpStandIn&) = delete;
+    ~HttpStandIn();
+
+    std::string get_url(const std::string &path = "/") const;
+    unsigned get_connections() const;
+    unsigned get_requests() const;
+};
+
+} // Bench
+
+#endif // HTTPSTANDIN_HPP
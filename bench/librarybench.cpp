@@ -0,0 +1,140 @@
+/**
+ * @file
+ * Benchmarks of the profiles XML file and the profile config files.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "corpus.hpp"
+#include "profilelibrary.h"
+#include "autoexec.h"
+#include <glibmm/fileutils.h>
+#include <glibmm/keyfile.h>
+#include <benchmark/benchmark.h>
+#include <cstdio>
+
+using namespace DOSBoxGTK;
+
+/**
+ * Copies a corpus file to the temporary directory, so the benchmarks writing
+ * it do not change the corpus.
+ * @param name Corpus file name.
+ * @return Path of the copy.
+ */
+static std::string copy_corpus(const std::string &name)
+{
+    auto path = Bench::get_temp_path(name);
+
+    Glib::file_set_contents(path, Bench::read_corpus(name));
+
+    return path;
+}
+
+/**
+ * Loads the profiles XML file of the corpus.
+ * @param state Benchmark state.
+ */
+static void BM_ProfilesLoad(benchmark::State &state)
+{
+    auto filename = copy_corpus("profiles.xml");
+    std::size_t profiles = 0;
+
+    for (auto _ : state) {
+        ProfileLibrary library;
+
+        library.load(filename);
+        profiles = library.get_snapshot()->size();
+    }
+
+    state.SetItemsProcessed(state.iterations() * profiles);
+    std::remove(filename.c_str());
+}
+BENCHMARK(BM_ProfilesLoad)->Unit(benchmark::kMillisecond);
+
+/**
+ * Saves the profiles XML file of the corpus.
+ * @param state Benchmark state.
+ */
+static void BM_ProfilesSave(benchmark::State &state)
+{
+    auto filename = copy_corpus("profiles.xml");
+    ProfileLibrary library;
+
+    library.load(filename);
+
+    for (auto _ : state) {
+        library.save();
+    }
+
+    state.SetItemsProcessed(state.iterations() * library.get_snapshot()->size());
+    std::remove(filename.c_str());
+}
+BENCHMARK(BM_ProfilesSave)->Unit(benchmark::kMillisecond);
+
+/**
+ * Loads a profile config file the way EditProfileDialog::load_config_file()
+ * does, reading every key instead of setting the widgets.
+ * @param state Benchmark state.
+ */
+static void BM_ConfigLoad(benchmark::State &state)
+{
+    auto filename = Bench::get_corpus_path("game.conf");
+
+    for (auto _ : state) {
+        auto config_parts(Autoexec::split(Glib::file_get_contents(filename)));
+        Glib::KeyFile config;
+
+        config.load_from_data(config_parts[0]);
+
+        for (auto &group : config.get_groups()) {
+            for (auto &key : config.get_keys(group)) {
+                benchmark::DoNotOptimize(config.get_value(group, key));
+            }
+        }
+
+        if (config_parts.size() > 1) {
+            benchmark::DoNotOptimize(Autoexec::parse(config_parts[1]));
+        }
+    }
+}
+BENCHMARK(BM_ConfigLoad);
+
+/**
+ * Saves a profile config file the way EditProfileDialog::save_config_file()
+ * does, writing only the values different from the default config.
+ * @param state Benchmark state.
+ */
+static void BM_ConfigSave(benchmark::State &state)
+{
+    auto default_filename = Bench::get_corpus_path("dosbox.conf"),
+         filename         = Bench::get_temp_path("game.conf");
+    auto game_parts(Autoexec::split(Bench::read_corpus("game.conf")));
+    Glib::KeyFile game_config;
+
+    game_config.load_from_data(game_parts[0]);
+
+    for (auto _ : state) {
+        Glib::KeyFile default_config, config;
+
+        config.set_comment(" DOSBox config file for 'Monkey Island 2: LeChuck's Revenge'");
+        default_config.load_from_file(default_filename);
+
+        for (auto &group : default_config.get_groups()) {
+            for (auto &key : default_config.get_keys(group)) {
+                if (game_config.has_group(group) && game_config.has_key(group, key)) {
+                    auto value = game_config.get_value(group, key);
+
+                    if (value != default_config.get_value(group, key)) {
+                        config.set_value(group, key, value);
+                    }
+                }
+            }
+        }
+
+        Glib::file_set_contents(filename, config.to_data() + "\n[autoexec]" + game_parts[1]);
+    }
+
+    std::remove(filename.c_str());
+}
+BENCHMARK(BM_ConfigSave);
@@ -0,0 +1,426 @@
+/**
+ * @file
+ * LibraryGenerator class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "librarygenerator.hpp"
+#include "config.h"
+#include "mountcommand.h"
+#include "imgmountcommand.h"
+#include <glibmm/fileutils.h>
+#include <glibmm/keyfile.h>
+#include <glibmm/miscutils.h>
+#include <glib.h>
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+/**
+ * Namespace used by the benchmarks.
+ */
+namespace Bench
+{
+
+static const char *s_title_words[] = {"Monkey", "Tentacle", "Doom", "Keen", "Descent", "Lemmings", "Ultima", "Wing",
+                                      "Dune", "Syndicate", "Quest", "Moon", "Island", "Empire", "Galaxy", "Dungeon",
+                                      "Throttle", "Atlantis", "Shadow", "Tomb", "Arena", "Pirates", "Castle", "Star"}; ///< Words titles are made of.
+static const char *s_title_prefixes[] = {"", "The", "Super", "Return to", "Secret of", "Legend of", "Night of",
+                                         "Curse of", "Space", "Alone in"};                                               ///< Title prefixes.
+static const char *s_companies[] = {"LucasArts", "Sierra On-Line", "id Software", "Apogee Software", "MicroProse",
+                                    "Origin Systems", "Westwood Studios", "Bullfrog Productions", "Brøderbund Software",
+                                    "Psygnosis", "Interplay Productions", "Epic MegaGames", "Access Software",
+                                    "Looking Glass Technologies", "SSI", "Infogrames", "Delphine Software", "Blizzard Entertainment"}; ///< Developers and publishers.
+static const char *s_genres[] = {"Adventure", "Action", "Strategy", "Role-Playing (RPG)", "Simulation", "Puzzle",
+                                 "Racing / Driving", "Sports", "Educational"};                                    ///< Genres.
+static const char *s_note_words[] = {"needs", "cycles", "fixed", "max", "sound", "blaster", "gravis", "midi", "mt-32",
+                                     "install", "from", "cd", "floppy", "disk", "copy", "protection", "manual", "page",
+                                     "code", "wheel", "patch", "version", "1.1", "english", "spanish", "talkie", "ems",
+                                     "xms", "memory", "loadfix", "crashes", "after", "intro", "save", "slot", "the",
+                                     "a", "and", "of", "to", "&", "<b>", "\"works\""};                         ///< Words notes are made of.
+
+/**
+ * Constructor.
+ * @param root Root directory of the library. It is created if missing.
+ * @param options Generation options.
+ */
+LibraryGenerator::LibraryGenerator(const std::string &root, const LibraryOptions &options) :
+    m_root(root), m_options(options), m_random(options.seed)
+{}
+
+/**
+ * Gets a random number.
+ * @param max Upper bound, not included.
+ * @return Number between 0 and max - 1.
+ */
+unsigned LibraryGenerator::get_random(unsigned max)
+{
+    return std::uniform_int_distribution<unsigned>(0, max - 1)(this->m_random);
+}
+
+/**
+ * Tosses a biased coin.
+ * @param probability Probability of returning @c TRUE.
+ * @return @c TRUE with the given probability.
+ */
+bool LibraryGenerator::get_chance(double probability)
+{
+    return std::bernoulli_distribution(probability)(this->m_random);
+}
+
+/**
+ * Creates a game title. Titles repeat after some thousands of profiles, like
+ * collections with several versions of the same game, and get a sequel
+ * number then.
+ * @param index Profile index.
+ * @return Game title.
+ */
+Glib::ustring LibraryGenerator::get_title(unsigned index)
+{
+    unsigned n_words    = std::size(s_title_words),
+             n_prefixes = std::size(s_title_prefixes);
+    auto combinations = n_prefixes * n_words * n_words;
+    Glib::ustring prefix = s_title_prefixes[index % n_prefixes],
+                  title  = Glib::ustring::compose("%1 %2", s_title_words[(index / n_prefixes) % n_words],
+                                                  s_title_words[(index / (n_prefixes * n_words)) % n_words]);
+
+    if (!prefix.empty()) {
+        title = prefix + " " + title;
+    }
+
+    if (index >= combinations) {
+        title += Glib::ustring::compose(" %1", index / combinations + 1);
+    }
+
+    return title;
+}
+
+/**
+ * Creates the notes of a profile. 55% of the notes are empty, and the rest
+ * are mostly short with a few very long ones.
+ * @return Profile notes.
+ */
+Glib::ustring LibraryGenerator::get_notes()
+{
+    unsigned words;
+    Glib::ustring notes;
+
+    if (this->get_chance(0.55)) {
+        return notes;
+    }
+
+    auto size = this->get_random(100);
+
+    if (size < 70) {
+        words = 5 + this->get_random(25);
+    } else if (size < 95) {
+        words = 30 + this->get_random(170);
+    } else {
+        words = 200 + this->get_random(1300);
+    }
+
+    for (unsigned i = 0; i < words; ++i) {
+        notes += s_note_words[this->get_random(std::size(s_note_words))];
+        notes += this->get_random(12) == 0 ? ".\n" : " ";
+    }
+
+    return notes;
+}
+
+/**
+ * Creates the profile data.
+ * @param index Profile index, used as its ID.
+ * @return New profile.
+ */
+DOSBoxGTK::Profile LibraryGenerator::create_profile(unsigned index)
+{
+    DOSBoxGTK::Profile profile;
+
+    profile.id        = Glib::ustring::compose("%1", index);
+    profile.title     = this->get_title(index);
+    profile.developer = s_companies[this->get_random(std::size(s_companies))];
+    profile.publisher = this->get_chance(0.6) ? profile.developer : Glib::ustring(s_companies[this->get_random(std::size(s_companies))]);
+    profile.genre     = s_genres[this->get_random(std::size(s_genres))];
+    profile.year      = Glib::ustring::compose("%1", 1983 + this->get_random(17));
+    profile.notes     = this->get_notes();
+
+    return profile;
+}
+
+/**
+ * Decides the files and mounts of a game.
+ * @param title Game title, used to name its directory.
+ * @return Game description.
+ */
+LibraryGenerator::Game LibraryGenerator::create_game(const Glib::ustring &title)
+{
+    Game game;
+    std::string dir_name = title;
+
+    // One in five directories keeps the spaces, so the commands need quotes.
+    if (!this->get_chance(0.2)) {
+        dir_name = title.lowercase();
+        std::replace(dir_name.begin(), dir_name.end(), ' ', '_');
+    }
+
+    game.dir = Glib::build_filename(this->m_root, "games", dir_name);
+
+    std::string exe = Glib::ustring(title, 0, 8).uppercase();
+
+    std::replace(exe.begin(), exe.end(), ' ', '_');
+    game.program = this->get_chance(0.3) ? Glib::ustring(Glib::build_filename("GAME", exe + ".EXE")) : Glib::ustring(exe + ".EXE");
+
+    if (this->get_chance(0.4)) {
+        game.setup = this->get_chance(0.5) ? "SETUP.EXE" : "INSTALL.EXE";
+    }
+
+    // CD: images or a directory, some games with several discs.
+    if (this->get_chance(0.25)) {
+        if (this->get_chance(0.6)) {
+            std::vector<Glib::ustring> discs;
+            auto n_discs = this->get_chance(0.15) ? 2 + this->get_random(3) : 1;
+            auto extension = this->get_chance(0.5) ? "iso" : "cue";
+
+            for (unsigned i = 1; i <= n_discs; ++i) {
+                discs.push_back(Glib::build_filename(game.dir, "cd", Glib::ustring::compose("disc%1.%2", i, extension)));
+            }
+
+            game.images.insert(game.images.end(), discs.begin(), discs.end());
+            game.mounts.push_back(DOSBoxGTK::ImgmountCommand('D', discs, "cdrom").get_command());
+        } else {
+            auto cd_dir = Glib::build_filename(game.dir, "cd");
+
+            game.cd_dirs.push_back(cd_dir);
+            game.mounts.push_back(DOSBoxGTK::MountCommand('D', cd_dir, "cdrom", Glib::ustring(exe, 0, 8)).get_command());
+        }
+    }
+
+    // Floppies, or booter games.
+    if (this->get_chance(0.08)) {
+        std::vector<Glib::ustring> disks;
+        auto n_disks = 1 + this->get_random(4);
+
+        for (unsigned i = 1; i <= n_disks; ++i) {
+            disks.push_back(Glib::build_filename(game.dir, "floppy", Glib::ustring::compose("disk%1.img", i)));
+        }
+
+        game.images.insert(game.images.end(), disks.begin(), disks.end());
+
+        if (this->get_chance(0.35)) {
+            game.boot_images = disks;
+        } else {
+            game.mounts.push_back(DOSBoxGTK::ImgmountCommand('A', disks, "floppy").get_command());
+        }
+    }
+
+    return game;
+}
+
+/**
+ * Creates the autoexec group of a config file, in the format written by
+ * EditProfileDialog.
+ * @param game Game description.
+ * @param for_setup Whether to run the setup program instead of the game.
+ * @return Autoexec group, including its header.
+ */
+Glib::ustring LibraryGenerator::create_autoexec(const Game &game, bool for_setup)
+{
+    Glib::ustring autoexec;
+    auto program = for_setup ? game.setup : game.program;
+    auto loadfix = !for_setup && this->get_chance(0.1);
+
+    if (!for_setup) {
+        if (this->get_chance(0.15)) {
+            autoexec += Glib::ustring::compose("MIXER.COM MASTER %1:%1 SPKR %2:%2\n", 60 + this->get_random(41), this->get_random(101));
+        }
+
+        if (this->get_chance(0.1)) {
+            autoexec += "KEYB.COM sp 850\n";
+        }
+
+        if (loadfix) {
+            autoexec += Glib::ustring::compose("LOADFIX.COM -%1\n", 16 * (1 + this->get_random(4)));
+        }
+    }
+
+    autoexec += DOSBoxGTK::MountCommand('C', game.dir).get_command() + "\n";
+
+    for (auto &mount : game.mounts) {
+        autoexec += mount + "\n";
+    }
+
+    if (!game.boot_images.empty() && !for_setup) {
+        autoexec += "BOOT.COM -l A";
+
+        for (auto &image : game.boot_images) {
+            auto quote = image.find(' ') != Glib::ustring::npos ? "\"" : "";
+
+            autoexec += Glib::ustring::compose(" %1%2%1", quote, image);
+        }
+
+        return "[autoexec]\n" + autoexec + "\n";
+    }
+
+    auto program_dir = Glib::path_get_dirname(program);
+
+    autoexec += "C:\n";
+
+    if (program_dir != ".") {
+        autoexec += Glib::ustring::compose("CD /%1\n", program_dir);
+    }
+
+    if (!for_setup && this->get_chance(0.05)) {
+        autoexec += "LOADHIGH ";
+    }
+
+    autoexec += Glib::path_get_basename(program) + "\n";
+
+    if (loadfix) {
+        autoexec += "LOADFIX.COM -f\n";
+    }
+
+    if (for_setup || this->get_chance(0.7)) {
+        autoexec += "EXIT\n";
+    }
+
+    return "[autoexec]\n" + autoexec;
+}
+
+/**
+ * Creates the config part of a profile config file with the values usually
+ * changed from the defaults.
+ * @param profile Profile the config file belongs to.
+ * @return Config file contents but the autoexec group.
+ */
+Glib::ustring LibraryGenerator::create_config(const DOSBoxGTK::Profile &profile)
+{
+    Glib::KeyFile config;
+
+    config.set_comment(Glib::ustring::compose(" DOSBox config file for '%1'\n"
+                                              " This config file was generated by %2 version %3.%4.",
+                                              profile.title, PROJECT_NAME, VERSION_MAJOR, VERSION_MINOR));
+
+    if (this->get_chance(0.5)) {
+        config.set_boolean("sdl", "fullscreen", true);
+        config.set_value("sdl", "fullresolution", this->get_chance(0.5) ? "1920x1080" : "desktop");
+    }
+
+    if (this->get_chance(0.3)) {
+        config.set_value("sdl", "output", this->get_chance(0.7) ? "opengl" : "overlay");
+    }
+
+    if (this->get_chance(0.1)) {
+        config.set_value("dosbox", "machine", this->get_chance(0.5) ? "vgaonly" : "tandy");
+    }
+
+    if (this->get_chance(0.2)) {
+        config.set_value("render", "scaler", this->get_chance(0.5) ? "hq2x" : "advmame2x");
+    }
+
+    if (this->get_chance(0.6)) {
+        auto cycles = this->get_random(3);
+
+        config.set_value("cpu", "cycles", cycles == 0 ? Glib::ustring("max")
+                                                      : Glib::ustring::compose("fixed %1", 1000 * (1 + this->get_random(40))));
+        config.set_value("cpu", "core", this->get_chance(0.5) ? "dynamic" : "normal");
+    }
+
+    if (this->get_chance(0.25)) {
+        config.set_value("sblaster", "sbtype", this->get_chance(0.5) ? "sbpro2" : "sb2");
+        config.set_value("sblaster", "oplmode", "opl3");
+    }
+
+    if (this->get_chance(0.05)) {
+        config.set_boolean("gus", "gus", true);
+    }
+
+    return config.to_data();
+}
+
+/**
+ * Creates the empty files and directories of a game.
+ * @param game Game description.
+ */
+void LibraryGenerator::create_game_files(const Game &game)
+{
+    std::vector<std::string> files = {Glib::build_filename(game.dir, game.program),
+                                      Glib::build_filename(game.dir, "README.TXT"),
+                                      Glib::build_filename(game.dir, "DATA", "RESOURCE.001"),
+                                      Glib::build_filename(game.dir, "DATA", "RESOURCE.002")};
+
+    if (!game.setup.empty()) {
+        files.push_back(Glib::build_filename(game.dir, game.setup));
+    }
+
+    files.insert(files.end(), game.images.begin(), game.images.end());
+
+    for (auto &dir : game.cd_dirs) {
+        files.push_back(Glib::build_filename(dir, "INSTALL.EXE"));
+    }
+
+    for (auto &file : files) {
+        g_mkdir_with_parents(Glib::path_get_dirname(file).c_str(), 0755);
+        Glib::file_set_contents(file, "");
+    }
+}
+
+/**
+ * Gets the directory of the profile files.
+ * @return Directory to be used as the "profiles-path" setting.
+ */
+std::string LibraryGenerator::get_profiles_path() const
+{
+    return Glib::build_filename(this->m_root, "profiles");
+}
+
+/**
+ * Gets the profiles XML file.
+ * @return Profiles XML file path.
+ */
+std::string LibraryGenerator::get_profiles_filename() const
+{
+    return Glib::build_filename(this->get_profiles_path(), PROFILES_FILENAME);
+}
+
+/**
+ * Generates the library, replacing the files of a previous one.
+ */
+void LibraryGenerator::generate()
+{
+    auto profiles_path = this->get_profiles_path();
+    std::vector<DOSBoxGTK::ProfilePtr> profiles;
+    DOSBoxGTK::ProfileLibrary library;
+
+    g_mkdir_with_parents(profiles_path.c_str(), 0755);
+
+    for (unsigned i = 0; i < this->m_options.profiles; ++i) {
+        auto profile = std::make_shared<DOSBoxGTK::Profile>(this->create_profile(i));
+        auto game = this->create_game(profile->title);
+        auto config = this->create_config(*profile);
+
+        Glib::file_set_contents(Glib::build_filename(profiles_path, Glib::ustring::compose("%1.conf", profile->id)),
+                                config + "\n" + this->create_autoexec(game, false));
+
+        if (!game.setup.empty()) {
+            Glib::file_set_contents(Glib::build_filename(profiles_path, Glib::ustring::compose("%1_setup.conf", profile->id)),
+                                    config + "\n" + this->create_autoexec(game, true));
+        }
+
+        if (this->m_options.create_games) {
+            this->create_game_files(game);
+        }
+
+        profiles.push_back(profile);
+    }
+
+    std::remove(this->get_profiles_filename().c_str());
+    library.load(this->get_profiles_filename());
+    library.update([&profiles](const DOSBoxGTK::ProfileSnapshotPtr &snapshot) {
+        return snapshot->with_profiles(profiles);
+    });
+    library.save();
+}
+
+} // Bench
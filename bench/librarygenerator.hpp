@@ -0,0 +1,92 @@
+/**
+ * @file
+ * LibraryGenerator class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef LIBRARYGENERATOR_HPP
+#define LIBRARYGENERATOR_HPP
+
+#include "profilelibrary.h"
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Namespace used by the benchmarks.
+ */
+namespace Bench
+{
+
+/**
+ * Options of a generated library.
+ */
+struct LibraryOptions
+{
+    unsigned profiles = 1000; ///< Number of profiles.
+    unsigned seed     = 1;    ///< Random seed. The same seed gives the same library.
+    bool create_games = true; ///< Whether to create the fake game directory trees.
+};
+
+/**
+ * Generates synthetic profile libraries: the profiles XML file, the profile
+ * config files and fake game directories for them.
+ * The distributions follow the libraries seen in practice:
+ * - Most games are a single directory mounted as C. About a quarter add a CD,
+ *   as an image or a mounted directory, some with several discs, and a few
+ *   use floppy images.
+ * - A few profiles boot a disk image instead of running a program.
+ * - About 40% of the profiles have a setup program.
+ * - Most notes are empty, the rest are mostly short with a long tail.
+ * Library layout under the root directory:
+ * @code
+ * profiles/profiles.xml
+ * profiles/ID.conf
+ * profiles/ID_setup.conf
+ * games/SLUG/...
+ * @endcode
+ */
+class LibraryGenerator final
+{
+private:
+    /**
+     * Files and mounts of a generated game.
+     */
+    struct Game
+    {
+        std::string dir;                        ///< Game directory, mounted as C.
+        Glib::ustring program,                  ///< Program path relative to dir.
+                      setup;                    ///< Setup program path relative to dir, empty if there is none.
+        std::vector<Glib::ustring> mounts,      ///< MOUNT and IMGMOUNT commands but the C one.
+                                   images,      ///< Disk image files to create.
+                                   cd_dirs,     ///< CD directories to create.
+                                   boot_images; ///< BOOT images, empty if the game runs a program.
+    };
+
+    std::string m_root;       ///< Root directory of the library.
+    LibraryOptions m_options; ///< Generation options.
+    std::mt19937 m_random;    ///< Random number generator.
+
+    unsigned get_random(unsigned max);
+    bool get_chance(double probability);
+    Glib::ustring get_title(unsigned index);
+    Glib::ustring get_notes();
+    DOSBoxGTK::Profile create_profile(unsigned index);
+    Game create_game(const Glib::ustring &title);
+    Glib::ustring create_autoexec(const Game &game, bool for_setup);
+    Glib::ustring create_config(const DOSBoxGTK::Profile &profile);
+    void create_game_files(const Game &game);
+
+public:
+    LibraryGenerator(const std::string &root, const LibraryOptions &options);
+
+    std::string get_profiles_path() const;
+    std::string get_profiles_filename() const;
+    void generate();
+};
+
+} // Bench
+
+#endif // LIBRARYGENERATOR_HPP
@@ -0,0 +1,33 @@
+/**
+ * @file
+ * Benchmarks entry point.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include <glibmm/init.h>
+#include <benchmark/benchmark.h>
+
+/**
+ * Runs the benchmarks selected in the command line. See "--help" for the
+ * Google Benchmark options, like "--benchmark_filter=REGEX" or
+ * "--benchmark_format=json".
+ * @param argc Number of arguments.
+ * @param argv Arguments array.
+ * @return Process status.
+ */
+int main(int argc, char **argv)
+{
+    Glib::init();
+    benchmark::Initialize(&argc, argv);
+
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    return 0;
+}
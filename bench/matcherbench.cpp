@@ -0,0 +1,90 @@
+/**
+ * @file
+ * Benchmarks of the fuzzy title matcher.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "titlematcher.h"
+#include <benchmark/benchmark.h>
+#include <iterator>
+
+using namespace DOSBoxGTK;
+
+static const char *s_words[] = {"Monkey", "Island", "Prince", "Persia", "Commander", "Keen", "Ultima", "Quest",
+                                "Shadow", "Flame", "Secret", "Tentacle", "Wing", "Descent", "Dark", "Forces",
+                                "Lemmings", "Pirates", "Castle", "Wolfenstein", "Legend", "Kyrandia", "Star", "Control"}; ///< Words titles are made of.
+static const char *s_sequels[] = {"", " II", " 3", " IV: The Return", ": Director's Cut", " & Friends"}; ///< Title endings.
+
+/**
+ * Creates the normalized titles of a library.
+ * @param count Number of titles.
+ * @return Normalized titles.
+ */
+static std::vector<std::string> get_titles(unsigned count)
+{
+    std::vector<std::string> titles;
+    unsigned n_words = std::size(s_words);
+
+    for (unsigned i = 0; i < count; ++i) {
+        auto title = Glib::ustring::compose("%1 of the %2 %3%4", s_words[i % n_words], s_words[(i / n_words) % n_words],
+                                            s_words[(i / (n_words * n_words)) % n_words], s_sequels[i % std::size(s_sequels)]);
+
+        titles.push_back(TitleMatcher::normalize(title));
+    }
+
+    return titles;
+}
+
+/**
+ * Normalizes game titles.
+ * @param state Benchmark state.
+ */
+static void BM_TitleNormalize(benchmark::State &state)
+{
+    Glib::ustring title = "Prince of Persia II: The Shadow &amp; The Flame";
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(TitleMatcher::normalize(title));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TitleNormalize);
+
+/**
+ * Scores a library against a searched title, as the duplicate title check
+ * does.
+ * @param state Benchmark state. Its range is the number of titles.
+ */
+static void BM_TitleRank(benchmark::State &state)
+{
+    auto titles = get_titles(state.range(0));
+    TitleMatcher matcher("Prince of Persia 2: The Shadow & The Flame");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(matcher.rank(titles));
+    }
+
+    state.SetItemsProcessed(state.iterations() * titles.size());
+}
+BENCHMARK(BM_TitleRank)->Arg(1000)->Arg(30000)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Scores a library against a searched title with no minimum score, so every
+ * candidate goes through both similarities.
+ * @param state Benchmark state. Its range is the number of titles.
+ */
+static void BM_TitleRankAll(benchmark::State &state)
+{
+    auto titles = get_titles(state.range(0));
+    TitleMatcher matcher("Prince of Persia 2: The Shadow & The Flame");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(matcher.rank(titles, 0.0));
+    }
+
+    state.SetItemsProcessed(state.iterations() * titles.size());
+}
+BENCHMARK(BM_TitleRankAll)->Arg(30000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,159 @@
+/**
+ * @file
+ * Benchmarks of the DOSBox command and autoexec parsers and the HTML tools.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "corpus.hpp"
+#include "mountcommand.h"
+#include "imgmountcommand.h"
+#include "autoexec.h"
+#include "mixerdialog.h"
+#include "htmltools.hpp"
+#include <benchmark/benchmark.h>
+
+using namespace DOSBoxGTK;
+
+/**
+ * Parses every MOUNT command of the corpus.
+ * @param state Benchmark state.
+ */
+static void BM_MountCommandParse(benchmark::State &state)
+{
+    auto commands = Bench::read_corpus_lines("mount_commands.txt");
+    MountCommand command('C', "/");
+
+    for (auto _ : state) {
+        for (auto &line : commands) {
+            benchmark::DoNotOptimize(command.parse(line));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * commands.size());
+}
+BENCHMARK(BM_MountCommandParse);
+
+/**
+ * Formats every MOUNT command of the corpus.
+ * @param state Benchmark state.
+ */
+static void BM_MountCommandGetCommand(benchmark::State &state)
+{
+    std::vector<MountCommand> commands;
+
+    for (auto &line : Bench::read_corpus_lines("mount_commands.txt")) {
+        commands.emplace_back(line);
+    }
+
+    for (auto _ : state) {
+        for (auto &command : commands) {
+            benchmark::DoNotOptimize(command.get_command());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * commands.size());
+}
+BENCHMARK(BM_MountCommandGetCommand);
+
+/**
+ * Parses every IMGMOUNT command of the corpus.
+ * @param state Benchmark state.
+ */
+static void BM_ImgmountCommandParse(benchmark::State &state)
+{
+    auto commands = Bench::read_corpus_lines("imgmount_commands.txt");
+    ImgmountCommand command('D', {"/"});
+
+    for (auto _ : state) {
+        for (auto &line : commands) {
+            benchmark::DoNotOptimize(command.parse(line));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * commands.size());
+}
+BENCHMARK(BM_ImgmountCommandParse);
+
+/**
+ * Splits a profile config file in its config and autoexec parts.
+ * @param state Benchmark state.
+ */
+static void BM_AutoexecSplit(benchmark::State &state)
+{
+    auto contents = Bench::read_corpus(state.range(0) ? "dosbox.conf" : "game.conf");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Autoexec::split(contents));
+    }
+
+    state.SetBytesProcessed(state.iterations() * contents.bytes());
+}
+BENCHMARK(BM_AutoexecSplit)->ArgName("default_config")->Arg(0)->Arg(1);
+
+/**
+ * Parses the autoexec group of a profile config file, for the program and for
+ * the setup.
+ * @param state Benchmark state.
+ */
+static void BM_AutoexecParse(benchmark::State &state)
+{
+    auto for_setup = state.range(0) != 0;
+    auto parts = Autoexec::split(Bench::read_corpus(for_setup ? "game_setup.conf" : "game.conf"));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Autoexec::parse(parts[1], for_setup));
+    }
+}
+BENCHMARK(BM_AutoexecParse)->ArgName("for_setup")->Arg(0)->Arg(1);
+
+/**
+ * Parses every MIXER command of the corpus.
+ * @param state Benchmark state.
+ */
+static void BM_MixerParseCommand(benchmark::State &state)
+{
+    auto commands = Bench::read_corpus_lines("mixer_commands.txt");
+
+    for (auto _ : state) {
+        for (auto &line : commands) {
+            benchmark::DoNotOptimize(MixerDialog::parse_levels(line));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * commands.size());
+}
+BENCHMARK(BM_MixerParseCommand);
+
+/**
+ * Decodes the entities of a game information page.
+ * @param state Benchmark state.
+ */
+static void BM_HtmlEntitiesDecode(benchmark::State &state)
+{
+    auto html = Bench::read_corpus("mobygames.html");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Tools::html_entities_decode(html));
+    }
+
+    state.SetBytesProcessed(state.iterations() * html.bytes());
+}
+BENCHMARK(BM_HtmlEntitiesDecode);
+
+/**
+ * Encodes the entities of a decoded game information page.
+ * @param state Benchmark state.
+ */
+static void BM_HtmlEntitiesEncode(benchmark::State &state)
+{
+    auto text = Tools::html_entities_decode(Bench::read_corpus("mobygames.html"));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(Tools::html_entities_encode(text));
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.bytes());
+}
+BENCHMARK(BM_HtmlEntitiesEncode);
@@ -0,0 +1,294 @@
+/**
+ * @file
+ * Library scale test harness.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "librarygenerator.hpp"
+#include "profilefacetindex.h"
+#include "profilelibrary.h"
+#include "profilesearchindex.h"
+#include "profilevalidator.h"
+#include "profileviewupdater.h"
+#include <glibmm/fileutils.h>
+#include <glibmm/init.h>
+#include <glibmm/miscutils.h>
+#include <gtkmm/main.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+#define SCALE_DEFAULT_POINTS "10000,25000,50000,100000,200000" ///< Default library sizes.
+#define SCALE_DEFAULT_REPEAT 3                                 ///< Default number of runs of each measure.
+#define SCALE_BATCH_SIZE 20                                    ///< Profiles edited or deleted by each run.
+
+using namespace DOSBoxGTK;
+
+/**
+ * Columns of the profiles model, as in the main window.
+ */
+class ProfileColumns final : public Gtk::TreeModelColumnRecord
+{
+public:
+    Gtk::TreeModelColumn<Glib::ustring> title,     ///< Profile title.
+                                        id,        ///< Profile ID.
+                                        icon_name, ///< Status icon name.
+                                        tooltip;   ///< Status tooltip markup.
+
+    /**
+     * Constructor.
+     */
+    ProfileColumns()
+    {
+        this->add(this->title);
+        this->add(this->id);
+        this->add(this->icon_name);
+        this->add(this->tooltip);
+    }
+};
+
+/**
+ * Times a function.
+ * @param function Function to be timed.
+ * @param repeat Number of runs.
+ * @return Median run time in milliseconds.
+ */
+static double measure(const std::function<void()> &function, unsigned repeat)
+{
+    std::vector<double> times;
+
+    for (unsigned i = 0; i < repeat; ++i) {
+        auto start = std::chrono::steady_clock::now();
+
+        function();
+        times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::sort(times.begin(), times.end());
+
+    return times[times.size() / 2];
+}
+
+/**
+ * Gets the IDs of a batch of profiles spread over the library.
+ * @param snapshot Library version.
+ * @param run Run number, so every run takes different profiles.
+ * @return Profile IDs.
+ */
+static std::vector<Glib::ustring> get_batch(const ProfileSnapshotPtr &snapshot, unsigned run)
+{
+    auto profiles = snapshot->get_profiles();
+    std::vector<Glib::ustring> ids;
+
+    for (unsigned i = 0; i < SCALE_BATCH_SIZE && i < profiles.size(); ++i) {
+        ids.push_back(profiles[(i * 7919 + run * 104729) % profiles.size()]->id);
+    }
+
+    return ids;
+}
+
+/**
+ * Measures a library of the given size and prints its CSV row.
+ * The measures are each operation without drawing the window:
+ * - startup: loading the profiles XML file.
+ * - load_profiles: the main window load, syncing the facets index and
+ *   appending every profile to a title sorted profiles model through the
+ *   ProfileViewUpdater. It needs a display, and it is left empty without
+ *   one.
+ * - validate: the broken profiles check run after loading.
+ * - index: building the search index of the whole library, done in the
+ *   thread pool after loading.
+ * - search: searches of the search entry in that index.
+ * - edit_save: changing a profile, rewriting its config file and saving the
+ *   library, per profile.
+ * - delete: deleting a batch of profiles with their files and saving once.
+ * @param out CSV output.
+ * @param root Directory of the generated libraries.
+ * @param options Library options.
+ * @param repeat Number of runs of each measure.
+ * @param has_display Whether GTK could be initialized.
+ */
+static void run_scale_point(std::ostream &out, const std::string &root, const Bench::LibraryOptions &options, unsigned repeat, bool has_display)
+{
+    Bench::LibraryGenerator generator(Glib::build_filename(root, Glib::ustring::compose("%1", options.profiles)), options);
+    auto profiles_path = generator.get_profiles_path();
+    auto filename = generator.get_profiles_filename();
+    ProfileLibrary library;
+    ProfileSearchIndex search_index;
+    unsigned run = 0;
+    std::ostringstream load_profiles_ms;
+
+    auto generate_ms = measure([&generator] {
+        generator.generate();
+    }, 1);
+
+    auto startup_ms = measure([&filename] {
+        ProfileLibrary startup_library;
+
+        startup_library.load(filename);
+    }, repeat);
+
+    library.load(filename);
+
+    if (has_display) {
+        ProfileColumns columns;
+        auto store = Gtk::ListStore::create(columns);
+        Gtk::TreeView view(store);
+        std::map<Glib::ustring, Gtk::TreeIter> rows;
+        ProfileViewUpdater updater(view, rows);
+        ProfileFacetIndex facet_index;
+
+        store->set_sort_column(0, Gtk::SORT_ASCENDING);
+
+        // As MainWindow::load_profiles() and show_profiles() without a
+        // search nor filters, the view not being mapped.
+        load_profiles_ms << measure([&library, &store, &rows, &updater, &facet_index] {
+            auto snapshot = library.get_snapshot();
+
+            updater.clear();
+            rows.clear();
+            store->clear();
+            facet_index.sync(snapshot);
+
+            for (auto &profile : snapshot->get_profiles()) {
+                ProfileRowUpdate update;
+
+                update.id     = profile->id;
+                update.fields = ProfileRowUpdate::TITLE;
+                update.title  = profile->title;
+                updater.push(std::move(update));
+            }
+
+            updater.flush();
+        }, repeat);
+    }
+
+    auto validate_ms = measure([&library, &profiles_path] {
+        ProfileValidator validator(profiles_path);
+
+        validator.begin_pass();
+        library.get_snapshot()->for_each([&validator](const ProfilePtr &profile) {
+            validator.validate(profile->id);
+        });
+    }, repeat);
+
+    auto index_ms = measure([&library, &search_index] {
+        search_index.clear();
+        search_index.sync(library.get_snapshot());
+    }, repeat);
+
+    auto search_ms = measure([&search_index] {
+        for (auto query : {"mon", "secret of", "tomb", "alone in the", "zzz"}) {
+            search_index.search(query);
+        }
+    }, repeat);
+
+    auto edit_save_ms = measure([&library, &profiles_path, &run] {
+        for (auto &id : get_batch(library.get_snapshot(), run++)) {
+            auto profile = std::make_shared<Profile>(*library.get_snapshot()->find(id));
+            auto config_filename = Glib::build_filename(profiles_path, Glib::ustring::compose("%1.conf", id));
+
+            profile->notes += " Edited.";
+            library.set_profile(profile);
+            Glib::file_set_contents(config_filename, Glib::file_get_contents(config_filename));
+            library.save();
+        }
+    }, repeat) / SCALE_BATCH_SIZE;
+
+    auto delete_ms = measure([&library, &profiles_path, &run] {
+        for (auto &id : get_batch(library.get_snapshot(), run++)) {
+            std::remove(Glib::build_filename(profiles_path, Glib::ustring::compose("%1.conf", id)).c_str());
+            std::remove(Glib::build_filename(profiles_path, Glib::ustring::compose("%1_setup.conf", id)).c_str());
+            library.remove_profile(id);
+        }
+
+        library.save();
+    }, repeat);
+
+    out << options.profiles << ',' << generate_ms << ',' << startup_ms << ',' << load_profiles_ms.str() << ',' << validate_ms
+        << ',' << index_ms << ',' << search_ms << ',' << edit_save_ms << ',' << delete_ms << std::endl;
+}
+
+/**
+ * Runs the scale test. Usage:
+ * @code
+ * dosboxgtk_scale [--scales=N,N,...] [--repeat=N] [--seed=N] [--no-games] [--output=FILE] [--dir=DIR]
+ * @endcode
+ * A CSV row with the median time in milliseconds of each operation is
+ * written for each library size. Without a display, as when not run under
+ * xvfb-run, the profiles load is not measured.
+ * @param argc Number of arguments.
+ * @param argv Arguments array.
+ * @return Process status.
+ */
+int main(int argc, char **argv)
+{
+    std::string scales = SCALE_DEFAULT_POINTS,
+                output,
+                root   = Glib::build_filename(Glib::get_tmp_dir(), "dosboxgtk_scale");
+    unsigned repeat = SCALE_DEFAULT_REPEAT;
+    Bench::LibraryOptions options;
+    std::ofstream file;
+    bool has_display = gtk_init_check(&argc, &argv);
+
+    Glib::init();
+
+    if (has_display) {
+        Gtk::Main::init_gtkmm_internals();
+    } else {
+        std::cerr << "No display, load_profiles_ms is not measured" << std::endl;
+    }
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--scales=", 9) == 0) {
+            scales = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--repeat=", 9) == 0) {
+            repeat = std::max(1ul, std::strtoul(argv[i] + 9, nullptr, 10));
+        } else if (std::strncmp(argv[i], "--seed=", 7) == 0) {
+            options.seed = std::strtoul(argv[i] + 7, nullptr, 10);
+        } else if (std::strcmp(argv[i], "--no-games") == 0) {
+            options.create_games = false;
+        } else if (std::strncmp(argv[i], "--output=", 9) == 0) {
+            output = argv[i] + 9;
+        } else if (std::strncmp(argv[i], "--dir=", 6) == 0) {
+            root = argv[i] + 6;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--scales=N,N,...] [--repeat=N] [--seed=N] [--no-games] [--output=FILE] [--dir=DIR]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (!output.empty()) {
+        file.open(output);
+
+        if (!file) {
+            std::cerr << "Can not open " << output << std::endl;
+            return 1;
+        }
+    }
+
+    auto &out = output.empty() ? std::cout : file;
+    std::istringstream points(scales);
+    std::string point;
+
+    out << "profiles,generate_ms,startup_ms,load_profiles_ms,validate_ms,index_ms,search_ms,edit_save_ms,delete_ms" << std::endl;
+
+    while (std::getline(points, point, ',')) {
+        options.profiles = std::strtoul(point.c_str(), nullptr, 10);
+
+        if (options.profiles > 0) {
+            std::cerr << "Measuring " << options.profiles << " profiles..." << std::endl;
+            run_scale_point(out, root, options, repeat, has_display);
+        }
+    }
+
+    return 0;
+}
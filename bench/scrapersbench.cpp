@@ -0,0 +1,198 @@
+/**
+ * @file
+ * Benchmarks of the MobyGames scrapers.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "corpus.hpp"
+#include "mobygamesscraper.h"
+#include <glibmm/regex.h>
+#include <algorithm>
+#include <benchmark/benchmark.h>
+
+using namespace DOSBoxGTK;
+
+/**
+ * Builds a page that makes the old regular expression scrapers backtrack:
+ * a single line of game links without a DOS release, then value labels
+ * without a link after them. Every failed match scans to the end of the
+ * line or page.
+ * @param repeat Number of unfinished items.
+ * @return Page contents.
+ */
+static std::string get_pathological_page(int repeat)
+{
+    std::string html = "<html><body><h1 class=\"niceHeaderTitle\"><a href=\"/game/dos/x\">X</a></h1><div>";
+
+    for (int i = 0; i < repeat; ++i) {
+        html += "Game: <a href=\"/game/amiga/x\">X</a> Amiga (<i>1990</i>) ";
+    }
+
+    html += "</div>\n";
+
+    for (int i = 0; i < repeat; ++i) {
+        html += "<div>Published by</div><div>Unknown</div>\n";
+    }
+
+    return html + "</body></html>";
+}
+
+/**
+ * Extracts the information of a game page.
+ * @param state Benchmark state.
+ */
+static void BM_ScrapeGamePage(benchmark::State &state)
+{
+    std::string html = Bench::read_corpus("mobygames.html");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MobyGamesScraper::parse_game_page(html));
+    }
+
+    state.SetBytesProcessed(state.iterations() * html.size());
+}
+BENCHMARK(BM_ScrapeGamePage);
+
+/**
+ * Extracts the games of a search results page.
+ * @param state Benchmark state.
+ */
+static void BM_ScrapeSearchResults(benchmark::State &state)
+{
+    std::string html = Bench::read_corpus("mobygames_search.html");
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MobyGamesScraper::parse_search_results(html));
+    }
+
+    state.SetBytesProcessed(state.iterations() * html.size());
+}
+BENCHMARK(BM_ScrapeSearchResults);
+
+/**
+ * Extracts the games of a search results page fed in pieces of the given
+ * size, as they arrive from the network.
+ * @param state Benchmark state.
+ */
+static void BM_StreamSearchResults(benchmark::State &state)
+{
+    std::string html = Bench::read_corpus("mobygames_search.html");
+    std::size_t piece_size = state.range(0);
+
+    for (auto _ : state) {
+        std::size_t results = 0;
+        SearchResultsParser parser([&results](const GameSearchResult&) {
+            ++results;
+        });
+
+        for (std::size_t offset = 0; offset < html.size(); offset += piece_size) {
+            parser.feed(html.data() + offset, std::min(piece_size, html.size() - offset));
+        }
+
+        parser.finish();
+        benchmark::DoNotOptimize(results);
+    }
+
+    state.SetBytesProcessed(state.iterations() * html.size());
+}
+BENCHMARK(BM_StreamSearchResults)->Arg(512)->Arg(1460)->Arg(16384);
+
+/**
+ * Extracts the information of a game page with the regular expression the
+ * scraper used before, as a baseline.
+ * @param state Benchmark state.
+ */
+static void BM_ScrapeGamePageRegex(benchmark::State &state)
+{
+    Glib::ustring html = Bench::read_corpus("mobygames.html");
+    auto regex = Glib::Regex::create("niceHeaderTitle\">\\s*<a.+?>(?'title'.+?)\\s*<\\/a>|(?'key'Published by|Developed by|Released|Genre)<\\/div>.+?<a.+?>(?'value'.+?)<\\/a>|<h2>Description<\\/h2>(?'description'.+?)<div", Glib::REGEX_DOTALL);
+
+    for (auto _ : state) {
+        Glib::MatchInfo minfo;
+
+        regex->match(html, 0, minfo);
+
+        while (minfo.matches()) {
+            benchmark::DoNotOptimize(minfo.fetch(0));
+            minfo.next();
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * html.bytes());
+}
+BENCHMARK(BM_ScrapeGamePageRegex);
+
+/**
+ * Extracts the games of a search results page with the regular expression
+ * the scraper used before, as a baseline.
+ * @param state Benchmark state.
+ */
+static void BM_ScrapeSearchResultsRegex(benchmark::State &state)
+{
+    Glib::ustring html = Bench::read_corpus("mobygames_search.html");
+    auto regex = Glib::Regex::create("Game:\\s*<a\\s+href=\"(?'href'.+?)\">\\s*(?'title'.+?)\\s*<\\/a>\\s*.+?\\s*DOS\\s*\\(<em>\\s*(?'year'.+?)\\s*<\\/em>\\)");
+
+    for (auto _ : state) {
+        Glib::MatchInfo minfo;
+
+        regex->match(html, 0, minfo);
+
+        while (minfo.matches()) {
+            benchmark::DoNotOptimize(minfo.fetch(0));
+            minfo.next();
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * html.bytes());
+}
+BENCHMARK(BM_ScrapeSearchResultsRegex);
+
+/**
+ * Extracts the information of a pathological page, whose size grows with the
+ * argument.
+ * @param state Benchmark state.
+ */
+static void BM_ScrapePathologicalPage(benchmark::State &state)
+{
+    auto html = get_pathological_page(state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MobyGamesScraper::parse_game_page(html));
+        benchmark::DoNotOptimize(MobyGamesScraper::parse_search_results(html));
+    }
+
+    state.SetBytesProcessed(state.iterations() * html.size());
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ScrapePathologicalPage)->RangeMultiplier(4)->Range(256, 16384)->Complexity();
+
+/**
+ * Extracts the information of a pathological page with the old regular
+ * expressions, as a baseline. Backtracking makes it quadratic.
+ * @param state Benchmark state.
+ */
+static void BM_ScrapePathologicalPageRegex(benchmark::State &state)
+{
+    Glib::ustring html = get_pathological_page(state.range(0));
+    auto page_regex   = Glib::Regex::create("niceHeaderTitle\">\\s*<a.+?>(?'title'.+?)\\s*<\\/a>|(?'key'Published by|Developed by|Released|Genre)<\\/div>.+?<a.+?>(?'value'.+?)<\\/a>|<h2>Description<\\/h2>(?'description'.+?)<div", Glib::REGEX_DOTALL),
+         search_regex = Glib::Regex::create("Game:\\s*<a\\s+href=\"(?'href'.+?)\">\\s*(?'title'.+?)\\s*<\\/a>\\s*.+?\\s*DOS\\s*\\(<em>\\s*(?'year'.+?)\\s*<\\/em>\\)");
+
+    for (auto _ : state) {
+        for (auto regex : {page_regex, search_regex}) {
+            Glib::MatchInfo minfo;
+
+            regex->match(html, 0, minfo);
+
+            while (minfo.matches()) {
+                benchmark::DoNotOptimize(minfo.fetch(0));
+                minfo.next();
+            }
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * html.bytes());
+    state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ScrapePathologicalPageRegex)->RangeMultiplier(4)->Range(256, 4096)->Complexity();
@@ -0,0 +1,113 @@
+/**
+ * @file
+ * Benchmarks of the profile search index.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profilesearchindex.h"
+#include <benchmark/benchmark.h>
+#include <iterator>
+
+using namespace DOSBoxGTK;
+
+static const char *s_words[] = {"Monkey", "Island", "Prince", "Persia", "Commander", "Keen", "Ultima", "Quest",
+                                "Shadow", "Flame", "Secret", "Tentacle", "Wing", "Descent", "Dark", "Forces",
+                                "Lemmings", "Pirates", "Castle", "Wolfenstein", "Legend", "Kyrandia", "Star", "Control"}; ///< Words texts are made of.
+static const char *s_companies[] = {"Sierra", "LucasArts", "id Software", "Apogee", "Origin", "Westwood", "MicroProse", "Psygnosis"}; ///< Developers and publishers.
+static const char *s_genres[] = {"Adventure", "Action", "Role-Playing (RPG)", "Strategy", "Simulation", "Puzzle"}; ///< Game genres.
+static const char *s_queries[] = {"mon", "monkey isl", "p", "sierra 199", "role play", "wolfenstein origin 1993"}; ///< Searched texts.
+
+/**
+ * Creates a snapshot of a synthetic library.
+ * @param count Number of profiles.
+ * @return Library snapshot.
+ */
+static ProfileSnapshotPtr get_library(unsigned count)
+{
+    std::vector<ProfilePtr> profiles;
+    unsigned n_words = std::size(s_words);
+
+    for (unsigned i = 0; i < count; ++i) {
+        auto profile = std::make_shared<Profile>();
+
+        profile->id        = Glib::ustring::compose("%1", i);
+        profile->title     = Glib::ustring::compose("%1 of the %2 %3", s_words[i % n_words], s_words[(i / n_words) % n_words],
+                                                    s_words[(i / (n_words * n_words)) % n_words]);
+        profile->developer = s_companies[i % std::size(s_companies)];
+        profile->publisher = s_companies[(i / 3) % std::size(s_companies)];
+        profile->genre     = s_genres[i % std::size(s_genres)];
+        profile->year      = Glib::ustring::compose("%1", 1985 + i % 15);
+
+        if (i % 4 == 0) {
+            profile->notes = Glib::ustring::compose("Needs the %1 %2 patch to run with the %3 sound card.",
+                                                    s_words[(i / 7) % n_words], s_words[(i / 11) % n_words], s_companies[i % 5]);
+        }
+
+        profiles.push_back(profile);
+    }
+
+    return std::make_shared<ProfileSnapshot>()->with_profiles(profiles);
+}
+
+/**
+ * Indexes a whole library, as done when the main window opens.
+ * @param state Benchmark state. Its range is the number of profiles.
+ */
+static void BM_SearchIndexBuild(benchmark::State &state)
+{
+    auto snapshot = get_library(state.range(0));
+
+    for (auto _ : state) {
+        ProfileSearchIndex index;
+
+        index.sync(snapshot);
+        benchmark::DoNotOptimize(index.size());
+    }
+
+    state.SetItemsProcessed(state.iterations() * snapshot->size());
+}
+BENCHMARK(BM_SearchIndexBuild)->Arg(100000)->Unit(benchmark::kMillisecond);
+
+/**
+ * Searches a library, as done on each change of the search entry.
+ * @param state Benchmark state. Its first range is the number of profiles
+ * and the second one the index of the searched text.
+ */
+static void BM_SearchQuery(benchmark::State &state)
+{
+    ProfileSearchIndex index;
+    auto query = s_queries[state.range(1)];
+
+    index.sync(get_library(state.range(0)));
+    state.SetLabel(query);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.search(query));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SearchQuery)->ArgsProduct({{100000}, benchmark::CreateDenseRange(0, std::size(s_queries) - 1, 1)})->Unit(benchmark::kMicrosecond);
+
+/**
+ * Indexes again a changed profile, as done when a profile is saved.
+ * @param state Benchmark state. Its range is the number of profiles.
+ */
+static void BM_SearchIndexUpdate(benchmark::State &state)
+{
+    ProfileSearchIndex index;
+    auto snapshot = get_library(state.range(0));
+    auto profile = std::make_shared<Profile>(*snapshot->find("42"));
+
+    index.sync(snapshot);
+
+    for (auto _ : state) {
+        profile = std::make_shared<Profile>(*profile);
+        index.update(profile);
+    }
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_SearchIndexUpdate)->Arg(100000)->Unit(benchmark::kMicrosecond);
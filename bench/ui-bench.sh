@@ -0,0 +1,67 @@
+#!/bin/sh
+#
+# Runs the scripted UI latency benchmark on a generated library under a
+# virtual display.
+#
+# Author: Javier Campón Pichardo
+# Date: 2014
+# Copyright: GNU Public License Version 3
+#
+# Usage, from a build directory configured with -DENABLE_BENCHMARKS=ON:
+#
+#     ../bench/ui-bench.sh [PROFILES] [OUTPUT]
+#
+# PROFILES is the size of the generated library (1000 by default) and OUTPUT
+# the results CSV file (dosboxgtk-ui.csv by default). The number of profiles
+# edited is read from DOSBOXGTK_UI_BENCH_ROUNDS.
+# The benchmark runs under Xvfb through xvfb-run. Set UI_BENCH_BACKEND=broadway
+# to use the GTK Broadway backend instead.
+# The benchmark deletes profiles, so a new library is generated on every run
+# and the user settings are never used.
+
+set -e
+
+PROFILES=${1:-1000}
+OUTPUT=${2:-dosboxgtk-ui.csv}
+BUILD_DIR=$(pwd)
+SOURCE_DIR=$(cd "$(dirname "$0")/.." && pwd)
+WORK_DIR=$(mktemp -d)
+
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+"$BUILD_DIR/dosboxgtk_genlibrary" --profiles="$PROFILES" "$WORK_DIR/library"
+mkdir -p "$WORK_DIR/captures" "$WORK_DIR/config/glib-2.0/settings" "$WORK_DIR/schemas"
+
+# Settings pointing to the generated library, in a private keyfile backend.
+cat > "$WORK_DIR/config/glib-2.0/settings/keyfile" <<EOF
+[org/kazires/dosboxgtk]
+dosbox-path='/bin/true'
+default-config='$SOURCE_DIR/bench/corpus/dosbox.conf'
+profiles-path='$WORK_DIR/library/profiles'
+captures-path='$WORK_DIR/captures'
+EOF
+
+cp "$BUILD_DIR"/schemas/*.gschema.xml "$WORK_DIR/schemas/"
+glib-compile-schemas "$WORK_DIR/schemas"
+
+export GSETTINGS_BACKEND=keyfile
+export GSETTINGS_SCHEMA_DIR="$WORK_DIR/schemas"
+export XDG_CONFIG_HOME="$WORK_DIR/config"
+
+# Stall reports would add noise to the measures.
+export DOSBOXGTK_STALL_THRESHOLD=0
+
+case "${UI_BENCH_BACKEND:-xvfb}" in
+    broadway)
+        broadwayd :5 &
+        BROADWAYD_PID=$!
+        trap 'kill $BROADWAYD_PID; rm -rf "$WORK_DIR"' EXIT
+        sleep 1
+        GDK_BACKEND=broadway BROADWAY_DISPLAY=:5 "$BUILD_DIR/dosboxgtk" --ui-bench="$OUTPUT"
+        ;;
+    *)
+        xvfb-run -a -s "-screen 0 1280x1024x24" "$BUILD_DIR/dosboxgtk" --ui-bench="$OUTPUT"
+        ;;
+esac
+
+cat "$OUTPUT"
@@ -0,0 +1,362 @@
+/**
+ * @file
+ * AllocAccounting class implementation and operator new hooks.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "allocaccounting.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#define ALLOC_HEADER_SIZE 16 ///< Bytes in front of each block holding its size and tag. Keeps malloc()'s alignment.
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Allocation counters of a subsystem. They are constant initialized, so they
+ * can be used by allocations made before main().
+ */
+struct alignas(64) AllocCounters
+{
+    std::atomic<uint64_t> allocations{0},        ///< Allocations.
+                          bytes{0},              ///< Bytes allocated.
+                          steady_allocations{0}, ///< Allocations when the steady state was marked.
+                          steady_bytes{0};       ///< Bytes allocated when the steady state was marked.
+    std::atomic<int64_t> live_bytes{0},          ///< Bytes currently allocated.
+                         peak_bytes{0};          ///< Highest live_bytes value.
+};
+
+static AllocCounters s_counters[static_cast<int>(AllocTag::COUNT)];
+static thread_local AllocTag t_tag = AllocTag::OTHER;
+
+#ifdef ALLOC_ACCOUNTING
+/**
+ * Metadata stored in front of each block.
+ */
+struct AllocHeader
+{
+    size_t size;  ///< Requested size.
+    AllocTag tag; ///< Subsystem the block is charged to.
+};
+
+static_assert(sizeof(AllocHeader) <= ALLOC_HEADER_SIZE, "AllocHeader does not fit in ALLOC_HEADER_SIZE.");
+
+/**
+ * Charges an allocation to the current thread's subsystem.
+ * @param size Allocated bytes.
+ * @return Subsystem charged.
+ */
+static AllocTag charge(size_t size)
+{
+    auto tag = t_tag;
+    auto &counters = s_counters[static_cast<int>(tag)];
+    auto live = counters.live_bytes.fetch_add(size, std::memory_order_relaxed) + static_cast<int64_t>(size);
+    auto peak = counters.peak_bytes.load(std::memory_order_relaxed);
+
+    counters.allocations.fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(size, std::memory_order_relaxed);
+
+    while (live > peak && !counters.peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+
+    return tag;
+}
+
+/**
+ * Allocates a block with room for its header in front.
+ * @param size Requested size.
+ * @param alignment Requested alignment. The header takes this many bytes if it
+ * is bigger than ALLOC_HEADER_SIZE.
+ * @return Pointer for the caller, or @c nullptr if there is no memory.
+ */
+static void *allocate(size_t size, size_t alignment = ALLOC_HEADER_SIZE)
+{
+    auto offset = alignment > ALLOC_HEADER_SIZE ? alignment : ALLOC_HEADER_SIZE;
+    void *base = nullptr;
+
+    if (alignment > ALLOC_HEADER_SIZE) {
+        if (posix_memalign(&base, alignment, offset + size) != 0) {
+            return nullptr;
+        }
+    } else {
+        base = std::malloc(offset + size);
+
+        if (base == nullptr) {
+            return nullptr;
+        }
+    }
+
+    auto ptr = static_cast<char*>(base) + offset;
+    auto header = reinterpret_cast<AllocHeader*>(ptr - ALLOC_HEADER_SIZE);
+
+    header->size = size;
+    header->tag = charge(size);
+
+    return ptr;
+}
+
+/**
+ * Frees a block allocated by allocate() and credits its subsystem.
+ * @param ptr Pointer returned by allocate().
+ * @param alignment Alignment passed to allocate().
+ */
+static void deallocate(void *ptr, size_t alignment = ALLOC_HEADER_SIZE)
+{
+    if (ptr == nullptr) {
+        return;
+    }
+
+    auto offset = alignment > ALLOC_HEADER_SIZE ? alignment : ALLOC_HEADER_SIZE;
+    auto header = reinterpret_cast<AllocHeader*>(static_cast<char*>(ptr) - ALLOC_HEADER_SIZE);
+
+    s_counters[static_cast<int>(header->tag)].live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    std::free(static_cast<char*>(ptr) - offset);
+}
+
+/**
+ * Allocates a block, throwing on failure like the standard operator new.
+ * @param size Requested size.
+ * @param alignment Requested alignment.
+ * @return Pointer for the caller.
+ */
+static void *allocate_or_throw(size_t size, size_t alignment = ALLOC_HEADER_SIZE)
+{
+    while (true) {
+        auto ptr = allocate(size, alignment);
+
+        if (ptr != nullptr) {
+            return ptr;
+        }
+
+        auto handler = std::get_new_handler();
+
+        if (handler == nullptr) {
+            throw std::bad_alloc();
+        }
+
+        handler();
+    }
+}
+#endif // ALLOC_ACCOUNTING
+
+/**
+ * Checks whether the allocation accounting has been compiled in.
+ * @return @c TRUE if it is enabled or @c FALSE otherwise.
+ */
+bool AllocAccounting::is_enabled()
+{
+#ifdef ALLOC_ACCOUNTING
+    return true;
+#else
+    return false;
+#endif // ALLOC_ACCOUNTING
+}
+
+/**
+ * Gets the name of a tag.
+ * @param tag Allocation tag.
+ * @return Tag name.
+ */
+const char *AllocAccounting::get_tag_name(AllocTag tag)
+{
+    static_assert(static_cast<int>(AllocTag::COUNT) == 6, "Update get_tag_name() with the new tag.");
+
+    switch (tag) {
+    case AllocTag::XML:      return "xml";
+    case AllocTag::CONFIG:   return "config";
+    case AllocTag::AUTOEXEC: return "autoexec";
+    case AllocTag::NETWORK:  return "network";
+    case AllocTag::UI:       return "ui";
+    default:                 return "other";
+    }
+}
+
+/**
+ * Sets the calling thread's allocation tag. Use ALLOC_SCOPE() instead.
+ * @param tag New tag.
+ * @return Previous tag.
+ */
+AllocTag AllocAccounting::set_tag(AllocTag tag)
+{
+    auto previous = t_tag;
+
+    t_tag = tag;
+
+    return previous;
+}
+
+/**
+ * Gets the allocation figures of a subsystem. They are all 0 if the
+ * accounting is not enabled.
+ * @param tag Allocation tag.
+ * @return Allocation figures.
+ */
+AllocStats AllocAccounting::get_stats(AllocTag tag)
+{
+    auto &counters = s_counters[static_cast<int>(tag)];
+    AllocStats stats;
+
+    stats.allocations        = counters.allocations.load(std::memory_order_relaxed);
+    stats.bytes              = counters.bytes.load(std::memory_order_relaxed);
+    stats.steady_allocations = stats.allocations - counters.steady_allocations.load(std::memory_order_relaxed);
+    stats.steady_bytes       = stats.bytes - counters.steady_bytes.load(std::memory_order_relaxed);
+    stats.live_bytes         = counters.live_bytes.load(std::memory_order_relaxed);
+    stats.peak_bytes         = counters.peak_bytes.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+/**
+ * Marks the end of the startup. The steady state figures count from here.
+ */
+void AllocAccounting::mark_steady_state()
+{
+    for (auto &counters : s_counters) {
+        counters.steady_allocations.store(counters.allocations.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        counters.steady_bytes.store(counters.bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+/**
+ * Formats the figures of every subsystem as a table.
+ * @return Report, or an empty string if the accounting is not enabled.
+ */
+std::string AllocAccounting::report()
+{
+    std::string text;
+    char line[160];
+
+    if (!is_enabled()) {
+        return text;
+    }
+
+    std::snprintf(line, sizeof(line), "%-9s %12s %14s %13s %14s %12s %12s\n",
+                  "tag", "allocs", "bytes", "steady_allocs", "steady_bytes", "live_bytes", "peak_bytes");
+    text += line;
+
+    for (int i = 0; i < static_cast<int>(AllocTag::COUNT); ++i) {
+        auto tag = static_cast<AllocTag>(i);
+        auto stats = get_stats(tag);
+
+        std::snprintf(line, sizeof(line), "%-9s %12llu %14llu %13llu %14llu %12lld %12lld\n", get_tag_name(tag),
+                      static_cast<unsigned long long>(stats.allocations), static_cast<unsigned long long>(stats.bytes),
+                      static_cast<unsigned long long>(stats.steady_allocations), static_cast<unsigned long long>(stats.steady_bytes),
+                      static_cast<long long>(stats.live_bytes), static_cast<long long>(stats.peak_bytes));
+        text += line;
+    }
+
+    return text;
+}
+
+} // Tools
+
+#ifdef ALLOC_ACCOUNTING
+// Replacements of the global allocation functions. --------------------------
+
+void *operator new(size_t size)
+{
+    return Tools::allocate_or_throw(size);
+}
+
+void *operator new[](size_t size)
+{
+    return Tools::allocate_or_throw(size);
+}
+
+void *operator new(size_t size, const std::nothrow_t&) noexcept
+{
+    return Tools::allocate(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+    return Tools::allocate(size);
+}
+
+void *operator new(size_t size, std::align_val_t alignment)
+{
+    return Tools::allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment)
+{
+    return Tools::allocate_or_throw(size, static_cast<size_t>(alignment));
+}
+
+void *operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return Tools::allocate(size, static_cast<size_t>(alignment));
+}
+
+void *operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return Tools::allocate(size, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *ptr) noexcept
+{
+    Tools::deallocate(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    Tools::deallocate(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    Tools::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, size_t) noexcept
+{
+    Tools::deallocate(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t&) noexcept
+{
+    Tools::deallocate(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t&) noexcept
+{
+    Tools::deallocate(ptr);
+}
+
+void operator delete(void *ptr, std::align_val_t alignment) noexcept
+{
+    Tools::deallocate(ptr, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment) noexcept
+{
+    Tools::deallocate(ptr, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *ptr, size_t, std::align_val_t alignment) noexcept
+{
+    Tools::deallocate(ptr, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void *ptr, size_t, std::align_val_t alignment) noexcept
+{
+    Tools::deallocate(ptr, static_cast<size_t>(alignment));
+}
+
+void operator delete(void *ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    Tools::deallocate(ptr, static_cast<size_t>(alignment));
+}
+
+void operator delete[](void *ptr, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    Tools::deallocate(ptr, static_cast<size_t>(alignment));
+}
+#endif // ALLOC_ACCOUNTING
@@ -0,0 +1,116 @@
+/**
+ * @file
+ * AllocAccounting class declaration and allocation tagging macros.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef ALLOCACCOUNTING_HPP
+#define ALLOCACCOUNTING_HPP
+
+#include <cstdint>
+#include <string>
+
+#define ALLOC_CONCAT_IMPL(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_IMPL(a, b)
+
+#ifdef ALLOC_ACCOUNTING
+/**
+ * Charges the allocations made in the rest of the enclosing scope, on the
+ * current thread, to the given subsystem. It must not span a co_await.
+ * @param tag Tools::AllocTag value.
+ */
+#   define ALLOC_SCOPE(tag) Tools::AllocScope ALLOC_CONCAT(alloc_scope_, __LINE__)(tag)
+#else
+#   define ALLOC_SCOPE(tag) do {} while (false)
+#endif // ALLOC_ACCOUNTING
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Subsystem allocations are charged to.
+ */
+enum class AllocTag : uint8_t
+{
+    OTHER,    ///< Untagged allocations.
+    XML,      ///< Profiles XML parsing and writing.
+    CONFIG,   ///< DOSBox config files.
+    AUTOEXEC, ///< Autoexec parsing and generation.
+    NETWORK,  ///< Game information downloads and scraping.
+    UI,       ///< Windows and dialogs.
+    COUNT     ///< Number of tags, not a real tag.
+};
+
+/**
+ * Allocation figures of a subsystem.
+ */
+struct AllocStats
+{
+    uint64_t allocations = 0;        ///< Allocations since the process started.
+    uint64_t bytes = 0;              ///< Bytes allocated since the process started.
+    uint64_t steady_allocations = 0; ///< Allocations since mark_steady_state().
+    uint64_t steady_bytes = 0;       ///< Bytes allocated since mark_steady_state().
+    int64_t live_bytes = 0;          ///< Bytes currently allocated.
+    int64_t peak_bytes = 0;          ///< Highest value reached by live_bytes.
+};
+
+/**
+ * Opt-in accounting of the allocations made through operator new, enabled by
+ * configuring with -DENABLE_ALLOC_ACCOUNTING=ON. A global operator new hook
+ * charges each allocation to the subsystem tagged with ALLOC_SCOPE() on the
+ * allocating thread. Freed memory is credited to the subsystem that
+ * allocated it. Memory allocated by the C libraries through malloc() or
+ * g_malloc() is not seen.
+ */
+class AllocAccounting final
+{
+public:
+    AllocAccounting() = delete;
+
+    static bool is_enabled();
+    static const char *get_tag_name(AllocTag tag);
+    static AllocTag set_tag(AllocTag tag);
+    static AllocStats get_stats(AllocTag tag);
+    static void mark_steady_state();
+    static std::string report();
+};
+
+#ifdef ALLOC_ACCOUNTING
+/**
+ * Scope guard setting the current thread's allocation tag.
+ */
+class AllocScope final
+{
+private:
+    AllocTag m_previous; ///< Tag active before this one.
+
+public:
+    /**
+     * Constructor. Makes the given tag the active one.
+     * @param tag Subsystem charged with the allocations.
+     */
+    explicit AllocScope(AllocTag tag) :
+        m_previous(AllocAccounting::set_tag(tag))
+    {}
+
+    /**
+     * Destructor. Restores the previous tag.
+     */
+    ~AllocScope()
+    {
+        AllocAccounting::set_tag(this->m_previous);
+    }
+
+    AllocScope(const AllocScope&) = delete;
+    AllocScope &operator=(const AllocScope&) = delete;
+};
+#endif // ALLOC_ACCOUNTING
+
+} // Tools
+
+#endif // ALLOCACCOUNTING_HPP
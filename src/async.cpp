@@ -0,0 +1,297 @@
+/**
+ * @file
+ * Coroutine support implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "async.hpp"
+#include "log.hpp"
+#include "metrics.hpp"
+#include "allocaccounting.hpp"
+#include "httpclient.hpp"
+#include <glibmm/spawn.h>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+static auto &s_bytes_fetched = Metrics::get_counter("dosboxgtk_fetched_bytes_total", "Bytes downloaded from game information sites."); ///< Downloaded bytes counter.
+
+/**
+ * Logs the exceptions escaping an AsyncTask coroutine.
+ */
+void AsyncTask::promise_type::unhandled_exception()
+{
+    try {
+        throw;
+    } catch (const Glib::Exception &e) {
+        LOG_ERROR(LogCategory::GENERAL, "Unhandled exception in asynchronous task: %1", e.what());
+    } catch (const std::exception &e) {
+        LOG_ERROR(LogCategory::GENERAL, "Unhandled exception in asynchronous task: %1", e.what());
+    } catch (...) {
+        LOG_ERROR(LogCategory::GENERAL, "Unhandled exception in asynchronous task");
+    }
+}
+
+/**
+ * Runs the callback of invoke_on_main_context().
+ * @param data The callback.
+ * @return G_SOURCE_REMOVE.
+ */
+static gboolean on_main_context_idle(gpointer data)
+{
+    (*static_cast<std::function<void()>*>(data))();
+
+    return G_SOURCE_REMOVE;
+}
+
+/**
+ * Frees the callback of invoke_on_main_context().
+ * @param data The callback.
+ */
+static void on_main_context_idle_destroy(gpointer data)
+{
+    delete static_cast<std::function<void()>*>(data);
+}
+
+/**
+ * Runs a callback on the next main loop iteration. It can be called from any
+ * thread.
+ * @param callback Callback to be run.
+ */
+void invoke_on_main_context(std::function<void()> callback)
+{
+    g_idle_add_full(G_PRIORITY_DEFAULT, &on_main_context_idle, new std::function<void()>(std::move(callback)), &on_main_context_idle_destroy);
+}
+
+/**
+ * Resumes a coroutine on the main context, or destroys it if its token has
+ * been cancelled by then. It can be called from any thread.
+ * @param token Cancellation token of the coroutine.
+ * @param handle Suspended coroutine.
+ */
+void resume_on_main_context(const CancellationToken &token, std::coroutine_handle<> handle)
+{
+    invoke_on_main_context([token, handle] {
+        if (token.is_cancelled()) {
+            handle.destroy();
+        } else {
+            handle.resume();
+        }
+    });
+}
+
+/**
+ * Constructor.
+ * @param token Cancellation token.
+ * @param dialog Dialog to be shown.
+ */
+DialogResponseAwaitable::DialogResponseAwaitable(const CancellationToken &token, Gtk::Dialog &dialog) :
+    m_token(token), m_dialog(dialog)
+{}
+
+/**
+ * Destructor.
+ */
+DialogResponseAwaitable::~DialogResponseAwaitable()
+{
+    this->m_connection.disconnect();
+}
+
+/**
+ * The dialog has not responded yet.
+ * @return @c FALSE.
+ */
+bool DialogResponseAwaitable::await_ready() const
+{
+    return false;
+}
+
+/**
+ * Shows the dialog.
+ * @param handle Coroutine to be resumed when the dialog responds.
+ */
+void DialogResponseAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    // The coroutine is resumed from an idle source, so it can destroy the
+    // dialog without doing it in the middle of the signal emission.
+    this->m_connection = this->m_dialog.signal_response().connect([this, handle](int response_id) {
+        if (!this->m_responded) {
+            this->m_responded   = true;
+            this->m_response_id = response_id;
+            resume_on_main_context(this->m_token, handle);
+        }
+    });
+
+    this->m_dialog.show();
+}
+
+/**
+ * Gets the dialog response.
+ * @return Response ID.
+ */
+int DialogResponseAwaitable::await_resume()
+{
+    this->m_connection.disconnect();
+
+    return this->m_response_id;
+}
+
+/**
+ * Constructor.
+ * @param token Cancellation token.
+ * @param file File to be loaded.
+ */
+LoadContentsAwaitable::LoadContentsAwaitable(const CancellationToken &token, const Glib::RefPtr<Gio::File> &file) :
+    m_token(token), m_file(file)
+{}
+
+/**
+ * The file is always loaded asynchronously.
+ * @return @c FALSE.
+ */
+bool LoadContentsAwaitable::await_ready() const
+{
+    return false;
+}
+
+/**
+ * Starts loading the file.
+ * @param handle Coroutine to be resumed when the file has been loaded.
+ */
+void LoadContentsAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    this->m_file->load_contents_async([this, handle](Glib::RefPtr<Gio::AsyncResult> &result) {
+        try {
+            char *contents = nullptr;
+            gsize length   = 0;
+
+            this->m_file->load_contents_finish(result, contents, length);
+            this->m_contents.assign(contents, length);
+            g_free(contents);
+        } catch (...) {
+            this->m_exception = std::current_exception();
+        }
+
+        // Already on the main context, just check the token.
+        if (this->m_token.is_cancelled()) {
+            handle.destroy();
+        } else {
+            handle.resume();
+        }
+    });
+}
+
+/**
+ * Gets the file contents.
+ * @return File contents. If the file could not be loaded the error is thrown.
+ */
+std::string LoadContentsAwaitable::await_resume()
+{
+    if (this->m_exception) {
+        std::rethrow_exception(this->m_exception);
+    }
+
+    return std::move(this->m_contents);
+}
+
+/**
+ * Shows a dialog and awaits its response.
+ * @param token Cancellation token.
+ * @param dialog Dialog to be shown. It is not hidden afterwards.
+ * @return Awaitable returning the response ID.
+ */
+DialogResponseAwaitable dialog_response(const CancellationToken &token, Gtk::Dialog &dialog)
+{
+    return DialogResponseAwaitable(token, dialog);
+}
+
+/**
+ * Loads the contents of a file without blocking the main loop.
+ * @param token Cancellation token.
+ * @param file File to be loaded.
+ * @return Awaitable returning the file contents. It throws Glib::Error if
+ * the file can not be read.
+ */
+LoadContentsAwaitable load_contents(const CancellationToken &token, const Glib::RefPtr<Gio::File> &file)
+{
+    return LoadContentsAwaitable(token, file);
+}
+
+/**
+ * Runs a command and awaits its completion without blocking the main loop.
+ * @param token Cancellation token.
+ * @param command Command line.
+ * @return Awaitable returning the exit status and standard output.
+ */
+PoolAwaitable<SpawnResult> spawn_command_line(const CancellationToken &token, const std::string &command)
+{
+    return run_in_pool(token, [command] {
+        SpawnResult result;
+
+        Glib::spawn_command_line_sync(command, &result.output, nullptr, &result.exit_status);
+
+        return result;
+    });
+}
+
+/**
+ * Downloads a URL without blocking the main loop, reusing the connections
+ * and cached pages of the default HttpClient.
+ * @param token Cancellation token. Cancelling it aborts the transfer.
+ * @param url URL to be downloaded.
+ * @param post_fields POST request data. If it is empty a GET request is done.
+ * @return Awaitable returning the response body. It throws
+ * std::runtime_error on transfer errors.
+ */
+PoolAwaitable<std::string> fetch_url(const CancellationToken &token, const std::string &url, const std::string &post_fields)
+{
+    return run_in_pool(token, [token, url, post_fields] {
+        ALLOC_SCOPE(AllocTag::NETWORK);
+        auto response = HttpClient::get_default().fetch(token, url, post_fields);
+
+        if (!response.from_cache) {
+            s_bytes_fetched.add(response.body.size());
+        }
+
+        LOG_DEBUG(LogCategory::NETWORK, "%1 returned %2 bytes", url, response.body.size());
+
+        return std::move(response.body);
+    });
+}
+
+/**
+ * Downloads a URL without blocking the main loop nor keeping the response
+ * body in memory. The body is passed to a function as it arrives, from the
+ * pool thread running the transfer, so it can be parsed incrementally.
+ * @param token Cancellation token. Cancelling it aborts the transfer.
+ * @param url URL to be downloaded.
+ * @param post_fields POST request data. If it is empty a GET request is done.
+ * @param on_data Function called with each received piece of the body. It
+ * must not use the widgets, see invoke_on_main_context().
+ * @return Awaitable returning the size of the response body. It throws
+ * std::runtime_error on transfer errors.
+ */
+PoolAwaitable<std::size_t> fetch_url_stream(const CancellationToken &token, const std::string &url, const std::string &post_fields,
+                                            std::function<void(const char*, std::size_t)> on_data)
+{
+    return run_in_pool(token, [token, url, post_fields, on_data] {
+        ALLOC_SCOPE(AllocTag::NETWORK);
+        std::size_t total = 0;
+
+        HttpClient::get_default().fetch_stream(token, url, post_fields, [&on_data, &total](const char *data, std::size_t size) {
+            on_data(data, size);
+            total += size;
+        });
+        s_bytes_fetched.add(total);
+        LOG_DEBUG(LogCategory::NETWORK, "%1 returned %2 bytes", url, total);
+
+        return total;
+    });
+}
+
+} // Tools
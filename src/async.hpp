@@ -0,0 +1,194 @@
+/**
+ * @file
+ * Coroutine support for asynchronous operations resumed on the GLib main
+ * context.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef ASYNC_HPP
+#define ASYNC_HPP
+
+#include "taskgroup.hpp"
+#include <giomm/file.h>
+#include <gtkmm/dialog.h>
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <string>
+#include <type_traits>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Return type of the coroutines started from the main loop, usually signal
+ * handlers. The coroutine starts running immediately and nobody waits for
+ * it. Every awaitable of this file resumes it on the main context, so the
+ * code after a @c co_await can use the widgets.
+ * Awaitables take a CancellationToken. If it has been cancelled when the
+ * operation finishes, the coroutine is destroyed instead of resumed, so it
+ * never touches an object that no longer exists. Objects starting
+ * coroutines cancel their token in their destructor.
+ * Exceptions escaping the coroutine are logged.
+ */
+class AsyncTask final
+{
+public:
+    /**
+     * Coroutine promise.
+     */
+    struct promise_type
+    {
+        AsyncTask get_return_object() { return AsyncTask(); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+    };
+};
+
+/**
+ * Result of a command run with spawn_command_line().
+ */
+struct SpawnResult
+{
+    int exit_status = -1; ///< Exit status of the command.
+    std::string output;   ///< Standard output of the command.
+};
+
+void invoke_on_main_context(std::function<void()> callback);
+void resume_on_main_context(const CancellationToken &token, std::coroutine_handle<> handle);
+
+/**
+ * Awaitable running a function on the shared thread pool.
+ * @tparam T Type returned by the function, it can not be @c void.
+ */
+template <typename T>
+class PoolAwaitable final
+{
+private:
+    CancellationToken m_token;        ///< Cancels the coroutine resumption.
+    std::function<T()> m_function;   ///< Function run by the pool.
+    std::optional<T> m_result;        ///< Value returned by the function.
+    std::exception_ptr m_exception;   ///< Exception thrown by the function.
+
+public:
+    /**
+     * Constructor.
+     * @param token Cancellation token.
+     * @param function Function to be run by the pool. It must not use
+     * objects that may be destroyed before it finishes.
+     */
+    PoolAwaitable(const CancellationToken &token, std::function<T()> function) :
+        m_token(token), m_function(std::move(function))
+    {}
+
+    /**
+     * The function is always run in the pool.
+     * @return @c FALSE.
+     */
+    bool await_ready() const
+    {
+        return false;
+    }
+
+    /**
+     * Queues the function in the pool.
+     * @param handle Coroutine to be resumed when the function returns.
+     */
+    void await_suspend(std::coroutine_handle<> handle)
+    {
+        ThreadPool::get_default().push([this, handle] {
+            try {
+                this->m_result.emplace(this->m_function());
+            } catch (...) {
+                this->m_exception = std::current_exception();
+            }
+
+            resume_on_main_context(this->m_token, handle);
+        });
+    }
+
+    /**
+     * Gets the result of the function.
+     * @return Value returned by the function. If it threw an exception it is
+     * thrown again.
+     */
+    T await_resume()
+    {
+        if (this->m_exception) {
+            std::rethrow_exception(this->m_exception);
+        }
+
+        return std::move(*this->m_result);
+    }
+};
+
+/**
+ * Awaits a function run on the shared thread pool.
+ * @param token Cancellation token.
+ * @param function Function to be run by the pool.
+ * @return Awaitable returning the value returned by the function.
+ */
+template <typename F>
+PoolAwaitable<std::invoke_result_t<F>> run_in_pool(const CancellationToken &token, F function)
+{
+    return PoolAwaitable<std::invoke_result_t<F>>(token, std::move(function));
+}
+
+/**
+ * Awaitable showing a dialog and waiting for its response.
+ */
+class DialogResponseAwaitable final
+{
+private:
+    CancellationToken m_token;       ///< Cancels the coroutine resumption.
+    Gtk::Dialog &m_dialog;           ///< Dialog to be shown.
+    sigc::connection m_connection;   ///< Response signal connection.
+    int m_response_id = Gtk::RESPONSE_NONE; ///< Response received.
+    bool m_responded  = false;              ///< Whether the response has been received.
+
+public:
+    DialogResponseAwaitable(const CancellationToken &token, Gtk::Dialog &dialog);
+    ~DialogResponseAwaitable();
+
+    bool await_ready() const;
+    void await_suspend(std::coroutine_handle<> handle);
+    int await_resume();
+};
+
+/**
+ * Awaitable loading the contents of a file with Gio asynchronous I/O.
+ */
+class LoadContentsAwaitable final
+{
+private:
+    CancellationToken m_token;                ///< Cancels the coroutine resumption.
+    Glib::RefPtr<Gio::File> m_file;           ///< File to be loaded.
+    std::string m_contents;                   ///< File contents.
+    std::exception_ptr m_exception;           ///< Error loading the file.
+
+public:
+    LoadContentsAwaitable(const CancellationToken &token, const Glib::RefPtr<Gio::File> &file);
+
+    bool await_ready() const;
+    void await_suspend(std::coroutine_handle<> handle);
+    std::string await_resume();
+};
+
+DialogResponseAwaitable dialog_response(const CancellationToken &token, Gtk::Dialog &dialog);
+LoadContentsAwaitable load_contents(const CancellationToken &token, const Glib::RefPtr<Gio::File> &file);
+PoolAwaitable<SpawnResult> spawn_command_line(const CancellationToken &token, const std::string &command);
+PoolAwaitable<std::string> fetch_url(const CancellationToken &token, const std::string &url, const std::string &post_fields = std::string());
+PoolAwaitable<std::size_t> fetch_url_stream(const CancellationToken &token, const std::string &url, const std::string &post_fields,
+                                            std::function<void(const char*, std::size_t)> on_data);
+
+} // Tools
+
+#endif // ASYNC_HPP
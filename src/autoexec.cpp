@@ -0,0 +1,129 @@
+/**
+ * @file
+ * Autoexec parsing helpers implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "autoexec.h"
+#include "allocaccounting.hpp"
+#include <glibmm/stringutils.h>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Helpers for reading the autoexec group of a DOSBox config file without
+ * depending on any widget.
+ */
+namespace Autoexec
+{
+
+/**
+ * Removes comment lines from the given config file contents and splits it in
+ * order to separate the autoexec group from the rest of the config file.
+ * @param contents Config file contents.
+ * @return std::vector with the parts of the splitted config file. Index 0 for
+ * the config file contents witout the autoexec group and following indexes for
+ * the autoexec groups contents, if there is an autoexec group.
+ */
+std::vector<Glib::ustring> split(const Glib::ustring &contents)
+{
+    return Glib::Regex::split_simple("^\\s*\\[autoexec\\]\\s*$", contents, Glib::REGEX_MULTILINE, Glib::REGEX_MATCH_NEWLINE_ANY);
+}
+
+/**
+ * Parses a text line with the given regular expression.
+ * @param line Line to parse.
+ * @param regex Compiled regular expression for parsing the text line.
+ * @param minfo Glib::MachInfo object with the parsing results.
+ * @return @c TRUE if the regular expresion matches or @c FALSE otherwise.
+ */
+bool parse_line(const Glib::ustring &line, const Glib::RefPtr<Glib::Regex> &regex, Glib::MatchInfo &minfo)
+{
+    static auto comments_regex = Glib::Regex::create("^\\s*#.*$", Glib::REGEX_MULTILINE);
+
+    return !comments_regex->match(line) && regex->match(line, 0, minfo);
+}
+
+/**
+ * Parses the contents of an autoexec group.
+ * The regular expressions are compiled only once and shared by every call, so
+ * this function may be used from worker threads.
+ * @param autoexec Contents of a config file autoexec group.
+ * @param for_setup If is @c TRUE the autoexec will be parsed to retrieve only
+ * the setup information (executable and parameters).
+ * @return The parsed information.
+ */
+Info parse(const Glib::ustring &autoexec, bool for_setup)
+{
+    ALLOC_SCOPE(Tools::AllocTag::AUTOEXEC);
+    static auto keyb_regex    = Glib::Regex::create(PCRE_KEYB,    Glib::REGEX_CASELESS),
+                mixer_regex   = Glib::Regex::create(PCRE_MIXER,   Glib::REGEX_CASELESS),
+                loadfix_regex = Glib::Regex::create(PCRE_LOADFIX, Glib::REGEX_CASELESS),
+                mount_regex   = Glib::Regex::create(PCRE_MOUNT,   Glib::REGEX_CASELESS),
+                drive_regex   = Glib::Regex::create(PCRE_DRIVE,   Glib::REGEX_CASELESS),
+                path_regex    = Glib::Regex::create(PCRE_PATH,    Glib::REGEX_CASELESS),
+                exit_regex    = Glib::Regex::create(PCRE_EXIT,    Glib::REGEX_CASELESS),
+                program_regex = Glib::Regex::create(PCRE_PROGRAM, Glib::REGEX_CASELESS),
+                boot_regex    = Glib::Regex::create(PCRE_BOOT,    Glib::REGEX_CASELESS);
+    auto lines = Glib::Regex::split_simple("\n", autoexec);
+    Glib::MatchInfo minfo;
+    Info info;
+
+    for (auto line : lines) {
+        if (!for_setup && parse_line(line, keyb_regex, minfo)) {
+            info.keyb_args = minfo.fetch_named("keyb_args");
+        } else if (!for_setup && parse_line(line, mixer_regex, minfo)) {
+            info.mixer_command = line;
+        } else if (!for_setup && parse_line(line, loadfix_regex, minfo)) {
+            info.loadfix_amount = Glib::Ascii::strtod(minfo.fetch_named("amount"));
+        } else if (!for_setup && parse_line(line, mount_regex, minfo)) {
+            info.mount_commands.push_back(line);
+        } else if (parse_line(line, drive_regex, minfo)) {
+            info.drive_letter = minfo.fetch_named("drive");
+        } else if (parse_line(line, path_regex, minfo)) {
+            info.path = minfo.fetch_named("path");
+        } else if (!for_setup && parse_line(line, exit_regex, minfo)) {
+            info.exit = true;
+        } else if (parse_line(line, program_regex, minfo)) {
+            info.has_program = true;
+            info.loadhigh    = minfo.fetch_named("loadhigh").uppercase() == "LOADHIGH";
+            info.program     = minfo.fetch_named("program");
+            info.parameters  = minfo.fetch_named("parameters");
+        } else if (!for_setup && parse_line(line, boot_regex, minfo)) {
+            do {
+                auto letter   = minfo.fetch_named("letter"),
+                     image_sq = minfo.fetch_named("image_sq"),
+                     image_dq = minfo.fetch_named("image_dq"),
+                     image    = minfo.fetch_named("image");
+
+                if (!letter.empty()) {
+                    info.boot_letter = letter;
+                }
+
+                if (!image_sq.empty()) {
+                    image = image_sq;
+                } else if (!image_dq.empty()) {
+                    image = image_dq;
+                }
+
+                if (!image.empty()) {
+                    info.boot_images.push_back(image);
+                }
+            } while (minfo.next());
+
+            info.has_booter = true;
+        }
+    }
+
+    return info;
+}
+
+} // Autoexec
+
+} // DOSBoxGTK
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * Autoexec parsing helpers declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef AUTOEXEC_H
+#define AUTOEXEC_H
+
+// Pearlc Compatible Regular Expresions for parsing autoexec group in config file.
+#define PCRE_MIXER   "^MIXER" ///< PCRE for MIXER DOSBox Command.
+#define PCRE_KEYB    "^KEYB(?:\\.COM){0,1}\\s+(?'keyb_args'.+)" ///< PCRE for KEYB DOSBox Command.
+#define PCRE_LOADFIX "^LOADFIX(?:.COM){0,1}\\s+-(?'amount'[0-9]+)$" ///< PCRE for LOADFIX DOSBox Command.
+#define PCRE_MOUNT   "^(?'command'IMGMOUNT|MOUNT)" ///< PCRE for MOUNT and IMGMount DOSBox Commands.
+#define PCRE_BOOT    "^(?'command'BOOT(?:\\.COM){0,1})|-l\\s+(?'letter'[A-Y])|(?:\\s+'(?'image_sq'[^']+)'|\"(?'image_dq'[^\"]+)\"|(?'image'[^\\s]+))" ///< PCRE for BOOT DOSBox Command.
+#define PCRE_DRIVE   "^(?'drive'[A-Y]):" /// < PCRE for the drive letter.
+#define PCRE_PATH    "^CD (?'path'.+)" ///< PCRE for CD DOSBox Command.
+#define PCRE_PROGRAM "^(?!(?:LOADFIX(?:\\.COM){0,1}|MOUNT(?:\\.COM){0,1}|IMGMOUNT(?:\\.COM){0,1}|MIXER(?:\\.COM){0,1}|KEYB(?:\\.COM){0,1}|BOOT(?:\\.COM){0,1}|EXIT|[A-Z]:|CD(?:\\s+|$)))(?:(?'loadhigh'LOADHIGH)\\s+)?(?'program'[^\\s]+)(?:\\s+(?'parameters'.+))?$" ///< PCER for DOS executables.
+#define PCRE_EXIT    "^EXIT" ///< PCRE for EXIT DOSBox Command.
+
+#include <glibmm/ustring.h>
+#include <glibmm/regex.h>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Helpers for reading the autoexec group of a DOSBox config file without
+ * depending on any widget.
+ */
+namespace Autoexec
+{
+
+/**
+ * Information retrieved from an autoexec group.
+ */
+struct Info
+{
+    Glib::ustring keyb_args,     ///< Arguments of the KEYB command.
+                  mixer_command, ///< Full MIXER command line.
+                  drive_letter,  ///< Drive letter the program is run from.
+                  path,          ///< Directory changed to with CD.
+                  program,       ///< Program executable name.
+                  parameters,    ///< Program parameters.
+                  boot_letter;   ///< Drive letter used by BOOT.
+    std::vector<Glib::ustring> mount_commands, ///< MOUNT and IMGMOUNT command lines.
+                               boot_images;    ///< Images used by BOOT.
+    int loadfix_amount = -1;    ///< LOADFIX amount or -1 if there is no LOADFIX.
+    bool loadhigh      = false, ///< Program is run with LOADHIGH.
+         exit          = false, ///< There is an EXIT command.
+         has_program   = false, ///< A program line has been found.
+         has_booter    = false; ///< A BOOT command has been found.
+};
+
+std::vector<Glib::ustring> split(const Glib::ustring &contents);
+bool parse_line(const Glib::ustring &line, const Glib::RefPtr<Glib::Regex> &regex, Glib::MatchInfo &minfo);
+Info parse(const Glib::ustring &autoexec, bool for_setup = false);
+
+} // Autoexec
+
+} // DOSBoxGTK
+
+#endif // AUTOEXEC_H
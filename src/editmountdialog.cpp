@@ -11,9 +11,7 @@
 #include <glibmm/i18n.h>
 #include <glibmm/miscutils.h>
 #include <glibmm/stringutils.h>
-#include <glibmm/regex.h>
 #include <gtkmm/filechooserdialog.h>
-#include <iostream>
 
 /**
  * DOSBoxGTK namespace.
@@ -238,16 +236,16 @@ EditMountDialog::EditMountDialog(BaseObjectType *object, const Glib::RefPtr<Gtk:
 
 /**
  * Set the drive letters that canbe used in the mounting point.
- * @param used_letters String with the alredy used letters.
+ * @param used_letters Set of alredy used letters.
  */
-void EditMountDialog::set_drive_letters(const Glib::ustring &used_letters)
+void EditMountDialog::set_drive_letters(const DriveLetterSet &used_letters)
 {
     int pos = 0;
 
     this->m_drive_letter_cbt->remove_all();
 
-    for (char l = 'A'; l < 'Z'; ++l) {
-        if (used_letters.uppercase().find(l) == Glib::ustring::npos) {
+    for (char l = DRIVE_LETTER_FIRST; l <= DRIVE_LETTER_LAST; ++l) {
+        if (!used_letters.contains(l)) {
             Glib::ustring letter_str(1, l);
             this->m_drive_letter_cbt->insert(pos, letter_str, letter_str);
             ++pos;
@@ -255,20 +253,16 @@ void EditMountDialog::set_drive_letters(const Glib::ustring &used_letters)
     }
 
     this->m_drive_letter_cbt->set_wrap_width(6);
-    this->m_drive_letter_cbt->set_active(0);
-
-    if (used_letters.uppercase().find('C') == Glib::ustring::npos) {
-        this->m_drive_letter_cbt->set_active_id("C");
-    }
+    this->m_drive_letter_cbt->set_active_id(Glib::ustring(1, used_letters.get_first_free()));
 }
 
 /**
  * Gets the resulting mounting command from the dialog.
- * @return DOSBox mount command.
+ * @return DOSBox mounting command.
  */
-Glib::ustring EditMountDialog::get_command() const
+std::shared_ptr<MountCommandBase> EditMountDialog::get_command() const
 {
-    Glib::ustring command;
+    std::shared_ptr<MountCommandBase> command;
     char letter = *this->m_drive_letter_cbt->get_active_id().begin();
 
     if (this->m_dir_mount_rb->get_active()) {
@@ -291,7 +285,7 @@ Glib::ustring EditMountDialog::get_command() const
             freesize = this->m_freesize_sb->get_value_as_int();
         }
 
-        command = MountCommand(letter, host_dir, type, label, cd_access, usecd, freesize).get_command();
+        command = std::make_shared<MountCommand>(letter, host_dir, type, label, cd_access, usecd, freesize);
     } else {
         auto image_type = this->m_image_type_cbt->get_active_id();
         std::vector<Glib::ustring> images;
@@ -303,7 +297,7 @@ Glib::ustring EditMountDialog::get_command() const
             images.push_back(image);
         }
 
-        command = ImgmountCommand(letter, images, image_type).get_command();
+        command = std::make_shared<ImgmountCommand>(letter, images, image_type);
     }
 
     return command;
@@ -352,27 +346,4 @@ void EditMountDialog::set_command(const MountCommandBase *command)
     this->validate_controls();
 }
 
-/**
- * Gets the dialog controls values from a DOSBox Mounting command.
- * @param command String with the DOSBox mounting command.
- */
-void EditMountDialog::set_command(const Glib::ustring &command)
-{
-    auto mounting_command_regex = Glib::Regex::create("^(?'command'MOUNT|IMGMOUNT)", Glib::REGEX_CASELESS);
-    Glib::MatchInfo minfo;
-    MountCommandBase *mounting_command = nullptr;
-
-    if (mounting_command_regex->match(command, 0, minfo)) {
-        if (minfo.fetch_named("command").uppercase() == "MOUNT") {
-            mounting_command = new MountCommand(command);
-        } else {
-            mounting_command = new ImgmountCommand(command);
-        }
-
-        this->set_command(mounting_command);
-    }
-
-    delete mounting_command;
-}
-
 } // DOSBoxGTK
@@ -11,6 +11,7 @@
 
 #include "mountcommand.h"
 #include "imgmountcommand.h"
+#include "mounttable.h"
 #include <gtkmm/dialog.h>
 #include <gtkmm/builder.h>
 #include <gtkmm/liststore.h>
@@ -75,10 +76,9 @@ public:
     EditMountDialog(BaseObjectType *object, const Glib::RefPtr<Gtk::Builder> &builder);
     virtual ~EditMountDialog() {}
 
-    void set_drive_letters(const Glib::ustring &used_letters = Glib::ustring());
-    Glib::ustring get_command() const;
+    void set_drive_letters(const DriveLetterSet &used_letters = DriveLetterSet());
+    std::shared_ptr<MountCommandBase> get_command() const;
     void set_command(const MountCommandBase *command);
-    void set_command(const Glib::ustring &command);
 };
 
 } // DOSBoxGTK
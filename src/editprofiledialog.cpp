@@ -11,16 +11,17 @@
 #include "editprofiledialog.h"
 #include "editmountdialog.h"
 #include "selectgameinfodialog.h"
-#include "htmltools.hpp"
+#include "metadataservice.h"
+#include "trace.hpp"
+#include "metrics.hpp"
+#include "allocaccounting.hpp"
 #include <glibmm/i18n.h>
 #include <glibmm/miscutils.h>
 #include <glibmm/stringutils.h>
 #include <glibmm/fileutils.h>
+#include <glibmm/main.h>
 #include <gtkmm/cssprovider.h>
-#include <libxml++/parsers/domparser.h>
-#include <curlpp/cURLpp.hpp>
-#include <curlpp/Easy.hpp>
-#include <curlpp/Options.hpp>
+#include <gtkmm/messagedialog.h>
 
 /**
  * DOSBoxGTK namespace.
@@ -28,6 +29,8 @@
 namespace DOSBoxGTK
 {
 
+static auto &s_config_save_time = Tools::Metrics::get_histogram("dosboxgtk_config_save_seconds", "Time spent writing a profile's config files."); ///< Config save time histogram.
+
 /**
  * Process response and closes dialog window.
  * @param response_id Dialog response value;
@@ -59,23 +62,103 @@ void EditProfileDialog::on_entry_changed(Gtk::Entry *sender)
             sender->set_icon_from_icon_name(Glib::ustring());
         }
 
-        this->validate_controls();
-    } else if (sender == this->m_program_entry) {
-        sender->get_style_context()->add_class("invalid");
+        this->m_duplicate_check.disconnect();
 
-        if (this->m_booter_rb->get_active() || this->check_program(text)) {
-            sender->get_style_context()->remove_class("invalid");
+        if (!is_empty) {
+            this->m_duplicate_check = Glib::signal_timeout().connect(sigc::mem_fun(*this, &EditProfileDialog::on_duplicate_check_timeout),
+                                                                     DUPLICATE_CHECK_DELAY);
         }
 
         this->validate_controls();
-    } else if (sender == this->m_setup_entry) {
-        this->m_setup_entry->get_style_context()->add_class("invalid");
+    } else if (sender == this->m_program_entry || sender == this->m_setup_entry) {
+        this->schedule_program_check(sender);
+    }
+}
 
-        if (this->m_booter_rb->get_active() || is_empty || this->check_program(text)) {
-            sender->get_style_context()->remove_class("invalid");
+/**
+ * Checks the program of the given entry once the user has stopped typing.
+ * @param entry Program or setup Entry.
+ * @return Always @c FALSE so the timeout is not run again.
+ */
+bool EditProfileDialog::on_program_check_timeout(Gtk::Entry *entry)
+{
+    auto text = entry->get_text();
+
+    this->m_program_checks.erase(entry);
+    entry->get_style_context()->add_class("invalid");
+
+    if (this->m_booter_rb->get_active() || (entry == this->m_setup_entry && text.empty()) || this->check_program(text)) {
+        entry->get_style_context()->remove_class("invalid");
+    }
+
+    this->validate_controls();
+
+    return false;
+}
+
+/**
+ * Checks the title for duplicates once the user has stopped typing.
+ * @return Always @c FALSE so the timeout is not run again.
+ */
+bool EditProfileDialog::on_duplicate_check_timeout()
+{
+    this->check_duplicate_title();
+
+    return false;
+}
+
+/**
+ * Looks for other profiles with a title similar to the one typed, and shows
+ * the most similar one in the tooltip of an information icon of the title
+ * entry. The titles of the library are normalized in the thread pool by the
+ * first check, and then scored there by each check.
+ */
+Tools::AsyncTask EditProfileDialog::check_duplicate_title()
+{
+    auto token = this->m_async_token;
+    auto title = this->m_title_entry->get_text();
+    auto id    = this->m_profile_id;
+
+    if (!this->m_library_titles) {
+        auto snapshot = this->m_library->get_snapshot();
+
+        this->m_library_titles = co_await Tools::run_in_pool(token, [snapshot] {
+            auto library_titles = std::make_shared<LibraryTitles>();
+
+            snapshot->for_each([&library_titles](const ProfilePtr &profile) {
+                library_titles->titles.push_back(TitleMatcher::normalize(profile->title));
+                library_titles->profiles.push_back(profile);
+            });
+
+            return std::shared_ptr<const LibraryTitles>(library_titles);
+        });
+    }
+
+    auto library_titles = this->m_library_titles;
+    auto duplicate = co_await Tools::run_in_pool(token, [library_titles, title, id] {
+        TitleMatcher matcher(title);
+
+        for (auto &match : matcher.rank(library_titles->titles, TITLE_DUPLICATE_THRESHOLD)) {
+            auto &profile = library_titles->profiles[match.index];
+
+            if (profile->id != id) {
+                return profile->title;
+            }
         }
 
-        this->validate_controls();
+        return Glib::ustring();
+    });
+
+    // The title may have changed meanwhile, being checked again.
+    if (this->m_title_entry->get_text() != title) {
+        co_return;
+    }
+
+    if (duplicate.empty()) {
+        this->m_title_entry->set_icon_from_icon_name(Glib::ustring());
+    } else {
+        this->m_title_entry->set_icon_from_icon_name("dialog-information");
+        this->m_title_entry->set_icon_tooltip_text(Glib::ustring::compose(_("There is already a profile with a similar title: %1"), duplicate));
     }
 }
 
@@ -122,16 +205,11 @@ void EditProfileDialog::on_entry_icon_release(Gtk::EntryIconPosition icon_pos, c
                         dialog.set_current_folder(dirname);
                     }
                 } else if (dialog.get_filename().empty() && selection->count_selected_rows() == 1) {
-                    auto iter =this->m_mounting_overview_tree_view->get_model()->get_iter(selection->get_selected_rows()[0]);
-                    Glib::ustring command;
-                    Glib::MatchInfo minfo;
-
-                    iter->get_value(0, command);
-                    this->parse_line(command, PCRE_MOUNT, minfo);
+                    auto iter = this->m_mounting_overview_tree_view->get_model()->get_iter(selection->get_selected_rows()[0]);
+                    auto m_command = dynamic_cast<const MountCommand*>(this->get_mounting_command(iter));
 
-                    if (minfo.fetch_named("command").uppercase() == "MOUNT") {
-                        MountCommand m_command(command);
-                        dialog.set_current_folder(m_command.get_host_dir());
+                    if (m_command != nullptr) {
+                        dialog.set_current_folder(m_command->get_host_dir());
                     }
                 }
 
@@ -202,7 +280,7 @@ void EditProfileDialog::on_add_mount_tb_clicked()
 {
     EditMountDialog *dialog;
     auto resource_path = Glib::build_filename(APP_PATH, "gui", "editmountdialog.glade");
-    Glib::RefPtr<Gtk::Builder> builder = Gtk::Builder::create_from_resource(resource_path);
+    Glib::RefPtr<Gtk::Builder> builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
 
     builder->get_widget_derived("EditMountDialog", dialog);
     dialog->set_drive_letters(this->get_used_letters());
@@ -222,20 +300,24 @@ void EditProfileDialog::on_edit_mount_tb_clicked()
 {
     EditMountDialog *dialog;
     auto resource_path = Glib::build_filename(APP_PATH, "gui", "editmountdialog.glade");
-    auto builder = Gtk::Builder::create_from_resource(resource_path);
+    auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
     auto model = this->m_mounting_overview_tree_view->get_model();
     auto selected_row_path = this->m_mounting_overview_tree_view->get_selection()->get_selected_rows()[0];
     auto selected_row_iter = model->get_iter(selected_row_path);
-    Glib::ustring command;
+    auto selected_command = this->m_mount_table.get(this->get_mounting_command(selected_row_iter)->get_letter());
 
     builder->get_widget_derived("EditMountDialog", dialog);
 
-    selected_row_iter->get_value(0, command);
     dialog->set_drive_letters(this->get_used_letters(true));
-    dialog->set_command(command);
+    dialog->set_command(selected_command.get());
 
     if (dialog->run() == Gtk::RESPONSE_ACCEPT) {
-        selected_row_iter->set_value(0, dialog->get_command());
+        auto mounting_command = dialog->get_command();
+
+        if (this->m_mount_table.replace(selected_command->get_letter(), mounting_command)) {
+            selected_row_iter->set_value(0, mounting_command->get_command());
+            selected_row_iter->set_value(1, static_cast<gpointer>(mounting_command.get()));
+        }
     }
 }
 
@@ -252,8 +334,12 @@ void EditProfileDialog::on_remove_mount_tb_clicked()
         selected_rows.push_back(mounting_ls->get_iter(path));
     }
 
+    // The row is erased before releasing its mounting command.
     for (auto row : selected_rows) {
+        auto letter = this->get_mounting_command(row)->get_letter();
+
         mounting_ls->erase(row);
+        this->m_mount_table.remove(letter);
     }
 
     this->on_entry_changed(this->m_program_entry);
@@ -328,7 +414,7 @@ void EditProfileDialog::on_mixer_button_clicked()
 {
     MixerDialog *dialog;
     auto resource_path = Glib::build_filename(APP_PATH, "gui", "mixerdialog.glade");
-    auto builder = Gtk::Builder::create_from_resource(resource_path);
+    auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
 
     builder->get_widget_derived("MixerDialog", dialog);
 
@@ -340,62 +426,55 @@ void EditProfileDialog::on_mixer_button_clicked()
 }
 
 /**
- * Searchs in the MobyGame site for info about the title of the profile.
+ * Searchs the metadata providers for info about the title of the profile.
+ * The selected game is got from its provider in the thread pool, and the
+ * errors are shown to the user.
  */
-void EditProfileDialog::on_consult_button_clicked()
+Tools::AsyncTask EditProfileDialog::on_consult_button_clicked()
 {
-    SelectGameInfoDialog *dialog;
     auto resource_path = Glib::build_filename(APP_PATH, "gui", "selectgameinfodialog.glade");
-    auto builder = Gtk::Builder::create_from_resource(resource_path);
+    auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
+    SelectGameInfoDialog *dialog_ptr = nullptr;
+
+    builder->get_widget_derived("SelectGameInfoDialog", dialog_ptr);
+    std::unique_ptr<SelectGameInfoDialog> dialog(dialog_ptr);
 
-    builder->get_widget_derived("SelectGameInfoDialog", dialog);
+    dialog->set_transient_for(*this);
+    dialog->set_modal();
     dialog->search_game_info(this->m_title_entry->get_text());
 
-    if (dialog->run() == Gtk::RESPONSE_ACCEPT) {
-        curlpp::initialize();
-        curlpp::Easy request;
-        std::stringstream os;
-        auto regex = Glib::Regex::create("niceHeaderTitle\">\\s*<a.+?>(?'title'.+?)\\s*<\\/a>|(?'key'Published by|Developed by|Released|Genre)<\\/div>.+?<a.+?>(?'value'.+?)<\\/a>|<h2>Description<\\/h2>(?'description'.+?)<div",Glib::REGEX_DOTALL);
-        Glib::MatchInfo minfo;
-
-        request.setOpt<curlpp::options::Url>(dialog->get_selected_href());
-        request.setOpt<curlpp::options::WriteStream>(&os);
-
-        request.perform();
-        curlpp::terminate();
-
-        if (regex->match(os.str(), 0, minfo)) {
-            this->m_title_entry->set_text(Tools::html_entities_decode(minfo.fetch_named("title")));
-            this->m_publisher_entry->set_text(Glib::ustring());
-            this->m_developer_entry->set_text(Glib::ustring());
-            this->m_year_entry->set_text(Glib::ustring());
-            this->m_genre_entry->set_text(Glib::ustring());
-            this->m_notes_tv->get_buffer()->set_text(Glib::ustring());
-
-            while (minfo.next()) {
-                auto key   = minfo.fetch_named("key").lowercase(),
-                     value = Tools::html_entities_decode(minfo.fetch_named("value")),
-                     description = Tools::html_entities_decode(minfo.fetch_named("description"));
-
-                if (!description.empty()) {
-                    auto br_regex  = Glib::Regex::create("(?:<br.*?>.*?<.*?\\/br.*>|<br.*?\\/*>)+", Glib::REGEX_CASELESS),
-                         tag_regex = Glib::Regex::create("<(.+?)>"),
-                         nl_regex  = Glib::Regex::create("\n");
-
-                    description = nl_regex->replace(description, 0, " ", static_cast<Glib::RegexMatchFlags>(0));
-                    description = br_regex->replace(description, 0, "\n", static_cast<Glib::RegexMatchFlags>(0)); // Replaces <br> tags with newlines.
-                    description = tag_regex->replace(description, 0, Glib::ustring(), static_cast<Glib::RegexMatchFlags>(0)); // Removes every html/xml tag from the text.
-                    this->m_notes_tv->get_buffer()->set_text(curlpp::unescape(description));
-                } else if (key == "published by") {
-                    this->m_publisher_entry->set_text(value);
-                } else if (key == "developed by") {
-                    this->m_developer_entry->set_text(value);
-                } else if (key == "released") {
-                    this->m_year_entry->set_text(value.substr(value.size() - 4));
-                } else if (key == "genre") {
-                    this->m_genre_entry->set_text(value);
-                }
-            }
+    if (co_await Tools::dialog_response(this->m_async_token, *dialog) == Gtk::RESPONSE_ACCEPT) {
+        this->m_consult_button->set_sensitive(false);
+        auto token  = this->m_async_token;
+        auto result = dialog->get_selected_result();
+        GameInfo info;
+        Glib::ustring error;
+
+        try {
+            info = co_await Tools::run_in_pool(token, [token, result] {
+                return MetadataService::get_default().get_game(token, result);
+            });
+        } catch (const Glib::Exception &e) {
+            error = e.what();
+        } catch (const std::exception &e) {
+            error = e.what();
+        }
+
+        this->m_consult_button->set_sensitive(!this->m_title_entry->get_text().empty());
+
+        if (!error.empty()) {
+            Gtk::MessageDialog msg_dialog(*this, Glib::ustring::compose(_("The game information could not be retrieved:\n%1"), error), false, Gtk::MESSAGE_ERROR);
+
+            msg_dialog.set_modal();
+            co_await Tools::dialog_response(token, msg_dialog);
+        } else if (!info.title.empty()) {
+            ALLOC_SCOPE(Tools::AllocTag::NETWORK); // Not before, it must not span a co_await.
+            this->m_title_entry->set_text(info.title);
+            this->m_publisher_entry->set_text(info.publisher);
+            this->m_developer_entry->set_text(info.developer);
+            this->m_year_entry->set_text(info.year);
+            this->m_genre_entry->set_text(info.genre);
+            this->m_notes_tv->get_buffer()->set_text(info.description);
         }
     }
 }
@@ -417,6 +496,15 @@ void EditProfileDialog::on_cycles_cbt_changed()
     }
 }
 
+/**
+ * Marks the mounting points trie as outdated when the mounting overview model
+ * changes.
+ */
+void EditProfileDialog::on_mounting_model_changed()
+{
+    this->m_mount_trie_dirty = true;
+}
+
 /**
  * Changes the sensitivity of the remove ToolButton related to the given
  * TreeView whose selection has changed.
@@ -441,7 +529,9 @@ void EditProfileDialog::on_selection_changed(Gtk::TreeView *tv)
  */
 void EditProfileDialog::load_config_file(const Glib::ustring &filename)
 {
-    auto config_parts(this->autoexec_split(filename));
+    TRACE_SCOPE("EditProfileDialog::load_config_file");
+    ALLOC_SCOPE(Tools::AllocTag::CONFIG);
+    auto config_parts(Autoexec::split(Glib::file_get_contents(filename)));
     Glib::KeyFile config;
 
     config.load_from_data(config_parts[0]);
@@ -823,6 +913,9 @@ void EditProfileDialog::load_config_file(const Glib::ustring &filename)
  */
 void EditProfileDialog::save_config_file()
 {
+    TRACE_SCOPE("EditProfileDialog::save_config_file");
+    ALLOC_SCOPE(Tools::AllocTag::CONFIG);
+    Tools::MetricsTimer timer(s_config_save_time);
     auto profiles_path         = this->m_settings->get_string("profiles-path"),
          config_basename       = Glib::ustring::compose("%1.conf", this->m_profile_id),
          setup_config_basename = Glib::ustring::compose("%1_setup.conf", this->m_profile_id);
@@ -1274,41 +1367,6 @@ void EditProfileDialog::save_config_file()
     }
 }
 
-/**
- * Removes comment lines from the given config files and splits it in order to
- * separate the autoexec group from the rest of the config file.
- * @param filename Config file filename.
- * @return std::vector with the parts of the splitted config file. Index 0 for
- * the config file contents witout the autoexec group and following indexes for
- * the autoexec groups contents, if there is an autoexec group.
- */
-std::vector<Glib::ustring> EditProfileDialog::autoexec_split(const Glib::ustring &filename)
-{
-    Glib::ustring contents = Glib::file_get_contents(filename);
-
-    return Glib::Regex::split_simple("^\\s*\\[autoexec\\]\\s*$", contents, Glib::REGEX_MULTILINE, Glib::REGEX_MATCH_NEWLINE_ANY);
-}
-
-/**
- * Parses a text line with the given regular expression
- * @param line Line to parse.
- * @param pcre_expresion PCRE for parsing the text line.
- * @param minfo Glib::MachInfo object with the parsing results.
- * @return @c TRUE if the regular expresion matches or @c FALSE otherwise.
- */
-bool EditProfileDialog::parse_line(const Glib::ustring &line, const Glib::ustring &pcre_expresion, Glib::MatchInfo &minfo) const
-{
-    auto comments_regex = Glib::Regex::create("^\\s*#.*$", Glib::REGEX_MULTILINE);
-    bool matched = false;
-
-    if (!comments_regex->match(line)) {
-        auto regex = Glib::Regex::create(pcre_expresion, Glib::REGEX_CASELESS);
-        matched = regex->match(line, 0, minfo);
-    }
-
-    return matched;
-}
-
 /**
  * Parses the autoexec group of the config file in order to set the related
  * profile control's values.
@@ -1318,9 +1376,10 @@ bool EditProfileDialog::parse_line(const Glib::ustring &line, const Glib::ustrin
  */
 void EditProfileDialog::parse_autoexec(const Glib::ustring &autoexec, bool for_setup)
 {
-    auto lines = Glib::Regex::split_simple("\n", autoexec);
-    Glib::MatchInfo minfo;
-    Glib::ustring drive_letter, mount_path, path, program, parameters;
+    TRACE_SCOPE("EditProfileDialog::parse_autoexec");
+    ALLOC_SCOPE(Tools::AllocTag::AUTOEXEC);
+    auto info = Autoexec::parse(autoexec, for_setup);
+    Glib::ustring mount_path;
     auto exec_entry       = this->m_program_entry,
          parameters_entry = this->m_program_parameters_entry;
 
@@ -1329,80 +1388,56 @@ void EditProfileDialog::parse_autoexec(const Glib::ustring &autoexec, bool for_s
         parameters_entry = this->m_setup_parameters_entry;
     }
 
-    for (auto line : lines) {
-        if (!for_setup && this->parse_line(line, PCRE_KEYB, minfo)) {
-             this->m_keyb_args_entry->set_text(minfo.fetch_named("keyb_args"));
-        } else if (!for_setup && this->parse_line(line, PCRE_MIXER, minfo)) {
-            this->m_mixer_command = line;
-        } else if (!for_setup && this->parse_line(line, PCRE_LOADFIX, minfo)) {
-            this->m_loadfix_cb->set_active();
-            this->m_loadfix_spin_button->set_value(Glib::Ascii::strtod(minfo.fetch_named("amount")));
-        } else if (!for_setup && this->parse_line(line, PCRE_MOUNT, minfo)) {
-            this->add_mounting_command(line);
-        } else if (this->parse_line(line, PCRE_DRIVE, minfo)) {
-            drive_letter = minfo.fetch_named("drive");
-        } else if (this->parse_line(line, PCRE_PATH, minfo)) {
-            path = minfo.fetch_named("path");
-        } else if (!for_setup && this->parse_line(line, PCRE_EXIT, minfo)) {
-            this->m_exit_afterwards_switch->set_active();
-        } else if (this->parse_line(line, PCRE_PROGRAM, minfo)) {
-            this->m_program_rb->set_active();
-            this->m_loadhigh_cb->set_active(minfo.fetch_named("loadhigh").uppercase() == "LOADHIGH");
-            program = minfo.fetch_named("program");
-            parameters = minfo.fetch_named("parameters");
-        } else if (!for_setup && this->parse_line(line, PCRE_BOOT, minfo)) {
-            auto booter_ls = Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_booter_tree_view->get_model());
-
-            do {
-                auto letter   = minfo.fetch_named("letter"),
-                     image_sq = minfo.fetch_named("image_sq"),
-                     image_dq = minfo.fetch_named("image_dq"),
-                     image    = minfo.fetch_named("image");
-
-                if (!letter.empty()) {
-                    this->m_booter_drive_letter_cbt->set_active_id(letter);
-                }
+    if (!info.keyb_args.empty()) {
+        this->m_keyb_args_entry->set_text(info.keyb_args);
+    }
 
-                if (!image_sq.empty()) {
-                    image = image_sq;
-                } else if (!image_dq.empty()) {
-                    image = image_dq;
-                }
+    if (!info.mixer_command.empty()) {
+        this->m_mixer_command = info.mixer_command;
+    }
 
-                if (!image.empty()) {
-                    auto iter = booter_ls->append();
+    if (info.loadfix_amount > -1) {
+        this->m_loadfix_cb->set_active();
+        this->m_loadfix_spin_button->set_value(info.loadfix_amount);
+    }
 
-                    iter->set_value(0, image);
-                }
-            } while (minfo.next());
+    for (auto command : info.mount_commands) {
+        this->add_mounting_command(command);
+    }
 
-            this->m_booter_rb->set_active();
-        }
+    if (info.exit) {
+        this->m_exit_afterwards_switch->set_active();
     }
 
-    auto rows = this->m_mounting_overview_tree_view->get_model()->children();
-    auto iter = rows.begin();
+    if (info.has_program) {
+        this->m_program_rb->set_active();
+        this->m_loadhigh_cb->set_active(info.loadhigh);
+    }
 
-    while (iter != rows.end() && mount_path.empty()) {
-        Glib::ustring command;
+    if (info.has_booter) {
+        auto booter_ls = Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_booter_tree_view->get_model());
 
-        iter->get_value(0, command);
-        this->parse_line(command, PCRE_MOUNT, minfo);
+        if (!info.boot_letter.empty()) {
+            this->m_booter_drive_letter_cbt->set_active_id(info.boot_letter);
+        }
 
-        if (minfo.fetch_named("command").uppercase() == "MOUNT") {
-            MountCommand m_command(command);
+        for (auto image : info.boot_images) {
+            auto iter = booter_ls->append();
 
-            if (Glib::ustring(1, m_command.get_letter()) == drive_letter) {
-                mount_path = m_command.get_host_dir();
-            }
+            iter->set_value(0, image);
         }
 
-        ++iter;
+        this->m_booter_rb->set_active();
     }
 
-    program = Glib::build_filename(mount_path, path, program);
-    exec_entry->set_text(program);
-    parameters_entry->set_text(parameters);
+    auto m_command = std::dynamic_pointer_cast<MountCommand>(this->m_mount_table.get(info.drive_letter.c_str()[0]));
+
+    if (m_command) {
+        mount_path = m_command->get_host_dir();
+    }
+
+    exec_entry->set_text(Glib::build_filename(mount_path, info.path, info.program));
+    parameters_entry->set_text(info.parameters);
 }
 
 /**
@@ -1414,6 +1449,7 @@ void EditProfileDialog::parse_autoexec(const Glib::ustring &autoexec, bool for_s
  */
 Glib::ustring EditProfileDialog::create_autoexec(bool for_setup) const
 {
+    ALLOC_SCOPE(Tools::AllocTag::AUTOEXEC);
     Glib::ustring autoexec;
     auto exec_entry       = this->m_program_entry,
          parameters_entry = this->m_program_parameters_entry;
@@ -1423,7 +1459,7 @@ Glib::ustring EditProfileDialog::create_autoexec(bool for_setup) const
         parameters_entry = this->m_setup_parameters_entry;
     }
 
-    auto mounting_command_str = this->get_mounting_command_for_program(exec_entry->get_text());
+    auto m_command = this->get_mounting_command_for_program(exec_entry->get_text());
 
     if (this->m_program_rb->get_active()) {
         if (!this->m_mixer_command.empty()) {
@@ -1440,20 +1476,16 @@ Glib::ustring EditProfileDialog::create_autoexec(bool for_setup) const
     }
 
     for (auto row : this->m_mounting_overview_tree_view->get_model()->children()) {
-        Glib::ustring mounting_command;
-
-        row->get_value(0, mounting_command);
-        autoexec += mounting_command + "\n";
+        autoexec += this->get_mounting_command(row)->get_command() + "\n";
     }
 
-    if (!mounting_command_str.empty()) {
-        MountCommand m_command(mounting_command_str);
+    if (m_command) {
         auto abs_program_path = exec_entry->get_text();
         auto abs_program_dir_path = Glib::path_get_dirname(abs_program_path),
-             rel_program_dir_path = abs_program_dir_path.substr(m_command.get_host_dir().size()),
+             rel_program_dir_path = abs_program_dir_path.substr(m_command->get_host_dir().size()),
              program_name = Glib::path_get_basename(abs_program_path);
 
-        autoexec += Glib::ustring::compose("%1:\n", m_command.get_letter());
+        autoexec += Glib::ustring::compose("%1:\n", m_command->get_letter());
         if (!rel_program_dir_path.empty()) {
             autoexec += Glib::ustring::compose("CD %1\n", rel_program_dir_path);
         }
@@ -1481,6 +1513,7 @@ Glib::ustring EditProfileDialog::create_autoexec(bool for_setup) const
         for (auto row : this->m_booter_tree_view->get_model()->children()) {
             Glib::ustring image;
             Glib::ustring quote;
+            Tools::Metrics::get_regex_compilations().add();
             auto has_spaces_regex = Glib::Regex::create("\\s");
 
             row->get_value(0, image);
@@ -1500,123 +1533,104 @@ Glib::ustring EditProfileDialog::create_autoexec(bool for_setup) const
 
 /**
  * Adds the given mounting command to the mounting overview TreeView.
- * @param command String with the mounting DOSBox command.
- * @return @c TRUE if the command was succesfully added or @c FALSE otherwise.
+ * @param command Mounting command.
+ * @return @c TRUE if the command was succesfully added or @c FALSE if its drive
+ * letter is alredy used.
  */
-bool EditProfileDialog::add_mounting_command(const Glib::ustring &command)
+bool EditProfileDialog::add_mounting_command(const std::shared_ptr<MountCommandBase> &command)
 {
     auto mounting_ls = Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_mounting_overview_tree_view->get_model());
-    auto rows = mounting_ls->children();
-    auto iter = rows.begin();
-    bool found = 0;
+    bool added = this->m_mount_table.add(command);
 
-    while (iter != rows.end() && !found) {
-        Glib::ustring row_command;
+    if (added) {
+        auto iter = mounting_ls->append();
 
-        iter->get_value(0, row_command);
-        found = command == row_command;
-        ++iter;
+        iter->set_value(0, command->get_command());
+        iter->set_value(1, static_cast<gpointer>(command.get()));
     }
 
-    if (iter == rows.end()) {
-        iter = mounting_ls->append();
-        iter->set_value(0, command);
-    }
+    return added;
+}
+
+/**
+ * Adds the given mounting command to the mounting overview TreeView.
+ * @param command String with the mounting DOSBox command.
+ * @return @c TRUE if the command was succesfully added or @c FALSE if it is not
+ * a valid mounting command or its drive letter is alredy used.
+ */
+bool EditProfileDialog::add_mounting_command(const Glib::ustring &command)
+{
+    auto mounting_command = MountCommandBase::create(command);
 
-    return !found;
+    return mounting_command && this->add_mounting_command(mounting_command);
+}
+
+/**
+ * Gets the mounting command of a row of the mounting overview TreeView.
+ * The command is owned by the mounting table.
+ * @param iter Row of the mounting overview TreeView.
+ * @return The mounting command.
+ */
+const MountCommandBase *EditProfileDialog::get_mounting_command(const Gtk::TreeIter &iter) const
+{
+    gpointer command = nullptr;
+
+    iter->get_value(1, command);
+
+    return static_cast<const MountCommandBase*>(command);
 }
 
 /**
  * Gets the drive letters alredy used by the mounting commands.
  * @param ignore_selected_row If @c TRUE the drive letter of the selected row
  * on the mounting TreeView will be ignored.
- * @return String with the used drive letters.
+ * @return Set of used drive letters.
  */
-Glib::ustring EditProfileDialog::get_used_letters(bool ignore_selected_row) const
+DriveLetterSet EditProfileDialog::get_used_letters(bool ignore_selected_row) const
 {
-    Glib::ustring letters;
-    char selected_letter = '\0';
-    auto model = this->m_mounting_overview_tree_view->get_model();
+    auto letters = this->m_mount_table.get_used_letters();
     auto selection = this->m_mounting_overview_tree_view->get_selection();
-    MountCommandBase *mounting_command = nullptr;
 
     if (ignore_selected_row && selection->count_selected_rows() == 1) {
-        auto selected_row = model->get_iter(selection->get_selected_rows()[0]);
-        Glib::MatchInfo minfo;
-        Glib::ustring command;
-
-        selected_row->get_value(0, command);
-        this->parse_line(command, PCRE_MOUNT, minfo);
-
-        if (minfo.fetch_named("command").uppercase() == "MOUNT") {
-            mounting_command = new MountCommand(command);
-        } else {
-            mounting_command = new ImgmountCommand(command);
-        }
-
-        selected_letter = mounting_command->get_letter();
-
-        delete mounting_command;
-        mounting_command = nullptr;
-    }
-
-    for (auto row : model->children()) {
-        Glib::ustring command;
-        Glib::MatchInfo minfo;
-
-        row->get_value(0, command);
-        this->parse_line(command, PCRE_MOUNT, minfo);
-
-        if (minfo.fetch_named("command").uppercase() == "MOUNT") {
-            mounting_command = new MountCommand(command);
-        } else {
-            mounting_command = new ImgmountCommand(command);
-        }
-
-        letters += mounting_command->get_letter();
-        delete mounting_command;
-    }
+        auto selected_row = this->m_mounting_overview_tree_view->get_model()->get_iter(selection->get_selected_rows()[0]);
 
-    if (ignore_selected_row) {
-        letters.erase(letters.find(selected_letter), 1);
+        letters.erase(this->get_mounting_command(selected_row)->get_letter());
     }
 
     return letters;
 }
 
 /**
- * Gets the mounting command that matches the given program.
+ * Gets the directory mounting command that contains the given program.
  * @param program_path Pah of the DOSBox executable whose mounting command is
  * requested.
- * @return Mounting command which corresponds to the given program path or empty
- * string if none is found or the program path is invalid.
+ * @return Mounting command which corresponds to the given program path or
+ * @c nullptr if none is found or the program path is invalid.
  */
-Glib::ustring EditProfileDialog::get_mounting_command_for_program(const Glib::ustring &program_path) const
+std::shared_ptr<MountCommand> EditProfileDialog::get_mounting_command_for_program(const Glib::ustring &program_path) const
 {
-    auto is_dosbox_executable_regex = Glib::Regex::create("^[^\\s]+\\.(?:exe|com|bat)$", Glib::REGEX_CASELESS);
-    Glib::ustring result_command;
+    static auto is_dosbox_executable_regex = Glib::Regex::create("^[^\\s]+\\.(?:exe|com|bat)$", Glib::REGEX_CASELESS);
+    std::shared_ptr<MountCommand> result_command;
 
-    if (!program_path.empty() && Glib::file_test(program_path, Glib::FILE_TEST_IS_REGULAR) && is_dosbox_executable_regex->match(program_path)) {
-        auto rows = this->m_mounting_overview_tree_view->get_model()->children();
-        auto iter = rows.begin();
+    if (!program_path.empty() && is_dosbox_executable_regex->match(program_path) && Glib::file_test(program_path, Glib::FILE_TEST_IS_REGULAR)) {
+        Glib::ustring letter;
 
-        while (iter != rows.end() && result_command.empty()) {
-            Glib::ustring command;
-            Glib::MatchInfo minfo;
+        if (this->m_mount_trie_dirty) {
+            this->m_mount_trie.clear();
 
+            for (char l = DRIVE_LETTER_FIRST; l <= DRIVE_LETTER_LAST; ++l) {
+                auto m_command = std::dynamic_pointer_cast<MountCommand>(this->m_mount_table.get(l));
 
-            iter->get_value(0, command);
-            this->parse_line(command, PCRE_MOUNT, minfo);
-
-            if (minfo.fetch_named("command").uppercase() == "MOUNT") {
-                MountCommand m_command(command);
-
-                if(Glib::str_has_prefix(program_path, m_command.get_host_dir())) {
-                    result_command = command;
+                if (m_command) {
+                    this->m_mount_trie.insert(m_command->get_host_dir(), Glib::ustring(1, l));
                 }
             }
 
-            ++iter;
+            this->m_mount_trie_dirty = false;
+        }
+
+        if (this->m_mount_trie.find(program_path, letter)) {
+            result_command = std::dynamic_pointer_cast<MountCommand>(this->m_mount_table.get(letter.c_str()[0]));
         }
     }
 
@@ -1631,27 +1645,23 @@ Glib::ustring EditProfileDialog::get_mounting_command_for_program(const Glib::us
  */
 bool EditProfileDialog::check_program(const Glib::ustring &program_path) const
 {
-    return !this->get_mounting_command_for_program(program_path).empty();
+    return this->get_mounting_command_for_program(program_path) != nullptr;
 }
 
 /**
- * Gets the next available profile ID.
- * @return String with the next available profile ID.
+ * Schedules the check of a program entry, so the mounting points and the file
+ * system are looked up only once the user stops typing. The Accept button is
+ * kept insensitive while there are pending checks.
+ * @param entry Program or setup Entry.
  */
-Glib::ustring EditProfileDialog::get_next_id() const
+void EditProfileDialog::schedule_program_check(Gtk::Entry *entry)
 {
-    auto profiles_path = this->m_settings->get_string("profiles-path");
-    xmlpp::DomParser parser(Glib::build_filename(profiles_path, PROFILES_FILENAME));
-    auto root = parser.get_document()->get_root_node();
-    guint index = 0;
-    Glib::ustring xpath("/profiles/profile[@id='0'][1]");
-
-    while (root->find(xpath).size() > 0) {
-        ++index;
-        xpath = Glib::ustring::compose("/profiles/profile[@id='%1'][1]", index);
-    }
+    auto &connection = this->m_program_checks[entry];
 
-    return Glib::ustring::compose("%1", index);
+    connection.disconnect();
+    connection = Glib::signal_timeout().connect(sigc::bind<Gtk::Entry*>(sigc::mem_fun(*this, &EditProfileDialog::on_program_check_timeout), entry),
+                                                PROGRAM_CHECK_DELAY);
+    this->validate_controls();
 }
 
 /**
@@ -1662,7 +1672,9 @@ void EditProfileDialog::validate_controls()
 {
     auto accept_widget = this->get_widget_for_response(Gtk::RESPONSE_ACCEPT);
 
-    if (this->m_program_rb->get_active()) {
+    if (!this->m_program_checks.empty()) {
+        accept_widget->set_sensitive(false);
+    } else if (this->m_program_rb->get_active()) {
         accept_widget->set_sensitive(!this->m_program_entry->get_style_context()->has_class("invalid") &&
                                      !this->m_setup_entry->get_style_context()->has_class("invalid") &&
                                      !this->m_title_entry->get_style_context()->has_class("invalid"));
@@ -1835,8 +1847,12 @@ EditProfileDialog::EditProfileDialog(BaseObjectType *cobject, const Glib::RefPtr
 
     this->m_language_file_fcb->set_current_folder(Glib::get_home_dir());
 
-    // Getting a valid profile ID. ---------------------------------------------
-    this->m_profile_id = this->get_next_id();
+    // Keeping track of the mounting points changes. --------------------------
+    auto mounting_model = this->m_mounting_overview_tree_view->get_model();
+
+    mounting_model->signal_row_changed().connect(sigc::hide(sigc::hide(sigc::mem_fun(*this, &EditProfileDialog::on_mounting_model_changed))));
+    mounting_model->signal_row_inserted().connect(sigc::hide(sigc::hide(sigc::mem_fun(*this, &EditProfileDialog::on_mounting_model_changed))));
+    mounting_model->signal_row_deleted().connect(sigc::hide(sigc::mem_fun(*this, &EditProfileDialog::on_mounting_model_changed)));
 
     // Signals -----------------------------------------------------------------
     this->m_add_mount_tb->signal_clicked().connect(sigc::mem_fun(*this, &EditProfileDialog::on_add_mount_tb_clicked));
@@ -1847,7 +1863,7 @@ EditProfileDialog::EditProfileDialog(BaseObjectType *cobject, const Glib::RefPtr
     this->m_program_rb->signal_toggled().connect(sigc::mem_fun(*this, &EditProfileDialog::on_program_rb_toggled));
     this->m_loadfix_cb->signal_toggled().connect(sigc::mem_fun(*this, &EditProfileDialog::on_loadfix_cb_toggled));
     this->m_mixer_button->signal_clicked().connect(sigc::mem_fun(*this, &EditProfileDialog::on_mixer_button_clicked));
-    this->m_consult_button->signal_clicked().connect(sigc::mem_fun(*this, &EditProfileDialog::on_consult_button_clicked));
+    this->m_consult_button->signal_clicked().connect(sigc::hide_return(sigc::mem_fun(*this, &EditProfileDialog::on_consult_button_clicked)));
     this->m_cycles_cbt->signal_changed().connect(sigc::mem_fun(*this, &EditProfileDialog::on_cycles_cbt_changed));
 
     for (auto object : builder->get_objects()) {
@@ -1866,62 +1882,54 @@ EditProfileDialog::EditProfileDialog(BaseObjectType *cobject, const Glib::RefPtr
     this->load_config_file(this->m_settings->get_string("default-config"));
 }
 
+/**
+ * Destructor. Stops the pending asynchronous tasks.
+ */
+EditProfileDialog::~EditProfileDialog()
+{
+    this->m_async_token.cancel();
+}
+
+/**
+ * Sets the library the profiles are loaded from and saved to. It must be
+ * called before load_profile() and save_profile().
+ * @param library Profile library.
+ */
+void EditProfileDialog::set_library(ProfileLibrary &library)
+{
+    this->m_library = &library;
+}
+
 /**
  * Loads the given game profile.
  * @param id ID of the profile to be lodaded.
  */
 void EditProfileDialog::load_profile(const Glib::ustring &id)
 {
+    TRACE_SCOPE("EditProfileDialog::load_profile");
     auto profiles_path   = this->m_settings->get_string("profiles-path");
     auto config_filename = Glib::build_filename(profiles_path, Glib::ustring::compose("%1.conf", id)),
          setup_filename  = Glib::build_filename(profiles_path, Glib::ustring::compose("%1_setup.conf", id));
-    xmlpp::DomParser parser(Glib::build_filename(profiles_path, PROFILES_FILENAME));
-    auto nodes = parser.get_document()->get_root_node()->get_children();
-    auto iter = nodes.begin();
-
-    parser.set_substitute_entities();
+    auto profile = this->m_library->get_snapshot()->find(id);
 
-    while (iter != nodes.end() && static_cast<xmlpp::Element*>(*iter)->get_attribute_value("id") != id) {
-        ++iter;
-    }
-
-    if (iter == nodes.end()) {
+    if (!profile) {
         throw std::invalid_argument(Glib::ustring::compose(_("Invalid profile's ID: Unable to find profile with ID '%1'."), id));
     }
 
     this->m_profile_id = id;
-
-    for (auto node : (*iter)->get_children()) {
-        auto element   = static_cast<xmlpp::Element*>(node);
-        auto text_node = element->get_child_text();
-        auto name = element->get_name();
-        Glib::ustring content;
-
-        if (text_node != nullptr) {
-            content = text_node->get_content();
-        }
-
-        if (name == "title") {
-            this->m_title_entry->set_text(content);
-        } else if (name == "developer") {
-            this->m_developer_entry->set_text(content);
-        } else if (name == "publisher") {
-            this->m_publisher_entry->set_text(content);
-        } else if (name == "genre") {
-            this->m_genre_entry->set_text(content);
-        } else if (name == "year") {
-            this->m_year_entry->set_text(content);
-        } else if (name == "notes") {
-            this->m_notes_tv->get_buffer()->set_text(content);
-        }
-    }
+    this->m_title_entry->set_text(profile->title);
+    this->m_developer_entry->set_text(profile->developer);
+    this->m_publisher_entry->set_text(profile->publisher);
+    this->m_genre_entry->set_text(profile->genre);
+    this->m_year_entry->set_text(profile->year);
+    this->m_notes_tv->get_buffer()->set_text(profile->notes);
 
     this->load_config_file(this->m_settings->get_string("default-config"));
 
     if (Glib::file_test(config_filename, Glib::FILE_TEST_IS_REGULAR)) {
         this->load_config_file(config_filename);
         if (Glib::file_test(setup_filename, Glib::FILE_TEST_IS_REGULAR)) {
-            auto setup_autoexec = this->autoexec_split(setup_filename)[1];
+            auto setup_autoexec = Autoexec::split(Glib::file_get_contents(setup_filename))[1];
 
             this->parse_autoexec(setup_autoexec, true);
         }
@@ -1935,54 +1943,35 @@ void EditProfileDialog::load_profile(const Glib::ustring &id)
  */
 void EditProfileDialog::save_profile()
 {
-    auto profiles_path = this->m_settings->get_string("profiles-path");
-    xmlpp::DomParser parser(Glib::build_filename(profiles_path, PROFILES_FILENAME));
-    auto root = parser.get_document()->get_root_node();
-    xmlpp::Element *profile_element   = nullptr;
-    auto xpath = Glib::ustring::compose("/profiles/profile[@id='%1'][1]", this->m_profile_id);
-    auto result = root->find(xpath);
-
-    if (result.size() > 0) {
-        profile_element = static_cast<xmlpp::Element*>(result[0]);
-
-        for (auto node : profile_element->get_children()) {
-            auto element      = static_cast<xmlpp::Element*>(node);
-            auto text_node    = element->get_child_text();
-            auto element_name = element->get_name();
-
-            if (text_node == nullptr) {
-                text_node = element->add_child_text(Glib::ustring());
-            }
-
-            if (element_name == "title") {
-                text_node->set_content(this->m_title_entry->get_text());
-            } else if (element_name == "developer") {
-                text_node->set_content(this->m_developer_entry->get_text());
-            } else if (element_name == "publisher") {
-                text_node->set_content(this->m_publisher_entry->get_text());
-            } else if (element_name == "genre") {
-                text_node->set_content(this->m_genre_entry->get_text());
-            } else if (element_name == "year") {
-                text_node->set_content(this->m_year_entry->get_text());
-            } else if (element_name == "notes") {
-                text_node->set_content(this->m_notes_tv->get_buffer()->get_text());
-            }
-        }
-    }
-
-    if (profile_element == nullptr) {
-        profile_element = root->add_child("profile");
-        profile_element->set_attribute("id", this->m_profile_id);
-        profile_element->add_child("title")->set_child_text(this->m_title_entry->get_text());
-        profile_element->add_child("developer")->set_child_text(this->m_developer_entry->get_text());
-        profile_element->add_child("publisher")->set_child_text(this->m_publisher_entry->get_text());
-        profile_element->add_child("genre")->set_child_text(this->m_genre_entry->get_text());
-        profile_element->add_child("year")->set_child_text(this->m_year_entry->get_text());
-        profile_element->add_child("notes")->set_child_text(this->m_notes_tv->get_buffer()->get_text());
+    TRACE_SCOPE("EditProfileDialog::save_profile");
+    Profile profile;
+
+    profile.id        = this->m_profile_id;
+    profile.title     = this->m_title_entry->get_text();
+    profile.developer = this->m_developer_entry->get_text();
+    profile.publisher = this->m_publisher_entry->get_text();
+    profile.genre     = this->m_genre_entry->get_text();
+    profile.year      = this->m_year_entry->get_text();
+    profile.notes     = this->m_notes_tv->get_buffer()->get_text();
+
+    // New profiles get their ID when they are added to the library.
+    if (this->m_profile_id.empty()) {
+        this->m_profile_id = this->m_library->add_profile(profile);
+    } else {
+        this->m_library->set_profile(std::make_shared<const Profile>(profile));
     }
 
-    parser.get_document()->write_to_file_formatted(Glib::build_filename(profiles_path, PROFILES_FILENAME), "UTF-8");
+    this->m_library->save_async();
     this->save_config_file();
 }
 
+/**
+ * Gets the ID of the edited profile.
+ * @return Profile ID, empty for new profiles not saved yet.
+ */
+const Glib::ustring &EditProfileDialog::get_profile_id() const
+{
+    return this->m_profile_id;
+}
+
 } // DOSBoxGTK
@@ -9,18 +9,16 @@
 #ifndef EDITPROFILEDIALOG_H
 #define EDITPROFILEDIALOG_H
 
-// Pearlc Compatible Regular Expresions for parsing autoexec group in config file.
-#define PCRE_MIXER   "^MIXER" ///< PCRE for MIXER DOSBox Command.
-#define PCRE_KEYB    "^KEYB(?:\\.COM){0,1}\\s+(?'keyb_args'.+)" ///< PCRE for KEYB DOSBox Command.
-#define PCRE_LOADFIX "^LOADFIX(?:.COM){0,1}\\s+-(?'amount'[0-9]+)$" ///< PCRE for LOADFIX DOSBox Command.
-#define PCRE_MOUNT   "^(?'command'IMGMOUNT|MOUNT)" ///< PCRE for MOUNT and IMGMount DOSBox Commands.
-#define PCRE_BOOT    "^(?'command'BOOT(?:\\.COM){0,1})|-l\\s+(?'letter'[A-Y])|(?:\\s+'(?'image_sq'[^']+)'|\"(?'image_dq'[^\"]+)\"|(?'image'[^\\s]+))" ///< PCRE for BOOT DOSBox Command.
-#define PCRE_DRIVE   "^(?'drive'[A-Y]):" /// < PCRE for the drive letter.
-#define PCRE_PATH    "^CD (?'path'.+)" ///< PCRE for CD DOSBox Command.
-#define PCRE_PROGRAM "^(?!(?:LOADFIX(?:\\.COM){0,1}|MOUNT(?:\\.COM){0,1}|IMGMOUNT(?:\\.COM){0,1}|MIXER(?:\\.COM){0,1}|KEYB(?:\\.COM){0,1}|BOOT(?:\\.COM){0,1}|EXIT|[A-Z]:|CD(?:\\s+|$)))(?:(?'loadhigh'LOADHIGH)\\s+)?(?'program'[^\\s]+)(?:\\s+(?'parameters'.+))?$" ///< PCER for DOS executables.
-#define PCRE_EXIT    "^EXIT" ///< PCRE for EXIT DOSBox Command.
+#define PROGRAM_CHECK_DELAY   250 ///< Milliseconds without typing before checking a program entry.
+#define DUPLICATE_CHECK_DELAY 250 ///< Milliseconds without typing before looking for profiles with a similar title.
 
+#include "async.hpp"
+#include "autoexec.h"
+#include "hostdirtrie.h"
 #include "mountcommand.h"
+#include "mounttable.h"
+#include "profilelibrary.h"
+#include "titlematcher.h"
 #include <glibmm/keyfile.h>
 #include <glibmm/regex.h>
 #include <giomm/settings.h>
@@ -37,6 +35,7 @@
 #include <gtkmm/textview.h>
 #include <gtkmm/treeview.h>
 #include <gtkmm/toolbutton.h>
+#include <map>
 
 /**
  * DOSBoxGTK namespace.
@@ -50,6 +49,15 @@ namespace DOSBoxGTK
 class EditProfileDialog final : public Gtk::Dialog
 {
 private:
+    /**
+     * Normalized titles of the library, for the duplicate title checks.
+     */
+    struct LibraryTitles
+    {
+        std::vector<std::string> titles;  ///< Normalized titles.
+        std::vector<ProfilePtr> profiles; ///< Profile of each title.
+    };
+
     Gtk::Grid *m_mounting_overview_grid              = nullptr,
               *m_program_grid                        = nullptr,
               *m_booter_grid                         = nullptr;
@@ -154,7 +162,15 @@ private:
 
     Glib::RefPtr<Gio::Settings> m_settings;
     Glib::ustring m_mixer_command,
-                  m_profile_id;
+                  m_profile_id;                               ///< Empty for new profiles.
+    ProfileLibrary *m_library = nullptr;                      ///< Library of the edited profile.
+    MountTable m_mount_table;                                 ///< Mounting points by drive letter.
+    mutable HostDirTrie m_mount_trie;                         ///< Drive letters by mounted host directory.
+    mutable bool m_mount_trie_dirty = true;                   ///< Whether m_mount_trie must be rebuilt.
+    std::map<Gtk::Entry*, sigc::connection> m_program_checks; ///< Pending program entry checks.
+    sigc::connection m_duplicate_check;                       ///< Pending duplicate title check.
+    std::shared_ptr<const LibraryTitles> m_library_titles;    ///< Built by the first duplicate title check.
+    Tools::CancellationToken m_async_token;                   ///< Cancelled when the dialog is destroyed.
 
     void on_response(int response_id);
     void on_entry_changed(Gtk::Entry *sender);
@@ -167,28 +183,35 @@ private:
     void on_add_boot_tb_clicked();
     void on_remove_boot_tb_clicked();
     void on_mixer_button_clicked();
-    void on_consult_button_clicked();
+    Tools::AsyncTask on_consult_button_clicked();
     void on_cycles_cbt_changed();
     void on_selection_changed(Gtk::TreeView *tv);
+    void on_mounting_model_changed();
+    bool on_program_check_timeout(Gtk::Entry *entry);
+    bool on_duplicate_check_timeout();
+    Tools::AsyncTask check_duplicate_title();
 
     void load_config_file(const Glib::ustring &filename);
     void save_config_file();
-    std::vector<Glib::ustring> autoexec_split(const Glib::ustring &filename);
-    bool parse_line(const Glib::ustring &line, const Glib::ustring &pcre_expresion, Glib::MatchInfo &minfo) const;
     void parse_autoexec(const Glib::ustring &autoexec, bool for_setup = false);
     Glib::ustring create_autoexec(bool for_setup = false) const;
+    bool add_mounting_command(const std::shared_ptr<MountCommandBase> &command);
     bool add_mounting_command(const Glib::ustring &command);
-    Glib::ustring get_used_letters(bool ignore_selected_row = false) const;
-    Glib::ustring get_mounting_command_for_program(const Glib::ustring &program_path) const;
+    const MountCommandBase *get_mounting_command(const Gtk::TreeIter &iter) const;
+    DriveLetterSet get_used_letters(bool ignore_selected_row = false) const;
+    std::shared_ptr<MountCommand> get_mounting_command_for_program(const Glib::ustring &program_path) const;
     bool check_program(const Glib::ustring &program_path) const;
-    Glib::ustring get_next_id() const;
+    void schedule_program_check(Gtk::Entry *entry);
     void validate_controls();
 
 public:
     EditProfileDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder);
+    ~EditProfileDialog();
 
+    void set_library(ProfileLibrary &library);
     void load_profile(const Glib::ustring &id);
     void save_profile();
+    const Glib::ustring &get_profile_id() const;
 };
 
 } // DOSBoxGTK
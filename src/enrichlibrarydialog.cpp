@@ -0,0 +1,228 @@
+/**
+ * @file
+ * EnrichLibraryDialog class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "enrichlibrarydialog.h"
+#include "config.h"
+#include "allocaccounting.hpp"
+#include <glibmm/i18n.h>
+#include <gtkmm/messagedialog.h>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Stops listening to the enricher and closes the dialog.
+ * The enrichment keeps running and its accepted matches are still saved.
+ * @param response_id Dialog response value.
+ */
+void EnrichLibraryDialog::on_response(int response_id)
+{
+    for (auto &connection : this->m_connections) {
+        connection.disconnect();
+    }
+
+    this->m_connections.clear();
+    Gtk::Dialog::on_response(response_id);
+    this->hide();
+}
+
+/**
+ * Completes the profile of the selected candidate with its game page and
+ * removes the profile from the review list. The profile is kept in the list
+ * and the error is shown if the game page can not be retrieved.
+ */
+Tools::AsyncTask EnrichLibraryDialog::on_apply_button_clicked()
+{
+    auto iter = this->m_reviews_tv->get_selection()->get_selected();
+
+    if (!iter || !iter->parent()) {
+        co_return;
+    }
+
+    auto token = this->m_async_token;
+    Glib::ustring href, id, error;
+    GameInfo info;
+
+    iter->get_value(2, href);
+    iter->get_value(3, id);
+    this->m_apply_button->set_sensitive(false);
+
+    try {
+        std::string html = co_await Tools::fetch_url(token, MOBYGAMES_URL + href.raw());
+
+        info = co_await Tools::run_in_pool(token, [html] {
+            return MobyGamesScraper::parse_game_page(html);
+        });
+    } catch (const Glib::Exception &e) {
+        error = e.what();
+    } catch (const std::exception &e) {
+        error = e.what();
+    }
+
+    this->on_reviews_tv_selection_changed();
+
+    if (!error.empty()) {
+        Gtk::MessageDialog msg_dialog(*this, Glib::ustring::compose(_("The game information could not be retrieved:\n%1"), error), false, Gtk::MESSAGE_ERROR);
+
+        msg_dialog.set_modal();
+        co_await Tools::dialog_response(token, msg_dialog);
+        co_return;
+    }
+
+    auto profile = this->m_library->get_snapshot()->find(id);
+
+    if (profile && (profile = LibraryEnricher::fill_missing(profile, info))) {
+        this->m_library->set_profile(profile);
+        this->m_library->save_async();
+        this->m_signal_profile_applied.emit();
+    }
+
+    // The rows may have changed while the page was being retrieved.
+    for (auto &row : this->m_reviews_ts->children()) {
+        Glib::ustring row_id;
+
+        row.get_value(3, row_id);
+
+        if (row_id == id) {
+            this->m_reviews_ts->erase(row);
+            break;
+        }
+    }
+}
+
+/**
+ * Sets the sensitivity of the apply button when the selection changes. Only
+ * candidate rows can be applied.
+ */
+void EnrichLibraryDialog::on_reviews_tv_selection_changed()
+{
+    auto iter = this->m_reviews_tv->get_selection()->get_selected();
+
+    this->m_apply_button->set_sensitive(iter && iter->parent());
+}
+
+/**
+ * Adds a profile and its candidates to the review list.
+ * @param review Profile and its candidates.
+ */
+void EnrichLibraryDialog::on_review_needed(const EnrichmentReview &review)
+{
+    ALLOC_SCOPE(Tools::AllocTag::UI);
+    auto parent = this->m_reviews_ts->append();
+
+    parent->set_value(0, review.title);
+    parent->set_value(3, review.id);
+
+    for (auto &candidate : review.candidates) {
+        auto child = this->m_reviews_ts->append(parent->children());
+
+        child->set_value(0, candidate.title);
+        child->set_value(1, candidate.year);
+        child->set_value(2, candidate.href);
+        child->set_value(3, review.id);
+    }
+
+    ++this->m_reviews;
+}
+
+/**
+ * Updates the progress bar.
+ * @param done Profiles resolved.
+ * @param total Profiles to resolve.
+ */
+void EnrichLibraryDialog::on_progress(unsigned done, unsigned total)
+{
+    this->m_enrich_pb->set_fraction(static_cast<double>(done) / total);
+    this->m_enrich_pb->set_text(Glib::ustring::compose(_("%1 of %2 profiles looked up"), done, total));
+}
+
+/**
+ * Shows the summary when the enrichment ends.
+ * @param enriched Profiles completed.
+ * @param not_found Profiles not found.
+ */
+void EnrichLibraryDialog::on_finished(unsigned enriched, unsigned not_found)
+{
+    this->m_enrich_pb->set_fraction(1);
+    this->m_enrich_pb->set_text(_("Done"));
+
+    if (enriched == 0 && this->m_reviews == 0 && not_found == 0) {
+        this->m_summary_label->set_text(_("Every profile is complete."));
+    } else {
+        this->m_summary_label->set_text(Glib::ustring::compose(_("%1 profiles completed, %2 to review and %3 not found."), enriched, this->m_reviews, not_found));
+    }
+}
+
+/**
+ * Constructor.
+ * @param cobject Underlying C object for the Base Class constructor.
+ * @param builder Gtk::Builder used to retrieve the child widgets.
+ */
+EnrichLibraryDialog::EnrichLibraryDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder) :
+    Gtk::Dialog(cobject)
+{
+    builder->set_translation_domain(PACKAGE);
+
+    this->m_reviews_ts = Glib::RefPtr<Gtk::TreeStore>::cast_dynamic(builder->get_object("ReviewsTS"));
+    builder->get_widget("ReviewsTV", this->m_reviews_tv);
+    builder->get_widget("EnrichPB", this->m_enrich_pb);
+    builder->get_widget("SummaryLabel", this->m_summary_label);
+    builder->get_widget("ApplyButton", this->m_apply_button);
+
+    // Signals
+    this->m_reviews_tv->get_selection()->signal_changed().connect(sigc::mem_fun(*this, &EnrichLibraryDialog::on_reviews_tv_selection_changed));
+    this->m_apply_button->signal_clicked().connect(sigc::hide_return(sigc::mem_fun(*this, &EnrichLibraryDialog::on_apply_button_clicked)));
+}
+
+/**
+ * Destructor.
+ */
+EnrichLibraryDialog::~EnrichLibraryDialog()
+{
+    this->m_async_token.cancel();
+
+    for (auto &connection : this->m_connections) {
+        connection.disconnect();
+    }
+}
+
+/**
+ * Starts enriching the library and listing the profiles to review.
+ * @param enricher Enricher looking up the profiles.
+ * @param library Library being enriched.
+ * @param max_transfers Maximum number of simultaneous requests.
+ * @param max_rate Maximum number of requests started per second.
+ */
+void EnrichLibraryDialog::enrich(LibraryEnricher &enricher, ProfileLibrary &library, unsigned max_transfers, double max_rate)
+{
+    this->m_library = &library;
+
+    this->m_connections.push_back(enricher.signal_review_needed().connect(sigc::mem_fun(*this, &EnrichLibraryDialog::on_review_needed)));
+    this->m_connections.push_back(enricher.signal_progress().connect(sigc::mem_fun(*this, &EnrichLibraryDialog::on_progress)));
+    this->m_connections.push_back(enricher.signal_finished().connect(sigc::mem_fun(*this, &EnrichLibraryDialog::on_finished)));
+
+    this->m_reviews = 0;
+    this->m_enrich_pb->set_fraction(0);
+    this->m_enrich_pb->set_text(_("Looking up..."));
+    this->m_summary_label->set_text(Glib::ustring());
+    enricher.start(max_transfers, max_rate);
+}
+
+/**
+ * Signal emitted when the user has completed a profile with a candidate.
+ * @return The signal.
+ */
+EnrichLibraryDialog::type_signal_profile_applied EnrichLibraryDialog::signal_profile_applied()
+{
+    return this->m_signal_profile_applied;
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * EnrichLibraryDialog class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef ENRICHLIBRARYDIALOG_H
+#define ENRICHLIBRARYDIALOG_H
+
+#include "async.hpp"
+#include "libraryenricher.h"
+#include <gtkmm/dialog.h>
+#include <gtkmm/builder.h>
+#include <gtkmm/button.h>
+#include <gtkmm/label.h>
+#include <gtkmm/treestore.h>
+#include <gtkmm/treeview.h>
+#include <gtkmm/progressbar.h>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Dialog showing the progress of a library enrichment and the profiles whose
+ * game must be chosen by the user. Each profile to review is a row whose
+ * children are its candidate games.
+ */
+class EnrichLibraryDialog final : public Gtk::Dialog
+{
+public:
+    typedef sigc::signal<void> type_signal_profile_applied;
+
+private:
+    Glib::RefPtr<Gtk::TreeStore> m_reviews_ts;
+    Gtk::TreeView *m_reviews_tv   = nullptr;
+    Gtk::ProgressBar *m_enrich_pb = nullptr;
+    Gtk::Label *m_summary_label   = nullptr;
+    Gtk::Button *m_apply_button   = nullptr;
+
+    ProfileLibrary *m_library = nullptr;                  ///< Library being enriched.
+    unsigned m_reviews = 0;                               ///< Profiles to review found so far.
+    std::vector<sigc::connection> m_connections;          ///< Connections to the enricher signals.
+    Tools::CancellationToken m_async_token;               ///< Cancelled when the dialog is destroyed.
+    type_signal_profile_applied m_signal_profile_applied; ///< Emitted when a profile has been completed.
+
+protected:
+    virtual void on_response(int response_id) override;
+    Tools::AsyncTask on_apply_button_clicked();
+    void on_reviews_tv_selection_changed();
+    void on_review_needed(const EnrichmentReview &review);
+    void on_progress(unsigned done, unsigned total);
+    void on_finished(unsigned enriched, unsigned not_found);
+
+public:
+    EnrichLibraryDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder);
+    virtual ~EnrichLibraryDialog();
+
+    void enrich(LibraryEnricher &enricher, ProfileLibrary &library, unsigned max_transfers, double max_rate);
+    type_signal_profile_applied signal_profile_applied();
+};
+
+} // DOSBoxGTK
+
+#endif // ENRICHLIBRARYDIALOG_H
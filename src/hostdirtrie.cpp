@@ -0,0 +1,115 @@
+/**
+ * @file
+ * HostDirTrie class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "hostdirtrie.h"
+#include <glib.h>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Splits a path in its non empty components.
+ * @param path Path to split.
+ * @return std::vector with the path components.
+ */
+static std::vector<Glib::ustring> split_path(const Glib::ustring &path)
+{
+    std::vector<Glib::ustring> components;
+    Glib::ustring::size_type start = 0;
+
+    while (start < path.size()) {
+        auto end = path.find(G_DIR_SEPARATOR, start);
+
+        if (end == Glib::ustring::npos) {
+            end = path.size();
+        }
+
+        if (end > start) {
+            components.push_back(path.substr(start, end - start));
+        }
+
+        start = end + 1;
+    }
+
+    return components;
+}
+
+/**
+ * Inserts a host directory. If the directory is alredy in the trie the first
+ * inserted value is kept, as DOSBox does with the first matching mount.
+ * @param host_dir Host directory.
+ * @param value Value for the directory.
+ */
+void HostDirTrie::insert(const Glib::ustring &host_dir, const Glib::ustring &value)
+{
+    Node *node = &this->m_root;
+
+    for (auto component : split_path(host_dir)) {
+        auto &child = node->children[component];
+
+        if (!child) {
+            child.reset(new Node());
+        }
+
+        node = child.get();
+    }
+
+    if (!node->has_value) {
+        node->value     = value;
+        node->has_value = true;
+    }
+}
+
+/**
+ * Finds the deepest host directory containing the given path.
+ * @param path Path to look for.
+ * @param value Value of the found host directory.
+ * @return @c TRUE if a host directory containing the path was found or
+ * @c FALSE otherwise.
+ */
+bool HostDirTrie::find(const Glib::ustring &path, Glib::ustring &value) const
+{
+    const Node *node  = &this->m_root,
+               *found = this->m_root.has_value ? &this->m_root : nullptr;
+
+    for (auto component : split_path(path)) {
+        auto iter = node->children.find(component);
+
+        if (iter == node->children.end()) {
+            break;
+        }
+
+        node = iter->second.get();
+
+        if (node->has_value) {
+            found = node;
+        }
+    }
+
+    if (found != nullptr) {
+        value = found->value;
+    }
+
+    return found != nullptr;
+}
+
+/**
+ * Removes every host directory from the trie.
+ */
+void HostDirTrie::clear()
+{
+    this->m_root.children.clear();
+    this->m_root.value     = Glib::ustring();
+    this->m_root.has_value = false;
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,51 @@
+/**
+ * @file
+ * HostDirTrie class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef HOSTDIRTRIE_H
+#define HOSTDIRTRIE_H
+
+#include <glibmm/ustring.h>
+#include <map>
+#include <memory>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Prefix tree of host directories.
+ * Each mounted host directory is stored split in its path components, so the
+ * mounting point containing a given file is found walking the file path only
+ * once, no matter how many mounting points there are.
+ */
+class HostDirTrie final
+{
+private:
+    /**
+     * Trie node. A node holds a value when a host directory ends on it.
+     */
+    struct Node
+    {
+        std::map<Glib::ustring, std::unique_ptr<Node>> children; ///< Child nodes by path component.
+        Glib::ustring value;                                     ///< Value stored for the directory.
+        bool has_value = false;                                  ///< Whether the node holds a value.
+    };
+
+    Node m_root; ///< Root node.
+
+public:
+    void insert(const Glib::ustring &host_dir, const Glib::ustring &value);
+    bool find(const Glib::ustring &path, Glib::ustring &value) const;
+    void clear();
+};
+
+} // DOSBoxGTK
+
+#endif // HOSTDIRTRIE_H
@@ -0,0 +1,245 @@
+/**
+ * @file
+ * HtmlDocument class definition.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "htmldocument.hpp"
+#include "log.hpp"
+#include "metrics.hpp"
+#include <libxml/HTMLtree.h>
+#include <libxml/xpathInternals.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+static auto &s_html_truncated = Metrics::get_counter("dosboxgtk_html_truncated_total", "HTML pages not fully parsed because of the size or time budgets."); ///< Truncated pages counter.
+
+/**
+ * XPath error handler. Failed queries return no nodes, their errors are not
+ * printed.
+ */
+#if LIBXML_VERSION >= 21200
+static void ignore_error(void*, const xmlError*)
+#else
+static void ignore_error(void*, xmlErrorPtr)
+#endif // LIBXML_VERSION
+{
+}
+
+/**
+ * Appends the text of a node and its descendants. Runs of white space are
+ * collapsed into a single space, like a browser does.
+ * @param node Node.
+ * @param text Text. Updated.
+ * @param keep_breaks Whether @c br elements become new lines.
+ */
+void HtmlDocument::append_text(xmlNodePtr node, std::string &text, bool keep_breaks)
+{
+    if (node->type == XML_TEXT_NODE || node->type == XML_CDATA_SECTION_NODE) {
+        for (auto c = reinterpret_cast<const char*>(node->content); c != nullptr && *c != '\0'; ++c) {
+            if (std::strchr(" \t\r\n\f", *c) != nullptr) {
+                if (!text.empty() && text.back() != ' ' && text.back() != '\n') {
+                    text += ' ';
+                }
+            } else {
+                text += *c;
+            }
+        }
+    } else if (node->type == XML_ELEMENT_NODE) {
+        if (keep_breaks && is_element(node, "br")) {
+            while (!text.empty() && text.back() == ' ') {
+                text.pop_back();
+            }
+
+            text += '\n';
+        } else if (!is_element(node, "script") && !is_element(node, "style")) {
+            for (auto child = node->children; child != nullptr; child = child->next) {
+                append_text(child, text, keep_breaks);
+            }
+        }
+    }
+}
+
+/**
+ * Constructor. Parses a page within the size and time budgets.
+ * @param html Page contents. The encoding is taken from the page and UTF-8
+ * is assumed if the page does not declare it.
+ * @param max_size Size budget in bytes.
+ * @param time_budget Time budget.
+ */
+HtmlDocument::HtmlDocument(const std::string &html, std::size_t max_size, std::chrono::milliseconds time_budget)
+{
+    static std::once_flag init_flag;
+
+    std::call_once(init_flag, xmlInitParser);
+
+    auto deadline = std::chrono::steady_clock::now() + time_budget;
+    auto size = std::min(html.size(), max_size);
+    auto ctxt = htmlCreatePushParserCtxt(nullptr, nullptr, nullptr, 0, nullptr, XML_CHAR_ENCODING_UTF8);
+
+    if (ctxt == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    htmlCtxtUseOptions(ctxt, HTML_PARSE_RECOVER | HTML_PARSE_NOERROR | HTML_PARSE_NOWARNING | HTML_PARSE_NONET | HTML_PARSE_COMPACT);
+    this->m_truncated = size < html.size();
+
+    for (std::size_t offset = 0; offset < size; offset += HTML_CHUNK_SIZE) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            this->m_truncated = true;
+            break;
+        }
+
+#if LIBXML_VERSION < 21000
+        ctxt->checkIndex = 0; // See HtmlSaxParser::feed().
+#endif // LIBXML_VERSION
+        htmlParseChunk(ctxt, html.data() + offset, static_cast<int>(std::min<std::size_t>(HTML_CHUNK_SIZE, size - offset)), 0);
+    }
+
+    htmlParseChunk(ctxt, nullptr, 0, 1);
+    this->m_doc = ctxt->myDoc;
+    htmlFreeParserCtxt(ctxt);
+
+    if (this->m_truncated) {
+        s_html_truncated.add();
+        LOG_WARNING(LogCategory::NETWORK, "HTML page of %1 bytes truncated by the parsing budgets", html.size());
+    }
+
+    if (this->m_doc == nullptr) {
+        this->m_doc = htmlNewDocNoDtD(nullptr, nullptr);
+    }
+
+    this->m_xpath_ctxt = xmlXPathNewContext(this->m_doc);
+    this->m_xpath_ctxt->error = ignore_error;
+}
+
+/**
+ * Destructor.
+ */
+HtmlDocument::~HtmlDocument()
+{
+    xmlXPathFreeContext(this->m_xpath_ctxt);
+    xmlFreeDoc(this->m_doc);
+}
+
+/**
+ * Checks whether the page was not fully parsed.
+ * @return @c TRUE if a budget was exceeded or @c FALSE otherwise.
+ */
+bool HtmlDocument::is_truncated() const
+{
+    return this->m_truncated;
+}
+
+/**
+ * Evaluates an XPath expression.
+ * @param xpath XPath expression returning a node set.
+ * @param context Context node, the document if it is @c nullptr.
+ * @return Nodes in document order. Empty if the expression is not valid, does
+ * not return a node set or exceeds the operations budget.
+ */
+std::vector<xmlNodePtr> HtmlDocument::find(const std::string &xpath, xmlNodePtr context) const
+{
+    std::vector<xmlNodePtr> nodes;
+
+    this->m_xpath_ctxt->node = context != nullptr ? context : reinterpret_cast<xmlNodePtr>(this->m_doc);
+#if LIBXML_VERSION >= 20911
+    this->m_xpath_ctxt->opLimit = HTML_XPATH_OP_LIMIT;
+    this->m_xpath_ctxt->opCount = 0;
+#endif // LIBXML_VERSION
+
+    auto result = xmlXPathEvalExpression(reinterpret_cast<const xmlChar*>(xpath.c_str()), this->m_xpath_ctxt);
+
+    if (result == nullptr) {
+        LOG_DEBUG(LogCategory::NETWORK, "XPath query %1 failed", xpath);
+        return nodes;
+    }
+
+    if (result->type == XPATH_NODESET && result->nodesetval != nullptr) {
+        nodes.assign(result->nodesetval->nodeTab, result->nodesetval->nodeTab + result->nodesetval->nodeNr);
+    }
+
+    xmlXPathFreeObject(result);
+
+    return nodes;
+}
+
+/**
+ * Evaluates an XPath expression and gets the first node.
+ * @param xpath XPath expression returning a node set.
+ * @param context Context node, the document if it is @c nullptr.
+ * @return First node or @c nullptr if there are none.
+ */
+xmlNodePtr HtmlDocument::find_first(const std::string &xpath, xmlNodePtr context) const
+{
+    auto nodes = this->find(xpath, context);
+
+    return nodes.empty() ? nullptr : nodes.front();
+}
+
+/**
+ * Gets the text of a node and its descendants, with collapsed white space
+ * and without leading and trailing spaces.
+ * @param node Node. It can be @c nullptr.
+ * @param keep_breaks Whether @c br elements become new lines.
+ * @return UTF-8 text.
+ */
+std::string HtmlDocument::get_text(xmlNodePtr node, bool keep_breaks)
+{
+    std::string text;
+
+    if (node != nullptr) {
+        append_text(node, text, keep_breaks);
+    }
+
+    auto first = text.find_first_not_of(" \n"),
+         last  = text.find_last_not_of(" \n");
+
+    return first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+}
+
+/**
+ * Gets the value of an element attribute.
+ * @param node Element. It can be @c nullptr.
+ * @param name Attribute name.
+ * @return Attribute value, empty if the attribute is not set.
+ */
+std::string HtmlDocument::get_attribute(xmlNodePtr node, const char *name)
+{
+    std::string value;
+
+    if (node != nullptr && node->type == XML_ELEMENT_NODE) {
+        auto property = xmlGetProp(node, reinterpret_cast<const xmlChar*>(name));
+
+        if (property != nullptr) {
+            value = reinterpret_cast<const char*>(property);
+            xmlFree(property);
+        }
+    }
+
+    return value;
+}
+
+/**
+ * Checks the type and name of a node.
+ * @param node Node. It can be @c nullptr.
+ * @param name Lowercase element name.
+ * @return @c TRUE if the node is an element with the given name or @c FALSE
+ * otherwise.
+ */
+bool HtmlDocument::is_element(xmlNodePtr node, const char *name)
+{
+    return node != nullptr && node->type == XML_ELEMENT_NODE && xmlStrcmp(node->name, reinterpret_cast<const xmlChar*>(name)) == 0;
+}
+
+} // Tools
@@ -0,0 +1,72 @@
+/**
+ * @file
+ * HtmlDocument class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef HTMLDOCUMENT_HPP
+#define HTMLDOCUMENT_HPP
+
+#define HTML_MAX_SIZE (4 * 1024 * 1024) ///< Default size budget, bytes of a page that are parsed.
+#define HTML_TIME_BUDGET 500            ///< Default time budget for parsing a page, in milliseconds.
+#define HTML_CHUNK_SIZE (64 * 1024)     ///< Bytes fed to the parser between time budget checks.
+#define HTML_XPATH_OP_LIMIT 10000000    ///< Budget of operations of a single XPath query.
+
+#include <libxml/HTMLparser.h>
+#include <libxml/xpath.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * HTML page parsed by the libxml2 HTML parser, queried with XPath.
+ * Parsing and querying take linear time on the page size, unlike matching
+ * regular expressions over the raw HTML, and are bounded by hard budgets:
+ * - Only the first max_size bytes of the page are parsed.
+ * - The page is fed to the parser in HTML_CHUNK_SIZE chunks and parsing stops
+ *   once the time budget is spent.
+ * - Each XPath query is limited to HTML_XPATH_OP_LIMIT operations when
+ *   libxml2 supports it.
+ * Exceeding a budget is not an error: the document holds the part of the page
+ * parsed so far and is_truncated() returns @c TRUE.
+ * Entities are decoded by the parser and the text is always UTF-8.
+ * Documents can be used from any thread, but a document must not be shared
+ * between threads.
+ */
+class HtmlDocument final
+{
+private:
+    htmlDocPtr m_doc = nullptr;                 ///< Parsed document.
+    xmlXPathContextPtr m_xpath_ctxt = nullptr;  ///< XPath context of the document.
+    bool m_truncated = false;                   ///< Whether a budget was exceeded.
+
+    static void append_text(xmlNodePtr node, std::string &text, bool keep_breaks);
+
+public:
+    explicit HtmlDocument(const std::string &html,
+                          std::size_t max_size = HTML_MAX_SIZE,
+                          std::chrono::milliseconds time_budget = std::chrono::milliseconds(HTML_TIME_BUDGET));
+    HtmlDocument(const HtmlDocument&) = delete;
+    HtmlDocument &operator=(const HtmlDocument&) = delete;
+    ~HtmlDocument();
+
+    bool is_truncated() const;
+    std::vector<xmlNodePtr> find(const std::string &xpath, xmlNodePtr context = nullptr) const;
+    xmlNodePtr find_first(const std::string &xpath, xmlNodePtr context = nullptr) const;
+
+    static std::string get_text(xmlNodePtr node, bool keep_breaks = false);
+    static std::string get_attribute(xmlNodePtr node, const char *name);
+    static bool is_element(xmlNodePtr node, const char *name);
+};
+
+} // Tools
+
+#endif // HTMLDOCUMENT_HPP
@@ -0,0 +1,184 @@
+/**
+ * @file
+ * HtmlSaxParser class definition.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "htmlsaxparser.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * SAX start element callback.
+ * @param user_data The parser.
+ * @param name Element name.
+ * @param attributes Attribute names and values.
+ */
+void HtmlSaxParser::on_sax_start_element(void *user_data, const xmlChar *name, const xmlChar **attributes)
+{
+    static_cast<HtmlSaxParser*>(user_data)->on_start_element(reinterpret_cast<const char*>(name), reinterpret_cast<const char**>(attributes));
+}
+
+/**
+ * SAX end element callback.
+ * @param user_data The parser.
+ * @param name Element name.
+ */
+void HtmlSaxParser::on_sax_end_element(void *user_data, const xmlChar *name)
+{
+    static_cast<HtmlSaxParser*>(user_data)->on_end_element(reinterpret_cast<const char*>(name));
+}
+
+/**
+ * SAX characters callback.
+ * @param user_data The parser.
+ * @param text Text.
+ * @param length Text length in bytes.
+ */
+void HtmlSaxParser::on_sax_characters(void *user_data, const xmlChar *text, int length)
+{
+    static_cast<HtmlSaxParser*>(user_data)->on_text(reinterpret_cast<const char*>(text), length);
+}
+
+/**
+ * Gets the value of an attribute from the start element attributes.
+ * @param attributes Attribute names and values. It can be @c nullptr.
+ * @param name Lowercase attribute name.
+ * @return Attribute value or @c nullptr if it is not set.
+ */
+const char *HtmlSaxParser::get_attribute(const char **attributes, const char *name)
+{
+    for (auto attribute = attributes; attribute != nullptr && *attribute != nullptr; attribute += 2) {
+        if (std::strcmp(*attribute, name) == 0) {
+            return attribute[1] != nullptr ? attribute[1] : "";
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * Collapses the runs of white space of a text into a single space and
+ * removes the leading and trailing spaces, like the XPath normalize-space()
+ * function.
+ * @param text Text.
+ * @return Normalized text.
+ */
+std::string HtmlSaxParser::normalize_space(const std::string &text)
+{
+    std::string result;
+
+    for (auto c : text) {
+        if (std::strchr(" \t\r\n\f", c) != nullptr) {
+            if (!result.empty() && result.back() != ' ') {
+                result += ' ';
+            }
+        } else {
+            result += c;
+        }
+    }
+
+    if (!result.empty() && result.back() == ' ') {
+        result.pop_back();
+    }
+
+    return result;
+}
+
+/**
+ * Constructor.
+ * @param max_size Size budget in bytes. The rest of the page is ignored.
+ */
+HtmlSaxParser::HtmlSaxParser(std::size_t max_size) :
+    m_max_size(max_size)
+{
+    static std::once_flag init_flag;
+    htmlSAXHandler sax;
+
+    std::call_once(init_flag, xmlInitParser);
+    std::memset(&sax, 0, sizeof(sax));
+    sax.startElement = &HtmlSaxParser::on_sax_start_element;
+    sax.endElement   = &HtmlSaxParser::on_sax_end_element;
+    sax.characters   = &HtmlSaxParser::on_sax_characters;
+    sax.cdataBlock   = &HtmlSaxParser::on_sax_characters;
+
+    this->m_ctxt = htmlCreatePushParserCtxt(&sax, this, nullptr, 0, nullptr, XML_CHAR_ENCODING_UTF8);
+
+    if (this->m_ctxt == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    htmlCtxtUseOptions(this->m_ctxt, HTML_PARSE_RECOVER | HTML_PARSE_NOERROR | HTML_PARSE_NOWARNING | HTML_PARSE_NONET);
+}
+
+/**
+ * Destructor.
+ */
+HtmlSaxParser::~HtmlSaxParser()
+{
+    htmlFreeParserCtxt(this->m_ctxt);
+}
+
+/**
+ * Parses the next piece of the page. The events of the complete tokens are
+ * reported before returning.
+ * @param data Page bytes.
+ * @param size Number of bytes.
+ */
+void HtmlSaxParser::feed(const char *data, std::size_t size)
+{
+    if (this->m_finished || this->m_size >= this->m_max_size) {
+        return;
+    }
+
+    size = std::min(size, this->m_max_size - this->m_size);
+    this->m_size += size;
+
+    // htmlParseChunk() takes an int size.
+    for (std::size_t offset = 0; offset < size; offset += HTML_CHUNK_SIZE) {
+#if LIBXML_VERSION < 21000
+        // Older push parsers can keep a stale lookup position between chunks
+        // and stop reporting anything until the page ends.
+        this->m_ctxt->checkIndex = 0;
+#endif // LIBXML_VERSION
+        htmlParseChunk(this->m_ctxt, data + offset, static_cast<int>(std::min<std::size_t>(HTML_CHUNK_SIZE, size - offset)), 0);
+    }
+
+    if (this->m_size >= this->m_max_size) {
+        LOG_WARNING(LogCategory::NETWORK, "HTML stream truncated after %1 bytes", this->m_size);
+    }
+}
+
+/**
+ * Ends the page, reporting the pending text and the end of the elements
+ * still open.
+ */
+void HtmlSaxParser::finish()
+{
+    if (!this->m_finished) {
+        this->m_finished = true;
+        htmlParseChunk(this->m_ctxt, nullptr, 0, 1);
+    }
+}
+
+/**
+ * Checks whether the size budget was exceeded.
+ * @return @c TRUE if part of the page was ignored or @c FALSE otherwise.
+ */
+bool HtmlSaxParser::is_truncated() const
+{
+    return this->m_size >= this->m_max_size;
+}
+
+} // Tools
@@ -0,0 +1,84 @@
+/**
+ * @file
+ * HtmlSaxParser class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef HTMLSAXPARSER_HPP
+#define HTMLSAXPARSER_HPP
+
+#include "htmldocument.hpp"
+#include <libxml/HTMLparser.h>
+#include <string>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Incremental HTML tokenizer. It feeds the libxml2 HTML push parser with
+ * the page as it arrives and reports elements and text through virtual
+ * methods, without building a document tree, so memory use does not grow
+ * with the page size. Malformed markup is recovered the same way as
+ * HtmlDocument does: implied and unclosed elements produce their start and end
+ * events.
+ * The encoding is taken from the page, UTF-8 if it does not declare it.
+ * Only the first max_size bytes are parsed, see HTML_MAX_SIZE.
+ * A parser must be fed from a single thread at a time.
+ */
+class HtmlSaxParser
+{
+private:
+    htmlParserCtxtPtr m_ctxt = nullptr; ///< Push parser context.
+    std::size_t m_max_size;             ///< Size budget in bytes.
+    std::size_t m_size = 0;             ///< Bytes fed so far.
+    bool m_finished = false;            ///< Whether finish() has been called.
+
+    static void on_sax_start_element(void *user_data, const xmlChar *name, const xmlChar **attributes);
+    static void on_sax_end_element(void *user_data, const xmlChar *name);
+    static void on_sax_characters(void *user_data, const xmlChar *text, int length);
+
+protected:
+    /**
+     * An element starts.
+     * @param name Lowercase element name.
+     * @param attributes Attribute names and values, ending with @c nullptr.
+     * It can be @c nullptr if the element has no attributes.
+     */
+    virtual void on_start_element(const char *name, const char **attributes) = 0;
+
+    /**
+     * An element ends.
+     * @param name Lowercase element name.
+     */
+    virtual void on_end_element(const char *name) = 0;
+
+    /**
+     * Text between elements, UTF-8 with the entities decoded. A text node
+     * can be reported in several pieces.
+     * @param text Text, not null terminated.
+     * @param length Text length in bytes.
+     */
+    virtual void on_text(const char *text, std::size_t length) = 0;
+
+    static const char *get_attribute(const char **attributes, const char *name);
+    static std::string normalize_space(const std::string &text);
+
+public:
+    explicit HtmlSaxParser(std::size_t max_size = HTML_MAX_SIZE);
+    HtmlSaxParser(const HtmlSaxParser&) = delete;
+    HtmlSaxParser &operator=(const HtmlSaxParser&) = delete;
+    virtual ~HtmlSaxParser();
+
+    void feed(const char *data, std::size_t size);
+    void finish();
+    bool is_truncated() const;
+};
+
+} // Tools
+
+#endif // HTMLSAXPARSER_HPP
@@ -17,11 +17,11 @@
  */
 
 #include "htmltools.hpp"
+#include "metrics.hpp"
 #include <glibmm/stringutils.h>
 #include <glibmm/convert.h>
 #include <glibmm/regex.h>
 #include <map>
-#include <iostream>
 
 /**
  * Namespace used for miscelaneous tools and utilities.
@@ -171,11 +171,13 @@ Glib::ustring html_entities_decode(const Glib::ustring &str)
 {
     Glib::ustring result = str;
     Glib::MatchInfo entity_minfo;
+    Metrics::get_regex_compilations().add();
     auto regex_entity = Glib::Regex::create("(?'entity'&.+?;)");
 
     if(regex_entity->match(str, 0, entity_minfo)) {
         do {
             Glib::MatchInfo code_minfo;
+            Metrics::get_regex_compilations().add();
             auto regex_code = Glib::Regex::create("&#(?'entity_code'.+);");
             auto entity = entity_minfo.fetch_named("entity"),
                  number_entity = entity;
@@ -193,6 +195,7 @@ Glib::ustring html_entities_decode(const Glib::ustring &str)
                 }
 
                 auto c = static_cast<gunichar>(Glib::Ascii::strtod(code));
+                Metrics::get_regex_compilations().add();
                 auto regex_subst = Glib::Regex::create(entity);
                 result = regex_subst->replace(result, 0, Glib::ustring(1, c), static_cast<Glib::RegexMatchFlags>(0));
             }
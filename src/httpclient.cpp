@@ -0,0 +1,579 @@
+/**
+ * @file
+ * HttpClient class definition.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "httpclient.hpp"
+#include "log.hpp"
+#include "metrics.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <exception>
+#include <new>
+#include <stdexcept>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+static auto &s_requests     = Metrics::get_counter("dosboxgtk_http_requests_total", "HTTP requests done.");                                          ///< Requests counter.
+static auto &s_connections  = Metrics::get_counter("dosboxgtk_http_connections_total", "HTTP connections opened, the rest of requests reused one."); ///< New connections counter.
+static auto &s_not_modified = Metrics::get_counter("dosboxgtk_http_not_modified_total", "HTTP responses taken from the cache after revalidation.");  ///< Revalidated responses counter, the cache hits.
+static auto &s_cache_misses = Metrics::get_counter("dosboxgtk_http_cache_misses_total", "HTTP GET responses not cached or changed since cached.");   ///< Cache misses counter.
+
+/**
+ * State of a transfer, shared with the libcurl callbacks.
+ */
+struct Transfer
+{
+    const CancellationToken &token;                                               ///< Cancellation token.
+    const std::function<void(const char*, std::size_t)> &on_data;                 ///< Receives the body.
+    const std::function<void(const std::string&, const std::string&)> &on_header; ///< Receives the headers, it can be empty.
+    std::exception_ptr exception;                                                 ///< Exception thrown by a callback.
+};
+
+/**
+ * libcurl write callback. Passes the received body to the transfer function.
+ * @param data Received bytes.
+ * @param size Always 1.
+ * @param nmemb Number of bytes.
+ * @param user_data The Transfer.
+ * @return Number of bytes taken, less than received to abort the transfer.
+ */
+static std::size_t on_curl_write(char *data, std::size_t size, std::size_t nmemb, void *user_data)
+{
+    auto transfer = static_cast<Transfer*>(user_data);
+
+    // Exceptions must not go through libcurl.
+    try {
+        transfer->on_data(data, size * nmemb);
+    } catch (...) {
+        transfer->exception = std::current_exception();
+
+        return 0;
+    }
+
+    return size * nmemb;
+}
+
+/**
+ * libcurl header callback. Passes each header to the transfer function with
+ * its name in lowercase. A status line, which starts a new response after a
+ * redirection or a 100 Continue, is passed with an empty name.
+ * @param data Header line, including the line break.
+ * @param size Always 1.
+ * @param nmemb Line length.
+ * @param user_data The Transfer.
+ * @return Line length.
+ */
+static std::size_t on_curl_header(char *data, std::size_t size, std::size_t nmemb, void *user_data)
+{
+    auto transfer = static_cast<Transfer*>(user_data);
+    std::string line(data, size * nmemb);
+
+    if (!transfer->on_header) {
+        return size * nmemb;
+    }
+
+    try {
+        auto colon = line.find(':');
+
+        if (line.compare(0, 5, "HTTP/") == 0) {
+            transfer->on_header(std::string(), std::string());
+        } else if (colon != std::string::npos) {
+            auto name  = line.substr(0, colon);
+            auto begin = line.find_first_not_of(" \t", colon + 1);
+            auto end   = line.find_last_not_of(" \t\r\n");
+
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return std::tolower(c); });
+            transfer->on_header(name, begin == std::string::npos || end < begin ? std::string() : line.substr(begin, end - begin + 1));
+        }
+    } catch (...) {
+        transfer->exception = std::current_exception();
+
+        return 0;
+    }
+
+    return size * nmemb;
+}
+
+/**
+ * libcurl progress callback. Aborts the transfer, even while connecting,
+ * when the token is cancelled.
+ * @param user_data The Transfer.
+ * @return 0 to continue or 1 to abort the transfer.
+ */
+static int on_curl_progress(void *user_data, curl_off_t, curl_off_t, curl_off_t, curl_off_t)
+{
+    return static_cast<Transfer*>(user_data)->token.is_cancelled() ? 1 : 0;
+}
+
+/**
+ * Locks the shared data for a libcurl handle.
+ * @param handle Easy handle.
+ * @param data Kind of shared data.
+ * @param access Kind of access.
+ * @param user_data The client.
+ */
+void HttpClient::lock_share(CURL *handle, curl_lock_data data, curl_lock_access access, void *user_data)
+{
+    static_cast<HttpClient*>(user_data)->m_share_mutexes[data].lock();
+}
+
+/**
+ * Unlocks the shared data for a libcurl handle.
+ * @param handle Easy handle.
+ * @param data Kind of shared data.
+ * @param user_data The client.
+ */
+void HttpClient::unlock_share(CURL *handle, curl_lock_data data, void *user_data)
+{
+    static_cast<HttpClient*>(user_data)->m_share_mutexes[data].unlock();
+}
+
+/**
+ * Takes an idle easy handle or creates a new one.
+ * @return Easy handle.
+ */
+CURL *HttpClient::acquire_handle()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->m_handles_mutex);
+
+        if (!this->m_idle_handles.empty()) {
+            auto handle = this->m_idle_handles.back();
+
+            this->m_idle_handles.pop_back();
+
+            return handle;
+        }
+    }
+
+    auto handle = curl_easy_init();
+
+    if (handle == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    return handle;
+}
+
+/**
+ * Resets an easy handle and keeps it for the next request. Resetting keeps
+ * its open connections.
+ * @param handle Easy handle.
+ */
+void HttpClient::release_handle(CURL *handle)
+{
+    curl_easy_reset(handle);
+
+    std::lock_guard<std::mutex> lock(this->m_handles_mutex);
+
+    this->m_idle_handles.push_back(handle);
+}
+
+/**
+ * Takes an easy handle and sets it up for a request.
+ * @param transfer The Transfer passed to the libcurl callbacks.
+ * @param url URL.
+ * @param post_fields POST request data. If it is empty a GET request is done.
+ * It must be kept until the request ends.
+ * @param header_list Additional request headers. It can be @c nullptr.
+ * @return Easy handle.
+ */
+CURL *HttpClient::prepare(void *transfer, const std::string &url, const std::string &post_fields, struct curl_slist *header_list)
+{
+    auto handle = this->acquire_handle();
+
+    curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+    curl_easy_setopt(handle, CURLOPT_SHARE, this->m_share);
+    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+    // Every encoding libcurl was built with: gzip, deflate and, usually, br.
+    curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, static_cast<long>(HTTP_CONNECT_TIMEOUT));
+    curl_easy_setopt(handle, CURLOPT_HTTPHEADER, header_list);
+    curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, on_curl_write);
+    curl_easy_setopt(handle, CURLOPT_WRITEDATA, transfer);
+    curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, on_curl_header);
+    curl_easy_setopt(handle, CURLOPT_HEADERDATA, transfer);
+    curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, on_curl_progress);
+    curl_easy_setopt(handle, CURLOPT_XFERINFODATA, transfer);
+    curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+
+    if (post_fields.empty()) {
+        curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+    } else {
+        curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, static_cast<long>(post_fields.size()));
+        curl_easy_setopt(handle, CURLOPT_POSTFIELDS, post_fields.c_str());
+    }
+
+    return handle;
+}
+
+/**
+ * Performs a request.
+ * @param token Cancellation token. Cancelling it aborts the transfer.
+ * @param url URL.
+ * @param post_fields POST request data. If it is empty a GET request is done.
+ * @param headers Additional request headers.
+ * @param on_data Function called with each received piece of the body.
+ * @param on_header Function called with the name and value of each response
+ * header, see on_curl_header(). It can be empty.
+ * @return HTTP status code.
+ */
+long HttpClient::perform(const CancellationToken &token, const std::string &url, const std::string &post_fields,
+                         const std::vector<std::string> &headers, const std::function<void(const char*, std::size_t)> &on_data,
+                         const std::function<void(const std::string&, const std::string&)> &on_header)
+{
+    Transfer transfer{token, on_data, on_header, nullptr};
+    struct curl_slist *header_list = nullptr;
+    long status = 0, connections = 0;
+
+    for (auto &header : headers) {
+        header_list = curl_slist_append(header_list, header.c_str());
+    }
+
+    auto handle = this->prepare(&transfer, url, post_fields, header_list);
+    auto code = curl_easy_perform(handle);
+
+    curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+    curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connections);
+    curl_slist_free_all(header_list);
+    this->release_handle(handle);
+    s_requests.add(1);
+    s_connections.add(connections);
+
+    if (transfer.exception) {
+        std::rethrow_exception(transfer.exception);
+    }
+
+    if (code != CURLE_OK) {
+        throw std::runtime_error(url + ": " + curl_easy_strerror(code));
+    }
+
+    if (status >= 400) {
+        LOG_WARNING(LogCategory::NETWORK, "%1 returned HTTP status %2", url, status);
+    }
+
+    return status;
+}
+
+/**
+ * Caches a response body, evicting the least recently used responses when
+ * the cache is over its size budget.
+ * @param url URL.
+ * @param etag ETag header.
+ * @param last_modified Last-Modified header.
+ * @param body Response body.
+ */
+void HttpClient::store(const std::string &url, const std::string &etag, const std::string &last_modified, const std::string &body)
+{
+    std::lock_guard<std::mutex> lock(this->m_cache_mutex);
+    auto iter = this->m_cache.find(url);
+
+    if (iter != this->m_cache.end()) {
+        this->m_cache_size -= iter->second.body->size();
+        this->m_cache_lru.erase(iter->second.lru);
+        this->m_cache.erase(iter);
+    }
+
+    if (body.size() > HTTP_CACHE_MAX_SIZE) {
+        return;
+    }
+
+    this->m_cache_lru.push_front(url);
+    this->m_cache[url] = CacheEntry{etag, last_modified, std::make_shared<const std::string>(body), this->m_cache_lru.begin()};
+    this->m_cache_size += body.size();
+
+    while (this->m_cache_size > HTTP_CACHE_MAX_SIZE) {
+        auto &oldest = this->m_cache.at(this->m_cache_lru.back());
+
+        this->m_cache_size -= oldest.body->size();
+        this->m_cache.erase(this->m_cache_lru.back());
+        this->m_cache_lru.pop_back();
+    }
+}
+
+/**
+ * Constructor.
+ */
+HttpClient::HttpClient()
+{
+    // Reference counted, it only increments the count when already done.
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+    this->m_share = curl_share_init();
+
+    if (this->m_share == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    curl_share_setopt(this->m_share, CURLSHOPT_LOCKFUNC, &HttpClient::lock_share);
+    curl_share_setopt(this->m_share, CURLSHOPT_UNLOCKFUNC, &HttpClient::unlock_share);
+    curl_share_setopt(this->m_share, CURLSHOPT_USERDATA, this);
+    curl_share_setopt(this->m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+    curl_share_setopt(this->m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    curl_share_setopt(this->m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+}
+
+/**
+ * Destructor. No request can be running.
+ */
+HttpClient::~HttpClient()
+{
+    for (auto handle : this->m_idle_handles) {
+        curl_easy_cleanup(handle);
+    }
+
+    curl_share_cleanup(this->m_share);
+    curl_global_cleanup();
+}
+
+/**
+ * Gets the client shared by the application.
+ * @return The default client.
+ */
+HttpClient &HttpClient::get_default()
+{
+    static HttpClient client;
+
+    return client;
+}
+
+/**
+ * Downloads a URL. GET responses are revalidated against the cache.
+ * @param token Cancellation token. Cancelling it aborts the transfer.
+ * @param url URL.
+ * @param post_fields POST request data. If it is empty a GET request is done.
+ * @return Response. It throws std::runtime_error on transfer errors.
+ */
+HttpResponse HttpClient::fetch(const CancellationToken &token, const std::string &url, const std::string &post_fields)
+{
+    HttpResponse response;
+    std::vector<std::string> headers;
+    std::shared_ptr<const std::string> cached_body;
+    std::string etag, last_modified;
+
+    if (post_fields.empty()) {
+        std::lock_guard<std::mutex> lock(this->m_cache_mutex);
+        auto iter = this->m_cache.find(url);
+
+        if (iter != this->m_cache.end()) {
+            auto &entry = iter->second;
+
+            if (!entry.etag.empty()) {
+                headers.push_back("If-None-Match: " + entry.etag);
+            }
+
+            if (!entry.last_modified.empty()) {
+                headers.push_back("If-Modified-Since: " + entry.last_modified);
+            }
+
+            // Only the reference is taken, the body is copied on a 304.
+            cached_body = entry.body;
+            this->m_cache_lru.splice(this->m_cache_lru.begin(), this->m_cache_lru, entry.lru);
+        }
+    }
+
+    response.status = this->perform(token, url, post_fields, headers, [&response](const char *data, std::size_t size) {
+        response.body.append(data, size);
+    }, [&etag, &last_modified](const std::string &name, const std::string &value) {
+        if (name.empty()) {
+            etag.clear();
+            last_modified.clear();
+        } else if (name == "etag") {
+            etag = value;
+        } else if (name == "last-modified") {
+            last_modified = value;
+        }
+    });
+
+    if (cached_body && response.status == 304) {
+        s_not_modified.add(1);
+        LOG_DEBUG(LogCategory::NETWORK, "%1 not modified", url);
+        response.status     = 200;
+        response.body       = *cached_body;
+        response.from_cache = true;
+    } else if (post_fields.empty()) {
+        s_cache_misses.add(1);
+
+        if (response.status == 200 && (!etag.empty() || !last_modified.empty())) {
+            this->store(url, etag, last_modified, response.body);
+        }
+    }
+
+    return response;
+}
+
+/**
+ * Downloads a URL, passing the response body to a function as it arrives.
+ * The responses are not cached.
+ * @param token Cancellation token. Cancelling it aborts the transfer.
+ * @param url URL.
+ * @param post_fields POST request data. If it is empty a GET request is done.
+ * @param on_data Function called with each received piece of the body, from
+ * the calling thread.
+ * @return HTTP status code. It throws std::runtime_error on transfer errors.
+ */
+long HttpClient::fetch_stream(const CancellationToken &token, const std::string &url, const std::string &post_fields,
+                              const std::function<void(const char*, std::size_t)> &on_data)
+{
+    return this->perform(token, url, post_fields, std::vector<std::string>(), on_data, nullptr);
+}
+
+/**
+ * Runs a batch of requests concurrently on the calling thread with a libcurl
+ * multi handle. The responses are not cached. At most max_transfers requests
+ * run at once, sharing the client connections, and new requests are started
+ * at most max_rate times per second. Cancelling the token aborts the running
+ * transfers within HTTP_POLL_INTERVAL milliseconds and skips the rest.
+ * @param token Cancellation token.
+ * @param requests Requests.
+ * @param max_transfers Maximum number of simultaneous transfers, at least 1.
+ * @param max_rate Maximum number of requests started per second, 0 for no
+ * limit.
+ * @param on_response Function called, from the calling thread and in
+ * completion order, with the index of each finished request and its
+ * response. Failed transfers have their error set instead of throwing.
+ */
+void HttpClient::fetch_all(const CancellationToken &token, const std::vector<HttpRequest> &requests, unsigned max_transfers, double max_rate,
+                           const std::function<void(std::size_t, HttpResponse&)> &on_response)
+{
+    /**
+     * Request being transferred.
+     */
+    struct Active
+    {
+        /**
+         * Constructor.
+         * @param index Index of the request.
+         * @param token Cancellation token.
+         */
+        Active(std::size_t index, const CancellationToken &token) :
+            index(index), transfer{token, on_data, on_header, nullptr}
+        {
+            this->on_data = [this](const char *data, std::size_t size) {
+                this->response.body.append(data, size);
+            };
+        }
+
+        std::size_t index;                                                     ///< Index of the request.
+        HttpResponse response;                                                 ///< Response received so far.
+        std::function<void(const char*, std::size_t)> on_data;                 ///< Appends to the response body.
+        std::function<void(const std::string&, const std::string&)> on_header; ///< Unused, no headers are needed.
+        Transfer transfer;                                                     ///< State of the libcurl callbacks.
+        CURL *handle = nullptr;                                                ///< Easy handle.
+    };
+
+    typedef std::chrono::steady_clock Clock;
+
+    auto multi = curl_multi_init();
+    std::list<Active> active;
+    std::size_t next = 0;
+    auto interval = max_rate > 0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1 / max_rate)) : Clock::duration::zero();
+    auto next_start = Clock::now();
+    // Removes a transfer from the multi handle and keeps its easy handle.
+    auto finish = [this, multi](std::list<Active>::iterator iter) {
+        long connections = 0;
+
+        curl_easy_getinfo(iter->handle, CURLINFO_NUM_CONNECTS, &connections);
+        curl_multi_remove_handle(multi, iter->handle);
+        this->release_handle(iter->handle);
+        s_requests.add(1);
+        s_connections.add(connections);
+    };
+
+    if (multi == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    max_transfers = std::max(max_transfers, 1u);
+    curl_multi_setopt(multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(max_transfers));
+
+    try {
+        while ((next < requests.size() || !active.empty()) && !token.is_cancelled()) {
+            auto now = Clock::now();
+            int running = 0, queued = 0, timeout = HTTP_POLL_INTERVAL;
+            CURLMsg *message;
+
+            while (next < requests.size() && active.size() < max_transfers && now >= next_start) {
+                auto &request = requests[next];
+                auto &item = active.emplace_back(next++, token);
+
+                item.handle = this->prepare(&item.transfer, request.url, request.post_fields, nullptr);
+                curl_multi_add_handle(multi, item.handle);
+                next_start = std::max(next_start, now) + interval;
+            }
+
+            curl_multi_perform(multi, &running);
+
+            while ((message = curl_multi_info_read(multi, &queued)) != nullptr) {
+                if (message->msg != CURLMSG_DONE) {
+                    continue;
+                }
+
+                auto iter = std::find_if(active.begin(), active.end(), [message](const Active &item) { return item.handle == message->easy_handle; });
+                auto index = iter->index;
+                auto response = std::move(iter->response);
+
+                curl_easy_getinfo(iter->handle, CURLINFO_RESPONSE_CODE, &response.status);
+
+                if (iter->transfer.exception) {
+                    std::rethrow_exception(iter->transfer.exception);
+                }
+
+                if (message->data.result != CURLE_OK) {
+                    response.error = curl_easy_strerror(message->data.result);
+                    LOG_WARNING(LogCategory::NETWORK, "%1: %2", requests[index].url, response.error);
+                } else if (response.status >= 400) {
+                    LOG_WARNING(LogCategory::NETWORK, "%1 returned HTTP status %2", requests[index].url, response.status);
+                }
+
+                finish(iter);
+                active.erase(iter);
+                on_response(index, response);
+            }
+
+            if (next < requests.size() && active.size() < max_transfers) {
+                auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(next_start - Clock::now()).count();
+
+                timeout = static_cast<int>(std::clamp<long long>(wait, 0, timeout));
+            }
+
+            curl_multi_poll(multi, nullptr, 0, timeout, nullptr);
+        }
+    } catch (...) {
+        for (auto iter = active.begin(); iter != active.end(); ++iter) {
+            finish(iter);
+        }
+
+        curl_multi_cleanup(multi);
+        throw;
+    }
+
+    for (auto iter = active.begin(); iter != active.end(); ++iter) {
+        finish(iter);
+    }
+
+    curl_multi_cleanup(multi);
+}
+
+/**
+ * Removes every cached response.
+ */
+void HttpClient::clear_cache()
+{
+    std::lock_guard<std::mutex> lock(this->m_cache_mutex);
+
+    this->m_cache.clear();
+    this->m_cache_lru.clear();
+    this->m_cache_size = 0;
+}
+
+} // Tools
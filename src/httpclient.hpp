@@ -0,0 +1,117 @@
+/**
+ * @file
+ * HttpClient class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef HTTPCLIENT_HPP
+#define HTTPCLIENT_HPP
+
+#include "taskgroup.hpp"
+#include <curl/curl.h>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#define HTTP_CONNECT_TIMEOUT 15                ///< Connection timeout in seconds.
+#define HTTP_CACHE_MAX_SIZE  (8 * 1024 * 1024) ///< Size budget of the cached response bodies in bytes.
+#define HTTP_POLL_INTERVAL   100               ///< Maximum wait in milliseconds between cancellation checks of fetch_all().
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Request of an HttpClient::fetch_all() batch.
+ */
+struct HttpRequest
+{
+    std::string url,         ///< URL.
+                post_fields; ///< POST request data. If it is empty a GET request is done.
+};
+
+/**
+ * Response of an HttpClient request.
+ */
+struct HttpResponse
+{
+    long status = 0;         ///< HTTP status code. 200 for the responses taken from the cache.
+    std::string body;        ///< Decoded response body.
+    bool from_cache = false; ///< Whether the server answered 304 Not Modified and the body was cached.
+    std::string error;       ///< Transfer error of a fetch_all() request, empty if it succeeded.
+};
+
+/**
+ * Long lived HTTP client shared by the whole application.
+ * The requests share a libcurl DNS, TLS session and connection cache and
+ * reuse their easy handles, so consecutive requests to the same site skip
+ * the name resolution and the TCP and TLS handshakes. Compressed responses
+ * are requested and decoded transparently and TCP keep-alive is enabled.
+ * The bodies of successful GET responses are cached with their ETag and
+ * Last-Modified headers and revalidated with conditional requests, so
+ * unchanged pages are not downloaded again.
+ * Batches of requests can be run concurrently with fetch_all(), which limits
+ * the number of simultaneous transfers and the rate they are started at.
+ * The methods block and can be called from several pool threads at once.
+ */
+class HttpClient final
+{
+private:
+    /**
+     * Cached GET response.
+     */
+    struct CacheEntry
+    {
+        std::string etag,                        ///< ETag header, empty if there was none.
+                    last_modified;               ///< Last-Modified header, empty if there was none.
+        std::shared_ptr<const std::string> body; ///< Response body, shared with the requests revalidating it.
+        std::list<std::string>::iterator lru;    ///< Position in m_cache_lru.
+    };
+
+    CURLSH *m_share = nullptr;                           ///< DNS, TLS session and connection cache.
+    std::mutex m_share_mutexes[CURL_LOCK_DATA_LAST];     ///< Protect the shared data, one per kind.
+    std::mutex m_handles_mutex;                          ///< Protects m_idle_handles.
+    std::vector<CURL*> m_idle_handles;                   ///< Easy handles ready for the next request.
+    std::mutex m_cache_mutex;                            ///< Protects the response cache.
+    std::unordered_map<std::string, CacheEntry> m_cache; ///< Cached responses by URL.
+    std::list<std::string> m_cache_lru;                  ///< Cached URLs, most recently used first.
+    std::size_t m_cache_size = 0;                        ///< Size of the cached bodies in bytes.
+
+    static void lock_share(CURL *handle, curl_lock_data data, curl_lock_access access, void *user_data);
+    static void unlock_share(CURL *handle, curl_lock_data data, void *user_data);
+
+    CURL *acquire_handle();
+    void release_handle(CURL *handle);
+    CURL *prepare(void *transfer, const std::string &url, const std::string &post_fields, struct curl_slist *header_list);
+    long perform(const CancellationToken &token, const std::string &url, const std::string &post_fields,
+                 const std::vector<std::string> &headers, const std::function<void(const char*, std::size_t)> &on_data,
+                 const std::function<void(const std::string&, const std::string&)> &on_header);
+    void store(const std::string &url, const std::string &etag, const std::string &last_modified, const std::string &body);
+
+public:
+    HttpClient();
+    HttpClient(const HttpClient&) = delete;
+    HttpClient &operator=(const HttpClient&) = delete;
+    ~HttpClient();
+
+    static HttpClient &get_default();
+
+    HttpResponse fetch(const CancellationToken &token, const std::string &url, const std::string &post_fields = std::string());
+    long fetch_stream(const CancellationToken &token, const std::string &url, const std::string &post_fields,
+                      const std::function<void(const char*, std::size_t)> &on_data);
+    void fetch_all(const CancellationToken &token, const std::vector<HttpRequest> &requests, unsigned max_transfers, double max_rate,
+                   const std::function<void(std::size_t, HttpResponse&)> &on_response);
+    void clear_cache();
+};
+
+} // Tools
+
+#endif // HTTPCLIENT_HPP
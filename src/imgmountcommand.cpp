@@ -7,9 +7,9 @@
  */
 
 #include "imgmountcommand.h"
+#include "log.hpp"
 #include <glibmm/regex.h>
 #include <glibmm/stringutils.h>
-#include <iostream>
 
 /**
  * DOSBoxGTK namespace.
@@ -49,7 +49,7 @@ ImgmountCommand::ImgmountCommand(char letter, const std::vector<Glib::ustring> &
  */
 bool ImgmountCommand::parse(const Glib::ustring &imgmount_command)
 {
-    auto imgmount_regex = Glib::Regex::create(PCRE_IMGMOUNT_COMMAND, Glib::REGEX_CASELESS);
+    static auto imgmount_regex = Glib::Regex::create(PCRE_IMGMOUNT_COMMAND, Glib::REGEX_CASELESS);
     Glib::MatchInfo minfo;
     bool valid_command = imgmount_regex->match(imgmount_command, 0, minfo);
 
@@ -58,11 +58,16 @@ bool ImgmountCommand::parse(const Glib::ustring &imgmount_command)
 
     if (valid_command) {
         do {
-            auto file_system = minfo.fetch_named("file_system"),
-                 image_type  = minfo.fetch_named("image_type"),
-                 dq_image    = minfo.fetch_named("dq_image"),
-                 sq_image    = minfo.fetch_named("sq_image"),
-                 image       = minfo.fetch_named("image");
+            auto drive_letter = minfo.fetch_named("drive_letter").uppercase(),
+                 file_system  = minfo.fetch_named("file_system"),
+                 image_type   = minfo.fetch_named("image_type"),
+                 dq_image     = minfo.fetch_named("dq_image"),
+                 sq_image     = minfo.fetch_named("sq_image"),
+                 image        = minfo.fetch_named("image");
+
+            if (!drive_letter.empty()) {
+                this->m_drive_letter = drive_letter.c_str()[0];
+            }
 
             if (!image_type.empty()) {
                 this->m_image_type = image_type;
@@ -80,7 +85,7 @@ bool ImgmountCommand::parse(const Glib::ustring &imgmount_command)
         } while (minfo.next());
     }
 
-    valid_command = this->m_images.size() > 0;
+    valid_command = this->m_images.size() > 0 && this->m_drive_letter != '\0';
 
     if (!valid_command) {
         this->clear();
@@ -107,10 +112,9 @@ Glib::ustring ImgmountCommand::get_command() const
     Glib::ustring command;
 
     if (this->m_images.size() > 0 && this->m_drive_letter != '\0') {
-        auto has_spaces_regex  = Glib::Regex::create("\\s");
+        static auto has_spaces_regex = Glib::Regex::create("\\s");
 
         command = "IMGMOUNT.COM " + Glib::ustring(1, this->m_drive_letter).uppercase();
-        std::cout << command << std::endl;
 
         if (!this->m_image_type.empty()) {
             command += Glib::ustring::compose(" -t %1", this->m_image_type);
@@ -124,6 +128,8 @@ Glib::ustring ImgmountCommand::get_command() const
 
             command += Glib::ustring::compose(" %1%2%1", quote, image);
         }
+
+        LOG_TRACE(Tools::LogCategory::MOUNT, "Generated command: %1", command);
     }
 
     return command;
@@ -11,7 +11,7 @@
 
 #include "mountcommandbase.h"
 
-#define PCRE_IMGMOUNT_COMMAND "^(?'command'IMGMOUNT)(?:\\.COM){0,1}\\s+|(?:-t\\s+(?'image_type'[^\\s]+))|(?:-fs\\s+(?'file_system'[^\\s]+))|\"(?'dq_image'[^\"]+)\"|'(?'sq_image'[^']+)'|(?'image'[^\\s]+)" ///< PCRE for the IMGMOUNT DOSBox command.
+#define PCRE_IMGMOUNT_COMMAND "^(?'command'IMGMOUNT)(?:\\.COM){0,1}\\s+(?'drive_letter'[A-Y])(?=\\s|$)|(?:-t\\s+(?'image_type'[^\\s]+))|(?:-fs\\s+(?'file_system'[^\\s]+))|\"(?'dq_image'[^\"]+)\"|'(?'sq_image'[^']+)'|(?'image'[^\\s]+)" ///< PCRE for the IMGMOUNT DOSBox command.
 
 /**
  * DOSBoxGTK namespace.
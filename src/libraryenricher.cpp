@@ -0,0 +1,322 @@
+/**
+ * @file
+ * LibraryEnricher class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "libraryenricher.h"
+#include "httpclient.hpp"
+#include "allocaccounting.hpp"
+#include "log.hpp"
+#include "metrics.hpp"
+#include "titlematcher.h"
+#include "trace.hpp"
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+static auto &s_enriched = Tools::Metrics::get_counter("dosboxgtk_enriched_profiles_total", "Profiles completed with game information sites data."); ///< Enriched profiles counter.
+
+/**
+ * Constructor.
+ * @param library Library to be enriched.
+ */
+LibraryEnricher::LibraryEnricher(ProfileLibrary &library) :
+    m_library(library)
+{
+    this->m_main_loop.signal_drained().connect(sigc::mem_fun(*this, &LibraryEnricher::on_results_drained));
+}
+
+/**
+ * Destructor. Stops the running enrichment.
+ */
+LibraryEnricher::~LibraryEnricher()
+{
+    this->cancel();
+}
+
+/**
+ * Searches for the profiles and downloads the pages of the accepted games.
+ * Run by a worker thread.
+ * @param token Cancellation token of the run.
+ * @param profiles Profiles to be enriched.
+ * @param max_transfers Maximum number of simultaneous requests.
+ * @param max_rate Maximum number of requests started per second.
+ */
+void LibraryEnricher::run(const Tools::CancellationToken &token, std::vector<ProfilePtr> profiles, unsigned max_transfers, double max_rate)
+{
+    TRACE_SCOPE("LibraryEnricher::run");
+    ALLOC_SCOPE(Tools::AllocTag::NETWORK);
+    auto &client = Tools::HttpClient::get_default();
+    std::vector<Tools::HttpRequest> searches, pages;
+    std::vector<ProfilePtr> accepted;
+    std::vector<std::pair<Glib::ustring, GameInfo>> infos;
+    unsigned not_found = 0;
+
+    for (auto &profile : profiles) {
+        searches.push_back(Tools::HttpRequest{MOBYGAMES_URL "/search/quick", MobyGamesScraper::get_search_fields(profile->title)});
+    }
+
+    client.fetch_all(token, searches, max_transfers, max_rate, [&](std::size_t index, Tools::HttpResponse &response) {
+        auto &profile = profiles[index];
+        auto results = response.error.empty() ? MobyGamesScraper::parse_search_results(response.body) : std::vector<GameSearchResult>();
+        auto matches = get_matches(*profile, results);
+
+        if (matches.size() == 1) {
+            accepted.push_back(profile);
+            pages.push_back(Tools::HttpRequest{MOBYGAMES_URL + matches.front().href.raw(), std::string()});
+
+            return;
+        }
+
+        if (results.empty()) {
+            ++not_found;
+        } else {
+            EnrichmentReview review{profile->id, profile->title, matches.empty() ? results : matches};
+
+            if (review.candidates.size() > ENRICH_MAX_CANDIDATES) {
+                review.candidates.resize(ENRICH_MAX_CANDIDATES);
+            }
+
+            this->m_main_loop.post(std::bind(&LibraryEnricher::on_review_needed, this, std::move(review)));
+        }
+
+        this->m_main_loop.post(std::bind(&LibraryEnricher::on_resolved, this));
+    });
+
+    client.fetch_all(token, pages, max_transfers, max_rate, [&](std::size_t index, Tools::HttpResponse &response) {
+        if (response.error.empty() && response.status == 200) {
+            infos.emplace_back(accepted[index]->id, MobyGamesScraper::parse_game_page(response.body));
+        } else {
+            ++not_found;
+        }
+
+        this->m_main_loop.post(std::bind(&LibraryEnricher::on_resolved, this));
+    });
+
+    // The run may have been cancelled while downloading.
+    if (!token.is_cancelled()) {
+        this->m_main_loop.post(std::bind(&LibraryEnricher::on_enriched, this, std::move(infos), not_found));
+    }
+}
+
+/**
+ * Counts a profile as resolved on the main loop.
+ */
+void LibraryEnricher::on_resolved()
+{
+    ++this->m_done;
+}
+
+/**
+ * Delivers a profile to be reviewed on the main loop.
+ * @param review Profile and its candidates.
+ */
+void LibraryEnricher::on_review_needed(const EnrichmentReview &review)
+{
+    this->m_signal_review_needed.emit(review);
+}
+
+/**
+ * Writes the downloaded information to the library in a single update and
+ * saves it. Only the fields still empty are filled, so profiles edited
+ * meanwhile keep the user's changes.
+ * @param infos Game information by profile ID.
+ * @param not_found Number of profiles not found or whose requests failed.
+ */
+void LibraryEnricher::on_enriched(const std::vector<std::pair<Glib::ustring, GameInfo>> &infos, unsigned not_found)
+{
+    unsigned enriched = 0;
+
+    this->m_library.update([&infos, &enriched](const ProfileSnapshotPtr &snapshot) {
+        std::vector<ProfilePtr> profiles;
+
+        for (auto &info : infos) {
+            auto profile = snapshot->find(info.first);
+
+            if (profile && (profile = fill_missing(profile, info.second))) {
+                profiles.push_back(profile);
+            }
+        }
+
+        enriched = profiles.size();
+
+        return profiles.empty() ? snapshot : snapshot->with_profiles(profiles);
+    });
+
+    if (enriched > 0) {
+        this->m_library.save_async();
+    }
+
+    s_enriched.add(enriched);
+    LOG_INFO(Tools::LogCategory::NETWORK, "Library enrichment finished: %1 profiles completed, %2 not found", enriched, not_found);
+    this->m_total = 0;
+    this->m_signal_finished.emit(enriched, not_found);
+}
+
+/**
+ * Reports the progress once per batch of delivered results.
+ */
+void LibraryEnricher::on_results_drained()
+{
+    if (this->m_total > 0) {
+        this->m_signal_progress.emit(this->m_done, this->m_total);
+    }
+}
+
+/**
+ * Checks whether a profile lacks any of the information the enrichment
+ * looks for. Profiles without a title can not be searched for.
+ * @param profile Profile.
+ * @return @c TRUE if the profile has a title and lacks some information or
+ * @c FALSE otherwise.
+ */
+bool LibraryEnricher::needs_metadata(const Profile &profile)
+{
+    return !profile.title.empty() && (profile.developer.empty() || profile.publisher.empty() || profile.year.empty() || profile.genre.empty());
+}
+
+/**
+ * Gets the search results whose title matches the title of a profile once
+ * both are normalized by TitleMatcher, so roman numerals, entities and
+ * punctuation do not matter. Fuzzy matches are not taken, as sequels would
+ * match each other. If there are several and the profile has a year, the
+ * ones released that year are preferred.
+ * @param profile Profile.
+ * @param results Search results.
+ * @return Matching results. A single one is a high confidence match.
+ */
+std::vector<GameSearchResult> LibraryEnricher::get_matches(const Profile &profile, const std::vector<GameSearchResult> &results)
+{
+    auto title = TitleMatcher::normalize(profile.title);
+    std::vector<GameSearchResult> matches, same_year;
+
+    for (auto &result : results) {
+        if (TitleMatcher::normalize(result.title) == title) {
+            matches.push_back(result);
+
+            if (result.year == profile.year) {
+                same_year.push_back(result);
+            }
+        }
+    }
+
+    return matches.size() > 1 && !same_year.empty() ? same_year : matches;
+}
+
+/**
+ * Fills the empty developer, publisher, year and genre of a profile.
+ * @param profile Profile.
+ * @param info Game information.
+ * @return A changed copy of the profile or @c nullptr if no field was
+ * filled.
+ */
+ProfilePtr LibraryEnricher::fill_missing(const ProfilePtr &profile, const GameInfo &info)
+{
+    auto updated = *profile;
+    bool changed = false;
+    auto fill = [&changed](Glib::ustring &field, const Glib::ustring &value) {
+        if (field.empty() && !value.empty()) {
+            field   = value;
+            changed = true;
+        }
+    };
+
+    fill(updated.developer, info.developer);
+    fill(updated.publisher, info.publisher);
+    fill(updated.year, info.year);
+    fill(updated.genre, info.genre);
+
+    return changed ? std::make_shared<const Profile>(std::move(updated)) : nullptr;
+}
+
+/**
+ * Starts enriching every profile missing information, cancelling any
+ * running enrichment.
+ * @param max_transfers Maximum number of simultaneous requests.
+ * @param max_rate Maximum number of requests started per second, 0 for no
+ * limit.
+ */
+void LibraryEnricher::start(unsigned max_transfers, double max_rate)
+{
+    std::vector<ProfilePtr> profiles;
+
+    this->cancel();
+    this->m_library.get_snapshot()->for_each([&profiles](const ProfilePtr &profile) {
+        if (needs_metadata(*profile)) {
+            profiles.push_back(profile);
+        }
+    });
+
+    this->m_done  = 0;
+    this->m_total = profiles.size();
+
+    if (profiles.empty()) {
+        this->m_signal_finished.emit(0, 0);
+
+        return;
+    }
+
+    LOG_INFO(Tools::LogCategory::NETWORK, "Enriching %1 profiles, %2 requests at once, %3 per second", profiles.size(), max_transfers, max_rate);
+    this->m_tasks.push(std::bind(&LibraryEnricher::run, this, std::placeholders::_1, std::move(profiles), max_transfers, max_rate));
+}
+
+/**
+ * Cancels the running enrichment, if any, and discards its pending results.
+ * Nothing is written to the library.
+ */
+void LibraryEnricher::cancel()
+{
+    // Once the task is stopped no more results can be posted, so the
+    // pending ones are the last of the cancelled run.
+    this->m_tasks.cancel();
+    this->m_main_loop.clear();
+    this->m_total = 0;
+}
+
+/**
+ * Checks whether an enrichment is running.
+ * @return @c TRUE if there are profiles pending to be resolved.
+ */
+bool LibraryEnricher::is_running() const
+{
+    return this->m_total > 0;
+}
+
+/**
+ * Signal emitted on the main loop for each profile whose game must be chosen
+ * by the user.
+ * @return The signal.
+ */
+LibraryEnricher::type_signal_review_needed LibraryEnricher::signal_review_needed()
+{
+    return this->m_signal_review_needed;
+}
+
+/**
+ * Signal emitted on the main loop with the number of resolved profiles and
+ * the total number of profiles of the running enrichment.
+ * @return The signal.
+ */
+LibraryEnricher::type_signal_progress LibraryEnricher::signal_progress()
+{
+    return this->m_signal_progress;
+}
+
+/**
+ * Signal emitted on the main loop when the enrichment ends, with the number
+ * of profiles completed and the number of profiles not found or whose
+ * requests failed.
+ * @return The signal.
+ */
+LibraryEnricher::type_signal_finished LibraryEnricher::signal_finished()
+{
+    return this->m_signal_finished;
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,98 @@
+/**
+ * @file
+ * LibraryEnricher class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef LIBRARYENRICHER_H
+#define LIBRARYENRICHER_H
+
+#define ENRICH_DEFAULT_MAX_TRANSFERS 4   ///< Default maximum number of simultaneous requests.
+#define ENRICH_DEFAULT_MAX_RATE      2.0 ///< Default maximum number of requests started per second.
+#define ENRICH_MAX_CANDIDATES        10  ///< Maximum number of candidates offered for review.
+
+#include "metadataprovider.h"
+#include "profilelibrary.h"
+#include "mainloopdispatcher.hpp"
+#include "taskgroup.hpp"
+#include <utility>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Profile whose search returned several possible games, or none with its
+ * exact title, to be chosen by the user.
+ */
+struct EnrichmentReview
+{
+    Glib::ustring id,                         ///< Profile ID.
+                  title;                      ///< Profile game title.
+    std::vector<GameSearchResult> candidates; ///< Possible games, best first.
+};
+
+/**
+ * Fills the missing developer, publisher, year and genre of the library
+ * profiles with MobyGames data, in background.
+ * Every profile missing any of them is searched for. The searches run
+ * concurrently in a single pool task through HttpClient::fetch_all(), with
+ * a cap on simultaneous requests and on the request rate so the site is not
+ * flooded. A profile whose title matches a single search result is accepted
+ * and its game page downloaded, the rest are reported through
+ * signal_review_needed() for the user to choose. The accepted data only
+ * fills empty fields and is written to the library in a single update and
+ * saved once at the end.
+ * Results are delivered on the main loop. Instances must be created and
+ * used from the main thread.
+ */
+class LibraryEnricher final
+{
+public:
+    typedef sigc::signal<void, const EnrichmentReview&> type_signal_review_needed;
+    typedef sigc::signal<void, unsigned, unsigned> type_signal_progress;
+    typedef sigc::signal<void, unsigned, unsigned> type_signal_finished;
+
+private:
+    ProfileLibrary &m_library;              ///< Library being enriched.
+    Tools::MainLoopDispatcher m_main_loop;  ///< Delivers the results on the main loop.
+    Tools::TaskGroup m_tasks;               ///< Task of the current run.
+    unsigned m_done  = 0,                   ///< Profiles resolved in the current run.
+             m_total = 0;                   ///< Profiles to resolve in the current run.
+    type_signal_review_needed m_signal_review_needed;
+    type_signal_progress m_signal_progress;
+    type_signal_finished m_signal_finished;
+
+    void run(const Tools::CancellationToken &token, std::vector<ProfilePtr> profiles, unsigned max_transfers, double max_rate);
+    void on_resolved();
+    void on_review_needed(const EnrichmentReview &review);
+    void on_enriched(const std::vector<std::pair<Glib::ustring, GameInfo>> &infos, unsigned not_found);
+    void on_results_drained();
+
+public:
+    explicit LibraryEnricher(ProfileLibrary &library);
+    ~LibraryEnricher();
+
+    LibraryEnricher(const LibraryEnricher&) = delete;
+    LibraryEnricher &operator=(const LibraryEnricher&) = delete;
+
+    static bool needs_metadata(const Profile &profile);
+    static std::vector<GameSearchResult> get_matches(const Profile &profile, const std::vector<GameSearchResult> &results);
+    static ProfilePtr fill_missing(const ProfilePtr &profile, const GameInfo &info);
+
+    void start(unsigned max_transfers, double max_rate);
+    void cancel();
+    bool is_running() const;
+    type_signal_review_needed signal_review_needed();
+    type_signal_progress signal_progress();
+    type_signal_finished signal_finished();
+};
+
+} // DOSBoxGTK
+
+#endif // LIBRARYENRICHER_H
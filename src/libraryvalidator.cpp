@@ -0,0 +1,167 @@
+/**
+ * @file
+ * LibraryValidator class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "libraryvalidator.h"
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Constructor.
+ */
+LibraryValidator::LibraryValidator()
+{
+    this->m_main_loop.signal_drained().connect(sigc::mem_fun(*this, &LibraryValidator::on_results_drained));
+}
+
+/**
+ * Destructor. Stops the running validation.
+ */
+LibraryValidator::~LibraryValidator()
+{
+    this->cancel();
+}
+
+/**
+ * Validates a profile. Run by the worker threads.
+ * @param token Cancellation token of the run.
+ * @param id Profile ID.
+ */
+void LibraryValidator::run(const Tools::CancellationToken &token, Glib::ustring id)
+{
+    ProfileSettings settings;
+    auto issues = this->m_validator->validate(id, &settings);
+
+    // The run may have been cancelled while validating.
+    if (!token.is_cancelled()) {
+        this->m_main_loop.post(std::bind(&LibraryValidator::on_validated, this, id, std::move(issues), std::move(settings)));
+    }
+}
+
+/**
+ * Delivers a profile validation result on the main loop.
+ * @param id Profile ID.
+ * @param issues Issues found.
+ * @param settings Emulation settings read from the config file.
+ */
+void LibraryValidator::on_validated(const Glib::ustring &id, const std::vector<ProfileIssue> &issues, const ProfileSettings &settings)
+{
+    ++this->m_done;
+    this->m_signal_profile_settings.emit(id, settings);
+    this->m_signal_profile_validated.emit(id, issues);
+}
+
+/**
+ * Reports the progress once per batch of delivered results.
+ */
+void LibraryValidator::on_results_drained()
+{
+    if (this->m_total == 0) {
+        return;
+    }
+
+    this->m_signal_progress.emit(this->m_done, this->m_total);
+
+    if (this->m_done == this->m_total) {
+        this->m_total = 0;
+        this->m_signal_finished.emit();
+    }
+}
+
+/**
+ * Starts validating the given profiles, cancelling any running validation.
+ * @param profiles_path Directory containing the profiles config files.
+ * @param ids IDs of the profiles to validate.
+ */
+void LibraryValidator::start(const Glib::ustring &profiles_path, const std::vector<Glib::ustring> &ids)
+{
+    this->cancel();
+
+    if (!this->m_validator || this->m_profiles_path != profiles_path) {
+        this->m_validator.reset(new ProfileValidator(profiles_path));
+        this->m_profiles_path = profiles_path;
+    }
+
+    this->m_validator->begin_pass();
+    this->m_done  = 0;
+    this->m_total = ids.size();
+
+    if (ids.empty()) {
+        this->m_signal_finished.emit();
+
+        return;
+    }
+
+    for (auto id : ids) {
+        this->m_tasks.push(std::bind(&LibraryValidator::run, this, std::placeholders::_1, id));
+    }
+}
+
+/**
+ * Cancels the running validation, if any, and discards its pending results.
+ */
+void LibraryValidator::cancel()
+{
+    // Once the tasks are stopped no more results can be posted, so the
+    // pending ones are the last of the cancelled run.
+    this->m_tasks.cancel();
+    this->m_main_loop.clear();
+    this->m_total = 0;
+}
+
+/**
+ * Checks whether a validation is running.
+ * @return @c TRUE if there are profiles pending to be validated.
+ */
+bool LibraryValidator::is_running() const
+{
+    return this->m_total > 0;
+}
+
+/**
+ * Signal emitted on the main loop every time a profile has been validated.
+ * @return The signal.
+ */
+LibraryValidator::type_signal_profile_validated LibraryValidator::signal_profile_validated()
+{
+    return this->m_signal_profile_validated;
+}
+
+/**
+ * Signal emitted on the main loop every time the config file of a profile
+ * has been read, before signal_profile_validated().
+ * @return The signal.
+ */
+LibraryValidator::type_signal_profile_settings LibraryValidator::signal_profile_settings()
+{
+    return this->m_signal_profile_settings;
+}
+
+/**
+ * Signal emitted on the main loop with the number of validated profiles and
+ * the total number of profiles of the running validation.
+ * @return The signal.
+ */
+LibraryValidator::type_signal_progress LibraryValidator::signal_progress()
+{
+    return this->m_signal_progress;
+}
+
+/**
+ * Signal emitted on the main loop when every profile has been validated.
+ * @return The signal.
+ */
+LibraryValidator::type_signal_finished LibraryValidator::signal_finished()
+{
+    return this->m_signal_finished;
+}
+
+} // DOSBoxGTK
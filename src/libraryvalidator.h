@@ -0,0 +1,73 @@
+/**
+ * @file
+ * LibraryValidator class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef LIBRARYVALIDATOR_H
+#define LIBRARYVALIDATOR_H
+
+#include "profilevalidator.h"
+#include "mainloopdispatcher.hpp"
+#include "taskgroup.hpp"
+#include <memory>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Validates every game profile of the library using the shared thread pool.
+ * Results are delivered on the main loop through signal_profile_validated(),
+ * signal_progress() and signal_finished(). The emulation settings read from
+ * each config file are delivered too, through signal_profile_settings(), so
+ * other indexes do not have to read the config files again.
+ * The same ProfileValidator is kept between runs over the same profiles
+ * directory, so validating the library again only parses the config files
+ * that have changed.
+ * Instances must be created and used from the main thread.
+ */
+class LibraryValidator final
+{
+public:
+    typedef sigc::signal<void, const Glib::ustring&, const std::vector<ProfileIssue>&> type_signal_profile_validated;
+    typedef sigc::signal<void, const Glib::ustring&, const ProfileSettings&> type_signal_profile_settings;
+    typedef sigc::signal<void, unsigned, unsigned> type_signal_progress;
+    typedef sigc::signal<void> type_signal_finished;
+
+private:
+    std::unique_ptr<ProfileValidator> m_validator;  ///< Validator shared by the tasks.
+    Glib::ustring m_profiles_path;                  ///< Profiles directory of the current validator.
+    Tools::MainLoopDispatcher m_main_loop;          ///< Delivers the results on the main loop.
+    Tools::TaskGroup m_tasks;                       ///< Validation tasks of the current run.
+    unsigned m_done  = 0,                           ///< Profiles validated in the current run.
+             m_total = 0;                           ///< Profiles to validate in the current run.
+    type_signal_profile_validated m_signal_profile_validated;
+    type_signal_profile_settings m_signal_profile_settings;
+    type_signal_progress m_signal_progress;
+    type_signal_finished m_signal_finished;
+
+    void run(const Tools::CancellationToken &token, Glib::ustring id);
+    void on_validated(const Glib::ustring &id, const std::vector<ProfileIssue> &issues, const ProfileSettings &settings);
+    void on_results_drained();
+
+public:
+    LibraryValidator();
+    ~LibraryValidator();
+
+    void start(const Glib::ustring &profiles_path, const std::vector<Glib::ustring> &ids);
+    void cancel();
+    bool is_running() const;
+    type_signal_profile_validated signal_profile_validated();
+    type_signal_profile_settings signal_profile_settings();
+    type_signal_progress signal_progress();
+    type_signal_finished signal_finished();
+};
+
+} // DOSBoxGTK
+
+#endif // LIBRARYVALIDATOR_H
@@ -0,0 +1,329 @@
+/**
+ * @file
+ * Log class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "log.hpp"
+#include <glib.h>
+#include <chrono>
+#include <ctime>
+#include <sstream>
+
+/**
+ * Level enabled by default for every category.
+ */
+#ifdef RELEASE
+#   define LOG_DEFAULT_LEVEL static_cast<int>(LogLevel::WARNING)
+#else
+#   define LOG_DEFAULT_LEVEL static_cast<int>(LogLevel::VERBOSE)
+#endif // RELEASE
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+static_assert(static_cast<int>(LogCategory::COUNT) == 7, "Update Log::s_levels and get_category_name() with the new category.");
+
+std::atomic<int> Log::s_levels[static_cast<int>(LogCategory::COUNT)] = {
+    {LOG_DEFAULT_LEVEL}, {LOG_DEFAULT_LEVEL}, {LOG_DEFAULT_LEVEL}, {LOG_DEFAULT_LEVEL},
+    {LOG_DEFAULT_LEVEL}, {LOG_DEFAULT_LEVEL}, {LOG_DEFAULT_LEVEL}
+};
+
+/**
+ * Constructor.
+ * @param stream Output stream.
+ * @param owned If @c TRUE the stream is closed when the sink is destroyed.
+ */
+StreamLogSink::StreamLogSink(std::FILE *stream, bool owned) :
+    m_stream(stream), m_owned(owned)
+{}
+
+/**
+ * Destructor.
+ */
+StreamLogSink::~StreamLogSink()
+{
+    if (this->m_owned && this->m_stream != nullptr) {
+        std::fclose(this->m_stream);
+    }
+}
+
+/**
+ * Writes a batch of formatted log lines.
+ * @param lines Lines, each one ending with a new line character.
+ */
+void StreamLogSink::write(const std::string &lines)
+{
+    std::fwrite(lines.data(), 1, lines.size(), this->m_stream);
+}
+
+/**
+ * Flushes the written lines.
+ */
+void StreamLogSink::flush()
+{
+    std::fflush(this->m_stream);
+}
+
+/**
+ * Constructor. Starts the writer thread with a stderr sink.
+ */
+Log::Log()
+{
+    this->m_sinks.emplace_back(new StreamLogSink());
+    this->m_thread = std::thread(&Log::run, this);
+}
+
+/**
+ * Destructor. Writes the pending lines and stops the writer thread.
+ */
+Log::~Log()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+
+        this->m_stopping = true;
+    }
+
+    this->m_cv.notify_one();
+    this->m_thread.join();
+}
+
+/**
+ * Gets the logger instance, creating it the first time.
+ * @return The logger.
+ */
+Log &Log::get_instance()
+{
+    static Log instance;
+
+    return instance;
+}
+
+/**
+ * Writer thread body.
+ */
+void Log::run()
+{
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    std::vector<LogSink*> sinks;
+    std::string lines;
+
+    while (true) {
+        this->m_cv.wait(lock, [this] { return this->m_stopping || !this->m_buffer.empty(); });
+
+        lines.swap(this->m_buffer);
+        auto queued = this->m_queued;
+        auto stopping = this->m_stopping;
+
+        // The sinks are only touched by this thread, but add_sink() may add
+        // one while they are written, so they are taken from a copy.
+        sinks.clear();
+
+        for (auto &sink : this->m_sinks) {
+            sinks.push_back(sink.get());
+        }
+
+        lock.unlock();
+
+        for (auto sink : sinks) {
+            sink->write(lines);
+            sink->flush();
+        }
+
+        lines.clear();
+        lock.lock();
+        this->m_written = queued;
+        this->m_written_cv.notify_all();
+
+        if (stopping) {
+            break;
+        }
+    }
+}
+
+/**
+ * Gets the name of a level.
+ * @param level Log level.
+ * @return Level name.
+ */
+const char *Log::get_level_name(LogLevel level)
+{
+    static const char *names[] = {"trace", "debug", "info", "warning", "error", "none"};
+
+    return names[static_cast<int>(level)];
+}
+
+/**
+ * Gets the name of a category.
+ * @param category Log category.
+ * @return Category name.
+ */
+const char *Log::get_category_name(LogCategory category)
+{
+    static const char *names[] = {"general", "config", "autoexec", "mount", "network", "ui", "validator"};
+
+    return names[static_cast<int>(category)];
+}
+
+/**
+ * Configures the enabled levels from a string like the one read from the
+ * LOG_ENV_VAR environment variable. It is a comma separated list of levels,
+ * either alone to set the level of every category or as category=level:
+ * @code
+ * DOSBOXGTK_LOG=info,mount=trace,network=debug
+ * @endcode
+ * Unknown categories and levels are ignored. Levels below LOG_COMPILED_LEVEL
+ * are accepted but their messages are not in the binary.
+ * @param spec Levels specification.
+ */
+void Log::configure(const std::string &spec)
+{
+    std::istringstream stream(spec);
+    std::string item;
+
+    while (std::getline(stream, item, ',')) {
+        auto equal_pos = item.find('=');
+        auto category_name = equal_pos == std::string::npos ? std::string() : item.substr(0, equal_pos),
+             level_name    = item.substr(equal_pos == std::string::npos ? 0 : equal_pos + 1);
+        int level = -1;
+
+        for (int l = 0; l <= static_cast<int>(LogLevel::NONE); ++l) {
+            if (g_ascii_strcasecmp(level_name.c_str(), Log::get_level_name(static_cast<LogLevel>(l))) == 0) {
+                level = l;
+            }
+        }
+
+        if (level < 0) {
+            continue;
+        }
+
+        if (category_name.empty()) {
+            Log::set_level(static_cast<LogLevel>(level));
+        }
+
+        for (int c = 0; c < static_cast<int>(LogCategory::COUNT); ++c) {
+            if (g_ascii_strcasecmp(category_name.c_str(), Log::get_category_name(static_cast<LogCategory>(c))) == 0) {
+                Log::set_level(static_cast<LogCategory>(c), static_cast<LogLevel>(level));
+            }
+        }
+    }
+}
+
+/**
+ * Sets the enabled level of every category.
+ * @param level Lowest level written.
+ */
+void Log::set_level(LogLevel level)
+{
+    for (auto &category_level : Log::s_levels) {
+        category_level = static_cast<int>(level);
+    }
+}
+
+/**
+ * Sets the enabled level of a category.
+ * @param category Log category.
+ * @param level Lowest level written.
+ */
+void Log::set_level(LogCategory category, LogLevel level)
+{
+    Log::s_levels[static_cast<int>(category)] = static_cast<int>(level);
+}
+
+/**
+ * Adds a destination for the log messages.
+ * @param sink Log sink.
+ */
+void Log::add_sink(std::unique_ptr<LogSink> sink)
+{
+    auto &log = Log::get_instance();
+    std::lock_guard<std::mutex> lock(log.m_mutex);
+
+    log.m_sinks.push_back(std::move(sink));
+}
+
+/**
+ * Blocks until every line queued before the call has been written to the
+ * sinks and flushed.
+ */
+void Log::flush()
+{
+    auto &log = Log::get_instance();
+    std::unique_lock<std::mutex> lock(log.m_mutex);
+    auto queued = log.m_queued;
+
+    log.m_written_cv.wait(lock, [&log, queued] { return log.m_written >= queued; });
+}
+
+/**
+ * Queues a message for writing. Use the LOG_* macros instead, so the message
+ * is not formatted when it is not going to be written.
+ * Lines are written in logfmt style:
+ * @code
+ * time=12:34:56.789 level=debug category=mount msg="IMGMOUNT.COM D game.cue"
+ * @endcode
+ * @param level Message level.
+ * @param category Message category.
+ * @param message Message text.
+ */
+void Log::write(LogLevel level, LogCategory category, const Glib::ustring &message)
+{
+    auto now = std::chrono::system_clock::now();
+    auto time = std::chrono::system_clock::to_time_t(now);
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+    std::tm local_time;
+    char time_str[16];
+    std::string line;
+
+    localtime_r(&time, &local_time);
+    std::strftime(time_str, sizeof(time_str), "%H:%M:%S", &local_time);
+
+    line.reserve(message.bytes() + 64);
+    line += "time=";
+    line += time_str;
+    line += '.';
+    line += static_cast<char>('0' + millis / 100);
+    line += static_cast<char>('0' + millis / 10 % 10);
+    line += static_cast<char>('0' + millis % 10);
+    line += " level=";
+    line += Log::get_level_name(level);
+    line += " category=";
+    line += Log::get_category_name(category);
+    line += " msg=\"";
+
+    for (auto c : message.raw()) {
+        if (c == '"' || c == '\\') {
+            line += '\\';
+            line += c;
+        } else if (c == '\n') {
+            line += "\\n";
+        } else {
+            line += c;
+        }
+    }
+
+    line += "\"\n";
+
+    auto &log = Log::get_instance();
+    bool was_empty;
+
+    {
+        std::lock_guard<std::mutex> lock(log.m_mutex);
+
+        was_empty = log.m_buffer.empty();
+        log.m_buffer += line;
+        ++log.m_queued;
+    }
+
+    if (was_empty) {
+        log.m_cv.notify_one();
+    }
+}
+
+} // Tools
@@ -0,0 +1,195 @@
+/**
+ * @file
+ * Log class declaration and logging macros.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef LOG_HPP
+#define LOG_HPP
+
+#include "config.h"
+#include <glibmm/ustring.h>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * Lowest level compiled into the binary. Messages below it are removed by the
+ * preprocessor, so they have no cost at all. Release builds keep INFO and up.
+ */
+#ifndef LOG_COMPILED_LEVEL
+#   ifdef RELEASE
+#       define LOG_COMPILED_LEVEL 2
+#   else
+#       define LOG_COMPILED_LEVEL 0
+#   endif // RELEASE
+#endif // LOG_COMPILED_LEVEL
+
+#define LOG_ENV_VAR "DOSBOXGTK_LOG"           ///< Environment variable with the logging configuration.
+#define LOG_FILE_ENV_VAR "DOSBOXGTK_LOG_FILE" ///< Environment variable with a file to copy the log to.
+
+/**
+ * Writes a message if its level and category are enabled. The message is
+ * only formatted when it is going to be written.
+ * @param level Tools::LogLevel value.
+ * @param category Tools::LogCategory value.
+ * @param ... Glib::ustring::compose() format and arguments.
+ */
+#define LOG_WRITE(level, category, ...)                                                 \
+    do {                                                                                \
+        if (Tools::Log::is_enabled(level, category)) {                                  \
+            Tools::Log::write(level, category, Glib::ustring::compose(__VA_ARGS__));    \
+        }                                                                               \
+    } while (false)
+
+#if LOG_COMPILED_LEVEL <= 0
+#   define LOG_TRACE(category, ...) LOG_WRITE(Tools::LogLevel::TRACE, category, __VA_ARGS__)
+#else
+#   define LOG_TRACE(category, ...) do {} while (false)
+#endif
+
+#if LOG_COMPILED_LEVEL <= 1
+#   define LOG_DEBUG(category, ...) LOG_WRITE(Tools::LogLevel::VERBOSE, category, __VA_ARGS__)
+#else
+#   define LOG_DEBUG(category, ...) do {} while (false)
+#endif
+
+#define LOG_INFO(category, ...)    LOG_WRITE(Tools::LogLevel::INFO, category, __VA_ARGS__)
+#define LOG_WARNING(category, ...) LOG_WRITE(Tools::LogLevel::WARNING, category, __VA_ARGS__)
+#define LOG_ERROR(category, ...)   LOG_WRITE(Tools::LogLevel::ERROR, category, __VA_ARGS__)
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Severity of a log message.
+ */
+enum class LogLevel
+{
+    TRACE,   ///< Very detailed execution tracing.
+    VERBOSE, ///< Debugging information.
+    INFO,    ///< Normal but significant events.
+    WARNING, ///< Recoverable problems.
+    ERROR,   ///< Failed operations.
+    NONE     ///< Disables the messages of a category.
+};
+
+/**
+ * Subsystem a log message comes from. Each category has its own level.
+ */
+enum class LogCategory
+{
+    GENERAL,   ///< Application startup and anything else.
+    CONFIG,    ///< Config files and settings.
+    AUTOEXEC,  ///< Autoexec parsing and generation.
+    MOUNT,     ///< MOUNT and IMGMOUNT commands.
+    NETWORK,   ///< Game information downloads.
+    UI,        ///< Windows and dialogs.
+    VALIDATOR, ///< Profile validation.
+    COUNT      ///< Number of categories, not a real category.
+};
+
+/**
+ * Destination of the log messages. Sinks are only used from the logging
+ * thread, so they do not need to be thread safe.
+ */
+class LogSink
+{
+public:
+    virtual ~LogSink() {}
+
+    /**
+     * Writes a batch of formatted log lines.
+     * @param lines Lines, each one ending with a new line character.
+     */
+    virtual void write(const std::string &lines) = 0;
+
+    /**
+     * Flushes the written lines.
+     */
+    virtual void flush() = 0;
+};
+
+/**
+ * Sink writing to a C stream, stderr by default.
+ */
+class StreamLogSink final : public LogSink
+{
+private:
+    std::FILE *m_stream; ///< Output stream.
+    bool m_owned;        ///< Whether the stream must be closed.
+
+public:
+    StreamLogSink(std::FILE *stream = stderr, bool owned = false);
+    ~StreamLogSink();
+
+    void write(const std::string &lines) override;
+    void flush() override;
+};
+
+/**
+ * Asynchronous logger. Messages are formatted on the calling thread and
+ * appended to a buffer. A background thread writes the buffer to the sinks in
+ * batches, so logging never blocks on a slow terminal or pipe.
+ */
+class Log final
+{
+private:
+    static std::atomic<int> s_levels[static_cast<int>(LogCategory::COUNT)]; ///< Enabled level of each category.
+
+    std::vector<std::unique_ptr<LogSink>> m_sinks; ///< Log destinations.
+    std::string m_buffer;                          ///< Lines waiting to be written.
+    std::mutex m_mutex;                            ///< Protects every other member but m_thread.
+    std::condition_variable m_cv;                  ///< Signaled when there are lines to write.
+    std::condition_variable m_written_cv;          ///< Signaled when a batch has been written.
+    std::thread m_thread;                          ///< Writer thread.
+    uint64_t m_queued  = 0,                        ///< Lines queued so far.
+             m_written = 0;                        ///< Lines written and flushed to the sinks so far.
+    bool m_stopping = false;                       ///< Set to stop the writer thread.
+
+    Log();
+    ~Log();
+
+    static Log &get_instance();
+    void run();
+
+public:
+    Log(const Log&) = delete;
+    Log &operator=(const Log&) = delete;
+
+    static const char *get_level_name(LogLevel level);
+    static const char *get_category_name(LogCategory category);
+    static void configure(const std::string &spec);
+    static void set_level(LogLevel level);
+    static void set_level(LogCategory category, LogLevel level);
+    static void add_sink(std::unique_ptr<LogSink> sink);
+    static void flush();
+
+    /**
+     * Checks whether messages of the given level and category are written.
+     * @param level Message level.
+     * @param category Message category.
+     * @return @c TRUE if the message would be written or @c FALSE otherwise.
+     */
+    static inline bool is_enabled(LogLevel level, LogCategory category)
+    {
+        return static_cast<int>(level) >= s_levels[static_cast<int>(category)].load(std::memory_order_relaxed);
+    }
+
+    static void write(LogLevel level, LogCategory category, const Glib::ustring &message);
+};
+
+} // Tools
+
+#endif // LOG_HPP
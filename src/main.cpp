@@ -9,11 +9,20 @@
 #include "config.h"
 #include "preferencesdialog.h"
 #include "mainwindow.h"
+#include "log.hpp"
+#include "metrics.hpp"
+#include "trace.hpp"
+#include "watchdog.hpp"
+#include "allocaccounting.hpp"
+#include "uibench.h"
 #include <glibmm/i18n.h>
 #include <glibmm/miscutils.h>
 #include <glibmm/stringutils.h>
 #include <gtkmm/application.h>
 #include <gtkmm/messagedialog.h>
+#include <curlpp/cURLpp.hpp>
+#include <cstdio>
+#include <cstdlib>
 #include <locale>
 
 /**
@@ -28,6 +37,7 @@ namespace DOSBoxGTK
  */
 bool check_settings()
 {
+    TRACE_SCOPE("check_settings");
     auto settings = Gio::Settings::create(APP_ID, APP_PATH);
 
     auto dosbox_path    = settings->get_string("dosbox-path"),
@@ -50,6 +60,7 @@ bool check_settings()
  */
 void force_setup()
 {
+    TRACE_SCOPE("force_setup");
     if (!check_settings()) {
         auto message = Glib::ustring::compose(_("%1 settings are not correctly configured.\n\n"
                                                 "This usually happens the first time it is run.\n"
@@ -61,7 +72,7 @@ void force_setup()
         msg_dialog.run();
         msg_dialog.hide();
         auto resource_path = Glib::ustring::compose("%1gui/preferencesdialog.glade", APP_PATH);
-        auto builder = Gtk::Builder::create_from_resource(resource_path);
+        auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
         PreferencesDialog *dialog = nullptr;
 
         builder->get_widget_derived("PreferencesDialog", dialog);
@@ -97,15 +108,96 @@ int main(int argc, char** argv)
 #ifdef DEBUG
     Glib::setenv("GSETTINGS_SCHEMA_DIR", "./schemas", true);
 #endif // DEBUG
-    Glib::RefPtr<Gtk::Application> app = Gtk::Application::create(argc, argv, APP_ID);
-    Glib::set_application_name(PROJECT_NAME);
+    Tools::Log::configure(Glib::getenv(LOG_ENV_VAR));
 
-    DOSBoxGTK::force_setup();
+    auto log_filename = Glib::getenv(LOG_FILE_ENV_VAR);
+
+    if (!log_filename.empty()) {
+        auto log_file = std::fopen(log_filename.c_str(), "a");
+
+        if (log_file != nullptr) {
+            Tools::Log::add_sink(std::unique_ptr<Tools::LogSink>(new Tools::StreamLogSink(log_file, true)));
+        } else {
+            LOG_WARNING(Tools::LogCategory::GENERAL, "Can not open log file %1", log_filename);
+        }
+    }
+
+    // Chrome trace of the startup and dialog flows.
+    auto trace_filename = Tools::Trace::parse_options(argc, argv);
+
+    if (trace_filename.empty()) {
+        trace_filename = Glib::getenv(TRACE_ENV_VAR);
+    }
+
+    if (!trace_filename.empty()) {
+        Tools::Trace::start(trace_filename);
+    }
+
+    // Scripted UI latency benchmark, see bench/ui-bench.sh.
+    auto ui_bench_filename = DOSBoxGTK::UiBench::parse_options(argc, argv);
+
+    // Initialized once here, libcurl global initialization is not thread safe.
+    curlpp::Cleanup curl_cleanup;
+    Glib::RefPtr<Gtk::Application> app;
+    Glib::RefPtr<Gtk::Builder> builder;
+    std::unique_ptr<Tools::Watchdog> watchdog;
+    std::unique_ptr<DOSBoxGTK::UiBench> ui_bench;
     DOSBoxGTK::MainWindow *main_window = nullptr;
+    auto metrics_filename = Glib::getenv(METRICS_FILE_ENV_VAR);
+
+    {
+        TRACE_SCOPE("main");
+        app = Gtk::Application::create(argc, argv, APP_ID);
+        Glib::set_application_name(PROJECT_NAME);
+
+        // Main loop stall detection. Enabled unless the threshold is 0.
+        auto stall_threshold = Glib::getenv(WATCHDOG_THRESHOLD_ENV_VAR),
+             stall_log       = Glib::getenv(WATCHDOG_LOG_ENV_VAR);
+        auto threshold = stall_threshold.empty() ? WATCHDOG_DEFAULT_THRESHOLD : std::atol(stall_threshold.c_str());
+
+        if (threshold > 0) {
+            watchdog.reset(new Tools::Watchdog(std::chrono::milliseconds(threshold),
+                                               stall_log.empty() ? Tools::Watchdog::get_default_log_filename() : stall_log));
+        }
 
-    Glib::ustring mainwindow_resource_path = Glib::build_filename(APP_PATH, "gui/mainwindow.glade");
-    auto builder = Gtk::Builder::create_from_resource(mainwindow_resource_path);
-    builder->get_widget_derived("MainWindow", main_window);
+        // Prometheus textfile for the node exporter.
+        if (!metrics_filename.empty()) {
+            auto interval = Glib::getenv(METRICS_INTERVAL_ENV_VAR);
+
+            Tools::Metrics::start_textfile_export(metrics_filename, interval.empty() ? METRICS_DEFAULT_INTERVAL : std::atol(interval.c_str()));
+        }
+
+        DOSBoxGTK::force_setup();
+
+        Glib::ustring mainwindow_resource_path = Glib::build_filename(APP_PATH, "gui/mainwindow.glade");
+        builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(mainwindow_resource_path));
+        builder->get_widget_derived("MainWindow", main_window);
+
+        if (!ui_bench_filename.empty()) {
+            ui_bench.reset(new DOSBoxGTK::UiBench(*main_window, builder, ui_bench_filename));
+        }
+    }
+
+    if (ui_bench) {
+        ui_bench->start();
+    }
+
+    Tools::AllocAccounting::mark_steady_state();
+    LOG_INFO(Tools::LogCategory::GENERAL, "%1 started", PROJECT_NAME);
+    auto status = app->run(*main_window);
+    Tools::Trace::stop();
+
+    if (!metrics_filename.empty()) {
+        Tools::Metrics::write_textfile(metrics_filename);
+    }
+
+    Tools::Log::flush();
+
+    // Written as is after the log, which escapes the line breaks and may
+    // leave out the INFO messages.
+    if (Tools::AllocAccounting::is_enabled()) {
+        std::fprintf(stderr, "Allocations by subsystem:\n%s", Tools::AllocAccounting::report().c_str());
+    }
 
-    return app->run(*main_window);
+    return status;
 }
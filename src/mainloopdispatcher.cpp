@@ -0,0 +1,86 @@
+/**
+ * @file
+ * MainLoopDispatcher class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "mainloopdispatcher.hpp"
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Constructor.
+ */
+MainLoopDispatcher::MainLoopDispatcher() :
+    m_scheduled(false)
+{
+    this->m_dispatcher.connect(sigc::mem_fun(*this, &MainLoopDispatcher::on_dispatched));
+}
+
+/**
+ * Runs the pending callbacks on the main loop.
+ */
+void MainLoopDispatcher::on_dispatched()
+{
+    Callback callback;
+    bool ran = false;
+
+    while (this->m_pending.pop(callback)) {
+        callback();
+        ran = true;
+    }
+
+    // A callback may have been posted after the last pop() but seen the main
+    // loop still woken up, so the queue is checked again after unscheduling.
+    this->m_scheduled = false;
+
+    if (!this->m_pending.empty() && !this->m_scheduled.exchange(true)) {
+        this->m_dispatcher.emit();
+    }
+
+    if (ran) {
+        this->m_signal_drained.emit();
+    }
+}
+
+/**
+ * Queues a callback to be run on the main loop. It can be called from any
+ * thread.
+ * @param callback Callback to be run.
+ */
+void MainLoopDispatcher::post(Callback callback)
+{
+    // Pushed before waking up the main loop, as MpscQueue requires.
+    this->m_pending.push(std::move(callback));
+
+    if (!this->m_scheduled.exchange(true)) {
+        this->m_dispatcher.emit();
+    }
+}
+
+/**
+ * Discards the callbacks not run yet. Main thread only.
+ */
+void MainLoopDispatcher::clear()
+{
+    Callback callback;
+
+    while (this->m_pending.pop(callback)) {}
+}
+
+/**
+ * Signal emitted on the main loop after running a batch of callbacks.
+ * @return The signal.
+ */
+MainLoopDispatcher::type_signal_drained MainLoopDispatcher::signal_drained()
+{
+    return this->m_signal_drained;
+}
+
+} // Tools
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * MainLoopDispatcher class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef MAINLOOPDISPATCHER_HPP
+#define MAINLOOPDISPATCHER_HPP
+
+#include "mpscqueue.hpp"
+#include <glibmm/dispatcher.h>
+#include <atomic>
+#include <functional>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Runs callbacks posted from any thread on the main loop.
+ * Callbacks are passed through a lock-free queue, so the worker threads
+ * posting their results never wait for each other or for the main loop.
+ * They are run in batches: only the first callback posted after a batch
+ * wakes up the main loop, and every callback queued until then is run in the
+ * same main loop iteration. signal_drained() is emitted after each batch so
+ * the owner can update the UI once instead of once per callback.
+ * Instances must be created and destroyed on the main thread.
+ */
+class MainLoopDispatcher final
+{
+public:
+    typedef std::function<void()> Callback;
+    typedef sigc::signal<void> type_signal_drained;
+
+private:
+    MpscQueue<Callback> m_pending;    ///< Callbacks not run yet.
+    std::atomic<bool> m_scheduled;    ///< Whether the main loop has been woken up.
+    Glib::Dispatcher m_dispatcher;    ///< Wakes up the main loop.
+    type_signal_drained m_signal_drained;
+
+    void on_dispatched();
+
+public:
+    MainLoopDispatcher();
+
+    void post(Callback callback);
+    void clear();
+    type_signal_drained signal_drained();
+};
+
+} // Tools
+
+#endif // MAINLOOPDISPATCHER_HPP
@@ -10,14 +10,27 @@
 #include "config.h"
 #include "preferencesdialog.h"
 #include "editprofiledialog.h"
+#include "verifylibrarydialog.h"
+#include "enrichlibrarydialog.h"
+#include "metadataimporter.h"
+#include "metadataindex.h"
+#include "performancedialog.h"
 #include "resourcemanager.hpp"
+#include "trace.hpp"
+#include "metrics.hpp"
+#include "allocaccounting.hpp"
 #include <glibmm/i18n.h>
+#include <glibmm/markup.h>
 #include <glibmm/miscutils.h>
 #include <glibmm/spawn.h>
 #include <gtkmm/toolbar.h>
 #include <gtkmm/aboutdialog.h>
+#include <gtkmm/filechooserdialog.h>
+#include <gtkmm/messagedialog.h>
 #include <gtkmm/liststore.h>
 #include <gtkmm/icontheme.h>
+#include <algorithm>
+#include <unordered_set>
 
 /**
  * DOSBoxGTK namespace.
@@ -25,6 +38,9 @@
 namespace DOSBoxGTK
 {
 
+static auto &s_launches       = Tools::Metrics::get_counter("dosboxgtk_launches_total", "DOSBox launches, including setup programs.");       ///< Launches counter.
+static auto &s_launch_latency = Tools::Metrics::get_histogram("dosboxgtk_launch_seconds", "Time from the launch request until DOSBox is spawned."); ///< Launch latency histogram.
+
 /**
  * Creates an empty profiles XML file if there is none.
  */
@@ -34,34 +50,164 @@ void MainWindow::create_profiles_file()
 
     if (!this->m_profiles_file->query_exists()) {
         profiles_ls->clear();
-        this->m_parser.get_document()->create_root_node("profiles");
-        this->m_parser.get_document()->write_to_file_formatted(this->m_profiles_file->get_path(), "UTF-8");
+        this->m_library.load(this->m_profiles_file->get_path());
+        this->m_search_index.sync(this->m_library.get_snapshot());
+        this->m_facet_index.sync(this->m_library.get_snapshot());
     }
 }
 
 /**
- * Loads the profiles into the TreeView from the profiles XML file.
+ * Loads the profiles into the TreeView from the profile library.
  */
 void MainWindow::load_profiles()
 {
-    this->m_parser.parse_file(this->m_profiles_file->get_path());
-
-    auto root_element = this->m_parser.get_document()->get_root_node();
+    TRACE_SCOPE("MainWindow::load_profiles");
+    ALLOC_SCOPE(Tools::AllocTag::UI);
+    auto snapshot = this->m_library.get_snapshot();
     auto profiles_ls = Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_profiles_tv->get_model());
 
+    std::vector<Glib::ustring> ids;
+
     // Clear the profiles.
+    this->m_library_validator.cancel();
+    this->m_view_updater->clear();
+    this->m_profile_rows.clear();
+    this->m_profile_issues.clear();
     profiles_ls->clear();
 
-    // Load the profiles
-    for (xmlpp::Node *child : root_element->get_children("profile")) {
-        auto element = static_cast<xmlpp::Element*>(child);
-        auto id = element->get_attribute_value("id");
-        auto title_element = static_cast<xmlpp::Element*>(*child->get_children("title").begin());
-        auto title = title_element->get_child_text()->get_content();
+    snapshot->for_each([&ids](const ProfilePtr &profile) {
+        ids.push_back(profile->id);
+    });
+
+    // The config file facets are filled in by the validator.
+    this->m_facet_index.sync(snapshot);
+
+    // Load the profiles matching the search and the filters.
+    this->show_profiles();
+
+    // Look for broken profiles without blocking the UI.
+    this->m_library_validator.start(this->m_settings->get_string("profiles-path"), ids);
+}
+
+/**
+ * Shows in the TreeView the profiles matching the search entry text, or
+ * every profile if there is none, and the filters of the facets box. Only
+ * the rows of the profiles not shown any more are removed, unless they are
+ * most of the rows. The rows are appended in batches, frame by frame, with
+ * the status found by the validator. The facet counts are updated to the
+ * search results.
+ */
+void MainWindow::show_profiles()
+{
+    TRACE_SCOPE("MainWindow::show_profiles");
+    ALLOC_SCOPE(Tools::AllocTag::UI);
+    auto profiles_ls = Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_profiles_tv->get_model());
+    auto query = this->m_profiles_search_entry->get_text();
+    auto &filter = this->m_facets_box->get_filter();
+    auto pending = !this->m_view_updater->is_idle();
+    std::vector<ProfilePtr> profiles;
+    std::unordered_set<std::string> shown;
+    Tools::RoaringBitmap scope;
+
+    if (query.empty()) {
+        profiles = this->m_library.get_snapshot()->get_profiles();
+    } else {
+        profiles = this->m_search_index.search(query);
+        scope = this->m_facet_index.get_documents(profiles);
+    }
+
+    if (!filter.is_empty()) {
+        auto docs = this->m_facet_index.evaluate(filter, query.empty() ? nullptr : &scope);
+
+        profiles.erase(std::remove_if(profiles.begin(), profiles.end(), [this, &docs](const ProfilePtr &profile) {
+            return !this->m_facet_index.contains(docs, profile->id);
+        }), profiles.end());
+    }
+
+    this->m_facets_box->update_counts(this->m_facet_index, query.empty() ? nullptr : &scope);
+
+    for (auto &profile : profiles) {
+        shown.insert(profile->id.raw());
+    }
+
+    // The pending rows may not match any more, the missing ones are pushed
+    // again, and so is the status of the kept ones with issues.
+    this->m_view_updater->clear();
+
+    std::size_t kept = std::count_if(this->m_profile_rows.begin(), this->m_profile_rows.end(), [&shown](const auto &row) {
+        return shown.count(row.first.raw()) > 0;
+    });
+
+    if (this->m_profile_rows.size() - kept > kept) {
+        this->m_profile_rows.clear();
+        profiles_ls->clear();
+    } else {
+        for (auto row = this->m_profile_rows.begin(); row != this->m_profile_rows.end();) {
+            if (shown.count(row->first.raw()) == 0) {
+                profiles_ls->erase(row->second);
+                row = this->m_profile_rows.erase(row);
+            } else {
+                ++row;
+            }
+        }
+    }
 
-        auto iter = profiles_ls->append();
-        iter->set_value(0, title);
-        iter->set_value(1, id);
+    for (auto &profile : profiles) {
+        if (this->m_profile_rows.find(profile->id) == this->m_profile_rows.end()) {
+            auto issues = this->m_profile_issues.find(profile->id);
+            ProfileRowUpdate update;
+
+            if (issues != this->m_profile_issues.end()) {
+                update = issues->second;
+            }
+
+            update.id      = profile->id;
+            update.fields |= ProfileRowUpdate::TITLE;
+            update.title   = profile->title;
+            this->m_view_updater->push(std::move(update));
+        } else if (pending) {
+            auto issues = this->m_profile_issues.find(profile->id);
+
+            if (issues != this->m_profile_issues.end()) {
+                this->m_view_updater->push(issues->second);
+            }
+        }
+    }
+}
+
+/**
+ * Builds the search index of the whole library in the thread pool, and
+ * then updates it with the changes made meanwhile.
+ */
+Tools::AsyncTask MainWindow::build_search_index()
+{
+    auto snapshot = this->m_library.get_snapshot();
+
+    this->m_search_index = co_await Tools::run_in_pool(this->m_async_token, [snapshot] {
+        ProfileSearchIndex index;
+
+        index.sync(snapshot);
+
+        return index;
+    });
+
+    this->sync_search_index();
+}
+
+/**
+ * Indexes the profiles changed in the library by others, like the library
+ * enricher, and shows them if they match the search and the filters now.
+ * The facet counts are refreshed otherwise.
+ */
+void MainWindow::sync_search_index()
+{
+    this->m_search_index.sync(this->m_library.get_snapshot());
+    this->m_facet_index.sync(this->m_library.get_snapshot());
+
+    if (!this->m_profiles_search_entry->get_text().empty() || !this->m_facets_box->get_filter().is_empty()) {
+        this->show_profiles();
+    } else {
+        this->m_facets_box->update_counts(this->m_facet_index, nullptr);
     }
 }
 
@@ -87,39 +233,18 @@ std::vector<Glib::ustring> MainWindow::get_selected_ids() const
     return ids;
 }
 
-/**
- * Gets the profile XML element with the given ID.
- * @return Pointer to the requested xmlpp::Element.
- */
-xmlpp::Element *MainWindow::get_profile_element(const Glib::ustring &id) const
-{
-    auto root = this->m_parser.get_document()->get_root_node();
-    xmlpp::Element *element = nullptr;
-
-    for (auto child : root->get_children("profile")) {
-        auto child_element = static_cast<xmlpp::Element*>(child);
-
-        if (child_element->get_attribute_value("id") == id) {
-            element = child_element;
-        }
-    }
-
-    return element;
-}
-
 /**
  * Removes the profile with the given ID and it's associated files.
- * The changes will not take effect until the XML document is saved.
+ * The changes will not take effect until the library is saved.
  * @param id Profile ID.
  * @return @c TRUE if the profile gets succesfully removed or @c FALSE
  * otherwise.
  */
 bool MainWindow::remove_profile(const Glib::ustring &id)
 {
-    auto profile = this->get_profile_element(id);
+    auto profile = this->m_library.get_snapshot()->find(id);
 
-    if (profile != nullptr) {
-        auto root = this->m_parser.get_document()->get_root_node();
+    if (profile) {
         auto basedir = this->m_settings->get_string("profiles-path");
         auto config_filename = Glib::build_filename(basedir, Glib::ustring::compose("%1.conf", id)),
              setup_filename  = Glib::build_filename(basedir, Glib::ustring::compose("%1_setup.conf", id));
@@ -134,7 +259,10 @@ bool MainWindow::remove_profile(const Glib::ustring &id)
             setup_file->remove();
         }
 
-        root->remove_child(profile);
+        this->m_library.remove_profile(id);
+        this->m_search_index.remove(id);
+        this->m_facet_index.remove(id);
+        this->m_profile_issues.erase(id);
     }
 
     return profile != nullptr;
@@ -163,6 +291,36 @@ void MainWindow::on_profiles_tv_selection_changed()
     this->m_main_ag->get_action("Remove")->set_sensitive(selected_rows.size() > 0);
 }
 
+/**
+ * Filters the profiles TreeView as the user types in the search entry.
+ */
+void MainWindow::on_search_changed()
+{
+    this->show_profiles();
+}
+
+/**
+ * Refreshes the facets box with the profile settings read since the last
+ * refresh, and the profiles TreeView too if it is filtered.
+ * @return Always @c FALSE so the timeout is not run again.
+ */
+bool MainWindow::on_facets_refresh_timeout()
+{
+    auto query = this->m_profiles_search_entry->get_text();
+
+    if (!this->m_facets_box->get_filter().is_empty()) {
+        this->show_profiles();
+    } else if (query.empty()) {
+        this->m_facets_box->update_counts(this->m_facet_index, nullptr);
+    } else {
+        auto scope = this->m_facet_index.get_documents(this->m_search_index.search(query));
+
+        this->m_facets_box->update_counts(this->m_facet_index, &scope);
+    }
+
+    return false;
+}
+
 /**
  * Execute the the game which profile has been activated with DOSBox.
  * @param path The Gtk::TreePath for the activated row.
@@ -180,17 +338,22 @@ void MainWindow::on_row_activated(const Gtk::TreePath &path, Gtk::TreeViewColumn
 /**
  * Adds a new game profile to the list.
  */
-void MainWindow::on_new_activated()
+Tools::AsyncTask MainWindow::on_new_activated()
 {
     auto resource_path = Glib::ustring::compose("%1gui/editprofiledialog.glade", APP_PATH);
-    auto builder = Gtk::Builder::create_from_resource(resource_path);
-    EditProfileDialog *dialog = nullptr;
+    auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
+    EditProfileDialog *dialog_ptr = nullptr;
+
+    builder->get_widget_derived("EditProfileDialog", dialog_ptr);
+    std::unique_ptr<EditProfileDialog> dialog(dialog_ptr);
 
-    builder->get_widget_derived("EditProfileDialog", dialog);
     dialog->set_transient_for(*this);
+    dialog->set_modal();
+    dialog->set_library(this->m_library);
 
-    if (dialog->run() == Gtk::RESPONSE_ACCEPT) {
+    if (co_await Tools::dialog_response(this->m_async_token, *dialog) == Gtk::RESPONSE_ACCEPT) {
         dialog->save_profile();
+        this->m_search_index.update(this->m_library.get_snapshot()->find(dialog->get_profile_id()));
         this->load_profiles();
     }
 }
@@ -198,19 +361,23 @@ void MainWindow::on_new_activated()
 /**
  * Edits the currently selected game profile.
  */
-void MainWindow::on_edit_activated()
+Tools::AsyncTask MainWindow::on_edit_activated()
 {
     auto resource_path = Glib::ustring::compose("%1gui/editprofiledialog.glade", APP_PATH);
-    auto builder = Gtk::Builder::create_from_resource(resource_path);
-    EditProfileDialog *dialog = nullptr;
+    auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
+    EditProfileDialog *dialog_ptr = nullptr;
 
-    builder->get_widget_derived("EditProfileDialog", dialog);
-    dialog->set_transient_for(*this);
+    builder->get_widget_derived("EditProfileDialog", dialog_ptr);
+    std::unique_ptr<EditProfileDialog> dialog(dialog_ptr);
 
+    dialog->set_transient_for(*this);
+    dialog->set_modal();
+    dialog->set_library(this->m_library);
     dialog->load_profile(this->get_selected_ids()[0]);
 
-    if (dialog->run() == Gtk::RESPONSE_ACCEPT) {
+    if (co_await Tools::dialog_response(this->m_async_token, *dialog) == Gtk::RESPONSE_ACCEPT) {
         dialog->save_profile();
+        this->m_search_index.update(this->m_library.get_snapshot()->find(dialog->get_profile_id()));
         this->load_profiles();
     }
 }
@@ -235,9 +402,11 @@ void MainWindow::on_remove_activated()
         iter->get_value(1, id);
 
         this->remove_profile(id);
-        this->m_parser.get_document()->write_to_file_formatted(this->m_profiles_file->get_path());
+        this->m_profile_rows.erase(id);
         profiles_ls->erase(iter);
     }
+
+    this->m_library.save_async();
 }
 
 /**
@@ -245,6 +414,8 @@ void MainWindow::on_remove_activated()
  */
 void MainWindow::on_run_activated()
 {
+    TRACE_SCOPE("MainWindow::on_run_activated");
+    Tools::MetricsTimer timer(s_launch_latency);
     Glib::ustring  id               = this->get_selected_ids()[0],
                    basedir          = this->m_settings->get_string("profiles-path"),
                    basename         = Glib::ustring::compose("%1.conf", id),
@@ -253,6 +424,7 @@ void MainWindow::on_run_activated()
                    command          = Glib::ustring::compose("%1 -conf \"%2\"", dosbox_exec_path, config_file);
 
     Glib::spawn_command_line_async(command);
+    s_launches.add();
 }
 
 /**
@@ -260,6 +432,7 @@ void MainWindow::on_run_activated()
  */
 void MainWindow::on_setup_activated()
 {
+    Tools::MetricsTimer timer(s_launch_latency);
     Glib::ustring  id               = this->get_selected_ids()[0],
                    basedir          = this->m_settings->get_string("profiles-path"),
                    basename         = Glib::ustring::compose("%1_setup.conf", id),
@@ -268,6 +441,105 @@ void MainWindow::on_setup_activated()
                    command          = Glib::ustring::compose("%1 -conf \"%2\"", dosbox_exec_path, config_file);
 
     Glib::spawn_command_line_async(command);
+    s_launches.add();
+}
+
+/**
+ * Verify every game profile and show a report with the problems found.
+ */
+void MainWindow::on_verify_activated()
+{
+    auto resource_path = Glib::ustring::compose("%1gui/verifylibrarydialog.glade", APP_PATH);
+    auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
+    std::map<Glib::ustring, Glib::ustring> titles;
+    VerifyLibraryDialog *dialog = nullptr;
+
+    // The view may be filtered, so the titles are taken from the library.
+    this->m_library.get_snapshot()->for_each([&titles](const ProfilePtr &profile) {
+        titles[profile->id] = profile->title;
+    });
+
+    builder->get_widget_derived("VerifyLibraryDialog", dialog);
+    dialog->set_transient_for(*this);
+    dialog->verify(this->m_library_validator, this->m_settings->get_string("profiles-path"), titles);
+    dialog->run();
+
+    delete dialog;
+}
+
+/**
+ * Look up the missing metadata of every game profile and show the profiles
+ * whose game must be chosen.
+ */
+void MainWindow::on_enrich_activated()
+{
+    auto resource_path = Glib::ustring::compose("%1gui/enrichlibrarydialog.glade", APP_PATH);
+    auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
+    EnrichLibraryDialog *dialog = nullptr;
+
+    builder->get_widget_derived("EnrichLibraryDialog", dialog);
+    dialog->set_transient_for(*this);
+    dialog->signal_profile_applied().connect(sigc::mem_fun(*this, &MainWindow::sync_search_index));
+    dialog->enrich(this->m_library_enricher, this->m_library,
+                   this->m_settings->get_int("enrich-max-transfers"), this->m_settings->get_double("enrich-max-rate"));
+    dialog->run();
+
+    delete dialog;
+}
+
+/**
+ * Imports a game information dump chosen by the user into the offline
+ * database. The dump is read and indexed in the thread pool.
+ */
+Tools::AsyncTask MainWindow::on_import_activated()
+{
+    Gtk::FileChooserDialog dialog(*this, _("Select a game information dump..."), Gtk::FILE_CHOOSER_ACTION_OPEN);
+    auto dump_filter = Gtk::FileFilter::create(),
+         all_filter  = Gtk::FileFilter::create();
+
+    dump_filter->set_name(_("CSV, XML and JSON files"));
+    dump_filter->add_pattern("*.[cC][sS][vV]");
+    dump_filter->add_pattern("*.[xX][mM][lL]");
+    dump_filter->add_pattern("*.[jJ][sS][oO][nN]");
+
+    all_filter->set_name(_("All files"));
+    all_filter->add_pattern("*");
+
+    dialog.set_modal();
+    dialog.add_button(_("Cancel"), Gtk::RESPONSE_CANCEL);
+    dialog.add_button(_("Accept"), Gtk::RESPONSE_ACCEPT);
+    dialog.set_current_folder(Glib::get_home_dir());
+    dialog.add_filter(dump_filter);
+    dialog.add_filter(all_filter);
+
+    if (co_await Tools::dialog_response(this->m_async_token, dialog) != Gtk::RESPONSE_ACCEPT) {
+        co_return;
+    }
+
+    std::string filename = dialog.get_filename();
+    Glib::ustring message;
+    auto type = Gtk::MESSAGE_INFO;
+
+    dialog.hide();
+
+    try {
+        auto count = co_await Tools::run_in_pool(this->m_async_token, [filename] {
+            return MetadataImporter::import(filename, MetadataIndex::get_default_filename());
+        });
+
+        message = Glib::ustring::compose(_("%1 games imported. They will be looked up before searching on the Internet."), count);
+    } catch (const Glib::Exception &e) {
+        message = Glib::ustring::compose(_("The game information could not be imported:\n%1"), e.what());
+        type    = Gtk::MESSAGE_ERROR;
+    } catch (const std::exception &e) {
+        message = Glib::ustring::compose(_("The game information could not be imported:\n%1"), e.what());
+        type    = Gtk::MESSAGE_ERROR;
+    }
+
+    Gtk::MessageDialog msg_dialog(*this, message, false, type);
+
+    msg_dialog.set_modal();
+    co_await Tools::dialog_response(this->m_async_token, msg_dialog);
 }
 
 /**
@@ -276,7 +548,7 @@ void MainWindow::on_setup_activated()
 void MainWindow::on_preferences_activated()
 {
     auto resource_path = Glib::ustring::compose("%1gui/preferencesdialog.glade", APP_PATH);
-    auto builder = Gtk::Builder::create_from_resource(resource_path);
+    auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
     PreferencesDialog *dialog = nullptr;
 
     builder->get_widget_derived("PreferencesDialog", dialog);
@@ -315,6 +587,39 @@ void MainWindow::on_about_activated()
     dialog.run();
 }
 
+/**
+ * Show the hidden performance dialog with the application metrics.
+ */
+void MainWindow::on_performance_activated()
+{
+    auto resource_path = Glib::ustring::compose("%1gui/performancedialog.glade", APP_PATH);
+    auto builder = TRACE_CALL("Gtk::Builder::create_from_resource", Gtk::Builder::create_from_resource(resource_path));
+    PerformanceDialog *dialog = nullptr;
+
+    builder->get_widget_derived("PerformanceDialog", dialog);
+    dialog->set_transient_for(*this);
+    dialog->run();
+
+    delete dialog;
+}
+
+/**
+ * Opens the performance dialog on Ctrl+Shift+P. It has no menu entry.
+ * @param event Key event.
+ * @return @c TRUE if the event has been handled or @c FALSE otherwise.
+ */
+bool MainWindow::on_window_key_press(GdkEventKey *event)
+{
+    auto modifiers = event->state & gtk_accelerator_get_default_mod_mask();
+
+    if (modifiers == (GDK_CONTROL_MASK | GDK_SHIFT_MASK) && (event->keyval == GDK_KEY_P || event->keyval == GDK_KEY_p)) {
+        this->on_performance_activated();
+        return true;
+    }
+
+    return false;
+}
+
 /**
  * Quit the DOSBoxGTK.
  */
@@ -323,6 +628,53 @@ void MainWindow::on_quit_activated()
     this->get_application()->quit();
 }
 
+/**
+ * Flags the profiles with missing files in the profiles TreeView.
+ * @param id ID of the validated profile.
+ * @param issues Problems found in the profile.
+ */
+void MainWindow::on_profile_validated(const Glib::ustring &id, const std::vector<ProfileIssue> &issues)
+{
+    ProfileRowUpdate update;
+
+    update.id     = id;
+    update.fields = ProfileRowUpdate::STATUS;
+
+    for (auto &issue : issues) {
+        if (!update.tooltip.empty()) {
+            update.tooltip += "\n";
+        }
+
+        update.tooltip += Glib::Markup::escape_text(issue.describe());
+    }
+
+    if (!issues.empty()) {
+        update.icon_name = "dialog-warning";
+        this->m_profile_issues[id] = update;
+    } else {
+        this->m_profile_issues.erase(id);
+    }
+
+    this->m_view_updater->push(std::move(update));
+}
+
+/**
+ * Indexes the emulation settings of a validated profile for the facets box,
+ * which is refreshed after FACETS_REFRESH_DELAY milliseconds so a whole
+ * validation run does not refresh it for every profile.
+ * @param id ID of the validated profile.
+ * @param settings Settings read from the profile config file.
+ */
+void MainWindow::on_profile_settings(const Glib::ustring &id, const ProfileSettings &settings)
+{
+    this->m_facet_index.set_settings(id, settings);
+
+    if (!this->m_facets_refresh.connected()) {
+        this->m_facets_refresh = Glib::signal_timeout().connect(sigc::mem_fun(*this, &MainWindow::on_facets_refresh_timeout),
+                                                                FACETS_REFRESH_DELAY);
+    }
+}
+
 /**
  * Monitors changes in the profiles XML file.
  * @param file A file.
@@ -342,10 +694,14 @@ void MainWindow::on_profiles_file_changed(const Glib::RefPtr<Gio::File> &file, c
  * @param builder Gtk::Builder used to retrieve the child widgets.
  */
 MainWindow::MainWindow(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder) :
-    Gtk::ApplicationWindow(cobject)
+    Gtk::ApplicationWindow(cobject), m_library_enricher(m_library)
 {
+    TRACE_SCOPE("MainWindow::MainWindow");
     builder->set_translation_domain(PACKAGE);
     builder->get_widget("ProfilesTV", this->m_profiles_tv);
+    builder->get_widget("ProfilesSearchEntry", this->m_profiles_search_entry);
+    builder->get_widget_derived("ProfileFacetsBox", this->m_facets_box);
+    this->m_view_updater.reset(new ProfileViewUpdater(*this->m_profiles_tv, this->m_profile_rows));
 
     this->m_settings = Gio::Settings::create(APP_ID, APP_PATH);
     Tools::ResourceManager res_man(APP_PATH);
@@ -367,6 +723,9 @@ MainWindow::MainWindow(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder>
          remove_action      = this->m_main_ag->get_action("Remove"),
          run_action         = this->m_main_ag->get_action("Run"),
          setup_action       = this->m_main_ag->get_action("Setup"),
+         verify_action      = this->m_main_ag->get_action("Verify"),
+         enrich_action      = this->m_main_ag->get_action("Enrich"),
+         import_action      = this->m_main_ag->get_action("Import"),
          preferences_action = this->m_main_ag->get_action("Preferences"),
          about_action       = this->m_main_ag->get_action("About"),
          quit_action        = this->m_main_ag->get_action("Quit");
@@ -376,6 +735,9 @@ MainWindow::MainWindow(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder>
     remove_action->set_icon_name("dosboxgtk-remove");
     run_action->set_icon_name("dosboxgtk-run");
     setup_action->set_icon_name("dosboxgtk-run_setup");
+    verify_action->set_icon_name("system-search");
+    enrich_action->set_icon_name("network-workgroup");
+    import_action->set_icon_name("document-open");
     preferences_action->set_icon_name("dosboxgtk-preferences");
     about_action->set_icon_name("dosboxgtk-about");
     quit_action->set_icon_name("dosboxgtk-quit");
@@ -385,7 +747,7 @@ MainWindow::MainWindow(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder>
 
     this->set_title(Glib::ustring::compose("%1 v%2.%3.%4.%5", PROJECT_NAME, VERSION_MAJOR, VERSION_MINOR, VERSION_PATCH, VERSION_TWEAK));
 
-    this->create_profiles_file();
+    this->m_library.load(this->m_profiles_file->get_path());
 
     auto profiles_ls = Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_profiles_tv->get_model());
     profiles_ls->set_sort_column(0, Gtk::SORT_ASCENDING);
@@ -396,18 +758,46 @@ MainWindow::MainWindow(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder>
     // Signals
     this->m_profiles_tv->get_selection()->signal_changed().connect(sigc::mem_fun(*this, &MainWindow::on_profiles_tv_selection_changed));
     this->m_profiles_tv->signal_row_activated().connect(sigc::mem_fun(*this, &MainWindow::on_row_activated));
-    new_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_new_activated));
-    edit_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_edit_activated));
+    new_action->signal_activate().connect(sigc::hide_return(sigc::mem_fun(*this, &MainWindow::on_new_activated)));
+    edit_action->signal_activate().connect(sigc::hide_return(sigc::mem_fun(*this, &MainWindow::on_edit_activated)));
     remove_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_remove_activated));
     run_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_run_activated));
     setup_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_setup_activated));
+    verify_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_verify_activated));
+    enrich_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_enrich_activated));
+    import_action->signal_activate().connect(sigc::hide_return(sigc::mem_fun(*this, &MainWindow::on_import_activated)));
     preferences_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_preferences_activated));
     about_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_about_activated));
     quit_action->signal_activate().connect(sigc::mem_fun(*this, &MainWindow::on_quit_activated));
+    this->signal_key_press_event().connect(sigc::mem_fun(*this, &MainWindow::on_window_key_press), false);
     this->m_profiles_monitor->signal_changed().connect(sigc::mem_fun(*this, &MainWindow::on_profiles_file_changed));
+    this->m_library_validator.signal_profile_validated().connect(sigc::mem_fun(*this, &MainWindow::on_profile_validated));
+    this->m_library_validator.signal_profile_settings().connect(sigc::mem_fun(*this, &MainWindow::on_profile_settings));
+    this->m_library_enricher.signal_finished().connect(sigc::hide(sigc::hide(sigc::mem_fun(*this, &MainWindow::sync_search_index))));
+    this->m_profiles_search_entry->signal_search_changed().connect(sigc::mem_fun(*this, &MainWindow::on_search_changed));
+    this->m_facets_box->signal_changed().connect(sigc::mem_fun(*this, &MainWindow::show_profiles));
 
     this->load_profiles();
+    this->build_search_index();
     this->show_all_children();
 }
 
+/**
+ * Checks whether there are profile rows waiting to be shown.
+ * @return @c TRUE while the profiles view is being updated or @c FALSE
+ * otherwise.
+ */
+bool MainWindow::is_updating_view() const
+{
+    return !this->m_view_updater->is_idle();
+}
+
+/**
+ * Destructor. Stops the pending asynchronous tasks.
+ */
+MainWindow::~MainWindow()
+{
+    this->m_async_token.cancel();
+}
+
 } // DOSBoxGTK
@@ -9,12 +9,23 @@
 #ifndef MAINWINDOW_H
 #define MAINWINDOW_H
 
+#define FACETS_REFRESH_DELAY 250 ///< Milliseconds the facet counts wait for more profile settings before being refreshed.
+
+#include "async.hpp"
+#include "libraryvalidator.h"
+#include "libraryenricher.h"
+#include "profilelibrary.h"
+#include "profilesearchindex.h"
+#include "profilefacetindex.h"
+#include "profilefacetsbox.h"
+#include "profileviewupdater.h"
 #include <gtkmm/applicationwindow.h>
 #include <gtkmm/builder.h>
 #include <gtkmm/treeview.h>
+#include <gtkmm/searchentry.h>
 #include <gtkmm/actiongroup.h>
 #include <giomm/settings.h>
-#include <libxml++/parsers/domparser.h>
+#include <map>
 
 
 /**
@@ -29,38 +40,62 @@ namespace DOSBoxGTK
 class MainWindow final : public Gtk::ApplicationWindow
 {
 private:
-    Gtk::ActionGroup *m_main_ag  = nullptr;
-    Gtk::TreeView *m_profiles_tv = nullptr;
+    Gtk::ActionGroup *m_main_ag               = nullptr;
+    Gtk::TreeView *m_profiles_tv              = nullptr;
+    Gtk::SearchEntry *m_profiles_search_entry = nullptr;
+    ProfileFacetsBox *m_facets_box            = nullptr;
 
     Glib::RefPtr<Gio::Settings> m_settings; ///< Application's settings manager.
     Glib::RefPtr<Gio::File> m_profiles_file;
     Glib::RefPtr<Gio::FileMonitor> m_profiles_monitor;
     bool check_settings() const;
     void force_setup();
-    xmlpp::DomParser m_parser;
+    ProfileLibrary m_library;                                   ///< Game profiles.
+    LibraryValidator m_library_validator;                       ///< Looks for broken profiles in background.
+    LibraryEnricher m_library_enricher;                         ///< Completes the profiles metadata in background.
+    std::map<Glib::ustring, Gtk::TreeIter> m_profile_rows;      ///< Profiles TreeView rows by profile ID.
+    std::unique_ptr<ProfileViewUpdater> m_view_updater;         ///< Applies row changes to m_profiles_tv.
+    ProfileSearchIndex m_search_index;                          ///< Profiles text index, for the search entry.
+    ProfileFacetIndex m_facet_index;                            ///< Profiles facet bitmaps, for the facets box.
+    sigc::connection m_facets_refresh;                          ///< Pending refresh of the facets after new profile settings.
+    std::map<Glib::ustring, ProfileRowUpdate> m_profile_issues; ///< Status of the profiles with issues, for the rows shown again.
+    Tools::CancellationToken m_async_token;                     ///< Cancelled when the window is destroyed.
 
     void create_profiles_file();
     void load_profiles();
+    void show_profiles();
+    Tools::AsyncTask build_search_index();
+    void sync_search_index();
     std::vector<Glib::ustring> get_selected_ids() const;
-    xmlpp::Element *get_profile_element(const Glib::ustring &id) const;
     bool remove_profile(const Glib::ustring &id);
 
 protected:
     void on_profiles_tv_selection_changed();
+    void on_search_changed();
+    bool on_facets_refresh_timeout();
     void on_row_activated(const Gtk::TreePath &path, Gtk::TreeViewColumn *column);
-    void on_new_activated();
-    void on_edit_activated();
+    Tools::AsyncTask on_new_activated();
+    Tools::AsyncTask on_edit_activated();
     void on_remove_activated();
     void on_run_activated();
     void on_setup_activated();
+    void on_verify_activated();
+    void on_enrich_activated();
+    Tools::AsyncTask on_import_activated();
     void on_preferences_activated();
     void on_about_activated();
+    void on_performance_activated();
+    bool on_window_key_press(GdkEventKey *event);
     void on_quit_activated();
+    void on_profile_validated(const Glib::ustring &id, const std::vector<ProfileIssue> &issues);
+    void on_profile_settings(const Glib::ustring &id, const ProfileSettings &settings);
     void on_profiles_file_changed(const Glib::RefPtr<Gio::File> &file, const Glib::RefPtr<Gio::File> &other_file, Gio::FileMonitorEvent event_type);
 
 public:
     MainWindow(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder);
-    virtual ~MainWindow() {}
+    virtual ~MainWindow();
+
+    bool is_updating_view() const;
 };
 
 } // DOSBoxGTK
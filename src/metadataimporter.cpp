@@ -0,0 +1,585 @@
+/**
+ * @file
+ * MetadataImporter class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "metadataimporter.h"
+#include "metadataindex.h"
+#include "allocaccounting.hpp"
+#include "log.hpp"
+#include "trace.hpp"
+#include <glib.h>
+#include <glibmm/convert.h>
+#include <glibmm/fileutils.h>
+#include <libxml/xmlreader.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Recursive descent JSON parser looking for record objects, given their
+ * string, number and boolean members. Objects nested in a record, like its
+ * list of platforms, are not records themselves.
+ */
+class JsonObjectReader final
+{
+public:
+    typedef std::vector<std::pair<std::string, std::string>> Members;
+    typedef std::function<bool(const Members&)> RecordPredicate;
+
+private:
+    const std::string &m_filename; ///< File name, for the error messages.
+    const std::string &m_text;     ///< JSON text.
+    std::size_t m_pos = 0;         ///< Parsing position.
+    RecordPredicate m_is_record;   ///< Tells whether an object is a record.
+    std::vector<Members> m_records; ///< Records found so far.
+
+    /**
+     * Throws a syntax error at the current position.
+     */
+    [[noreturn]] void fail() const
+    {
+        throw std::runtime_error(this->m_filename + ": invalid JSON at byte " + std::to_string(this->m_pos));
+    }
+
+    /**
+     * Skips the white space.
+     * @return Next character, 0 at the end.
+     */
+    char peek()
+    {
+        while (this->m_pos < this->m_text.size() && std::isspace(static_cast<unsigned char>(this->m_text[this->m_pos]))) {
+            ++this->m_pos;
+        }
+
+        return this->m_pos < this->m_text.size() ? this->m_text[this->m_pos] : 0;
+    }
+
+    /**
+     * Consumes an expected character.
+     * @param c Character.
+     */
+    void expect(char c)
+    {
+        if (this->peek() != c) {
+            this->fail();
+        }
+
+        ++this->m_pos;
+    }
+
+    /**
+     * Reads four hexadecimal digits.
+     * @return Their value.
+     */
+    gunichar read_hex4()
+    {
+        gunichar value = 0;
+
+        for (int i = 0; i < 4; ++i, ++this->m_pos) {
+            if (this->m_pos >= this->m_text.size() || !std::isxdigit(static_cast<unsigned char>(this->m_text[this->m_pos]))) {
+                this->fail();
+            }
+
+            value = value * 16 + g_ascii_xdigit_value(this->m_text[this->m_pos]);
+        }
+
+        return value;
+    }
+
+    /**
+     * Reads a string.
+     * @return Unescaped string, UTF-8 encoded.
+     */
+    std::string read_string()
+    {
+        std::string result;
+
+        this->expect('"');
+
+        for (;;) {
+            if (this->m_pos >= this->m_text.size()) {
+                this->fail();
+            }
+
+            char c = this->m_text[this->m_pos++];
+
+            if (c == '"') {
+                return result;
+            } else if (c != '\\') {
+                result += c;
+                continue;
+            } else if (this->m_pos >= this->m_text.size()) {
+                this->fail();
+            }
+
+            switch (c = this->m_text[this->m_pos++]) {
+            case 'b': result += '\b'; break;
+            case 'f': result += '\f'; break;
+            case 'n': result += '\n'; break;
+            case 'r': result += '\r'; break;
+            case 't': result += '\t'; break;
+            case 'u': {
+                auto code = this->read_hex4();
+
+                if (code >= 0xD800 && code < 0xDC00 && this->m_text.compare(this->m_pos, 2, "\\u") == 0) {
+                    this->m_pos += 2;
+                    code = 0x10000 + ((code - 0xD800) << 10) + (this->read_hex4() - 0xDC00);
+                }
+
+                char utf8[6];
+
+                result.append(utf8, g_unichar_to_utf8(code, utf8));
+                break;
+            }
+            default:
+                result += c;
+            }
+        }
+    }
+
+    /**
+     * Reads a number, @c true, @c false or @c null.
+     * @return The literal text.
+     */
+    std::string read_literal()
+    {
+        auto begin = this->m_pos;
+
+        while (this->m_pos < this->m_text.size() && std::strchr(",:]} \t\r\n", this->m_text[this->m_pos]) == nullptr) {
+            ++this->m_pos;
+        }
+
+        if (this->m_pos == begin) {
+            this->fail();
+        }
+
+        auto literal = this->m_text.substr(begin, this->m_pos - begin);
+
+        return literal == "null" ? std::string() : literal;
+    }
+
+    /**
+     * Reads any value.
+     * @param depth Nesting of the value.
+     * @param scalar Set to the value if it is not an object or an array.
+     * @return @c TRUE if the value is a scalar or @c FALSE otherwise.
+     */
+    bool read_value(unsigned depth, std::string &scalar)
+    {
+        if (depth > METADATA_IMPORT_MAX_DEPTH) {
+            this->fail();
+        }
+
+        switch (this->peek()) {
+        case '{': {
+            auto first_nested = this->m_records.size();
+            Members members;
+
+            ++this->m_pos;
+
+            if (this->peek() != '}') {
+                for (;;) {
+                    auto name = this->read_string();
+                    std::string value;
+
+                    this->expect(':');
+
+                    if (this->read_value(depth + 1, value)) {
+                        members.emplace_back(std::move(name), std::move(value));
+                    }
+
+                    if (this->peek() != ',') {
+                        break;
+                    }
+
+                    ++this->m_pos;
+                }
+            }
+
+            this->expect('}');
+
+            if (this->m_is_record(members)) {
+                this->m_records.resize(first_nested);
+                this->m_records.push_back(std::move(members));
+            }
+
+            return false;
+        }
+        case '[':
+            ++this->m_pos;
+
+            if (this->peek() != ']') {
+                for (;;) {
+                    std::string value;
+
+                    this->read_value(depth + 1, value);
+
+                    if (this->peek() != ',') {
+                        break;
+                    }
+
+                    ++this->m_pos;
+                }
+            }
+
+            this->expect(']');
+
+            return false;
+        case '"':
+            scalar = this->read_string();
+
+            return true;
+        default:
+            scalar = this->read_literal();
+
+            return true;
+        }
+    }
+
+public:
+    /**
+     * Constructor.
+     * @param filename File name, for the error messages.
+     * @param text JSON text.
+     * @param is_record Tells whether an object is a record, given its scalar
+     * members.
+     */
+    JsonObjectReader(const std::string &filename, const std::string &text, RecordPredicate is_record) :
+        m_filename(filename), m_text(text), m_is_record(std::move(is_record))
+    {}
+
+    /**
+     * Parses the whole text.
+     * @return Scalar members of each record, in order.
+     */
+    std::vector<Members> read()
+    {
+        std::string scalar;
+
+        this->read_value(0, scalar);
+
+        if (this->peek() != 0) {
+            this->fail();
+        }
+
+        return std::move(this->m_records);
+    }
+};
+
+/**
+ * Sets a field of a game by name.
+ * @param game Game.
+ * @param name Field name, in any case.
+ * @param value Field value.
+ * @return @c TRUE if the name is a known field or @c FALSE otherwise.
+ */
+bool MetadataImporter::set_field(GameInfo &game, const std::string &name, const std::string &value)
+{
+    auto field = Glib::ustring(name).lowercase();
+    auto begin = value.find_first_not_of(" \t\r\n"),
+         end   = value.find_last_not_of(" \t\r\n");
+    auto trimmed = begin == std::string::npos ? std::string() : value.substr(begin, end - begin + 1);
+
+    if (!g_utf8_validate(trimmed.data(), trimmed.size(), nullptr)) {
+        trimmed = Glib::convert_with_fallback(trimmed, "UTF-8", "ISO-8859-1");
+    }
+
+    if (field == "title" || field == "name") {
+        game.title = trimmed;
+    } else if (field == "year" || field == "released") {
+        // Dates are reduced to their year.
+        game.year = trimmed.size() > 4 && std::all_of(trimmed.begin(), trimmed.begin() + 4, ::isdigit) ? trimmed.substr(0, 4) : trimmed;
+    } else if (field == "developer") {
+        game.developer = trimmed;
+    } else if (field == "publisher") {
+        game.publisher = trimmed;
+    } else if (field == "genre") {
+        game.genre = trimmed;
+    } else if (field == "description" || field == "notes") {
+        game.description = trimmed;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Reads the games of a CSV file, following RFC 4180: fields separated by
+ * commas, optionally quoted, with doubled quotes inside quoted fields.
+ * @param filename File name, for the error messages.
+ * @param contents File contents.
+ * @return Games.
+ */
+std::vector<GameInfo> MetadataImporter::read_csv(const std::string &filename, const std::string &contents)
+{
+    std::vector<GameInfo> games;
+    std::vector<std::string> columns, row;
+    std::string field;
+    bool quoted = false, in_field = false;
+    auto end_row = [&] {
+        row.push_back(std::move(field));
+        field.clear();
+
+        if (columns.empty()) {
+            columns = std::move(row);
+
+            if (std::none_of(columns.begin(), columns.end(), [](const std::string &column) {
+                    GameInfo game;
+
+                    return set_field(game, column, "x") && !game.title.empty();
+                })) {
+                throw std::runtime_error(filename + ": the first row has no title column");
+            }
+        } else if (row.size() > 1 || !row.front().empty()) {
+            GameInfo game;
+
+            for (std::size_t i = 0; i < row.size() && i < columns.size(); ++i) {
+                set_field(game, columns[i], row[i]);
+            }
+
+            if (!game.title.empty()) {
+                games.push_back(std::move(game));
+            }
+        }
+
+        row.clear();
+        in_field = false;
+    };
+
+    for (std::size_t i = 0; i < contents.size(); ++i) {
+        char c = contents[i];
+
+        if (quoted) {
+            if (c != '"') {
+                field += c;
+            } else if (i + 1 < contents.size() && contents[i + 1] == '"') {
+                field += '"';
+                ++i;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"' && !in_field) {
+            quoted = in_field = true;
+        } else if (c == ',') {
+            row.push_back(std::move(field));
+            field.clear();
+            in_field = false;
+        } else if (c == '\n') {
+            end_row();
+        } else if (c != '\r') {
+            field += c;
+            in_field = true;
+        }
+    }
+
+    if (in_field || !row.empty()) {
+        end_row();
+    }
+
+    return games;
+}
+
+/**
+ * Reads the games of an XML file. The file is streamed, so big dumps are
+ * not held in memory as a tree.
+ * @param filename File name.
+ * @return Games.
+ */
+std::vector<GameInfo> MetadataImporter::read_xml(const std::string &filename)
+{
+    std::vector<GameInfo> games;
+    GameInfo game;
+    std::string text, field;
+    int game_depth = -1, field_depth = -1;
+    auto reader = xmlReaderForFile(filename.c_str(), nullptr, XML_PARSE_NONET | XML_PARSE_NOCDATA);
+    int status;
+
+    if (reader == nullptr) {
+        throw std::runtime_error(filename + ": can not be read");
+    }
+
+    auto end_game = [&] {
+        if (!game.title.empty()) {
+            games.push_back(std::move(game));
+        }
+
+        game       = GameInfo();
+        game_depth = -1;
+    };
+
+    while ((status = xmlTextReaderRead(reader)) == 1) {
+        int depth = xmlTextReaderDepth(reader);
+
+        switch (xmlTextReaderNodeType(reader)) {
+        case XML_READER_TYPE_ELEMENT: {
+            std::string name = reinterpret_cast<const char*>(xmlTextReaderConstLocalName(reader));
+            bool empty = xmlTextReaderIsEmptyElement(reader);
+            GameInfo attributes;
+            bool has_attributes = false;
+
+            if (depth > METADATA_IMPORT_MAX_DEPTH) {
+                xmlFreeTextReader(reader);
+
+                throw std::runtime_error(filename + ": too deeply nested");
+            }
+
+            while (xmlTextReaderMoveToNextAttribute(reader) == 1) {
+                has_attributes |= set_field(attributes, reinterpret_cast<const char*>(xmlTextReaderConstLocalName(reader)),
+                                            reinterpret_cast<const char*>(xmlTextReaderConstValue(reader)));
+            }
+
+            xmlTextReaderMoveToElement(reader);
+
+            // Elements nested deeper than the fields of the current game,
+            // like lists of platforms or releases, are not games nor fields.
+            if (field_depth >= 0 || (game_depth >= 0 && depth > game_depth + 1)) {
+                break;
+            }
+
+            if (has_attributes && !attributes.title.empty() && game_depth < 0) {
+                // A game described by its attributes.
+                game       = std::move(attributes);
+                game_depth = depth;
+
+                if (empty) {
+                    end_game();
+                }
+            } else if (!empty && set_field(attributes, name, std::string())) {
+                // A field element, whose parent is the game.
+                game_depth  = depth - 1;
+                field       = name;
+                field_depth = depth;
+                text.clear();
+            }
+
+            break;
+        }
+        case XML_READER_TYPE_TEXT:
+        case XML_READER_TYPE_SIGNIFICANT_WHITESPACE:
+            if (field_depth >= 0) {
+                text += reinterpret_cast<const char*>(xmlTextReaderConstValue(reader));
+            }
+
+            break;
+        case XML_READER_TYPE_END_ELEMENT:
+            if (depth == field_depth) {
+                set_field(game, field, text);
+                field_depth = -1;
+            } else if (depth == game_depth) {
+                end_game();
+            }
+
+            break;
+        }
+    }
+
+    xmlFreeTextReader(reader);
+
+    if (status != 0) {
+        throw std::runtime_error(filename + ": invalid XML");
+    }
+
+    end_game();
+
+    return games;
+}
+
+/**
+ * Reads the games of a JSON file.
+ * @param filename File name, for the error messages.
+ * @param contents File contents.
+ * @return Games.
+ */
+std::vector<GameInfo> MetadataImporter::read_json(const std::string &filename, const std::string &contents)
+{
+    std::vector<GameInfo> games;
+    auto to_game = [](const JsonObjectReader::Members &members) {
+        GameInfo game;
+
+        for (auto &member : members) {
+            set_field(game, member.first, member.second);
+        }
+
+        return game;
+    };
+    JsonObjectReader reader(filename, contents, [&to_game](const JsonObjectReader::Members &members) {
+        return !to_game(members).title.empty();
+    });
+
+    for (auto &members : reader.read()) {
+        games.push_back(to_game(members));
+    }
+
+    return games;
+}
+
+/**
+ * Reads the games of a dump file.
+ * @param filename CSV, XML or JSON file.
+ * @return Games.
+ */
+std::vector<GameInfo> MetadataImporter::read(const std::string &filename)
+{
+    TRACE_SCOPE("MetadataImporter::read");
+    ALLOC_SCOPE(Tools::AllocTag::NETWORK);
+    auto dot       = filename.rfind('.');
+    auto extension = dot == std::string::npos ? Glib::ustring() : Glib::ustring(filename.substr(dot + 1)).lowercase();
+
+    if (extension == "xml") {
+        return read_xml(filename);
+    }
+
+    auto contents = Glib::file_get_contents(filename);
+
+    // A byte order mark would be taken as part of the first value.
+    if (contents.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        contents.erase(0, 3);
+    }
+
+    if (extension == "json") {
+        return read_json(filename, contents);
+    } else if (extension == "csv") {
+        return read_csv(filename, contents);
+    }
+
+    auto first = contents.find_first_not_of(" \t\r\n");
+
+    if (first != std::string::npos && contents[first] == '<') {
+        return read_xml(filename);
+    } else if (first != std::string::npos && (contents[first] == '[' || contents[first] == '{')) {
+        return read_json(filename, contents);
+    }
+
+    return read_csv(filename, contents);
+}
+
+/**
+ * Reads a dump file and replaces an index with its games.
+ * @param filename CSV, XML or JSON file.
+ * @param index_filename Index file.
+ * @return Number of games imported.
+ */
+unsigned MetadataImporter::import(const std::string &filename, const std::string &index_filename)
+{
+    auto games = read(filename);
+    auto count = MetadataIndex::write(index_filename, games);
+
+    LOG_INFO(Tools::LogCategory::GENERAL, "Imported %1 games from %2 into %3", count, filename, index_filename);
+
+    return count;
+}
+
+} // DOSBoxGTK
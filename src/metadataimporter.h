@@ -0,0 +1,52 @@
+/**
+ * @file
+ * MetadataImporter class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef METADATAIMPORTER_H
+#define METADATAIMPORTER_H
+
+#define METADATA_IMPORT_MAX_DEPTH 64 ///< Maximum nesting of the imported XML and JSON files.
+
+#include "mobygamesscraper.h"
+#include <string>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Reads game information dumps to build the offline MetadataIndex. The
+ * format is chosen by the file extension, or by the first character of the
+ * file if it is unknown:
+ * - CSV: the first row names the columns.
+ * - XML: the games are the elements with a title child element or
+ *   attribute, the other fields being their siblings or attributes.
+ * - JSON: the games are the objects with a title member, wherever they are.
+ * Fields are recognized by name regardless of case: title or name, year or
+ * released, developer, publisher, genre, and description or notes. Anything
+ * else is ignored, as well as the games without a title.
+ * The methods do not use the UI and can be called from the thread pool.
+ */
+class MetadataImporter final
+{
+private:
+    static bool set_field(GameInfo &game, const std::string &name, const std::string &value);
+    static std::vector<GameInfo> read_csv(const std::string &filename, const std::string &contents);
+    static std::vector<GameInfo> read_xml(const std::string &filename);
+    static std::vector<GameInfo> read_json(const std::string &filename, const std::string &contents);
+
+public:
+    static std::vector<GameInfo> read(const std::string &filename);
+    static unsigned import(const std::string &filename, const std::string &index_filename);
+};
+
+} // DOSBoxGTK
+
+#endif // METADATAIMPORTER_H
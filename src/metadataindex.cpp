@@ -0,0 +1,294 @@
+/**
+ * @file
+ * MetadataIndex class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "metadataindex.h"
+#include "config.h"
+#include "titlematcher.h"
+#include "trace.hpp"
+#include <glib.h>
+#include <glibmm/error.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <stdexcept>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Gets a field of a record.
+ * @param record Record index.
+ * @param field Field index.
+ * @return Field value, pointing to the mapped file.
+ */
+std::string_view MetadataIndex::get_string(uint32_t record, Field field) const
+{
+    auto &string = this->m_records[record].fields[field];
+
+    return std::string_view(this->m_strings + string.offset, string.length);
+}
+
+/**
+ * Gets the part of a record key starting at a word.
+ * @param word Word.
+ * @return Key suffix, pointing to the mapped file.
+ */
+std::string_view MetadataIndex::get_suffix(const Word &word) const
+{
+    return this->get_string(word.record, FIELD_KEY).substr(word.offset);
+}
+
+/**
+ * Constructor. Maps and checks an index file. Every offset is checked, so a
+ * corrupt file can not make the searches read outside of it.
+ * @param filename Index file.
+ */
+MetadataIndex::MetadataIndex(const std::string &filename)
+{
+    TRACE_SCOPE("MetadataIndex::MetadataIndex");
+    GError *error = nullptr;
+
+    this->m_file = g_mapped_file_new(filename.c_str(), FALSE, &error);
+
+    if (this->m_file == nullptr) {
+        Glib::Error::throw_exception(error);
+    }
+
+    auto data = g_mapped_file_get_contents(this->m_file);
+    uint64_t size = g_mapped_file_get_length(this->m_file),
+             strings_offset = 0;
+    Header header;
+    bool valid = size >= sizeof(header);
+
+    if (valid) {
+        std::memcpy(&header, data, sizeof(header));
+        strings_offset = sizeof(header) + static_cast<uint64_t>(header.records) * sizeof(Record) + static_cast<uint64_t>(header.words) * sizeof(Word);
+        valid = std::memcmp(header.magic, METADATA_INDEX_MAGIC, sizeof(header.magic)) == 0 && strings_offset <= size;
+    }
+
+    if (valid) {
+        this->m_records   = reinterpret_cast<const Record*>(data + sizeof(header));
+        this->m_words     = reinterpret_cast<const Word*>(this->m_records + header.records);
+        this->m_strings   = data + strings_offset;
+        this->m_n_records = header.records;
+        this->m_n_words   = header.words;
+
+        for (uint32_t i = 0; valid && i < this->m_n_records; ++i) {
+            for (auto &string : this->m_records[i].fields) {
+                valid = valid && static_cast<uint64_t>(string.offset) + string.length <= size - strings_offset;
+            }
+        }
+
+        for (uint32_t i = 0; valid && i < this->m_n_words; ++i) {
+            auto &word = this->m_words[i];
+
+            valid = word.record < this->m_n_records && word.offset < this->m_records[word.record].fields[FIELD_KEY].length;
+        }
+    }
+
+    if (!valid) {
+        g_mapped_file_unref(this->m_file);
+
+        throw std::runtime_error(filename + ": not a valid metadata index");
+    }
+}
+
+/**
+ * Destructor. Unmaps the file.
+ */
+MetadataIndex::~MetadataIndex()
+{
+    g_mapped_file_unref(this->m_file);
+}
+
+/**
+ * Gets the index file used by default, in the user data directory.
+ * @return Index file name.
+ */
+std::string MetadataIndex::get_default_filename()
+{
+    return Glib::build_filename(Glib::get_user_data_dir(), PROJECT_NAME, METADATA_INDEX_FILENAME);
+}
+
+/**
+ * Builds an index file, replacing the existing one at once so the mapped
+ * instances keep working. Games without a title are left out.
+ * @param filename Index file.
+ * @param games Games.
+ * @return Number of games written.
+ */
+unsigned MetadataIndex::write(const std::string &filename, const std::vector<GameInfo> &games)
+{
+    TRACE_SCOPE("MetadataIndex::write");
+    std::vector<std::pair<std::string, const GameInfo*>> keys;
+    std::vector<Record> records;
+    std::vector<Word> words;
+    std::string strings;
+
+    for (auto &game : games) {
+        auto key = TitleMatcher::normalize(game.title);
+
+        if (!key.empty()) {
+            keys.emplace_back(std::move(key), &game);
+        }
+    }
+
+    std::stable_sort(keys.begin(), keys.end(), [](const auto &a, const auto &b) {
+        return a.first < b.first;
+    });
+
+    auto add = [&strings](const std::string &value) {
+        String string{static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(value.size())};
+
+        strings += value;
+
+        return string;
+    };
+
+    for (auto &key : keys) {
+        auto &game = *key.second;
+        Record record;
+
+        record.fields[FIELD_KEY]         = add(key.first);
+        record.fields[FIELD_TITLE]       = add(game.title);
+        record.fields[FIELD_YEAR]        = add(game.year);
+        record.fields[FIELD_DEVELOPER]   = add(game.developer);
+        record.fields[FIELD_PUBLISHER]   = add(game.publisher);
+        record.fields[FIELD_GENRE]       = add(game.genre);
+        record.fields[FIELD_DESCRIPTION] = add(game.description);
+
+        for (std::size_t i = 0; i < key.first.size(); ++i) {
+            if (i == 0 || key.first[i - 1] == ' ') {
+                words.push_back(Word{static_cast<uint32_t>(records.size()), static_cast<uint32_t>(i)});
+            }
+        }
+
+        records.push_back(record);
+    }
+
+    if (strings.size() > UINT32_MAX) {
+        throw std::runtime_error(filename + ": too much metadata for an index");
+    }
+
+    std::sort(words.begin(), words.end(), [&strings, &records](const Word &a, const Word &b) {
+        auto &key_a = records[a.record].fields[FIELD_KEY],
+             &key_b = records[b.record].fields[FIELD_KEY];
+        std::string_view suffix_a(strings.data() + key_a.offset + a.offset, key_a.length - a.offset),
+                         suffix_b(strings.data() + key_b.offset + b.offset, key_b.length - b.offset);
+
+        return suffix_a < suffix_b || (suffix_a == suffix_b && a.record < b.record);
+    });
+
+    Header header;
+    std::string contents;
+
+    std::memcpy(header.magic, METADATA_INDEX_MAGIC, sizeof(header.magic));
+    header.records = records.size();
+    header.words   = words.size();
+
+    contents.reserve(sizeof(header) + records.size() * sizeof(Record) + words.size() * sizeof(Word) + strings.size());
+    contents.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    contents.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+    contents.append(reinterpret_cast<const char*>(words.data()), words.size() * sizeof(Word));
+    contents += strings;
+
+    g_mkdir_with_parents(Glib::path_get_dirname(filename).c_str(), 0755);
+    Glib::file_set_contents(filename, contents);
+
+    return records.size();
+}
+
+/**
+ * Gets the number of games.
+ * @return Number of games.
+ */
+std::size_t MetadataIndex::size() const
+{
+    return this->m_n_records;
+}
+
+/**
+ * Searches for the games with a title word starting with the searched title,
+ * once normalized. The games whose title starts with it go first, and then
+ * by title.
+ * @param title Searched title.
+ * @param max_results Maximum number of results.
+ * @return Games found, their HREF being their record index.
+ */
+std::vector<GameSearchResult> MetadataIndex::search(const Glib::ustring &title, std::size_t max_results) const
+{
+    auto query = TitleMatcher::normalize(title);
+    std::set<uint32_t> starting, // Records whose title starts with it.
+                       others;   // Records with a later word starting with it.
+    std::vector<GameSearchResult> results;
+
+    if (query.empty()) {
+        return results;
+    }
+
+    auto end  = this->m_words + this->m_n_words;
+    auto word = std::lower_bound(this->m_words, end, query, [this](const Word &word, const std::string &query) {
+        return this->get_suffix(word) < query;
+    });
+
+    // The words are in suffix order, not in result order, so every match is
+    // collected before cutting the results.
+    for (; word != end && this->get_suffix(*word).starts_with(query); ++word) {
+        (word->offset == 0 ? starting : others).insert(word->record);
+    }
+
+    // Records are sorted by key, so their index gives the title order.
+    for (auto records : { &starting, &others }) {
+        for (auto record : *records) {
+            if (results.size() >= max_results) {
+                return results;
+            }
+
+            if (records == &others && starting.count(record) != 0) {
+                continue;
+            }
+
+            results.push_back(GameSearchResult{std::string(this->get_string(record, FIELD_TITLE)),
+                                               std::string(this->get_string(record, FIELD_YEAR)),
+                                               std::to_string(record),
+                                               Glib::ustring()});
+        }
+    }
+
+    return results;
+}
+
+/**
+ * Gets a game.
+ * @param record Record index, the HREF of its search result.
+ * @return Game information.
+ */
+GameInfo MetadataIndex::get_game(uint32_t record) const
+{
+    if (record >= this->m_n_records) {
+        throw std::out_of_range("Metadata index record out of range: " + std::to_string(record));
+    }
+
+    GameInfo info;
+
+    info.title       = std::string(this->get_string(record, FIELD_TITLE));
+    info.year        = std::string(this->get_string(record, FIELD_YEAR));
+    info.developer   = std::string(this->get_string(record, FIELD_DEVELOPER));
+    info.publisher   = std::string(this->get_string(record, FIELD_PUBLISHER));
+    info.genre       = std::string(this->get_string(record, FIELD_GENRE));
+    info.description = std::string(this->get_string(record, FIELD_DESCRIPTION));
+
+    return info;
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,130 @@
+/**
+ * @file
+ * MetadataIndex class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef METADATAINDEX_H
+#define METADATAINDEX_H
+
+#define METADATA_INDEX_MAGIC       "DBGTKMI2"     ///< First bytes of a metadata index file, with its format version.
+#define METADATA_INDEX_FILENAME    "metadata.idx" ///< Offline metadata index file name, in the user data directory.
+#define METADATA_INDEX_MAX_RESULTS 50             ///< Maximum number of results of a search.
+
+#include "mobygamesscraper.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+typedef struct _GMappedFile GMappedFile;
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Read-only game information database kept in a memory-mapped file. Opening
+ * it reads the record and word arrays once to check their offsets, but the
+ * strings area, which holds most of the data, is only read where the
+ * searches touch it. The file holds the games sorted by their title
+ * normalized by TitleMatcher::normalize(), the same way the fuzzy matching
+ * does, and a sorted array with every word start of every normalized title. A
+ * search is a binary search for the searched title among those word starts,
+ * so it finds the games with a word starting with it in logarithmic time
+ * plus the number of matches.
+ * Layout, in host byte order, as the file is built on the machine using it:
+ * @code
+ * Header
+ * Record[records]  sorted by key
+ * Word[words]      sorted by the key suffix they point to
+ * strings          every field of every record, not terminated
+ * @endcode
+ * Instances can be searched from any thread.
+ */
+class MetadataIndex final
+{
+private:
+    /**
+     * Record field indexes.
+     */
+    enum Field
+    {
+        FIELD_KEY,
+        FIELD_TITLE,
+        FIELD_YEAR,
+        FIELD_DEVELOPER,
+        FIELD_PUBLISHER,
+        FIELD_GENRE,
+        FIELD_DESCRIPTION,
+        FIELD_COUNT
+    };
+
+    /**
+     * File header.
+     */
+    struct Header
+    {
+        char magic[8];    ///< METADATA_INDEX_MAGIC.
+        uint32_t records, ///< Number of records.
+                 words;   ///< Number of words.
+    };
+
+    /**
+     * String in the strings area.
+     */
+    struct String
+    {
+        uint32_t offset, ///< Offset from the start of the strings area.
+                 length; ///< Length in bytes.
+    };
+
+    /**
+     * Game.
+     */
+    struct Record
+    {
+        String fields[FIELD_COUNT]; ///< Fields, the key being the normalized title.
+    };
+
+    /**
+     * Start of a word of a record key.
+     */
+    struct Word
+    {
+        uint32_t record, ///< Record index.
+                 offset; ///< Offset of the word within the record key.
+    };
+
+    GMappedFile *m_file     = nullptr; ///< Mapped file.
+    const Record *m_records = nullptr; ///< Records in the mapped file.
+    const Word *m_words     = nullptr; ///< Words in the mapped file.
+    const char *m_strings   = nullptr; ///< Strings area in the mapped file.
+    uint32_t m_n_records    = 0,       ///< Number of records.
+             m_n_words      = 0;       ///< Number of words.
+
+    std::string_view get_string(uint32_t record, Field field) const;
+    std::string_view get_suffix(const Word &word) const;
+
+public:
+    explicit MetadataIndex(const std::string &filename);
+    ~MetadataIndex();
+
+    MetadataIndex(const MetadataIndex&) = delete;
+    MetadataIndex &operator=(const MetadataIndex&) = delete;
+
+    static std::string get_default_filename();
+    static unsigned write(const std::string &filename, const std::vector<GameInfo> &games);
+
+    std::size_t size() const;
+    std::vector<GameSearchResult> search(const Glib::ustring &title, std::size_t max_results = METADATA_INDEX_MAX_RESULTS) const;
+    GameInfo get_game(uint32_t record) const;
+};
+
+} // DOSBoxGTK
+
+#endif // METADATAINDEX_H
@@ -0,0 +1,299 @@
+/**
+ * @file
+ * MetadataProvider, MobyGamesProvider, LocalFileProvider and
+ * OfflineIndexProvider classes implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "metadataprovider.h"
+#include "config.h"
+#include "httpclient.hpp"
+#include "log.hpp"
+#include "titlematcher.h"
+#include "trace.hpp"
+#include <glib/gstdio.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/i18n.h>
+#include <glibmm/keyfile.h>
+#include <glibmm/miscutils.h>
+#include <stdexcept>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Constructor.
+ * @param id Provider ID. It must be unique, lowercase and only have letters,
+ * digits and underscores.
+ */
+MetadataProvider::MetadataProvider(const std::string &id) :
+    m_id(id)
+{}
+
+/**
+ * Destructor.
+ */
+MetadataProvider::~MetadataProvider()
+{}
+
+/**
+ * Gets the provider ID.
+ * @return Provider ID.
+ */
+const std::string &MetadataProvider::get_id() const
+{
+    return this->m_id;
+}
+
+/**
+ * Constructor.
+ */
+MobyGamesProvider::MobyGamesProvider() :
+    MetadataProvider("mobygames")
+{}
+
+/**
+ * Gets the name of the provider shown to the user.
+ * @return Provider name.
+ */
+Glib::ustring MobyGamesProvider::get_name() const
+{
+    return "MobyGames";
+}
+
+/**
+ * Searches for games on the quick search page of the site, parsing the page
+ * as it downloads.
+ * @param token Cancellation token.
+ * @param title Game title.
+ * @param on_result Called for each game found.
+ */
+void MobyGamesProvider::search(const Tools::CancellationToken &token, const Glib::ustring &title, const ResultCallback &on_result)
+{
+    TRACE_SCOPE("MobyGamesProvider::search");
+    auto name = this->get_name();
+    SearchResultsParser parser([&on_result, &name](const GameSearchResult &result) {
+        auto game = result;
+
+        game.provider = name;
+        on_result(game);
+    });
+    auto url = MOBYGAMES_URL "/search/quick";
+    auto status = Tools::HttpClient::get_default().fetch_stream(token, url, MobyGamesScraper::get_search_fields(title), [&parser](const char *data, std::size_t size) {
+        parser.feed(data, size);
+    });
+
+    if (status >= 400) {
+        throw std::runtime_error(std::string(url) + ": HTTP status " + std::to_string(status));
+    }
+
+    parser.finish();
+}
+
+/**
+ * Downloads and parses the page of a game.
+ * @param token Cancellation token.
+ * @param href Game page path.
+ * @return Game information.
+ */
+GameInfo MobyGamesProvider::get_game(const Tools::CancellationToken &token, const Glib::ustring &href)
+{
+    auto url = MOBYGAMES_URL + href.raw();
+    auto response = Tools::HttpClient::get_default().fetch(token, url);
+
+    if (response.status >= 400) {
+        throw std::runtime_error(url + ": HTTP status " + std::to_string(response.status));
+    }
+
+    return MobyGamesScraper::parse_game_page(response.body);
+}
+
+/**
+ * Constructor.
+ * @param filename Games file.
+ */
+LocalFileProvider::LocalFileProvider(const std::string &filename) :
+    MetadataProvider("local"), m_filename(filename)
+{}
+
+/**
+ * Gets the games file used by default, in the user data directory.
+ * @return Games file name.
+ */
+std::string LocalFileProvider::get_default_filename()
+{
+    return Glib::build_filename(Glib::get_user_data_dir(), PROJECT_NAME, LOCAL_METADATA_FILENAME);
+}
+
+/**
+ * Gets the name of the provider shown to the user.
+ * @return Provider name.
+ */
+Glib::ustring LocalFileProvider::get_name() const
+{
+    return _("Local file");
+}
+
+/**
+ * Searches the games file for the games whose title contains the searched
+ * one.
+ * @param token Cancellation token.
+ * @param title Game title.
+ * @param on_result Called for each game found.
+ */
+void LocalFileProvider::search(const Tools::CancellationToken &token, const Glib::ustring &title, const ResultCallback &on_result)
+{
+    TRACE_SCOPE("LocalFileProvider::search");
+    auto searched = TitleMatcher::normalize(title);
+    Glib::KeyFile games;
+
+    if (searched.empty() || !Glib::file_test(this->m_filename, Glib::FILE_TEST_IS_REGULAR)) {
+        return;
+    }
+
+    games.load_from_file(this->m_filename);
+
+    for (auto &group : games.get_groups()) {
+        if (token.is_cancelled()) {
+            return;
+        }
+
+        if (TitleMatcher::normalize(group).find(searched) != std::string::npos) {
+            on_result(GameSearchResult{group, games.has_key(group, "Year") ? games.get_string(group, "Year") : Glib::ustring(), group, this->get_name()});
+        }
+    }
+}
+
+/**
+ * Reads a game from the games file.
+ * @param token Cancellation token.
+ * @param href Game title, the name of its group.
+ * @return Game information.
+ */
+GameInfo LocalFileProvider::get_game(const Tools::CancellationToken &token, const Glib::ustring &href)
+{
+    Glib::KeyFile games;
+    GameInfo info;
+
+    games.load_from_file(this->m_filename);
+
+    if (!games.has_group(href)) {
+        throw std::runtime_error(this->m_filename + ": " + href.raw() + " not found");
+    }
+
+    auto get = [&games, &href](const char *key) {
+        return games.has_key(href, key) ? games.get_string(href, key) : Glib::ustring();
+    };
+
+    info.title       = href;
+    info.year        = get("Year");
+    info.developer   = get("Developer");
+    info.publisher   = get("Publisher");
+    info.genre       = get("Genre");
+    info.description = get("Description");
+
+    return info;
+}
+
+/**
+ * Gets the mapped index, mapping it again if the file has been replaced.
+ * @return Index, null if there is none or it can not be read.
+ */
+std::shared_ptr<const MetadataIndex> OfflineIndexProvider::get_index()
+{
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    GStatBuf status;
+
+    if (g_stat(this->m_filename.c_str(), &status) != 0) {
+        this->m_index.reset();
+
+        return nullptr;
+    }
+
+    // An import writes a new file and renames it, so the inode changes.
+    if (!this->m_index || this->m_inode != status.st_ino || this->m_mtime != status.st_mtime) {
+        this->m_inode = status.st_ino;
+        this->m_mtime = status.st_mtime;
+
+        try {
+            this->m_index = std::make_shared<const MetadataIndex>(this->m_filename);
+        } catch (const Glib::Exception &e) {
+            this->m_index.reset();
+            LOG_WARNING(Tools::LogCategory::GENERAL, "Can not open the metadata index: %1", e.what());
+        } catch (const std::exception &e) {
+            this->m_index.reset();
+            LOG_WARNING(Tools::LogCategory::GENERAL, "Can not open the metadata index: %1", e.what());
+        }
+    }
+
+    return this->m_index;
+}
+
+/**
+ * Constructor.
+ * @param filename Index file.
+ */
+OfflineIndexProvider::OfflineIndexProvider(const std::string &filename) :
+    MetadataProvider("offline"), m_filename(filename)
+{}
+
+/**
+ * Gets the name of the provider shown to the user.
+ * @return Provider name.
+ */
+Glib::ustring OfflineIndexProvider::get_name() const
+{
+    return _("Offline database");
+}
+
+/**
+ * Searches the index for the games with a title word starting with the
+ * searched title.
+ * @param token Cancellation token.
+ * @param title Game title.
+ * @param on_result Called for each game found.
+ */
+void OfflineIndexProvider::search(const Tools::CancellationToken &token, const Glib::ustring &title, const ResultCallback &on_result)
+{
+    TRACE_SCOPE("OfflineIndexProvider::search");
+    auto index = this->get_index();
+
+    if (!index) {
+        return;
+    }
+
+    for (auto &result : index->search(title)) {
+        if (token.is_cancelled()) {
+            return;
+        }
+
+        auto game = result;
+
+        game.provider = this->get_name();
+        on_result(game);
+    }
+}
+
+/**
+ * Reads a game from the index.
+ * @param token Cancellation token.
+ * @param href Record index of the game.
+ * @return Game information.
+ */
+GameInfo OfflineIndexProvider::get_game(const Tools::CancellationToken &token, const Glib::ustring &href)
+{
+    auto index = this->get_index();
+
+    if (!index) {
+        throw std::runtime_error(this->m_filename + ": metadata index not found");
+    }
+
+    return index->get_game(std::stoul(href.raw()));
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,144 @@
+/**
+ * @file
+ * MetadataProvider, MobyGamesProvider, LocalFileProvider and
+ * OfflineIndexProvider classes declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef METADATAPROVIDER_H
+#define METADATAPROVIDER_H
+
+#define LOCAL_METADATA_FILENAME "games.ini" ///< Local games file name, in the user data directory.
+
+#include "metadataindex.h"
+#include "mobygamesscraper.h"
+#include "taskgroup.hpp"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Source of game information. Providers are queried from the thread pool
+ * through MetadataService, so their methods block and must not use the UI.
+ * They must stop early, throwing or returning, when their token is
+ * cancelled.
+ */
+class MetadataProvider
+{
+private:
+    std::string m_id; ///< Provider ID, used in its metrics names.
+
+public:
+    typedef std::function<void(const GameSearchResult&)> ResultCallback;
+
+    explicit MetadataProvider(const std::string &id);
+    virtual ~MetadataProvider();
+
+    MetadataProvider(const MetadataProvider&) = delete;
+    MetadataProvider &operator=(const MetadataProvider&) = delete;
+
+    const std::string &get_id() const;
+
+    /**
+     * Gets the name of the provider shown to the user.
+     * @return Provider name.
+     */
+    virtual Glib::ustring get_name() const = 0;
+
+    /**
+     * Searches for games by title. Results are reported as soon as they are
+     * found, with their provider set to the provider name.
+     * @param token Cancellation token.
+     * @param title Game title.
+     * @param on_result Called for each game found.
+     */
+    virtual void search(const Tools::CancellationToken &token, const Glib::ustring &title, const ResultCallback &on_result) = 0;
+
+    /**
+     * Gets the information of a game found by search().
+     * @param token Cancellation token.
+     * @param href HREF of the search result.
+     * @return Game information.
+     */
+    virtual GameInfo get_game(const Tools::CancellationToken &token, const Glib::ustring &href) = 0;
+};
+
+/**
+ * Provider scraping the MobyGames site through the shared HttpClient.
+ */
+class MobyGamesProvider final : public MetadataProvider
+{
+public:
+    MobyGamesProvider();
+
+    virtual Glib::ustring get_name() const override;
+    virtual void search(const Tools::CancellationToken &token, const Glib::ustring &title, const ResultCallback &on_result) override;
+    virtual GameInfo get_game(const Tools::CancellationToken &token, const Glib::ustring &href) override;
+};
+
+/**
+ * Provider reading a key file kept by the user. Each group is a game whose
+ * name is its title, with optional Year, Developer, Publisher, Genre and
+ * Description keys:
+ * @code
+ * [Commander Keen]
+ * Year=1990
+ * Developer=id Software
+ * @endcode
+ * A game matches a search when its title normalized by TitleMatcher contains
+ * the normalized searched title. The file is read on each query, so changes
+ * are seen at once, and a missing file finds nothing.
+ */
+class LocalFileProvider final : public MetadataProvider
+{
+private:
+    std::string m_filename; ///< Games file.
+
+public:
+    explicit LocalFileProvider(const std::string &filename);
+
+    static std::string get_default_filename();
+
+    virtual Glib::ustring get_name() const override;
+    virtual void search(const Tools::CancellationToken &token, const Glib::ustring &title, const ResultCallback &on_result) override;
+    virtual GameInfo get_game(const Tools::CancellationToken &token, const Glib::ustring &href) override;
+};
+
+/**
+ * Provider answering from the offline MetadataIndex imported by the user, so
+ * searches take no network access at all. The index is mapped on the first
+ * query and mapped again when the file is replaced by a new import. A
+ * missing index finds nothing.
+ */
+class OfflineIndexProvider final : public MetadataProvider
+{
+private:
+    std::string m_filename;                       ///< Index file.
+    std::mutex m_mutex;                           ///< Protects m_index, m_inode and m_mtime.
+    std::shared_ptr<const MetadataIndex> m_index; ///< Mapped index, null if there is none.
+    uint64_t m_inode = 0;                         ///< Inode of the mapped file.
+    int64_t m_mtime  = 0;                         ///< Modification time of the mapped file.
+
+    std::shared_ptr<const MetadataIndex> get_index();
+
+public:
+    explicit OfflineIndexProvider(const std::string &filename);
+
+    virtual Glib::ustring get_name() const override;
+    virtual void search(const Tools::CancellationToken &token, const Glib::ustring &title, const ResultCallback &on_result) override;
+    virtual GameInfo get_game(const Tools::CancellationToken &token, const Glib::ustring &href) override;
+};
+
+} // DOSBoxGTK
+
+#endif // METADATAPROVIDER_H
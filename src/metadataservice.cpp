@@ -0,0 +1,278 @@
+/**
+ * @file
+ * MetadataService class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "metadataservice.h"
+#include "async.hpp"
+#include "allocaccounting.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * State of a hedged search shared by the queries of its providers.
+ */
+struct MetadataService::Search
+{
+    Tools::CancellationToken token;               ///< Token of the whole search.
+    Glib::ustring title;                          ///< Searched title.
+    std::vector<Entry> entries;                   ///< Queried providers, the fallback ones last.
+    std::vector<Tools::CancellationToken> tokens; ///< Token of each provider query, children of token.
+    type_result_callback on_result;               ///< Called on the main loop for each result of the winner.
+    type_finished_callback on_finished;           ///< Called on the main loop when the search ends.
+    std::mutex mutex;                             ///< Protects the following members.
+    bool has_winner     = false;                  ///< Whether a provider has found a game.
+    std::size_t winner  = 0,                      ///< Index of the provider which found a game first.
+                started = 0,                      ///< Number of provider queries started.
+                pending = 0;                      ///< Provider queries started and not finished yet.
+};
+
+/**
+ * Starts the queries of the next tier of providers: the ones which are not
+ * fallbacks, or the fallbacks if every other one has been queried. Called
+ * with the search mutex locked, or before the search is shared.
+ * @param search Search.
+ */
+void MetadataService::start_queries(const std::shared_ptr<Search> &search)
+{
+    auto begin = search->started;
+    auto end   = begin;
+
+    while (end < search->entries.size() && (end == begin || search->entries[end].fallback == search->entries[begin].fallback)) {
+        ++end;
+    }
+
+    search->started = end;
+    search->pending = end - begin;
+
+    for (auto i = begin; i < end; ++i) {
+        Tools::ThreadPool::get_default().push([search, i] {
+            run_search(search, i);
+        });
+    }
+}
+
+/**
+ * Queries a provider for a search. Run by a worker thread.
+ * @param search Search.
+ * @param index Index of the provider.
+ */
+void MetadataService::run_search(const std::shared_ptr<Search> &search, std::size_t index)
+{
+    ALLOC_SCOPE(Tools::AllocTag::NETWORK);
+    auto &entry = search->entries[index];
+    auto &token = search->tokens[index];
+    auto start  = std::chrono::steady_clock::now();
+
+    try {
+        entry.provider->search(token, search->title, [&search, &entry, index](const GameSearchResult &result) {
+            {
+                std::lock_guard<std::mutex> lock(search->mutex);
+
+                if (!search->has_winner) {
+                    search->has_winner = true;
+                    search->winner     = index;
+                    entry.wins->add();
+
+                    for (std::size_t i = 0; i < search->tokens.size(); ++i) {
+                        if (i != index) {
+                            search->tokens[i].cancel();
+                        }
+                    }
+                } else if (search->winner != index) {
+                    return;
+                }
+            }
+
+            Tools::invoke_on_main_context([search, result] {
+                if (!search->token.is_cancelled()) {
+                    search->on_result(result);
+                }
+            });
+        });
+    } catch (const Glib::Exception &e) {
+        if (!token.is_cancelled()) {
+            entry.errors->add();
+            LOG_WARNING(Tools::LogCategory::NETWORK, "%1 search failed: %2", entry.provider->get_id(), e.what());
+        }
+    } catch (const std::exception &e) {
+        if (!token.is_cancelled()) {
+            entry.errors->add();
+            LOG_WARNING(Tools::LogCategory::NETWORK, "%1 search failed: %2", entry.provider->get_id(), e.what());
+        }
+    }
+
+    if (token.is_cancelled()) {
+        entry.cancelled->add();
+    } else {
+        entry.latency->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    std::lock_guard<std::mutex> lock(search->mutex);
+
+    --search->pending;
+
+    // Nothing found yet, the fallback providers are the next to try.
+    if (!search->has_winner && search->pending == 0 && search->started < search->entries.size()) {
+        start_queries(search);
+
+        return;
+    }
+
+    // The search ends with its winner, or with the last provider if none
+    // found anything. The cancelled providers finish on their own.
+    if ((search->has_winner && search->winner == index) || (!search->has_winner && search->pending == 0)) {
+        Tools::invoke_on_main_context([search] {
+            if (!search->token.is_cancelled() && search->on_finished) {
+                search->on_finished();
+            }
+        });
+    }
+}
+
+/**
+ * Gets the service used by the application: the offline database and the
+ * default local games file are queried first, and the MobyGames site only if
+ * they find nothing.
+ * @return Default service.
+ */
+MetadataService &MetadataService::get_default()
+{
+    static MetadataService *service = [] {
+        auto service = new MetadataService();
+
+        service->add_provider(std::make_shared<OfflineIndexProvider>(MetadataIndex::get_default_filename()));
+        service->add_provider(std::make_shared<LocalFileProvider>(LocalFileProvider::get_default_filename()));
+        service->add_provider(std::make_shared<MobyGamesProvider>(), true);
+
+        return service;
+    }();
+
+    return *service;
+}
+
+/**
+ * Registers a provider.
+ * @param provider Provider.
+ * @param fallback Whether it must only be queried when the providers which
+ * are not fallbacks find nothing.
+ */
+void MetadataService::add_provider(std::shared_ptr<MetadataProvider> provider, bool fallback)
+{
+    auto prefix = "dosboxgtk_metadata_" + provider->get_id();
+    Entry entry{provider,
+                fallback,
+                &Tools::Metrics::get_histogram(prefix + "_seconds", "Duration of the " + provider->get_id() + " metadata queries not cancelled."),
+                &Tools::Metrics::get_counter(prefix + "_errors_total", "Failed " + provider->get_id() + " metadata queries."),
+                &Tools::Metrics::get_counter(prefix + "_wins_total", "Game searches answered first by " + provider->get_id() + "."),
+                &Tools::Metrics::get_counter(prefix + "_cancelled_total", "Cancelled " + provider->get_id() + " metadata queries.")};
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+    auto position = fallback ? this->m_entries.end() : std::find_if(this->m_entries.begin(), this->m_entries.end(), [](const Entry &entry) {
+        return entry.fallback;
+    });
+
+    this->m_entries.insert(position, std::move(entry));
+}
+
+/**
+ * Searches the providers for a game title and delivers the results of the
+ * first one finding a game. It returns at once, the callbacks are called on
+ * the main loop unless the token has been cancelled by then.
+ * @param token Cancellation token. Cancelling it cancels every query.
+ * @param title Game title.
+ * @param on_result Called for each game found by the winner.
+ * @param on_finished Called, if any, when the winner has delivered every
+ * result or when every provider has finished without finding anything.
+ */
+void MetadataService::search(const Tools::CancellationToken &token, const Glib::ustring &title, type_result_callback on_result, type_finished_callback on_finished)
+{
+    auto search = std::make_shared<Search>();
+
+    search->token       = token;
+    search->title       = title;
+    search->on_result   = std::move(on_result);
+    search->on_finished = std::move(on_finished);
+
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+
+        search->entries = this->m_entries;
+    }
+
+    if (search->entries.empty()) {
+        Tools::invoke_on_main_context([search] {
+            if (!search->token.is_cancelled() && search->on_finished) {
+                search->on_finished();
+            }
+        });
+
+        return;
+    }
+
+    // Every token is created before any query starts, so the winner can
+    // cancel all of them.
+    for (std::size_t i = 0; i < search->entries.size(); ++i) {
+        search->tokens.push_back(token.create_child());
+    }
+
+    std::lock_guard<std::mutex> lock(search->mutex);
+
+    start_queries(search);
+}
+
+/**
+ * Gets the information of a game from the provider which found it. It
+ * blocks, so it must be called from the thread pool.
+ * @param token Cancellation token.
+ * @param result Search result.
+ * @return Game information.
+ */
+GameInfo MetadataService::get_game(const Tools::CancellationToken &token, const GameSearchResult &result)
+{
+    Entry entry;
+
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        auto iter = std::find_if(this->m_entries.begin(), this->m_entries.end(), [&result](const Entry &entry) {
+            return entry.provider->get_name() == result.provider;
+        });
+
+        if (iter == this->m_entries.end()) {
+            throw std::runtime_error("Unknown metadata provider: " + result.provider.raw());
+        }
+
+        entry = *iter;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    try {
+        auto info = entry.provider->get_game(token, result.href);
+
+        entry.latency->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        return info;
+    } catch (...) {
+        if (token.is_cancelled()) {
+            entry.cancelled->add();
+        } else {
+            entry.errors->add();
+            entry.latency->observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        throw;
+    }
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,79 @@
+/**
+ * @file
+ * MetadataService class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef METADATASERVICE_H
+#define METADATASERVICE_H
+
+#include "metadataprovider.h"
+#include "metrics.hpp"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Queries the registered MetadataProvider instances in parallel with
+ * hedging. A search runs each provider in its own pool task with a child of
+ * the search token. The first provider to find a game wins: its results are
+ * delivered and the other providers are cancelled, so a search takes as long
+ * as the fastest provider with an answer instead of the slowest one.
+ * Providers finding nothing do not win, so the search goes on with the rest.
+ * Fallback providers, like the network ones when there is an offline
+ * database, are only queried once every other provider has found nothing.
+ * The latency, errors, wins and cancellations of each provider are kept in
+ * the metrics registry, named after the provider ID.
+ */
+class MetadataService final
+{
+public:
+    typedef std::function<void(const GameSearchResult&)> type_result_callback;
+    typedef std::function<void()> type_finished_callback;
+
+private:
+    /**
+     * Registered provider and its metrics.
+     */
+    struct Entry
+    {
+        std::shared_ptr<MetadataProvider> provider; ///< Provider.
+        bool fallback;                              ///< Whether it is only queried if the others find nothing.
+        Tools::Histogram *latency;                  ///< Duration of the queries not cancelled.
+        Tools::Counter *errors,                     ///< Failed queries.
+                       *wins,                       ///< Searches won.
+                       *cancelled;                  ///< Queries cancelled, mostly by a faster provider.
+    };
+
+    struct Search;
+
+    mutable std::mutex m_mutex;   ///< Protects m_entries.
+    std::vector<Entry> m_entries; ///< Registered providers.
+
+    static void start_queries(const std::shared_ptr<Search> &search);
+    static void run_search(const std::shared_ptr<Search> &search, std::size_t index);
+
+public:
+    MetadataService() {}
+
+    MetadataService(const MetadataService&) = delete;
+    MetadataService &operator=(const MetadataService&) = delete;
+
+    static MetadataService &get_default();
+
+    void add_provider(std::shared_ptr<MetadataProvider> provider, bool fallback = false);
+    void search(const Tools::CancellationToken &token, const Glib::ustring &title, type_result_callback on_result, type_finished_callback on_finished);
+    GameInfo get_game(const Tools::CancellationToken &token, const GameSearchResult &result);
+};
+
+} // DOSBoxGTK
+
+#endif // METADATASERVICE_H
@@ -0,0 +1,358 @@
+/**
+ * @file
+ * Metrics registry implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "metrics.hpp"
+#include "log.hpp"
+#include "threadpool.hpp"
+#include <glibmm/main.h>
+#include <algorithm>
+#include <cstdio>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Gets the shard used by the calling thread. Threads are assigned shards in
+ * round robin the first time they update a metric.
+ * @return Shard index.
+ */
+static unsigned get_shard_index()
+{
+    static std::atomic<unsigned> next_index(0);
+    thread_local unsigned index = next_index.fetch_add(1, std::memory_order_relaxed) % METRICS_SHARDS;
+
+    return index;
+}
+
+/**
+ * Formats a number the way the Prometheus text format expects it.
+ * @param value Number to be formatted.
+ * @return Formatted number.
+ */
+static std::string format_number(double value)
+{
+    char buffer[32];
+
+    std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+
+    return buffer;
+}
+
+/**
+ * Adds to the counter.
+ * @param n Amount to add.
+ */
+void Counter::add(uint64_t n)
+{
+    this->m_shards[get_shard_index()].value.fetch_add(n, std::memory_order_relaxed);
+}
+
+/**
+ * Gets the counter value. Updates made at the same time may be missed.
+ * @return Sum of every shard.
+ */
+uint64_t Counter::get() const
+{
+    uint64_t value = 0;
+
+    for (auto &shard : this->m_shards) {
+        value += shard.value.load(std::memory_order_relaxed);
+    }
+
+    return value;
+}
+
+/**
+ * Gets the mean of the observed values.
+ * @return Mean value, or 0 if there are no observations.
+ */
+double HistogramSnapshot::get_mean() const
+{
+    return this->count > 0 ? this->sum / this->count : 0;
+}
+
+/**
+ * Estimates a quantile interpolating linearly inside its bucket. Values in the
+ * unbounded bucket are estimated as the last bound.
+ * @param q Quantile, between 0 and 1.
+ * @return Estimated value, or 0 if there are no observations.
+ */
+double HistogramSnapshot::get_quantile(double q) const
+{
+    if (this->count == 0) {
+        return 0;
+    }
+
+    auto rank = q * this->count;
+    uint64_t seen = 0;
+
+    for (size_t i = 0; i < this->buckets.size(); ++i) {
+        if (this->buckets[i] == 0 || seen + this->buckets[i] < rank) {
+            seen += this->buckets[i];
+            continue;
+        }
+
+        if (i == this->bounds.size()) {
+            return this->bounds.empty() ? 0 : this->bounds.back();
+        }
+
+        auto lower = i > 0 ? this->bounds[i - 1] : 0;
+
+        return lower + (this->bounds[i] - lower) * (rank - seen) / this->buckets[i];
+    }
+
+    return this->bounds.empty() ? 0 : this->bounds.back();
+}
+
+/**
+ * Constructor.
+ * @param bounds Increasing upper bounds of the buckets. An unbounded bucket is
+ * added after the last one.
+ */
+Histogram::Histogram(const std::vector<double> &bounds) :
+    m_bounds(bounds), m_shards(new Shard[METRICS_SHARDS])
+{
+    for (unsigned i = 0; i < METRICS_SHARDS; ++i) {
+        this->m_shards[i].buckets = std::vector<std::atomic<uint64_t>>(bounds.size() + 1);
+    }
+}
+
+/**
+ * Adds an observation.
+ * @param value Observed value.
+ */
+void Histogram::observe(double value)
+{
+    auto &shard = this->m_shards[get_shard_index()];
+    auto bucket = std::lower_bound(this->m_bounds.begin(), this->m_bounds.end(), value) - this->m_bounds.begin();
+
+    shard.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+/**
+ * Gets the histogram values. Updates made at the same time may be missed.
+ * @return Sum of every shard.
+ */
+HistogramSnapshot Histogram::get() const
+{
+    HistogramSnapshot snapshot;
+
+    snapshot.bounds = this->m_bounds;
+    snapshot.buckets.resize(this->m_bounds.size() + 1);
+
+    for (unsigned i = 0; i < METRICS_SHARDS; ++i) {
+        auto &shard = this->m_shards[i];
+
+        for (size_t bucket = 0; bucket < snapshot.buckets.size(); ++bucket) {
+            auto n = shard.buckets[bucket].load(std::memory_order_relaxed);
+
+            snapshot.buckets[bucket] += n;
+            snapshot.count += n;
+        }
+
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+    }
+
+    return snapshot;
+}
+
+/**
+ * Gets the registry instance, creating it the first time.
+ * @return The registry.
+ */
+Metrics &Metrics::get_instance()
+{
+    static Metrics instance;
+
+    return instance;
+}
+
+/**
+ * Gets the default histogram bounds, suited to durations in seconds.
+ * @return Bounds from 1 ms to 10 s.
+ */
+const std::vector<double> &Metrics::get_latency_bounds()
+{
+    static const std::vector<double> bounds = {0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+
+    return bounds;
+}
+
+/**
+ * Gets a counter, registering it the first time.
+ * @param name Metric name, following the Prometheus naming rules.
+ * @param help Metric description.
+ * @return The counter.
+ */
+Counter &Metrics::get_counter(const std::string &name, const std::string &help)
+{
+    auto &instance = get_instance();
+    std::lock_guard<std::mutex> lock(instance.m_mutex);
+    auto &entry = instance.m_entries[name];
+
+    if (!entry.counter) {
+        entry.help = help;
+        entry.counter.reset(new Counter());
+    }
+
+    return *entry.counter;
+}
+
+/**
+ * Gets the counter of the regular expressions compiled on each use, shared
+ * by every module still doing so.
+ * @return The counter.
+ */
+Counter &Metrics::get_regex_compilations()
+{
+    static auto &counter = get_counter("dosboxgtk_regex_compilations_total", "Regular expressions compiled on each use.");
+
+    return counter;
+}
+
+/**
+ * Gets a histogram, registering it the first time.
+ * @param name Metric name, following the Prometheus naming rules.
+ * @param help Metric description.
+ * @param bounds Bucket bounds. Ignored if the histogram is already registered.
+ * @return The histogram.
+ */
+Histogram &Metrics::get_histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds)
+{
+    auto &instance = get_instance();
+    std::lock_guard<std::mutex> lock(instance.m_mutex);
+    auto &entry = instance.m_entries[name];
+
+    if (!entry.histogram) {
+        entry.help = help;
+        entry.histogram.reset(new Histogram(bounds));
+    }
+
+    return *entry.histogram;
+}
+
+/**
+ * Gets the value of every registered metric.
+ * @return Samples sorted by name.
+ */
+std::vector<MetricSample> Metrics::collect()
+{
+    auto &instance = get_instance();
+    std::lock_guard<std::mutex> lock(instance.m_mutex);
+    std::vector<MetricSample> samples;
+
+    for (auto &entry : instance.m_entries) {
+        MetricSample sample;
+
+        sample.name = entry.first;
+        sample.help = entry.second.help;
+
+        if (entry.second.histogram) {
+            sample.is_histogram = true;
+            sample.histogram = entry.second.histogram->get();
+        } else {
+            sample.value = entry.second.counter->get();
+        }
+
+        samples.push_back(std::move(sample));
+    }
+
+    return samples;
+}
+
+/**
+ * Formats every registered metric in the Prometheus text exposition format.
+ * @return Formatted metrics.
+ */
+std::string Metrics::to_prometheus()
+{
+    std::string text;
+
+    for (auto &sample : collect()) {
+        text += "# HELP " + sample.name + " " + sample.help + "\n";
+
+        if (!sample.is_histogram) {
+            text += "# TYPE " + sample.name + " counter\n";
+            text += sample.name + " " + std::to_string(sample.value) + "\n";
+            continue;
+        }
+
+        auto &histogram = sample.histogram;
+        uint64_t cumulative = 0;
+
+        text += "# TYPE " + sample.name + " histogram\n";
+
+        for (size_t i = 0; i < histogram.bounds.size(); ++i) {
+            cumulative += histogram.buckets[i];
+            text += sample.name + "_bucket{le=\"" + format_number(histogram.bounds[i]) + "\"} " + std::to_string(cumulative) + "\n";
+        }
+
+        text += sample.name + "_bucket{le=\"+Inf\"} " + std::to_string(histogram.count) + "\n";
+        text += sample.name + "_sum " + format_number(histogram.sum) + "\n";
+        text += sample.name + "_count " + std::to_string(histogram.count) + "\n";
+    }
+
+    return text;
+}
+
+/**
+ * Writes every registered metric to a textfile for the node exporter textfile
+ * collector. The file is replaced once completely written, so the collector
+ * never reads a partial file.
+ * @param filename Destination file. Its name should end with ".prom".
+ * @return @c TRUE on success or @c FALSE otherwise.
+ */
+bool Metrics::write_textfile(const std::string &filename)
+{
+    auto text = to_prometheus();
+    auto temp_filename = filename + ".tmp";
+    auto file = std::fopen(temp_filename.c_str(), "w");
+
+    if (file == nullptr) {
+        LOG_WARNING(LogCategory::GENERAL, "Can not open metrics file %1", temp_filename);
+        return false;
+    }
+
+    auto written = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+
+    if (std::fclose(file) != 0 || !written || std::rename(temp_filename.c_str(), filename.c_str()) != 0) {
+        LOG_WARNING(LogCategory::GENERAL, "Can not write metrics file %1", filename);
+        std::remove(temp_filename.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Writes the metrics textfile periodically from the thread pool. A write is
+ * skipped if the previous one has not finished yet.
+ * @param filename Destination file.
+ * @param interval Seconds between writes, at least 1.
+ */
+void Metrics::start_textfile_export(const std::string &filename, unsigned interval)
+{
+    static std::atomic<bool> writing(false);
+
+    Glib::signal_timeout().connect_seconds([filename] {
+        if (!writing.exchange(true)) {
+            ThreadPool::get_default().push([filename] {
+                write_textfile(filename);
+                writing.store(false);
+            });
+        }
+
+        return true;
+    }, std::max(interval, 1u));
+}
+
+} // Tools
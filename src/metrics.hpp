@@ -0,0 +1,180 @@
+/**
+ * @file
+ * Metrics registry declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define METRICS_SHARDS 16                                     ///< Number of shards of each metric. Threads are spread among them.
+#define METRICS_FILE_ENV_VAR "DOSBOXGTK_METRICS_FILE"         ///< Environment variable with the Prometheus textfile.
+#define METRICS_INTERVAL_ENV_VAR "DOSBOXGTK_METRICS_INTERVAL" ///< Environment variable with the textfile export interval in seconds.
+#define METRICS_DEFAULT_INTERVAL 60                           ///< Default textfile export interval in seconds.
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Monotonically increasing counter. Each thread adds to its own shard, so
+ * concurrent updates do not fight for the same cache line.
+ */
+class Counter final
+{
+private:
+    /**
+     * Counter part updated by a subset of the threads.
+     */
+    struct alignas(64) Shard
+    {
+        std::atomic<uint64_t> value{0}; ///< Shard's count.
+    };
+
+    Shard m_shards[METRICS_SHARDS]; ///< Counter shards.
+
+public:
+    void add(uint64_t n = 1);
+    uint64_t get() const;
+};
+
+/**
+ * Values of a histogram at a given moment.
+ */
+struct HistogramSnapshot
+{
+    std::vector<double> bounds;    ///< Upper bound of each bucket but the last one, which is unbounded.
+    std::vector<uint64_t> buckets; ///< Observations in each bucket, not cumulative.
+    double sum     = 0;            ///< Sum of the observed values.
+    uint64_t count = 0;            ///< Number of observations.
+
+    double get_mean() const;
+    double get_quantile(double q) const;
+};
+
+/**
+ * Distribution of observed values over fixed buckets. Sharded like Counter.
+ */
+class Histogram final
+{
+private:
+    /**
+     * Histogram part updated by a subset of the threads.
+     */
+    struct alignas(64) Shard
+    {
+        std::vector<std::atomic<uint64_t>> buckets; ///< Observations in each bucket.
+        std::atomic<double> sum{0};                 ///< Sum of the observed values.
+    };
+
+    std::vector<double> m_bounds;      ///< Upper bound of each bucket but the last one.
+    std::unique_ptr<Shard[]> m_shards; ///< Histogram shards.
+
+public:
+    explicit Histogram(const std::vector<double> &bounds);
+
+    void observe(double value);
+    HistogramSnapshot get() const;
+};
+
+/**
+ * Records the lifetime of a scope, in seconds, in a histogram.
+ */
+class MetricsTimer final
+{
+private:
+    Histogram &m_histogram;                        ///< Destination histogram.
+    std::chrono::steady_clock::time_point m_start; ///< Scope start time.
+
+public:
+    /**
+     * Constructor. Starts timing.
+     * @param histogram Histogram receiving the duration.
+     */
+    explicit MetricsTimer(Histogram &histogram) :
+        m_histogram(histogram), m_start(std::chrono::steady_clock::now())
+    {}
+
+    /**
+     * Destructor. Records the duration.
+     */
+    ~MetricsTimer()
+    {
+        this->m_histogram.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - this->m_start).count());
+    }
+
+    MetricsTimer(const MetricsTimer&) = delete;
+    MetricsTimer &operator=(const MetricsTimer&) = delete;
+};
+
+/**
+ * Value of a registered metric, as returned by Metrics::collect().
+ */
+struct MetricSample
+{
+    std::string name;            ///< Metric name.
+    std::string help;            ///< Metric description.
+    bool is_histogram = false;   ///< Whether it is a histogram or a counter.
+    uint64_t value = 0;          ///< Counter value.
+    HistogramSnapshot histogram; ///< Histogram values.
+};
+
+/**
+ * Process wide registry of always-on metrics. Metrics are registered by name
+ * the first time they are requested and live until the process ends, so the
+ * returned references can be kept in static variables:
+ * @code
+ * static auto &launches = Tools::Metrics::get_counter("dosboxgtk_launches_total", "DOSBox launches.");
+ * launches.add();
+ * @endcode
+ */
+class Metrics final
+{
+private:
+    /**
+     * Registered metric.
+     */
+    struct Entry
+    {
+        std::string help;                     ///< Metric description.
+        std::unique_ptr<Counter> counter;     ///< Counter, if it is one.
+        std::unique_ptr<Histogram> histogram; ///< Histogram, if it is one.
+    };
+
+    std::mutex m_mutex;                     ///< Protects m_entries.
+    std::map<std::string, Entry> m_entries; ///< Metrics by name.
+
+    Metrics() {}
+
+    static Metrics &get_instance();
+
+public:
+    Metrics(const Metrics&) = delete;
+    Metrics &operator=(const Metrics&) = delete;
+
+    static const std::vector<double> &get_latency_bounds();
+    static Counter &get_counter(const std::string &name, const std::string &help);
+    static Histogram &get_histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds = get_latency_bounds());
+    static Counter &get_regex_compilations();
+    static std::vector<MetricSample> collect();
+    static std::string to_prometheus();
+    static bool write_textfile(const std::string &filename);
+    static void start_textfile_export(const std::string &filename, unsigned interval);
+};
+
+} // Tools
+
+#endif // METRICS_HPP
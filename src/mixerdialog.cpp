@@ -8,6 +8,7 @@
 
 #include "mixerdialog.h"
 #include "config.h"
+#include "metrics.hpp"
 #include <glibmm/stringutils.h>
 #include <glibmm/regex.h>
 #include <gtkmm/grid.h>
@@ -158,46 +159,62 @@ Glib::ustring MixerDialog::get_mixer_command() const
  */
 void MixerDialog::parse_command(const Glib::ustring &command)
 {
+    for (auto &level : parse_levels(command)) {
+        auto &device = level.device;
+        auto left    = level.left,
+             right   = level.right;
+
+        if (device == "master") {
+            this->m_master_lock_cb->set_active(left == right);
+            this->m_master_left->set_value(left);
+            this->m_master_right->set_value(right);
+        } else if (device == "spkr") {
+            this->m_speaker_lock_cb->set_active(left == right);
+            this->m_speaker_left->set_value(left);
+            this->m_speaker_right->set_value(right);
+        } else if (device == "sb") {
+            this->m_sb_lock_cb->set_active(left == right);
+            this->m_sb_left->set_value(left);
+            this->m_sb_right->set_value(right);
+        } else if (device == "gus") {
+            this->m_gus_lock_cb->set_active(left == right);
+            this->m_gus_left->set_value(left);
+            this->m_gus_right->set_value(right);
+        } else if (device == "fm") {
+            this->m_tandy_lock_cb->set_active(left == right);
+            this->m_tandy_left->set_value(left);
+            this->m_tandy_right->set_value(right);
+        } else if (device == "disney") {
+            this->m_disney_lock_cb->set_active(left == right);
+            this->m_disney_left->set_value(left);
+            this->m_disney_right->set_value(right);
+        } else if (device == "cdaudio") {
+            this->m_cd_lock_cb->set_active(left == right);
+            this->m_cd_left->set_value(left);
+            this->m_cd_right->set_value(right);
+        }
+    }
+}
+
+/**
+ * Retrieves the volumes set by the given mixer command.
+ * @param command DOSBox MIXER.COM command.
+ * @return Volume of each device in the command, in order.
+ */
+std::vector<MixerLevel> MixerDialog::parse_levels(const Glib::ustring &command)
+{
+    Tools::Metrics::get_regex_compilations().add();
     Glib::RefPtr<Glib::Regex> regex = Glib::Regex::create("([a-z]+) ([0-9]+):([0-9]+)", Glib::REGEX_CASELESS);
     Glib::MatchInfo info;
+    std::vector<MixerLevel> levels;
 
     if (regex->match(command, 0, info)) {
         do {
-            Glib::ustring device = info.fetch(1).lowercase();
-            double left   = Glib::Ascii::strtod(info.fetch(2)),
-                   right  = Glib::Ascii::strtod(info.fetch(3));
-
-            if (device == "master") {
-                this->m_master_lock_cb->set_active(left == right);
-                this->m_master_left->set_value(left);
-                this->m_master_right->set_value(right);
-            } else if (device == "spkr") {
-                this->m_speaker_lock_cb->set_active(left == right);
-                this->m_speaker_left->set_value(left);
-                this->m_speaker_right->set_value(right);
-            } else if (device == "sb") {
-                this->m_sb_lock_cb->set_active(left == right);
-                this->m_sb_left->set_value(left);
-                this->m_sb_right->set_value(right);
-            } else if (device == "gus") {
-                this->m_gus_lock_cb->set_active(left == right);
-                this->m_gus_left->set_value(left);
-                this->m_gus_right->set_value(right);
-            } else if (device == "fm") {
-                this->m_tandy_lock_cb->set_active(left == right);
-                this->m_tandy_left->set_value(left);
-                this->m_tandy_right->set_value(right);
-            } else if (device == "disney") {
-                this->m_disney_lock_cb->set_active(left == right);
-                this->m_disney_left->set_value(left);
-                this->m_disney_right->set_value(right);
-            } else if (device == "cdaudio") {
-                this->m_cd_lock_cb->set_active(left == right);
-                this->m_cd_left->set_value(left);
-                this->m_cd_right->set_value(right);
-            }
+            levels.push_back({info.fetch(1).lowercase(), Glib::Ascii::strtod(info.fetch(2)), Glib::Ascii::strtod(info.fetch(3))});
         } while (info.next());
     }
+
+    return levels;
 }
 
 } // DOSBoxGTK
@@ -13,6 +13,7 @@
 #include <gtkmm/builder.h>
 #include <gtkmm/adjustment.h>
 #include <gtkmm/checkbutton.h>
+#include <vector>
 
 /**
  * DOSBoxGTK namespace.
@@ -20,6 +21,16 @@
 namespace DOSBoxGTK
 {
 
+/**
+ * Volume of a sound device in a MIXER command.
+ */
+struct MixerLevel
+{
+    Glib::ustring device; ///< Lowercase device name.
+    double left,          ///< Left channel volume.
+           right;         ///< Right channel volume.
+};
+
 /**
  * Dialog used to set the sound devices volumes.
  */
@@ -52,6 +63,8 @@ public:
 
     Glib::ustring get_mixer_command() const;
     void parse_command(const Glib::ustring &command);
+
+    static std::vector<MixerLevel> parse_levels(const Glib::ustring &command);
 };
 
 } // DOSBoxGTK
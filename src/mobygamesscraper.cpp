@@ -0,0 +1,233 @@
+/**
+ * @file
+ * MobyGamesScraper class definition.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "mobygamesscraper.h"
+#include "htmldocument.hpp"
+#include "trace.hpp"
+#include <curlpp/cURLpp.hpp>
+#include <cstring>
+#include <map>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Checks whether a text ends with the given string.
+ * @param text Text.
+ * @param suffix String.
+ * @return @c TRUE if the text ends with the string or @c FALSE otherwise.
+ */
+bool SearchResultsParser::ends_with(const std::string &text, const std::string &suffix)
+{
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * Starts capturing a game link or its DOS year, depending on the text right
+ * before the element.
+ * @param name Element name.
+ * @param attributes Element attributes.
+ */
+void SearchResultsParser::on_start_element(const char *name, const char **attributes)
+{
+    auto preceding_text = normalize_space(this->m_text);
+
+    this->m_text.clear();
+    ++this->m_depth;
+
+    if (this->m_capture_depth != 0) {
+        return;
+    }
+
+    if (std::strcmp(name, "a") == 0) {
+        auto href = get_attribute(attributes, "href");
+
+        if (href != nullptr && std::strncmp(href, "/game/", 6) == 0 && ends_with(preceding_text, "Game:")) {
+            this->m_current = GameSearchResult();
+            this->m_current.href   = href;
+            this->m_capture_depth   = this->m_depth;
+            this->m_capturing_title = true;
+            // The title block and the platforms share the link grandparent.
+            this->m_row_depth = this->m_depth > 2 ? this->m_depth - 2 : 1;
+            this->m_capture.clear();
+        }
+    } else if (std::strcmp(name, "em") == 0 && this->m_row_depth != 0 && ends_with(preceding_text, "DOS (")) {
+        this->m_capture_depth   = this->m_depth;
+        this->m_capturing_title = false;
+        this->m_capture.clear();
+    }
+}
+
+/**
+ * Ends the capture of a game link or year, reporting the game once its year
+ * is known.
+ * @param name Element name.
+ */
+void SearchResultsParser::on_end_element(const char *name)
+{
+    this->m_text.clear();
+
+    if (this->m_capture_depth != 0 && this->m_capture_depth == this->m_depth) {
+        this->m_capture_depth = 0;
+
+        if (this->m_capturing_title) {
+            this->m_current.title = normalize_space(this->m_capture);
+        } else {
+            this->m_current.year = normalize_space(this->m_capture);
+            this->m_row_depth = 0;
+            this->m_on_result(this->m_current);
+        }
+    }
+
+    if (this->m_depth == this->m_row_depth) {
+        this->m_row_depth = 0;
+    }
+
+    if (this->m_depth > 0) {
+        --this->m_depth;
+    }
+}
+
+/**
+ * Accumulates the text before the next element and the captured text.
+ * @param text Text.
+ * @param length Text length in bytes.
+ */
+void SearchResultsParser::on_text(const char *text, std::size_t length)
+{
+    this->m_text.append(text, length);
+
+    if (this->m_capture_depth != 0) {
+        this->m_capture.append(text, length);
+    }
+}
+
+/**
+ * Constructor.
+ * @param on_result Function called with each game found, from the thread
+ * feeding the parser.
+ */
+SearchResultsParser::SearchResultsParser(std::function<void(const GameSearchResult&)> on_result) :
+    m_on_result(std::move(on_result))
+{}
+
+/**
+ * Gets the POST data of a quick search, to be sent to MOBYGAMES_URL
+ * "/search/quick".
+ * @param title Game title to look for.
+ * @return POST request data.
+ */
+std::string MobyGamesScraper::get_search_fields(const Glib::ustring &title)
+{
+    return "game=" + curlpp::escape(title) + "&p=2&search=go";
+}
+
+/**
+ * Gets the games of a quick search results page.
+ * @param html Search results page.
+ * @return Games in the page order.
+ */
+std::vector<GameSearchResult> MobyGamesScraper::parse_search_results(const std::string &html)
+{
+    TRACE_SCOPE("MobyGamesScraper::parse_search_results");
+    std::vector<GameSearchResult> results;
+    SearchResultsParser parser([&results](const GameSearchResult &result) {
+        results.push_back(result);
+    });
+
+    parser.feed(html.data(), html.size());
+    parser.finish();
+
+    return results;
+}
+
+/**
+ * Gets the information of a game page.
+ * @param html Game page.
+ * @return Game information.
+ */
+GameInfo MobyGamesScraper::parse_game_page(const std::string &html)
+{
+    TRACE_SCOPE("MobyGamesScraper::parse_game_page");
+    Tools::HtmlDocument document(html);
+    GameInfo info;
+    std::map<std::string, xmlNodePtr> values = {{"Published by", nullptr}, {"Developed by", nullptr}, {"Genre", nullptr}, {"Released", nullptr}};
+
+    // Each value is the first link of the div following its label div. The
+    // labels only hold text, so only the divs without child elements are
+    // compared, each one once, instead of the text of every div per label.
+    for (auto label : document.find("//div[not(*)]")) {
+        auto value = values.find(Tools::HtmlDocument::get_text(label));
+
+        if (value == values.end() || value->second != nullptr) {
+            continue;
+        }
+
+        auto node = label->next;
+
+        while (node != nullptr && !Tools::HtmlDocument::is_element(node, "div")) {
+            node = node->next;
+        }
+
+        value->second = node;
+    }
+
+    auto get_value = [&document, &values](const std::string &label) {
+        auto node = values[label];
+
+        return Glib::ustring(node == nullptr ? std::string() : Tools::HtmlDocument::get_text(document.find_first(".//a[1]", node)));
+    };
+
+    info.title     = Tools::HtmlDocument::get_text(document.find_first("//h1[contains(concat(' ', normalize-space(@class), ' '), ' niceHeaderTitle ')]/a[1]"));
+    info.publisher = get_value("Published by");
+    info.developer = get_value("Developed by");
+    info.genre     = get_value("Genre");
+
+    auto released = get_value("Released");
+
+    if (released.size() >= 4) {
+        info.year = released.substr(released.size() - 4);
+    }
+
+    // The description is the text after its header, up to the next block.
+    // Runs of line breaks separate paragraphs.
+    auto header = document.find_first("//h2[normalize-space() = 'Description']");
+
+    if (header != nullptr) {
+        std::string description;
+
+        for (auto node = header->next; node != nullptr && !Tools::HtmlDocument::is_element(node, "div"); node = node->next) {
+            auto text = Tools::HtmlDocument::get_text(node, true);
+
+            if (Tools::HtmlDocument::is_element(node, "br")) {
+                if (!description.empty() && description.back() != '\n') {
+                    description += '\n';
+                }
+            } else if (!text.empty()) {
+                if (!description.empty() && description.back() != '\n') {
+                    description += ' ';
+                }
+
+                description += text;
+            }
+        }
+
+        while (!description.empty() && description.back() == '\n') {
+            description.pop_back();
+        }
+
+        info.description = description;
+    }
+
+    return info;
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,97 @@
+/**
+ * @file
+ * MobyGamesScraper class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef MOBYGAMESSCRAPER_H
+#define MOBYGAMESSCRAPER_H
+
+#define MOBYGAMES_URL "http://www.mobygames.com" ///< MobyGames site, game pages paths are relative to it.
+
+#include "htmlsaxparser.hpp"
+#include <glibmm/ustring.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Game found by a search.
+ */
+struct GameSearchResult
+{
+    Glib::ustring title,    ///< Game title.
+                  year,     ///< Year of the DOS release.
+                  href,     ///< Game page path, relative to the site, or game ID within its provider.
+                  provider; ///< Name of the MetadataProvider which found the game, if any.
+};
+
+/**
+ * Game information from a MobyGames game page. Fields not found on the page
+ * are empty.
+ */
+struct GameInfo
+{
+    Glib::ustring title,       ///< Game title.
+                  publisher,   ///< Publisher.
+                  developer,   ///< Developer.
+                  year,        ///< Release year.
+                  genre,       ///< Genre.
+                  description; ///< Description, paragraphs separated by new lines.
+};
+
+/**
+ * Incremental parser of MobyGames quick search results pages. Each result has
+ * a "Game: <a href="...">Title</a>" link in a title block followed by its
+ * platforms, the DOS one being "DOS (<em>Year</em>)". A result is reported as
+ * soon as its DOS year has been parsed, so they can be shown while the page is
+ * still downloading. Games without a DOS release are skipped.
+ */
+class SearchResultsParser final : public Tools::HtmlSaxParser
+{
+private:
+    std::function<void(const GameSearchResult&)> m_on_result; ///< Called for each result found.
+    GameSearchResult m_current;       ///< Game being parsed.
+    std::string m_text,               ///< Text since the last element boundary.
+                m_capture;            ///< Text of the link or year being captured.
+    unsigned m_depth         = 0;     ///< Number of open elements.
+    unsigned m_row_depth     = 0;     ///< Depth of the element holding the current game, 0 if there is none.
+    unsigned m_capture_depth = 0;     ///< Depth of the element being captured, 0 if there is none.
+    bool m_capturing_title   = false; ///< Whether the title or the year is being captured.
+
+    static bool ends_with(const std::string &text, const std::string &suffix);
+
+protected:
+    void on_start_element(const char *name, const char **attributes) override;
+    void on_end_element(const char *name) override;
+    void on_text(const char *text, std::size_t length) override;
+
+public:
+    explicit SearchResultsParser(std::function<void(const GameSearchResult&)> on_result);
+};
+
+/**
+ * Extracts game information from MobyGames pages. The pages are parsed with
+ * Tools::HtmlDocument and SearchResultsParser, so extraction takes linear time
+ * and is bounded by their budgets whatever the page contents. The methods do
+ * not use the UI and can be called from the thread pool.
+ */
+class MobyGamesScraper final
+{
+public:
+    static std::string get_search_fields(const Glib::ustring &title);
+    static std::vector<GameSearchResult> parse_search_results(const std::string &html);
+    static GameInfo parse_game_page(const std::string &html);
+};
+
+} // DOSBoxGTK
+
+#endif // MOBYGAMESSCRAPER_H
@@ -9,7 +9,6 @@
 #include "mountcommand.h"
 #include <glibmm/stringutils.h>
 #include <glibmm/regex.h>
-#include <iostream>
 
 /**
  * DOSBoxGTK namespace.
@@ -56,7 +55,7 @@ MountCommand::MountCommand(char letter, const Glib::ustring &host_dir, const Gli
  */
 bool MountCommand::parse(const Glib::ustring &mount_command)
 {
-    auto mount_regex = Glib::Regex::create(PCRE_MOUNT_COMMAND, Glib::REGEX_CASELESS);
+    static auto mount_regex = Glib::Regex::create(PCRE_MOUNT_COMMAND, Glib::REGEX_CASELESS);
     Glib::MatchInfo minfo;
     bool valid_command = mount_regex->match(mount_command, 0, minfo);
 
@@ -141,7 +140,7 @@ Glib::ustring MountCommand::get_command() const
     Glib::ustring command;
 
     if (!this->m_host_dir.empty() && this->m_drive_letter != '\0') {
-        auto has_spaces_regex = Glib::Regex::create("\\s");
+        static auto has_spaces_regex = Glib::Regex::create("\\s");
         Glib::ustring quote;
 
         if (has_spaces_regex->match(this->m_host_dir)) {
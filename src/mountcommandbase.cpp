@@ -7,6 +7,8 @@
  */
 
 #include "mountcommandbase.h"
+#include "mountcommand.h"
+#include "imgmountcommand.h"
 #include <glibmm/i18n.h>
 #include <glibmm/regex.h>
 
@@ -16,6 +18,33 @@
 namespace DOSBoxGTK
 {
 
+/**
+ * Creates the mounting command object for a DOSBox MOUNT or IMGMOUNT command.
+ * @param command String with the DOSBox mounting command.
+ * @return The mounting command or @c nullptr if the string is not a valid
+ * mounting command.
+ */
+std::shared_ptr<MountCommandBase> MountCommandBase::create(const Glib::ustring &command)
+{
+    static auto mounting_command_regex = Glib::Regex::create("^\\s*(?'command'MOUNT|IMGMOUNT)(?:\\.COM){0,1}\\s", Glib::REGEX_CASELESS);
+    Glib::MatchInfo minfo;
+    std::shared_ptr<MountCommandBase> mounting_command;
+
+    if (mounting_command_regex->match(command, 0, minfo)) {
+        if (minfo.fetch_named("command").uppercase() == "MOUNT") {
+            mounting_command = std::make_shared<MountCommand>(command);
+        } else {
+            mounting_command = std::make_shared<ImgmountCommand>(command);
+        }
+
+        if (mounting_command->get_letter() == '\0') {
+            mounting_command.reset();
+        }
+    }
+
+    return mounting_command;
+}
+
 /**
  * Gets the dirve letter of the mounting point.
  * @return Drive letter.
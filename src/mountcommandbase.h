@@ -10,6 +10,7 @@
 #define DOSBOXCOMMAND_H
 
 #include <glibmm/ustring.h>
+#include <memory>
 #include <vector>
 
 /**
@@ -29,6 +30,8 @@ protected:
 public:
     virtual ~MountCommandBase() {}
 
+    static std::shared_ptr<MountCommandBase> create(const Glib::ustring &command);
+
     virtual bool parse(const Glib::ustring &command) = 0;
     virtual Glib::ustring get_command() const = 0;
     virtual const char &get_letter() const;
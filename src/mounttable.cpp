@@ -0,0 +1,234 @@
+/**
+ * @file
+ * DriveLetterSet and MountTable classes implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "mounttable.h"
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Gets the bit of a drive letter.
+ * @param letter Drive letter, lower or upper case.
+ * @return Bit mask of the letter or 0 if it is not a valid drive letter.
+ */
+guint32 DriveLetterSet::get_mask(char letter)
+{
+    letter = g_ascii_toupper(letter);
+
+    return DriveLetterSet::is_valid(letter) ? 1u << (letter - DRIVE_LETTER_FIRST) : 0;
+}
+
+/**
+ * Checks whether a character is a drive letter that can be mounted.
+ * @param letter Drive letter, lower or upper case.
+ * @return @c TRUE if the letter can be mounted or @c FALSE otherwise.
+ */
+bool DriveLetterSet::is_valid(char letter)
+{
+    letter = g_ascii_toupper(letter);
+
+    return letter >= DRIVE_LETTER_FIRST && letter <= DRIVE_LETTER_LAST;
+}
+
+/**
+ * Checks whether a drive letter is in the set.
+ * @param letter Drive letter.
+ * @return @c TRUE if the letter is in the set or @c FALSE otherwise.
+ */
+bool DriveLetterSet::contains(char letter) const
+{
+    return (this->m_bits & DriveLetterSet::get_mask(letter)) != 0;
+}
+
+/**
+ * Adds a drive letter to the set.
+ * @param letter Drive letter.
+ * @return @c TRUE if the letter was added or @c FALSE if it is not valid or
+ * it was alredy in the set.
+ */
+bool DriveLetterSet::insert(char letter)
+{
+    auto mask = DriveLetterSet::get_mask(letter);
+    bool inserted = mask != 0 && (this->m_bits & mask) == 0;
+
+    this->m_bits |= mask;
+
+    return inserted;
+}
+
+/**
+ * Removes a drive letter from the set.
+ * @param letter Drive letter.
+ */
+void DriveLetterSet::erase(char letter)
+{
+    this->m_bits &= ~DriveLetterSet::get_mask(letter);
+}
+
+/**
+ * Removes every drive letter from the set.
+ */
+void DriveLetterSet::clear()
+{
+    this->m_bits = 0;
+}
+
+/**
+ * Checks whether the set is empty.
+ * @return @c TRUE if there are no letters in the set or @c FALSE otherwise.
+ */
+bool DriveLetterSet::empty() const
+{
+    return this->m_bits == 0;
+}
+
+/**
+ * Gets the number of letters in the set.
+ * @return Number of letters.
+ */
+guint DriveLetterSet::size() const
+{
+    return __builtin_popcount(this->m_bits);
+}
+
+/**
+ * Gets the first drive letter not in the set.
+ * @param preferred Letter returned if it is not in the set.
+ * @return First free drive letter or '\0' if every letter is used.
+ */
+char DriveLetterSet::get_first_free(char preferred) const
+{
+    const guint32 all_letters = (1u << (DRIVE_LETTER_LAST - DRIVE_LETTER_FIRST + 1)) - 1;
+    guint32 free_bits = ~this->m_bits & all_letters;
+    char letter = '\0';
+
+    if (DriveLetterSet::is_valid(preferred) && !this->contains(preferred)) {
+        letter = g_ascii_toupper(preferred);
+    } else if (free_bits != 0) {
+        letter = DRIVE_LETTER_FIRST + __builtin_ctz(free_bits);
+    }
+
+    return letter;
+}
+
+/**
+ * Takes the first drive letter not in the set.
+ * @param preferred Letter taken if it is not in the set.
+ * @return Allocated drive letter or '\0' if every letter is used.
+ */
+char DriveLetterSet::allocate(char preferred)
+{
+    auto letter = this->get_first_free(preferred);
+
+    this->insert(letter);
+
+    return letter;
+}
+
+/**
+ * Adds a mounting point to the table.
+ * @param command Mounting command.
+ * @return @c TRUE if the mounting point was added or @c FALSE if its drive
+ * letter is not valid or it is alredy used.
+ */
+bool MountTable::add(const std::shared_ptr<MountCommandBase> &command)
+{
+    bool added = command && this->m_letters.insert(command->get_letter());
+
+    if (added) {
+        this->m_mounts[g_ascii_toupper(command->get_letter()) - DRIVE_LETTER_FIRST] = command;
+    }
+
+    return added;
+}
+
+/**
+ * Replaces a mounting point of the table. The table is left unchanged if the
+ * new drive letter is used by another mounting point.
+ * @param letter Drive letter of the mounting point to be replaced.
+ * @param command New mounting command.
+ * @return @c TRUE if the mounting point was replaced or @c FALSE otherwise.
+ */
+bool MountTable::replace(char letter, const std::shared_ptr<MountCommandBase> &command)
+{
+    auto old_command = this->get(letter);
+
+    this->remove(letter);
+
+    if (!this->add(command)) {
+        this->add(old_command);
+
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Removes a mounting point from the table.
+ * @param letter Drive letter of the mounting point.
+ */
+void MountTable::remove(char letter)
+{
+    if (this->m_letters.contains(letter)) {
+        this->m_mounts[g_ascii_toupper(letter) - DRIVE_LETTER_FIRST].reset();
+        this->m_letters.erase(letter);
+    }
+}
+
+/**
+ * Removes every mounting point from the table.
+ */
+void MountTable::clear()
+{
+    for (auto &mount : this->m_mounts) {
+        mount.reset();
+    }
+
+    this->m_letters.clear();
+}
+
+/**
+ * Gets a mounting point.
+ * @param letter Drive letter of the mounting point.
+ * @return Mounting command or @c nullptr if the letter is not used.
+ */
+std::shared_ptr<MountCommandBase> MountTable::get(char letter) const
+{
+    std::shared_ptr<MountCommandBase> command;
+
+    if (this->m_letters.contains(letter)) {
+        command = this->m_mounts[g_ascii_toupper(letter) - DRIVE_LETTER_FIRST];
+    }
+
+    return command;
+}
+
+/**
+ * Checks whether a new mounting point would conflict with the existing ones.
+ * @param letter Drive letter of the new mounting point.
+ * @return @c TRUE if the letter is not valid or it is alredy used.
+ */
+bool MountTable::conflicts(char letter) const
+{
+    return !DriveLetterSet::is_valid(letter) || this->m_letters.contains(letter);
+}
+
+/**
+ * Gets the drive letters used by the mounting points.
+ * @return Set of used drive letters.
+ */
+const DriveLetterSet &MountTable::get_used_letters() const
+{
+    return this->m_letters;
+}
+
+} // DOSBoxGTK
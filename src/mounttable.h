@@ -0,0 +1,72 @@
+/**
+ * @file
+ * DriveLetterSet and MountTable classes declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef MOUNTTABLE_H
+#define MOUNTTABLE_H
+
+#include "mountcommandbase.h"
+#include <glib.h>
+#include <array>
+#include <memory>
+
+#define DRIVE_LETTER_FIRST 'A' ///< First drive letter available for mounting.
+#define DRIVE_LETTER_LAST  'Y' ///< Last drive letter available for mounting (Z is used by DOSBox itself).
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Set of DOS drive letters stored as a 32 bit bitmap, one bit per letter.
+ */
+class DriveLetterSet final
+{
+private:
+    guint32 m_bits = 0; ///< Bit N is set if the letter 'A' + N is in the set.
+
+    static guint32 get_mask(char letter);
+
+public:
+    static bool is_valid(char letter);
+
+    bool contains(char letter) const;
+    bool insert(char letter);
+    void erase(char letter);
+    void clear();
+    bool empty() const;
+    guint size() const;
+    char get_first_free(char preferred = 'C') const;
+    char allocate(char preferred = 'C');
+};
+
+/**
+ * Mounting points of a game profile indexed by drive letter.
+ * MOUNT and IMGMOUNT commands share the same table, so a drive letter can only
+ * be used once no matter the kind of mounting point.
+ */
+class MountTable final
+{
+private:
+    std::array<std::shared_ptr<MountCommandBase>, DRIVE_LETTER_LAST - DRIVE_LETTER_FIRST + 1> m_mounts; ///< Mounting points by letter.
+    DriveLetterSet m_letters; ///< Used drive letters.
+
+public:
+    bool add(const std::shared_ptr<MountCommandBase> &command);
+    bool replace(char letter, const std::shared_ptr<MountCommandBase> &command);
+    void remove(char letter);
+    void clear();
+    std::shared_ptr<MountCommandBase> get(char letter) const;
+    bool conflicts(char letter) const;
+    const DriveLetterSet &get_used_letters() const;
+};
+
+} // DOSBoxGTK
+
+#endif // MOUNTTABLE_H
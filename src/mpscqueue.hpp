@@ -0,0 +1,120 @@
+/**
+ * @file
+ * MpscQueue class template declaration and implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef MPSCQUEUE_HPP
+#define MPSCQUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Unbounded lock-free multiple producers single consumer queue, based on
+ * Dmitry Vyukov's intrusive MPSC node queue.
+ * push() can be called from any number of threads at the same time and never
+ * blocks. pop() and empty() must only be called from the consumer thread.
+ * A push is made of two steps, so the consumer may briefly see the queue as
+ * empty while a producer is in the middle of one. Producers must therefore
+ * wake up the consumer after pushing, never before.
+ * @tparam T Type of the queued values.
+ */
+template <typename T>
+class MpscQueue final
+{
+private:
+    /**
+     * Queue node.
+     */
+    struct Node
+    {
+        std::atomic<Node*> next; ///< Next node, towards the head.
+        T value;                 ///< Queued value.
+
+        Node() : next(nullptr) {}
+        Node(T &&v) : next(nullptr), value(std::move(v)) {}
+    };
+
+    std::atomic<Node*> m_head; ///< Last pushed node, updated by the producers.
+    Node *m_tail;              ///< Consumer side stub node, its value was already popped.
+
+public:
+    /**
+     * Constructor.
+     */
+    MpscQueue() :
+        m_head(new Node()), m_tail(m_head.load())
+    {}
+
+    /**
+     * Destructor. Discards the queued values.
+     */
+    ~MpscQueue()
+    {
+        while (this->m_tail != nullptr) {
+            auto next = this->m_tail->next.load();
+
+            delete this->m_tail;
+            this->m_tail = next;
+        }
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue &operator=(const MpscQueue&) = delete;
+
+    /**
+     * Queues a value. It can be called from any thread.
+     * @param value Value to be queued.
+     */
+    void push(T value)
+    {
+        auto node = new Node(std::move(value));
+        auto prev = this->m_head.exchange(node, std::memory_order_acq_rel);
+
+        prev->next.store(node, std::memory_order_seq_cst);
+    }
+
+    /**
+     * Takes the oldest value. Consumer thread only.
+     * @param value Where the value is stored.
+     * @return @c TRUE if a value has been taken or @c FALSE if the queue is
+     * empty.
+     */
+    bool pop(T &value)
+    {
+        auto next = this->m_tail->next.load(std::memory_order_seq_cst);
+
+        if (next == nullptr) {
+            return false;
+        }
+
+        // The popped node becomes the new stub.
+        value = std::move(next->value);
+        delete this->m_tail;
+        this->m_tail = next;
+
+        return true;
+    }
+
+    /**
+     * Checks whether there are values to pop. Consumer thread only.
+     * @return @c TRUE if the queue is empty or @c FALSE otherwise.
+     */
+    bool empty() const
+    {
+        return this->m_tail->next.load(std::memory_order_seq_cst) == nullptr;
+    }
+};
+
+} // Tools
+
+#endif // MPSCQUEUE_HPP
@@ -0,0 +1,150 @@
+/**
+ * @file
+ * PerformanceDialog class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "performancedialog.h"
+#include "config.h"
+#include "metrics.hpp"
+#include "allocaccounting.hpp"
+#include <glibmm/i18n.h>
+#include <glibmm/main.h>
+#include <glibmm/miscutils.h>
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+#define HITS_SUFFIX "_hits_total"     ///< Suffix of cache hit counters.
+#define MISSES_SUFFIX "_misses_total" ///< Suffix of cache miss counters.
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Formats a duration in seconds as milliseconds.
+ * @param seconds Duration.
+ * @return Formatted duration.
+ */
+static Glib::ustring format_ms(double seconds)
+{
+    return Glib::ustring::format(std::fixed, std::setprecision(1), seconds * 1000) + " ms";
+}
+
+/**
+ * Reloads the metrics list. Histograms show their count, mean and estimated
+ * percentiles. A hit ratio row is added for every pair of cache hit and miss
+ * counters, and a row for every subsystem if the allocation accounting is
+ * compiled in.
+ */
+void PerformanceDialog::refresh()
+{
+    auto samples = Tools::Metrics::collect();
+    std::map<std::string, uint64_t> counters;
+
+    this->m_metrics_ls->clear();
+
+    for (auto &sample : samples) {
+        auto iter = this->m_metrics_ls->append();
+        Glib::ustring value;
+
+        if (sample.is_histogram) {
+            auto &histogram = sample.histogram;
+
+            value = Glib::ustring::compose(_("%1 calls, mean %2, p50 %3, p95 %4"), histogram.count,
+                                           format_ms(histogram.get_mean()),
+                                           format_ms(histogram.get_quantile(0.5)),
+                                           format_ms(histogram.get_quantile(0.95)));
+        } else {
+            value = Glib::ustring::compose("%1", sample.value);
+            counters[sample.name] = sample.value;
+        }
+
+        iter->set_value(0, Glib::ustring(sample.name));
+        iter->set_value(1, value);
+        iter->set_value(2, Glib::ustring(sample.help));
+    }
+
+    for (auto &counter : counters) {
+        auto &name = counter.first;
+        auto suffix_length = std::string(HITS_SUFFIX).size();
+
+        if (name.size() <= suffix_length || name.compare(name.size() - suffix_length, suffix_length, HITS_SUFFIX) != 0) {
+            continue;
+        }
+
+        auto prefix = name.substr(0, name.size() - suffix_length);
+        auto misses = counters.find(prefix + MISSES_SUFFIX);
+
+        if (misses == counters.end()) {
+            continue;
+        }
+
+        auto lookups = counter.second + misses->second;
+        auto iter = this->m_metrics_ls->append();
+
+        iter->set_value(0, Glib::ustring(prefix + "_hit_ratio"));
+        iter->set_value(1, lookups > 0 ? Glib::ustring::format(std::fixed, std::setprecision(1), 100.0 * counter.second / lookups) + " %"
+                                       : Glib::ustring("-"));
+        iter->set_value(2, Glib::ustring(_("Lookups served from the cache.")));
+    }
+
+    if (!Tools::AllocAccounting::is_enabled()) {
+        return;
+    }
+
+    for (int i = 0; i < static_cast<int>(Tools::AllocTag::COUNT); ++i) {
+        auto tag = static_cast<Tools::AllocTag>(i);
+        auto stats = Tools::AllocAccounting::get_stats(tag);
+        auto iter = this->m_metrics_ls->append();
+
+        iter->set_value(0, Glib::ustring::compose("alloc_%1", Tools::AllocAccounting::get_tag_name(tag)));
+        iter->set_value(1, Glib::ustring::compose(_("%1 allocs (%2 after startup), %3 live, %4 peak"),
+                                                  stats.allocations, stats.steady_allocations,
+                                                  Glib::format_size(std::max<int64_t>(stats.live_bytes, 0)), Glib::format_size(stats.peak_bytes)));
+        iter->set_value(2, Glib::ustring(_("Allocations charged to the subsystem.")));
+    }
+}
+
+/**
+ * Refreshes the metrics periodically.
+ * @return Always @c TRUE to keep the timeout.
+ */
+bool PerformanceDialog::on_refresh_timeout()
+{
+    this->refresh();
+
+    return true;
+}
+
+/**
+ * Constructor.
+ * @param cobject Underlying C object for the Base Class constructor.
+ * @param builder Gtk::Builder used to retrieve the child widgets.
+ */
+PerformanceDialog::PerformanceDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder) :
+    Gtk::Dialog(cobject)
+{
+    builder->set_translation_domain(PACKAGE);
+
+    this->m_metrics_ls = Glib::RefPtr<Gtk::ListStore>::cast_dynamic(builder->get_object("MetricsLS"));
+    this->m_metrics_ls->set_sort_column(0, Gtk::SORT_ASCENDING);
+
+    this->refresh();
+    this->m_refresh = Glib::signal_timeout().connect(sigc::mem_fun(*this, &PerformanceDialog::on_refresh_timeout), PERFORMANCE_REFRESH_INTERVAL);
+}
+
+/**
+ * Destructor.
+ */
+PerformanceDialog::~PerformanceDialog()
+{
+    this->m_refresh.disconnect();
+}
+
+} // DOSBoxGTK
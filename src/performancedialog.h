@@ -0,0 +1,46 @@
+/**
+ * @file
+ * PerformanceDialog class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef PERFORMANCEDIALOG_H
+#define PERFORMANCEDIALOG_H
+
+#define PERFORMANCE_REFRESH_INTERVAL 1000 ///< Milliseconds between metric refreshes.
+
+#include <gtkmm/dialog.h>
+#include <gtkmm/builder.h>
+#include <gtkmm/liststore.h>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Hidden dialog showing the application metrics while it is open.
+ */
+class PerformanceDialog final : public Gtk::Dialog
+{
+private:
+    Glib::RefPtr<Gtk::ListStore> m_metrics_ls;
+
+    sigc::connection m_refresh; ///< Periodic refresh of the metrics.
+
+    void refresh();
+
+protected:
+    bool on_refresh_timeout();
+
+public:
+    PerformanceDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder);
+    virtual ~PerformanceDialog();
+};
+
+} // DOSBoxGTK
+
+#endif // PERFORMANCEDIALOG_H
@@ -10,7 +10,6 @@
 #include "config.h"
 #include <glibmm/i18n.h>
 #include <glibmm/miscutils.h>
-#include <glibmm/spawn.h>
 #include <glibmm/regex.h>
 #include <giomm/file.h>
 #include <gtkmm/grid.h>
@@ -38,34 +37,32 @@ void PreferencesDialog::update_controls()
 }
 
 /**
- * Creates the DOSBox default config file.
+ * Creates the DOSBox default config file and sets it in the dialog.
+ * DOSBox is run in background and the file is set when it finishes.
  */
-std::string PreferencesDialog::get_default_config()
+Tools::AsyncTask PreferencesDialog::request_default_config()
 {
     auto dosbox_path = this->m_dosbox_fcb->get_filename();
     auto dosbox_file = Gio::File::create_for_path(dosbox_path);
-    std::string output;
 
     if (!dosbox_path.empty() && dosbox_file->query_exists()) {
         auto command = Glib::ustring::compose("%1 -printconf", dosbox_path);
-        int exit;
 
         // Get the DOSBox default config path.
         // This will also create the requested file if it's not present.
-        Glib::spawn_command_line_sync(command, &output, nullptr, &exit);
+        auto result = co_await Tools::spawn_command_line(this->m_async_token, command);
 
-        // If the commands execution goes ok...
-        if (exit == 0) {
+        // If the commands execution goes ok and the user has not chosen a file meanwhile...
+        if (result.exit_status == 0 && this->m_default_config_fcb->get_filename().empty()) {
             // Eliminating spaces and new line characters with a regular expression.
             auto regex = Glib::Regex::create("\\n");
-            output = regex->replace(output, 0, Glib::ustring(), Glib::REGEX_MATCH_NEWLINE_ANY);
+            auto output = regex->replace(result.output, 0, Glib::ustring(), Glib::REGEX_MATCH_NEWLINE_ANY);
 
             // Assign the result to the widget.
             this->m_default_config_fcb->set_filename(output);
+            this->update_controls();
         }
     }
-
-    return output;
 }
 
 /**
@@ -108,11 +105,7 @@ void PreferencesDialog::init()
     if (default_profiles_path->query_file_type() == Gio::FILE_TYPE_REGULAR) {
         this->m_default_config_fcb->set_filename(this->m_settings_default_config);
     } else {
-        auto default_config = this->get_default_config();
-
-        if (!default_config.empty()) {
-            this->m_default_config_fcb->set_filename(default_config);
-        }
+        this->request_default_config();
     }
 
     if (!this->m_settings_profiles_path.empty()) {
@@ -239,6 +232,14 @@ PreferencesDialog::PreferencesDialog(BaseObjectType *cobject, const Glib::RefPtr
     this->m_captures_path_undo_button->signal_clicked().connect(sigc::mem_fun(*this, &PreferencesDialog::on_captures_path_undo_button_clicked));
 }
 
+/**
+ * Destructor. Stops the pending asynchronous tasks.
+ */
+PreferencesDialog::~PreferencesDialog()
+{
+    this->m_async_token.cancel();
+}
+
 /**
  * Apply changes to application settings.
  */
@@ -9,6 +9,7 @@
 #ifndef PREFERENCESDIALOG_H
 #define PREFERENCESDIALOG_H
 
+#include "async.hpp"
 #include <giomm/settings.h>
 #include <gtkmm/builder.h>
 #include <gtkmm/dialog.h>
@@ -30,9 +31,10 @@ private:
     Glib::ustring m_settings_dosbox_path, m_settings_default_config, m_settings_profiles_path, m_settings_captures_path;
     Gtk::Button *m_cancel_button, *m_accept_button, *m_dosbox_path_undo_button, *m_default_config_undo_button, *m_profiles_path_undo_button, *m_captures_path_undo_button;
     Gtk::FileChooserButton *m_dosbox_fcb, *m_default_config_fcb, *m_profiles_fcb, *m_captures_fcb;
+    Tools::CancellationToken m_async_token; ///< Cancelled when the dialog is destroyed.
 
     void update_controls();
-    std::string get_default_config();
+    Tools::AsyncTask request_default_config();
     void init();
 
 protected:
@@ -44,7 +46,7 @@ protected:
 
 public:
     PreferencesDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder);
-    virtual ~PreferencesDialog() {}
+    virtual ~PreferencesDialog();
     void apply_settings() const;
 };
 
@@ -0,0 +1,427 @@
+/**
+ * @file
+ * ProfileFacetIndex class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profilefacetindex.h"
+#include <glibmm/i18n.h>
+#include <cstdlib>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Removes the leading and trailing white space of a value.
+ * @param value Value.
+ * @return Trimmed value.
+ */
+static Glib::ustring trim(const Glib::ustring &value)
+{
+    auto first = value.find_first_not_of(" \t\r\n");
+
+    if (first == Glib::ustring::npos) {
+        return Glib::ustring();
+    }
+
+    return value.substr(first, value.find_last_not_of(" \t\r\n") - first + 1);
+}
+
+/**
+ * Gets the year of a year facet value.
+ * @param key Value key.
+ * @return Year, or 0 if the value does not start with a number.
+ */
+static int get_year(const std::string &key)
+{
+    return std::atoi(key.c_str());
+}
+
+/**
+ * Checks whether no value has been chosen.
+ * @return @c TRUE if the filter matches every profile or @c FALSE otherwise.
+ */
+bool ProfileFacetFilter::is_empty() const
+{
+    for (auto &facet_values : this->values) {
+        if (!facet_values.empty()) {
+            return false;
+        }
+    }
+
+    return this->year_from == 0 && this->year_to == 0;
+}
+
+/**
+ * Gets the key a facet value is compared by.
+ * @param value Facet value.
+ * @return Case folded value without surrounding white space, empty for no
+ * value.
+ */
+std::string ProfileFacetIndex::get_key(const Glib::ustring &value)
+{
+    return trim(value).casefold().raw();
+}
+
+/**
+ * Numbers a new profile, reusing a free document if there is any.
+ * @param id Profile ID, not in the index.
+ * @return Document.
+ */
+uint32_t ProfileFacetIndex::add_document(const Glib::ustring &id)
+{
+    uint32_t doc;
+
+    if (this->m_free.empty()) {
+        doc = this->m_documents.size();
+        this->m_documents.emplace_back();
+    } else {
+        doc = this->m_free.back();
+        this->m_free.pop_back();
+    }
+
+    this->m_documents[doc].id = id;
+    this->m_docs[id.raw()] = doc;
+    this->m_all.add(doc);
+
+    return doc;
+}
+
+/**
+ * Sets the value of a facet of a document.
+ * @param doc Document.
+ * @param facet Facet.
+ * @param value Value as found, empty for none.
+ */
+void ProfileFacetIndex::set_value(uint32_t doc, ProfileFacet facet, const Glib::ustring &value)
+{
+    this->set_value(doc, facet, get_key(value), value);
+}
+
+/**
+ * Sets the value of a facet of a document, moving the document from the
+ * bitmap of its previous value. Values without documents are dropped.
+ * @param doc Document.
+ * @param facet Facet.
+ * @param key Value key, empty for none.
+ * @param label Value as found, shown to the user if it is a new one.
+ */
+void ProfileFacetIndex::set_value(uint32_t doc, ProfileFacet facet, const std::string &key, const Glib::ustring &label)
+{
+    auto &values = this->m_facets[static_cast<int>(facet)];
+    auto &current = this->m_documents[doc].keys[static_cast<int>(facet)];
+
+    if (current == key) {
+        return;
+    }
+
+    if (!current.empty()) {
+        auto value = values.find(current);
+
+        value->second.docs.remove(doc);
+
+        if (value->second.docs.empty()) {
+            values.erase(value);
+        }
+    }
+
+    current = key;
+
+    if (!key.empty()) {
+        auto value = values.try_emplace(key);
+
+        if (value.second) {
+            value.first->second.label = trim(label);
+        }
+
+        value.first->second.docs.add(doc);
+    }
+}
+
+/**
+ * Indexes the metadata facets of a document.
+ * @param doc Document.
+ * @param profile Profile metadata.
+ */
+void ProfileFacetIndex::set_metadata(uint32_t doc, const ProfilePtr &profile)
+{
+    this->m_documents[doc].profile = profile;
+    this->set_value(doc, ProfileFacet::GENRE, profile->genre);
+    this->set_value(doc, ProfileFacet::PUBLISHER, profile->publisher);
+    this->set_value(doc, ProfileFacet::DEVELOPER, profile->developer);
+    this->set_value(doc, ProfileFacet::YEAR, profile->year);
+}
+
+/**
+ * Frees a document, removing it from the bitmaps of its values.
+ * @param doc Document in use.
+ */
+void ProfileFacetIndex::remove_document(uint32_t doc)
+{
+    for (int facet = 0; facet < PROFILE_FACET_COUNT; ++facet) {
+        this->set_value(doc, static_cast<ProfileFacet>(facet), std::string(), Glib::ustring());
+    }
+
+    this->m_docs.erase(this->m_documents[doc].id.raw());
+    this->m_documents[doc] = Document();
+    this->m_free.push_back(doc);
+    this->m_all.remove(doc);
+}
+
+/**
+ * Evaluates a filter leaving out the values chosen for a facet.
+ * @param filter Filter.
+ * @param scope Documents the result is limited to, all of them if null.
+ * @param skipped Facet not evaluated, -1 for none.
+ * @return Matching documents.
+ */
+Tools::RoaringBitmap ProfileFacetIndex::evaluate(const ProfileFacetFilter &filter, const Tools::RoaringBitmap *scope, int skipped) const
+{
+    auto result = scope ? this->m_all & *scope : this->m_all;
+
+    for (int facet = 0; facet < PROFILE_FACET_COUNT && !result.empty(); ++facet) {
+        auto &values = this->m_facets[facet];
+        Tools::RoaringBitmap docs;
+
+        if (facet == skipped) {
+            continue;
+        }
+
+        if (facet == static_cast<int>(ProfileFacet::YEAR)) {
+            if (filter.year_from == 0 && filter.year_to == 0) {
+                continue;
+            }
+
+            for (auto &value : values) {
+                auto year = get_year(value.first);
+
+                if (year != 0 && (filter.year_from == 0 || year >= filter.year_from) && (filter.year_to == 0 || year <= filter.year_to)) {
+                    docs |= value.second.docs;
+                }
+            }
+        } else {
+            if (filter.values[facet].empty()) {
+                continue;
+            }
+
+            for (auto &key : filter.values[facet]) {
+                auto value = values.find(key);
+
+                if (value != values.end()) {
+                    docs |= value->second.docs;
+                }
+            }
+        }
+
+        result &= docs;
+    }
+
+    return result;
+}
+
+/**
+ * Removes every profile.
+ */
+void ProfileFacetIndex::clear()
+{
+    for (auto &values : this->m_facets) {
+        values.clear();
+    }
+
+    this->m_documents.clear();
+    this->m_docs.clear();
+    this->m_free.clear();
+    this->m_all.clear();
+}
+
+/**
+ * Makes the index hold the metadata of the profiles of a library snapshot.
+ * Only the profiles changed since they were indexed are indexed again, and
+ * the config file facets of the kept profiles are left as they are.
+ * @param snapshot Library snapshot.
+ */
+void ProfileFacetIndex::sync(const ProfileSnapshotPtr &snapshot)
+{
+    std::vector<bool> seen(this->m_documents.size());
+
+    this->m_docs.reserve(snapshot->size());
+    this->m_documents.reserve(snapshot->size());
+
+    snapshot->for_each([this, &seen](const ProfilePtr &profile) {
+        auto iter = this->m_docs.find(profile->id.raw());
+        auto doc = iter != this->m_docs.end() ? iter->second : this->add_document(profile->id);
+
+        if (doc >= seen.size()) {
+            seen.resize(doc + 1);
+        }
+
+        seen[doc] = true;
+
+        if (this->m_documents[doc].profile != profile) {
+            this->set_metadata(doc, profile);
+        }
+    });
+
+    for (uint32_t doc = 0; doc < seen.size(); ++doc) {
+        if (!seen[doc] && !this->m_documents[doc].id.empty()) {
+            this->remove_document(doc);
+        }
+    }
+}
+
+/**
+ * Adds a profile or indexes its metadata again if it has changed.
+ * @param profile Profile.
+ */
+void ProfileFacetIndex::update(const ProfilePtr &profile)
+{
+    auto iter = this->m_docs.find(profile->id.raw());
+    auto doc = iter != this->m_docs.end() ? iter->second : this->add_document(profile->id);
+
+    if (this->m_documents[doc].profile != profile) {
+        this->set_metadata(doc, profile);
+    }
+}
+
+/**
+ * Indexes the config file facets of a profile. Profiles not in the index are
+ * ignored.
+ * @param id Profile ID.
+ * @param settings Settings read from the profile config file.
+ */
+void ProfileFacetIndex::set_settings(const Glib::ustring &id, const ProfileSettings &settings)
+{
+    auto iter = this->m_docs.find(id.raw());
+
+    if (iter == this->m_docs.end()) {
+        return;
+    }
+
+    auto doc = iter->second;
+
+    this->set_value(doc, ProfileFacet::MACHINE, settings.machine);
+    this->set_value(doc, ProfileFacet::CORE, settings.core);
+    this->set_value(doc, ProfileFacet::SBTYPE, settings.sbtype);
+
+    if (settings.has_booter) {
+        this->set_value(doc, ProfileFacet::MODE, "booter", _("Boot image"));
+    } else if (settings.has_program) {
+        this->set_value(doc, ProfileFacet::MODE, "program", _("Program"));
+    } else {
+        this->set_value(doc, ProfileFacet::MODE, std::string(), Glib::ustring());
+    }
+}
+
+/**
+ * Removes a profile.
+ * @param id Profile ID.
+ */
+void ProfileFacetIndex::remove(const Glib::ustring &id)
+{
+    auto iter = this->m_docs.find(id.raw());
+
+    if (iter != this->m_docs.end()) {
+        this->remove_document(iter->second);
+    }
+}
+
+/**
+ * Evaluates a filter.
+ * @param filter Filter.
+ * @param scope Documents the result is limited to, all of them if null.
+ * @return Matching documents.
+ */
+Tools::RoaringBitmap ProfileFacetIndex::evaluate(const ProfileFacetFilter &filter, const Tools::RoaringBitmap *scope) const
+{
+    return this->evaluate(filter, scope, -1);
+}
+
+/**
+ * Gets the documents of some profiles, to limit the filters to them.
+ * @param profiles Profiles.
+ * @return Documents of the indexed profiles.
+ */
+Tools::RoaringBitmap ProfileFacetIndex::get_documents(const std::vector<ProfilePtr> &profiles) const
+{
+    Tools::RoaringBitmap docs;
+
+    for (auto &profile : profiles) {
+        auto iter = this->m_docs.find(profile->id.raw());
+
+        if (iter != this->m_docs.end()) {
+            docs.add(iter->second);
+        }
+    }
+
+    return docs;
+}
+
+/**
+ * Checks whether the document of a profile is in a set of documents.
+ * @param docs Documents, as returned by evaluate().
+ * @param id Profile ID.
+ * @return @c TRUE if the profile is indexed and in the set or @c FALSE
+ * otherwise.
+ */
+bool ProfileFacetIndex::contains(const Tools::RoaringBitmap &docs, const Glib::ustring &id) const
+{
+    auto iter = this->m_docs.find(id.raw());
+
+    return iter != this->m_docs.end() && docs.contains(iter->second);
+}
+
+/**
+ * Counts the profiles having each value of a facet among the ones matching
+ * the filter of the other facets.
+ * @param facet Facet.
+ * @param filter Filter.
+ * @param scope Documents the counts are limited to, all of them if null.
+ * @return Values of the facet sorted by key, including the ones without
+ * matching profiles.
+ */
+std::vector<ProfileFacetCount> ProfileFacetIndex::count(ProfileFacet facet, const ProfileFacetFilter &filter, const Tools::RoaringBitmap *scope) const
+{
+    auto docs = this->evaluate(filter, scope, static_cast<int>(facet));
+    std::vector<ProfileFacetCount> counts;
+
+    for (auto &value : this->m_facets[static_cast<int>(facet)]) {
+        ProfileFacetCount count;
+
+        count.key   = value.first;
+        count.label = value.second.label;
+        count.count = value.second.docs.and_cardinality(docs);
+        counts.push_back(std::move(count));
+    }
+
+    return counts;
+}
+
+/**
+ * Gets the first and last years of the indexed profiles.
+ * @param first Where the first year is stored.
+ * @param last Where the last year is stored.
+ * @return @c TRUE if any profile has a year or @c FALSE otherwise.
+ */
+bool ProfileFacetIndex::get_year_range(int &first, int &last) const
+{
+    auto found = false;
+
+    for (auto &value : this->m_facets[static_cast<int>(ProfileFacet::YEAR)]) {
+        auto year = get_year(value.first);
+
+        if (year != 0) {
+            first = found ? std::min(first, year) : year;
+            last  = found ? std::max(last, year) : year;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,135 @@
+/**
+ * @file
+ * ProfileFacetIndex class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef PROFILEFACETINDEX_H
+#define PROFILEFACETINDEX_H
+
+#define PROFILE_FACET_COUNT 8 ///< Number of ProfileFacet values.
+
+#include "profilelibrary.h"
+#include "profilevalidator.h"
+#include "roaringbitmap.hpp"
+#include <glibmm/ustring.h>
+#include <array>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Profile properties the library can be filtered by.
+ */
+enum class ProfileFacet
+{
+    GENRE,     ///< Game genre.
+    PUBLISHER, ///< Game publisher.
+    DEVELOPER, ///< Game developer.
+    YEAR,      ///< Release year.
+    MACHINE,   ///< Emulated machine type, the "machine" config key.
+    CORE,      ///< CPU core, the "core" config key.
+    SBTYPE,    ///< Sound Blaster type, the "sbtype" config key.
+    MODE       ///< Whether the game boots from a disk image or runs a program.
+};
+
+/**
+ * Values chosen for each facet. A profile matches when it has any of the
+ * values chosen for each facet, so values are ORed within a facet and the
+ * facets are ANDed. Years are chosen as a range instead.
+ */
+struct ProfileFacetFilter
+{
+    std::array<std::set<std::string>, PROFILE_FACET_COUNT> values; ///< Chosen value keys by facet.
+    int year_from = 0,                                             ///< First year, 0 for no lower bound.
+        year_to   = 0;                                             ///< Last year, 0 for no upper bound.
+
+    bool is_empty() const;
+};
+
+/**
+ * Value of a facet and the number of profiles having it.
+ */
+struct ProfileFacetCount
+{
+    std::string key;       ///< Value key, used in the filters.
+    Glib::ustring label;   ///< Value as shown to the user.
+    std::size_t count = 0; ///< Number of matching profiles having the value.
+};
+
+/**
+ * Bitmap index of the profile facets.
+ * Every profile is a document numbered from 0, reusing the numbers of the
+ * removed ones, and every facet value keeps a RoaringBitmap of the documents
+ * having it. Values are compared case insensitively by their folded UTF-8
+ * bytes, and shown as first found. The metadata facets come from the library
+ * snapshot, the config file ones from the settings read by the library
+ * validator, so no file is read again to filter. Filters are evaluated ORing
+ * the bitmaps of the values chosen for each facet and ANDing the results,
+ * and each value is counted intersecting its bitmap with the filter of the
+ * other facets, which is what the user would get by choosing it too.
+ * Instances must be used from a single thread.
+ */
+class ProfileFacetIndex final
+{
+private:
+    /**
+     * Value of a facet.
+     */
+    struct Value
+    {
+        Glib::ustring label;       ///< Value as first found.
+        Tools::RoaringBitmap docs; ///< Documents having the value.
+    };
+
+    /**
+     * Indexed profile.
+     */
+    struct Document
+    {
+        Glib::ustring id;                                  ///< Profile ID, empty for free documents.
+        ProfilePtr profile;                                ///< Indexed profile metadata.
+        std::array<std::string, PROFILE_FACET_COUNT> keys; ///< Value key of each facet, empty for none.
+    };
+
+    std::array<std::map<std::string, Value>, PROFILE_FACET_COUNT> m_facets; ///< Values of each facet by key.
+    std::vector<Document> m_documents;                                     ///< Documents.
+    std::unordered_map<std::string, uint32_t> m_docs;                      ///< Document of each profile ID.
+    std::vector<uint32_t> m_free;                                          ///< Free documents, reused first.
+    Tools::RoaringBitmap m_all;                                            ///< Documents in use.
+
+    static std::string get_key(const Glib::ustring &value);
+    uint32_t add_document(const Glib::ustring &id);
+    void set_value(uint32_t doc, ProfileFacet facet, const Glib::ustring &value);
+    void set_value(uint32_t doc, ProfileFacet facet, const std::string &key, const Glib::ustring &label);
+    void set_metadata(uint32_t doc, const ProfilePtr &profile);
+    void remove_document(uint32_t doc);
+    Tools::RoaringBitmap evaluate(const ProfileFacetFilter &filter, const Tools::RoaringBitmap *scope, int skipped) const;
+
+public:
+    void clear();
+    void sync(const ProfileSnapshotPtr &snapshot);
+    void update(const ProfilePtr &profile);
+    void set_settings(const Glib::ustring &id, const ProfileSettings &settings);
+    void remove(const Glib::ustring &id);
+
+    Tools::RoaringBitmap evaluate(const ProfileFacetFilter &filter, const Tools::RoaringBitmap *scope = nullptr) const;
+    Tools::RoaringBitmap get_documents(const std::vector<ProfilePtr> &profiles) const;
+    bool contains(const Tools::RoaringBitmap &docs, const Glib::ustring &id) const;
+    std::vector<ProfileFacetCount> count(ProfileFacet facet, const ProfileFacetFilter &filter, const Tools::RoaringBitmap *scope = nullptr) const;
+    bool get_year_range(int &first, int &last) const;
+};
+
+} // DOSBoxGTK
+
+#endif // PROFILEFACETINDEX_H
@@ -0,0 +1,237 @@
+/**
+ * @file
+ * ProfileFacetsBox class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profilefacetsbox.h"
+#include <glibmm/i18n.h>
+#include <algorithm>
+#include <cstdlib>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Fills the year combo boxes with the years of the indexed profiles, keeping
+ * the chosen ones.
+ * @param index Facet index.
+ */
+void ProfileFacetsBox::update_years(const ProfileFacetIndex &index)
+{
+    int first = 0,
+        last  = 0;
+    auto found = index.get_year_range(first, last);
+
+    for (auto year : { this->m_filter.year_from, this->m_filter.year_to }) {
+        if (year != 0) {
+            first = found ? std::min(first, year) : year;
+            last  = found ? std::max(last, year) : year;
+            found = true;
+        }
+    }
+
+    this->m_year_expander->set_visible(found);
+
+    if (first == this->m_year_first && last == this->m_year_last) {
+        return;
+    }
+
+    this->m_year_first = first;
+    this->m_year_last  = last;
+
+    for (auto combo : { this->m_year_from_cbt, this->m_year_to_cbt }) {
+        combo->remove_all();
+        combo->append("0", _("Any"));
+
+        for (auto year = first; found && year <= last; ++year) {
+            auto text = Glib::ustring::compose("%1", year);
+
+            combo->append(text, text);
+        }
+    }
+
+    this->m_year_from_cbt->set_active_id(Glib::ustring::compose("%1", this->m_filter.year_from));
+    this->m_year_to_cbt->set_active_id(Glib::ustring::compose("%1", this->m_filter.year_to));
+}
+
+/**
+ * Updates the clear button and tells that the user changed the filter.
+ */
+void ProfileFacetsBox::notify_changed()
+{
+    this->m_clear_button->set_sensitive(!this->m_filter.is_empty());
+    this->m_signal_changed.emit();
+}
+
+/**
+ * Adds or removes a value from the filter when its check button is toggled.
+ * @param facet Facet.
+ * @param key Value key.
+ */
+void ProfileFacetsBox::on_value_toggled(ProfileFacet facet, std::string key)
+{
+    if (this->m_updating) {
+        return;
+    }
+
+    auto &values = this->m_filter.values[static_cast<int>(facet)];
+
+    if (this->m_buttons[static_cast<int>(facet)][key].button->get_active()) {
+        values.insert(key);
+    } else {
+        values.erase(key);
+    }
+
+    this->notify_changed();
+}
+
+/**
+ * Changes the filter year range when a year is chosen.
+ */
+void ProfileFacetsBox::on_year_changed()
+{
+    if (this->m_updating) {
+        return;
+    }
+
+    this->m_filter.year_from = std::atoi(this->m_year_from_cbt->get_active_id().c_str());
+    this->m_filter.year_to   = std::atoi(this->m_year_to_cbt->get_active_id().c_str());
+    this->notify_changed();
+}
+
+/**
+ * Unchecks every value.
+ */
+void ProfileFacetsBox::on_clear_clicked()
+{
+    this->m_updating = true;
+
+    for (auto &buttons : this->m_buttons) {
+        for (auto &button : buttons) {
+            button.second.button->set_active(false);
+        }
+    }
+
+    this->m_year_from_cbt->set_active_id("0");
+    this->m_year_to_cbt->set_active_id("0");
+    this->m_updating = false;
+
+    this->m_filter = ProfileFacetFilter();
+    this->notify_changed();
+}
+
+/**
+ * Constructor.
+ * @param cobject Underlying C object for the Base Class constructor.
+ * @param builder Gtk::Builder used to retrieve the child widgets.
+ */
+ProfileFacetsBox::ProfileFacetsBox(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder) :
+    Gtk::Box(cobject)
+{
+    builder->get_widget("GenreFacetValues", this->m_value_boxes[static_cast<int>(ProfileFacet::GENRE)]);
+    builder->get_widget("PublisherFacetValues", this->m_value_boxes[static_cast<int>(ProfileFacet::PUBLISHER)]);
+    builder->get_widget("DeveloperFacetValues", this->m_value_boxes[static_cast<int>(ProfileFacet::DEVELOPER)]);
+    builder->get_widget("MachineFacetValues", this->m_value_boxes[static_cast<int>(ProfileFacet::MACHINE)]);
+    builder->get_widget("CoreFacetValues", this->m_value_boxes[static_cast<int>(ProfileFacet::CORE)]);
+    builder->get_widget("SBTypeFacetValues", this->m_value_boxes[static_cast<int>(ProfileFacet::SBTYPE)]);
+    builder->get_widget("ModeFacetValues", this->m_value_boxes[static_cast<int>(ProfileFacet::MODE)]);
+    builder->get_widget("YearFacetExpander", this->m_year_expander);
+    builder->get_widget("YearFromCBT", this->m_year_from_cbt);
+    builder->get_widget("YearToCBT", this->m_year_to_cbt);
+    builder->get_widget("ClearFacetsButton", this->m_clear_button);
+
+    this->m_year_from_cbt->signal_changed().connect(sigc::mem_fun(*this, &ProfileFacetsBox::on_year_changed));
+    this->m_year_to_cbt->signal_changed().connect(sigc::mem_fun(*this, &ProfileFacetsBox::on_year_changed));
+    this->m_clear_button->signal_clicked().connect(sigc::mem_fun(*this, &ProfileFacetsBox::on_clear_clicked));
+}
+
+/**
+ * Gets the values chosen by the user.
+ * @return Filter.
+ */
+const ProfileFacetFilter &ProfileFacetsBox::get_filter() const
+{
+    return this->m_filter;
+}
+
+/**
+ * Lists the values of every facet with their number of profiles. Check
+ * buttons are added for the new values and removed for the values no
+ * profile has any more, unless they are checked.
+ * @param index Facet index.
+ * @param scope Documents the counts are limited to, like the ones matching
+ * the search, or null for all of them.
+ */
+void ProfileFacetsBox::update_counts(const ProfileFacetIndex &index, const Tools::RoaringBitmap *scope)
+{
+    this->m_updating = true;
+
+    for (int facet = 0; facet < PROFILE_FACET_COUNT; ++facet) {
+        auto box = this->m_value_boxes[facet];
+        auto &buttons = this->m_buttons[facet];
+
+        if (box == nullptr) {
+            continue;
+        }
+
+        auto counts = index.count(static_cast<ProfileFacet>(facet), this->m_filter, scope);
+        auto position = 0;
+        auto iter = counts.begin();
+
+        // Both the counts and the buttons are sorted by key.
+        for (auto button = buttons.begin(); button != buttons.end() || iter != counts.end(); ++position) {
+            if (iter == counts.end() || (button != buttons.end() && button->first < iter->key)) {
+                if (button->second.button->get_active()) {
+                    button->second.button->set_label(Glib::ustring::compose("%1 (0)", button->second.label));
+                    ++button;
+                } else {
+                    box->remove(*button->second.button);
+                    button = buttons.erase(button);
+                    --position;
+                }
+
+                continue;
+            }
+
+            if (button == buttons.end() || iter->key < button->first) {
+                auto check_button = Gtk::manage(new Gtk::CheckButton());
+
+                check_button->signal_toggled().connect(sigc::bind(sigc::mem_fun(*this, &ProfileFacetsBox::on_value_toggled), static_cast<ProfileFacet>(facet), iter->key));
+                box->pack_start(*check_button, Gtk::PACK_SHRINK);
+                box->reorder_child(*check_button, position);
+                check_button->show();
+                button = buttons.emplace_hint(button, iter->key, ValueButton());
+                button->second.button = check_button;
+                button->second.label  = iter->label;
+            }
+
+            button->second.button->set_label(Glib::ustring::compose("%1 (%2)", button->second.label, iter->count));
+            button->second.button->set_sensitive(iter->count > 0 || button->second.button->get_active());
+            ++button;
+            ++iter;
+        }
+
+        box->get_parent()->set_visible(!buttons.empty());
+    }
+
+    this->update_years(index);
+    this->m_clear_button->set_sensitive(!this->m_filter.is_empty());
+    this->m_updating = false;
+}
+
+/**
+ * Signal emitted when the user changes the filter.
+ * @return The signal.
+ */
+ProfileFacetsBox::type_signal_changed ProfileFacetsBox::signal_changed()
+{
+    return this->m_signal_changed;
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,81 @@
+/**
+ * @file
+ * ProfileFacetsBox class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef PROFILEFACETSBOX_H
+#define PROFILEFACETSBOX_H
+
+#include "profilefacetindex.h"
+#include <gtkmm/box.h>
+#include <gtkmm/builder.h>
+#include <gtkmm/button.h>
+#include <gtkmm/checkbutton.h>
+#include <gtkmm/comboboxtext.h>
+#include <array>
+#include <map>
+#include <string>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Side panel used to filter the profiles by facet.
+ * Every facet value is a check button labelled with the number of profiles
+ * the user would get by checking it too. Values without such profiles are
+ * insensitive, unless they are checked. The facets without values are
+ * hidden. The years are chosen as a range with two combo boxes.
+ */
+class ProfileFacetsBox final : public Gtk::Box
+{
+public:
+    typedef sigc::signal<void> type_signal_changed;
+
+private:
+    /**
+     * Check button of a facet value.
+     */
+    struct ValueButton
+    {
+        Gtk::CheckButton *button = nullptr; ///< Check button.
+        Glib::ustring label;                ///< Value as shown to the user.
+    };
+
+    std::array<Gtk::Box*, PROFILE_FACET_COUNT> m_value_boxes {};                   ///< Check buttons box of each facet, null for the year.
+    std::array<std::map<std::string, ValueButton>, PROFILE_FACET_COUNT> m_buttons; ///< Check buttons of each facet by value key.
+    Gtk::Widget *m_year_expander       = nullptr;                                  ///< Year range controls.
+    Gtk::ComboBoxText *m_year_from_cbt = nullptr,                                  ///< First year combo box.
+                      *m_year_to_cbt   = nullptr;                                  ///< Last year combo box.
+    Gtk::Button *m_clear_button        = nullptr;                                  ///< Unchecks every value.
+    ProfileFacetFilter m_filter;                                                   ///< Chosen values.
+    int m_year_first = 0,                                                          ///< First year listed in the combo boxes.
+        m_year_last  = 0;                                                          ///< Last year listed in the combo boxes.
+    bool m_updating  = false;                                                      ///< Set while the controls are changed by code.
+    type_signal_changed m_signal_changed;                                          ///< Emitted when the user changes the filter.
+
+    void update_years(const ProfileFacetIndex &index);
+    void notify_changed();
+
+protected:
+    void on_value_toggled(ProfileFacet facet, std::string key);
+    void on_year_changed();
+    void on_clear_clicked();
+
+public:
+    ProfileFacetsBox(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder);
+    virtual ~ProfileFacetsBox() {}
+
+    const ProfileFacetFilter &get_filter() const;
+    void update_counts(const ProfileFacetIndex &index, const Tools::RoaringBitmap *scope);
+    type_signal_changed signal_changed();
+};
+
+} // DOSBoxGTK
+
+#endif // PROFILEFACETSBOX_H
@@ -0,0 +1,461 @@
+/**
+ * @file
+ * Profile, ProfileSnapshot and ProfileLibrary classes implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profilelibrary.h"
+#include "trace.hpp"
+#include "metrics.hpp"
+#include "allocaccounting.hpp"
+#include "log.hpp"
+#include <glibmm/fileutils.h>
+#include <libxml++/document.h>
+#include <libxml++/parsers/domparser.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+static auto &s_profiles_loaded = Tools::Metrics::get_counter("dosboxgtk_profiles_loaded_total", "Profiles read from the profiles file.");      ///< Loaded profiles counter.
+static auto &s_xml_parse_time  = Tools::Metrics::get_histogram("dosboxgtk_xml_parse_seconds", "Time spent parsing the profiles file."); ///< XML parse time histogram.
+
+/**
+ * Constructor. Creates an empty snapshot.
+ */
+ProfileSnapshot::ProfileSnapshot() :
+    m_index(std::make_shared<const Index>())
+{}
+
+/**
+ * Replaces a chunk with a copy that can be modified. Only used while
+ * building a new snapshot, before publishing it.
+ * @param slot A slot of the chunk.
+ * @return The chunk copy.
+ */
+std::shared_ptr<ProfileSnapshot::Chunk> ProfileSnapshot::copy_chunk(std::size_t slot)
+{
+    auto &chunk = this->m_chunks[slot / PROFILE_SNAPSHOT_CHUNK_SIZE];
+    auto copy = std::make_shared<Chunk>(*chunk);
+
+    chunk = copy;
+
+    return copy;
+}
+
+/**
+ * Rebuilds the chunks and the index without empty slots. Only used while
+ * building a new snapshot, before publishing it.
+ */
+void ProfileSnapshot::compact()
+{
+    auto profiles = this->get_profiles();
+    auto index = std::make_shared<Index>();
+
+    this->m_chunks.clear();
+
+    for (std::size_t slot = 0; slot < profiles.size(); slot += PROFILE_SNAPSHOT_CHUNK_SIZE) {
+        auto end = std::min(slot + PROFILE_SNAPSHOT_CHUNK_SIZE, profiles.size());
+
+        this->m_chunks.push_back(std::make_shared<const Chunk>(profiles.begin() + slot, profiles.begin() + end));
+    }
+
+    for (std::size_t slot = 0; slot < profiles.size(); ++slot) {
+        (*index)[profiles[slot]->id] = slot;
+    }
+
+    this->m_index = index;
+    this->m_slots = profiles.size();
+}
+
+/**
+ * Gets the number of profiles.
+ * @return Number of profiles.
+ */
+std::size_t ProfileSnapshot::size() const
+{
+    return this->m_size;
+}
+
+/**
+ * Checks whether there are no profiles.
+ * @return @c TRUE if the snapshot is empty or @c FALSE otherwise.
+ */
+bool ProfileSnapshot::empty() const
+{
+    return this->m_size == 0;
+}
+
+/**
+ * Gets a profile.
+ * @param id Profile ID.
+ * @return The profile or @c nullptr if there is no profile with that ID.
+ */
+ProfilePtr ProfileSnapshot::find(const Glib::ustring &id) const
+{
+    auto entry = this->m_index->find(id);
+
+    if (entry == this->m_index->end()) {
+        return nullptr;
+    }
+
+    return (*this->m_chunks[entry->second / PROFILE_SNAPSHOT_CHUNK_SIZE])[entry->second % PROFILE_SNAPSHOT_CHUNK_SIZE];
+}
+
+/**
+ * Gets every profile, in insertion order.
+ * @return The profiles.
+ */
+std::vector<ProfilePtr> ProfileSnapshot::get_profiles() const
+{
+    std::vector<ProfilePtr> profiles;
+
+    profiles.reserve(this->m_size);
+    this->for_each([&profiles](const ProfilePtr &profile) {
+        profiles.push_back(profile);
+    });
+
+    return profiles;
+}
+
+/**
+ * Calls a function for every profile, in insertion order.
+ * @param function Function to be called.
+ */
+void ProfileSnapshot::for_each(const std::function<void(const ProfilePtr&)> &function) const
+{
+    for (auto &chunk : this->m_chunks) {
+        for (auto &profile : *chunk) {
+            if (profile) {
+                function(profile);
+            }
+        }
+    }
+}
+
+/**
+ * Creates a new version adding or replacing profiles.
+ * @param profiles Profiles to be stored, replacing the ones with the same ID.
+ * @return The new snapshot.
+ */
+ProfileSnapshotPtr ProfileSnapshot::with_profiles(const std::vector<ProfilePtr> &profiles) const
+{
+    auto snapshot = std::make_shared<ProfileSnapshot>(*this);
+    std::shared_ptr<Index> index;
+    std::vector<std::shared_ptr<Chunk>> copies(snapshot->m_chunks.size());
+
+    for (auto &profile : profiles) {
+        auto entry = snapshot->m_index->find(profile->id);
+        std::size_t slot;
+
+        if (entry != snapshot->m_index->end()) {
+            slot = entry->second;
+        } else {
+            // New profile: the index is copied once per new version.
+            if (!index) {
+                index = std::make_shared<Index>(*snapshot->m_index);
+                snapshot->m_index = index;
+            }
+
+            slot = snapshot->m_slots++;
+            (*index)[profile->id] = slot;
+            ++snapshot->m_size;
+
+            if (slot % PROFILE_SNAPSHOT_CHUNK_SIZE == 0) {
+                snapshot->m_chunks.push_back(std::make_shared<const Chunk>());
+                copies.push_back(nullptr);
+            }
+        }
+
+        auto &chunk = copies[slot / PROFILE_SNAPSHOT_CHUNK_SIZE];
+
+        if (!chunk) {
+            chunk = snapshot->copy_chunk(slot);
+        }
+
+        if (chunk->size() <= slot % PROFILE_SNAPSHOT_CHUNK_SIZE) {
+            chunk->resize(slot % PROFILE_SNAPSHOT_CHUNK_SIZE + 1);
+        }
+
+        (*chunk)[slot % PROFILE_SNAPSHOT_CHUNK_SIZE] = profile;
+    }
+
+    return snapshot;
+}
+
+/**
+ * Creates a new version adding or replacing a profile.
+ * @param profile Profile to be stored, replacing the one with the same ID.
+ * @return The new snapshot.
+ */
+ProfileSnapshotPtr ProfileSnapshot::with_profile(const ProfilePtr &profile) const
+{
+    return this->with_profiles({profile});
+}
+
+/**
+ * Creates a new version without a profile.
+ * @param id ID of the profile to be removed.
+ * @return The new snapshot.
+ */
+ProfileSnapshotPtr ProfileSnapshot::without_profile(const Glib::ustring &id) const
+{
+    auto snapshot = std::make_shared<ProfileSnapshot>(*this);
+    auto entry = this->m_index->find(id);
+
+    if (entry == this->m_index->end()) {
+        return snapshot;
+    }
+
+    auto slot = entry->second;
+    auto index = std::make_shared<Index>(*this->m_index);
+
+    index->erase(id);
+    snapshot->m_index = index;
+    (*snapshot->copy_chunk(slot))[slot % PROFILE_SNAPSHOT_CHUNK_SIZE] = nullptr;
+    --snapshot->m_size;
+
+    if (snapshot->m_slots - snapshot->m_size > snapshot->m_size + PROFILE_SNAPSHOT_CHUNK_SIZE) {
+        snapshot->compact();
+    }
+
+    return snapshot;
+}
+
+/**
+ * Constructor. Creates an empty library.
+ */
+ProfileLibrary::ProfileLibrary() :
+    m_snapshot(std::make_shared<const ProfileSnapshot>()), m_save_pending(false)
+{}
+
+/**
+ * Destructor. Waits for the pending writes.
+ */
+ProfileLibrary::~ProfileLibrary()
+{
+    this->m_save_tasks.wait();
+}
+
+/**
+ * Gets the current version of the library. It can be called from any thread.
+ * @return The current snapshot.
+ */
+ProfileSnapshotPtr ProfileLibrary::get_snapshot() const
+{
+    return this->m_snapshot.load();
+}
+
+/**
+ * Loads the library from a profiles XML file, replacing the current version.
+ * The file is used by the following saves and it is created empty if missing.
+ * @param filename Profiles XML file.
+ */
+void ProfileLibrary::load(const std::string &filename)
+{
+    TRACE_SCOPE("ProfileLibrary::load");
+    ALLOC_SCOPE(Tools::AllocTag::XML);
+    xmlpp::DomParser parser;
+    std::vector<ProfilePtr> profiles;
+
+    if (!Glib::file_test(filename, Glib::FILE_TEST_EXISTS)) {
+        {
+            std::lock_guard<std::mutex> lock(this->m_save_mutex);
+
+            this->m_filename = filename;
+        }
+
+        this->update([](const ProfileSnapshotPtr&) {
+            return std::make_shared<const ProfileSnapshot>();
+        });
+        this->save();
+
+        return;
+    }
+
+    parser.set_substitute_entities();
+
+    {
+        Tools::MetricsTimer timer(s_xml_parse_time);
+
+        parser.parse_file(filename);
+    }
+
+    for (auto node : parser.get_document()->get_root_node()->get_children("profile")) {
+        auto element = static_cast<xmlpp::Element*>(node);
+        auto profile = std::make_shared<Profile>();
+
+        profile->id = element->get_attribute_value("id");
+
+        for (auto child : element->get_children()) {
+            auto child_element = dynamic_cast<xmlpp::Element*>(child);
+
+            if (child_element == nullptr) {
+                continue;
+            }
+
+            auto text_node = child_element->get_child_text();
+            auto name = child_element->get_name();
+            Glib::ustring content;
+
+            if (text_node != nullptr) {
+                content = text_node->get_content();
+            }
+
+            if (name == "title") {
+                profile->title = content;
+            } else if (name == "developer") {
+                profile->developer = content;
+            } else if (name == "publisher") {
+                profile->publisher = content;
+            } else if (name == "genre") {
+                profile->genre = content;
+            } else if (name == "year") {
+                profile->year = content;
+            } else if (name == "notes") {
+                profile->notes = content;
+            }
+        }
+
+        profiles.push_back(profile);
+    }
+
+    s_profiles_loaded.add(profiles.size());
+
+    {
+        std::lock_guard<std::mutex> lock(this->m_save_mutex);
+
+        this->m_filename = filename;
+    }
+
+    this->update([&profiles](const ProfileSnapshotPtr&) {
+        return ProfileSnapshot().with_profiles(profiles);
+    });
+}
+
+/**
+ * Writes the current version to the profiles XML file. The file is
+ * replaced once completely written, and left as it was if it can not be
+ * written. It can be called from any thread.
+ * @throw xmlpp::exception if the temporary file can not be written.
+ */
+void ProfileLibrary::save()
+{
+    TRACE_SCOPE("ProfileLibrary::save");
+    ALLOC_SCOPE(Tools::AllocTag::XML);
+    std::lock_guard<std::mutex> lock(this->m_save_mutex);
+    auto snapshot = this->get_snapshot();
+    auto temp_filename = this->m_filename + ".tmp";
+    xmlpp::Document document;
+    auto root = document.create_root_node("profiles");
+
+    snapshot->for_each([root](const ProfilePtr &profile) {
+        auto element = root->add_child("profile");
+
+        element->set_attribute("id", profile->id);
+        element->add_child("title")->set_child_text(profile->title);
+        element->add_child("developer")->set_child_text(profile->developer);
+        element->add_child("publisher")->set_child_text(profile->publisher);
+        element->add_child("genre")->set_child_text(profile->genre);
+        element->add_child("year")->set_child_text(profile->year);
+        element->add_child("notes")->set_child_text(profile->notes);
+    });
+
+    try {
+        document.write_to_file_formatted(temp_filename, "UTF-8");
+    } catch (...) {
+        std::remove(temp_filename.c_str());
+        throw;
+    }
+
+    if (std::rename(temp_filename.c_str(), this->m_filename.c_str()) != 0) {
+        LOG_ERROR(Tools::LogCategory::CONFIG, "Could not replace %1: %2", this->m_filename, std::strerror(errno));
+        std::remove(temp_filename.c_str());
+    }
+}
+
+/**
+ * Saves the library in background. Calls made before the write starts are
+ * written together. Errors are logged, as there is nobody to report them to.
+ */
+void ProfileLibrary::save_async()
+{
+    if (!this->m_save_pending.exchange(true)) {
+        this->m_save_tasks.push([this](const Tools::CancellationToken&) {
+            this->m_save_pending = false;
+
+            try {
+                this->save();
+            } catch (const Glib::Exception &e) {
+                LOG_ERROR(Tools::LogCategory::CONFIG, "Could not save the profiles: %1", e.what());
+            } catch (const std::exception &e) {
+                LOG_ERROR(Tools::LogCategory::CONFIG, "Could not save the profiles: %1", e.what());
+            }
+        });
+    }
+}
+
+/**
+ * Publishes a new version of the library. It can be called from any thread.
+ * @param change Function creating the new version from the current one.
+ */
+void ProfileLibrary::update(const std::function<ProfileSnapshotPtr(const ProfileSnapshotPtr&)> &change)
+{
+    std::lock_guard<std::mutex> lock(this->m_write_mutex);
+
+    this->m_snapshot.store(change(this->m_snapshot.load()));
+}
+
+/**
+ * Adds or replaces a profile.
+ * @param profile Profile to be stored.
+ */
+void ProfileLibrary::set_profile(const ProfilePtr &profile)
+{
+    this->update([&profile](const ProfileSnapshotPtr &snapshot) {
+        return snapshot->with_profile(profile);
+    });
+}
+
+/**
+ * Adds a new profile with the first unused numeric ID.
+ * @param profile Profile to be added. Its ID is ignored.
+ * @return The ID of the new profile.
+ */
+Glib::ustring ProfileLibrary::add_profile(Profile profile)
+{
+    this->update([&profile](const ProfileSnapshotPtr &snapshot) {
+        guint index = 0;
+
+        while (snapshot->find(Glib::ustring::compose("%1", index))) {
+            ++index;
+        }
+
+        profile.id = Glib::ustring::compose("%1", index);
+
+        return snapshot->with_profile(std::make_shared<const Profile>(profile));
+    });
+
+    return profile.id;
+}
+
+/**
+ * Removes a profile.
+ * @param id Profile ID.
+ */
+void ProfileLibrary::remove_profile(const Glib::ustring &id)
+{
+    this->update([&id](const ProfileSnapshotPtr &snapshot) {
+        return snapshot->without_profile(id);
+    });
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,125 @@
+/**
+ * @file
+ * Profile, ProfileSnapshot and ProfileLibrary classes declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef PROFILELIBRARY_H
+#define PROFILELIBRARY_H
+
+#define PROFILE_SNAPSHOT_CHUNK_SIZE 64 ///< Profiles per snapshot chunk.
+
+#include "taskgroup.hpp"
+#include <glibmm/ustring.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Game profile data stored in the profiles XML file.
+ * Once shared through a snapshot a profile must not be modified, a changed
+ * copy must be stored instead.
+ */
+struct Profile
+{
+    Glib::ustring id,        ///< Profile ID.
+                  title,     ///< Game title.
+                  developer, ///< Game developer.
+                  publisher, ///< Game publisher.
+                  genre,     ///< Game genre.
+                  year,      ///< Release year.
+                  notes;     ///< User notes.
+};
+
+typedef std::shared_ptr<const Profile> ProfilePtr;
+
+class ProfileSnapshot;
+typedef std::shared_ptr<const ProfileSnapshot> ProfileSnapshotPtr;
+
+/**
+ * Immutable version of the profile collection.
+ * Profiles are stored in fixed size chunks shared between versions, so a new
+ * version only copies the chunk containing the changed profile and the chunk
+ * pointers. The ID index is shared too, and only copied when profiles are
+ * added or removed. Removed profiles leave an empty slot until there are too
+ * many of them.
+ * Snapshots can be read from any thread without locking.
+ */
+class ProfileSnapshot final
+{
+private:
+    typedef std::vector<ProfilePtr> Chunk;
+    typedef std::unordered_map<std::string, std::size_t> Index;
+
+    std::vector<std::shared_ptr<const Chunk>> m_chunks; ///< Profile slots, PROFILE_SNAPSHOT_CHUNK_SIZE per chunk.
+    std::shared_ptr<const Index> m_index;               ///< Slot of each profile by ID.
+    std::size_t m_slots = 0,                            ///< Used slots, including empty ones.
+                m_size  = 0;                            ///< Number of profiles.
+
+    std::shared_ptr<Chunk> copy_chunk(std::size_t slot);
+    void compact();
+
+public:
+    ProfileSnapshot();
+
+    std::size_t size() const;
+    bool empty() const;
+    ProfilePtr find(const Glib::ustring &id) const;
+    std::vector<ProfilePtr> get_profiles() const;
+    void for_each(const std::function<void(const ProfilePtr&)> &function) const;
+
+    ProfileSnapshotPtr with_profiles(const std::vector<ProfilePtr> &profiles) const;
+    ProfileSnapshotPtr with_profile(const ProfilePtr &profile) const;
+    ProfileSnapshotPtr without_profile(const Glib::ustring &id) const;
+};
+
+/**
+ * The game profiles library, kept in the profiles XML file.
+ * Readers take the current snapshot with get_snapshot() and use it as long
+ * as they need, from any thread and without locks, while writers publish new
+ * versions. Writers are serialized among themselves and never block the
+ * readers. Saving writes the snapshot current at the moment of the write, so
+ * several changes saved with save_async() in a row are written once.
+ */
+class ProfileLibrary final
+{
+private:
+    std::atomic<ProfileSnapshotPtr> m_snapshot; ///< Current version.
+    std::mutex m_write_mutex;                   ///< Serializes the writers.
+    std::mutex m_save_mutex;                    ///< Serializes the file writes.
+    std::string m_filename;                     ///< Profiles XML file.
+    std::atomic<bool> m_save_pending;           ///< Whether a save_async() write is queued.
+    Tools::TaskGroup m_save_tasks;              ///< Pending file writes.
+
+public:
+    ProfileLibrary();
+    ~ProfileLibrary();
+
+    ProfileLibrary(const ProfileLibrary&) = delete;
+    ProfileLibrary &operator=(const ProfileLibrary&) = delete;
+
+    ProfileSnapshotPtr get_snapshot() const;
+    void load(const std::string &filename);
+    void save();
+    void save_async();
+    void update(const std::function<ProfileSnapshotPtr(const ProfileSnapshotPtr&)> &change);
+    void set_profile(const ProfilePtr &profile);
+    Glib::ustring add_profile(Profile profile);
+    void remove_profile(const Glib::ustring &id);
+};
+
+} // DOSBoxGTK
+
+#endif // PROFILELIBRARY_H
@@ -0,0 +1,582 @@
+/**
+ * @file
+ * ProfileSearchIndex class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profilesearchindex.h"
+#include "texttools.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+typedef uint32_t U32x4 __attribute__((vector_size(16))); ///< Four 32 bit lanes, an SSE2 register.
+
+/**
+ * Gets the key of a trigram.
+ * @param text Text starting with the trigram.
+ * @return Trigram key.
+ */
+static inline uint32_t get_trigram(const char *text)
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(text[0])) << 16 |
+           static_cast<uint32_t>(static_cast<uint8_t>(text[1])) << 8 |
+           static_cast<uint32_t>(static_cast<uint8_t>(text[2]));
+}
+
+/**
+ * Splits a normalized text into its words.
+ * @param text Normalized text.
+ * @return Words, pointing into the text.
+ */
+static std::vector<std::string_view> get_words(std::string_view text)
+{
+    std::vector<std::string_view> words;
+    std::size_t start = 0;
+
+    while (start < text.size()) {
+        auto end = text.find(' ', start);
+
+        if (end == std::string_view::npos) {
+            end = text.size();
+        }
+
+        if (end > start) {
+            words.push_back(text.substr(start, end - start));
+        }
+
+        start = end + 1;
+    }
+
+    return words;
+}
+
+/**
+ * Normalizes a text for searching: lowercase words without accents, as
+ * folded by Tools::fold_words().
+ * @param text Text.
+ * @return Normalized text.
+ */
+std::string ProfileSearchIndex::normalize(const Glib::ustring &text)
+{
+    return Tools::fold_words(text);
+}
+
+/**
+ * Adds the trigrams of a word, padded with two leading spaces so the
+ * beginning of the word can be searched with one or two characters.
+ * @param word Normalized word.
+ * @param trigrams Where the trigrams are added.
+ */
+void ProfileSearchIndex::add_trigrams(std::string_view word, std::vector<uint32_t> &trigrams)
+{
+    std::string padded = "  ";
+
+    padded += word;
+
+    for (std::size_t i = 0; i + 3 <= padded.size(); ++i) {
+        trigrams.push_back(get_trigram(padded.data() + i));
+    }
+}
+
+/**
+ * Gets the trigrams of a normalized text.
+ * @param text Normalized text.
+ * @return Sorted trigrams, without duplicates.
+ */
+std::vector<uint32_t> ProfileSearchIndex::get_trigrams(std::string_view text)
+{
+    std::vector<uint32_t> trigrams;
+
+    for (auto word : get_words(text)) {
+        add_trigrams(word, trigrams);
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    return trigrams;
+}
+
+/**
+ * Decodes the documents of a block.
+ * @param block Block.
+ * @param docs Where the documents are stored, replacing its contents.
+ */
+void ProfileSearchIndex::decode(const Block &block, std::vector<uint32_t> &docs)
+{
+    auto doc = block.first;
+    uint32_t gap = 0;
+    unsigned shift = 0;
+
+    docs.clear();
+    docs.reserve(block.count);
+    docs.push_back(doc);
+
+    for (auto byte : block.gaps) {
+        gap |= static_cast<uint32_t>(byte & 0x7f) << shift;
+        shift += 7;
+
+        if (!(byte & 0x80)) {
+            doc += gap;
+            docs.push_back(doc);
+            gap = shift = 0;
+        }
+    }
+}
+
+/**
+ * Encodes sorted documents into a block.
+ * @param docs Documents.
+ * @param count Number of documents, from 1 to PROFILE_SEARCH_BLOCK_SIZE.
+ * @param block Where the documents are stored, replacing its contents.
+ */
+void ProfileSearchIndex::encode(const uint32_t *docs, std::size_t count, Block &block)
+{
+    block.first = docs[0];
+    block.last  = docs[count - 1];
+    block.count = count;
+    block.gaps.clear();
+
+    for (std::size_t i = 1; i < count; ++i) {
+        auto gap = docs[i] - docs[i - 1];
+
+        while (gap >= 0x80) {
+            block.gaps.push_back(static_cast<uint8_t>(gap | 0x80));
+            gap >>= 7;
+        }
+
+        block.gaps.push_back(static_cast<uint8_t>(gap));
+    }
+}
+
+/**
+ * Appends a document to a postings list.
+ * @param postings Postings list.
+ * @param doc Document, greater than any other in the list.
+ */
+void ProfileSearchIndex::append(Postings &postings, uint32_t doc)
+{
+    if (postings.blocks.empty() || postings.blocks.back().count == PROFILE_SEARCH_BLOCK_SIZE) {
+        postings.blocks.emplace_back();
+        encode(&doc, 1, postings.blocks.back());
+    } else {
+        auto &block = postings.blocks.back();
+        auto gap = doc - block.last;
+
+        while (gap >= 0x80) {
+            block.gaps.push_back(static_cast<uint8_t>(gap | 0x80));
+            gap >>= 7;
+        }
+
+        block.gaps.push_back(static_cast<uint8_t>(gap));
+        block.last = doc;
+        ++block.count;
+    }
+
+    ++postings.size;
+}
+
+/**
+ * Removes a document from a postings list, encoding again its block.
+ * @param postings Postings list.
+ * @param doc Document.
+ */
+void ProfileSearchIndex::erase(Postings &postings, uint32_t doc)
+{
+    auto block = std::lower_bound(postings.blocks.begin(), postings.blocks.end(), doc,
+                                  [](const Block &item, uint32_t value) { return item.last < value; });
+
+    if (block == postings.blocks.end() || block->first > doc) {
+        return;
+    }
+
+    std::vector<uint32_t> docs;
+
+    decode(*block, docs);
+
+    auto pos = std::lower_bound(docs.begin(), docs.end(), doc);
+
+    if (pos == docs.end() || *pos != doc) {
+        return;
+    }
+
+    docs.erase(pos);
+    --postings.size;
+
+    if (docs.empty()) {
+        postings.blocks.erase(block);
+    } else {
+        encode(docs.data(), docs.size(), *block);
+    }
+}
+
+/**
+ * Intersects sorted documents with a postings list. Only the blocks
+ * overlapping the documents are decoded.
+ * @param docs Sorted documents, replaced by the intersection.
+ * @param postings Postings list.
+ */
+void ProfileSearchIndex::intersect(std::vector<uint32_t> &docs, const Postings &postings)
+{
+    std::vector<uint32_t> result,
+                          buffer;
+    auto block = postings.blocks.begin();
+    auto doc = docs.begin();
+
+    while (doc != docs.end()) {
+        // First block which may hold the document.
+        block = std::lower_bound(block, postings.blocks.end(), *doc,
+                                 [](const Block &item, uint32_t value) { return item.last < value; });
+
+        if (block == postings.blocks.end()) {
+            break;
+        }
+
+        auto begin = std::lower_bound(doc, docs.end(), block->first),
+             end   = std::upper_bound(begin, docs.end(), block->last);
+
+        if (begin != end) {
+            decode(*block, buffer);
+            intersect(&*begin, end - begin, buffer.data(), buffer.size(), result);
+        }
+
+        doc = end;
+        ++block;
+    }
+
+    docs.swap(result);
+}
+
+/**
+ * Intersects two sorted lists of documents without duplicates. Four
+ * documents of each list are compared at once against every rotation of the
+ * other four, and the list with the smallest last document advances.
+ * @param a First list.
+ * @param na Length of the first list.
+ * @param b Second list.
+ * @param nb Length of the second list.
+ * @param result Where the common documents are appended.
+ */
+void ProfileSearchIndex::intersect(const uint32_t *a, std::size_t na, const uint32_t *b, std::size_t nb, std::vector<uint32_t> &result)
+{
+    auto count = result.size();
+    std::size_t i = 0,
+                j = 0;
+
+    result.resize(count + std::min(na, nb));
+
+    while (i + 4 <= na && j + 4 <= nb) {
+        U32x4 va,
+              vb;
+
+        std::memcpy(&va, a + i, sizeof(va));
+        std::memcpy(&vb, b + j, sizeof(vb));
+
+        auto matches = (va == vb) |
+                       (va == __builtin_shufflevector(vb, vb, 1, 2, 3, 0)) |
+                       (va == __builtin_shufflevector(vb, vb, 2, 3, 0, 1)) |
+                       (va == __builtin_shufflevector(vb, vb, 3, 0, 1, 2));
+
+        for (unsigned lane = 0; lane < 4; ++lane) {
+            result[count] = a[i + lane];
+            count += matches[lane] & 1;
+        }
+
+        auto last_a = a[i + 3],
+             last_b = b[j + 3];
+
+        i += last_a <= last_b ? 4 : 0;
+        j += last_b <= last_a ? 4 : 0;
+    }
+
+    while (i < na && j < nb) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (b[j] < a[i]) {
+            ++j;
+        } else {
+            result[count++] = a[i];
+            ++i;
+            ++j;
+        }
+    }
+
+    result.resize(count);
+}
+
+/**
+ * Adds a profile as a new document.
+ * @param profile Profile, not in the index.
+ */
+void ProfileSearchIndex::add_document(const ProfilePtr &profile)
+{
+    auto doc = static_cast<uint32_t>(this->m_profiles.size());
+    std::string text;
+
+    for (auto field : {&profile->title, &profile->developer, &profile->publisher, &profile->genre, &profile->year, &profile->notes}) {
+        auto words = normalize(*field);
+
+        if (!words.empty()) {
+            if (!text.empty()) {
+                text += ' ';
+            }
+
+            text += words;
+        }
+    }
+
+    for (auto trigram : get_trigrams(text)) {
+        append(this->m_postings[trigram], doc);
+    }
+
+    this->m_profiles.push_back(profile);
+    this->m_texts.push_back(std::move(text));
+    this->m_docs[profile->id.raw()] = doc;
+}
+
+/**
+ * Frees a document, removing it from the postings of its trigrams.
+ * @param doc Document in use.
+ */
+void ProfileSearchIndex::remove_document(uint32_t doc)
+{
+    for (auto trigram : get_trigrams(this->m_texts[doc])) {
+        auto postings = this->m_postings.find(trigram);
+
+        if (postings != this->m_postings.end()) {
+            erase(postings->second, doc);
+
+            if (postings->second.size == 0) {
+                this->m_postings.erase(postings);
+            }
+        }
+    }
+
+    this->m_docs.erase(this->m_profiles[doc]->id.raw());
+    this->m_profiles[doc] = nullptr;
+    std::string().swap(this->m_texts[doc]);
+    ++this->m_free;
+}
+
+/**
+ * Renumbers the documents once most of them are free. The postings are
+ * built again from the kept texts.
+ */
+void ProfileSearchIndex::compact()
+{
+    if (this->m_free <= PROFILE_SEARCH_BLOCK_SIZE || this->m_free <= this->m_docs.size()) {
+        return;
+    }
+
+    auto profiles = std::move(this->m_profiles);
+    auto texts = std::move(this->m_texts);
+
+    this->clear();
+
+    for (std::size_t i = 0; i < profiles.size(); ++i) {
+        if (profiles[i]) {
+            auto doc = static_cast<uint32_t>(this->m_profiles.size());
+
+            for (auto trigram : get_trigrams(texts[i])) {
+                append(this->m_postings[trigram], doc);
+            }
+
+            this->m_docs[profiles[i]->id.raw()] = doc;
+            this->m_profiles.push_back(std::move(profiles[i]));
+            this->m_texts.push_back(std::move(texts[i]));
+        }
+    }
+}
+
+/**
+ * Removes every profile.
+ */
+void ProfileSearchIndex::clear()
+{
+    this->m_postings.clear();
+    this->m_profiles.clear();
+    this->m_texts.clear();
+    this->m_docs.clear();
+    this->m_free = 0;
+}
+
+/**
+ * Makes the index hold the profiles of a library snapshot. Only the
+ * profiles changed since they were indexed are indexed again, so syncing
+ * with a slightly different snapshot is fast.
+ * @param snapshot Library snapshot.
+ */
+void ProfileSearchIndex::sync(const ProfileSnapshotPtr &snapshot)
+{
+    std::vector<bool> seen(this->m_profiles.size());
+
+    snapshot->for_each([this, &seen](const ProfilePtr &profile) {
+        auto doc = this->m_docs.find(profile->id.raw());
+
+        if (doc != this->m_docs.end()) {
+            if (this->m_profiles[doc->second] == profile) {
+                seen[doc->second] = true;
+                return;
+            }
+
+            this->remove_document(doc->second);
+        }
+
+        this->add_document(profile);
+    });
+
+    for (uint32_t doc = 0; doc < seen.size(); ++doc) {
+        if (!seen[doc] && this->m_profiles[doc]) {
+            this->remove_document(doc);
+        }
+    }
+
+    this->compact();
+}
+
+/**
+ * Adds a profile or indexes it again if it has changed.
+ * @param profile Profile.
+ */
+void ProfileSearchIndex::update(const ProfilePtr &profile)
+{
+    auto doc = this->m_docs.find(profile->id.raw());
+
+    if (doc != this->m_docs.end()) {
+        if (this->m_profiles[doc->second] == profile) {
+            return;
+        }
+
+        this->remove_document(doc->second);
+    }
+
+    this->add_document(profile);
+    this->compact();
+}
+
+/**
+ * Removes a profile.
+ * @param id Profile ID.
+ */
+void ProfileSearchIndex::remove(const Glib::ustring &id)
+{
+    auto doc = this->m_docs.find(id.raw());
+
+    if (doc != this->m_docs.end()) {
+        this->remove_document(doc->second);
+        this->compact();
+    }
+}
+
+/**
+ * Gets the number of indexed profiles.
+ * @return Number of profiles.
+ */
+std::size_t ProfileSearchIndex::size() const
+{
+    return this->m_docs.size();
+}
+
+/**
+ * Checks whether there are no indexed profiles.
+ * @return @c TRUE if the index is empty or @c FALSE otherwise.
+ */
+bool ProfileSearchIndex::empty() const
+{
+    return this->m_docs.empty();
+}
+
+/**
+ * Looks for the profiles matching every word of a query. Words of one or
+ * two characters match the beginning of a word, longer ones match anywhere
+ * in a word.
+ * @param query Searched text, not normalized.
+ * @return Matching profiles, every profile if the query has no words.
+ */
+std::vector<ProfilePtr> ProfileSearchIndex::search(const Glib::ustring &query) const
+{
+    auto text = normalize(query);
+    auto words = get_words(text);
+    std::vector<std::string_view> checked;
+    std::vector<uint32_t> trigrams,
+                          docs;
+    std::vector<const Postings*> lists;
+    std::vector<ProfilePtr> profiles;
+
+    if (words.empty()) {
+        std::copy_if(this->m_profiles.begin(), this->m_profiles.end(), std::back_inserter(profiles),
+                     [](const ProfilePtr &profile) { return profile != nullptr; });
+
+        return profiles;
+    }
+
+    for (auto word : words) {
+        if (word.size() < 3) {
+            std::string padded(3 - word.size(), ' ');
+
+            padded += word;
+            trigrams.push_back(get_trigram(padded.data()));
+        } else {
+            for (std::size_t i = 0; i + 3 <= word.size(); ++i) {
+                trigrams.push_back(get_trigram(word.data() + i));
+            }
+
+            // The trigrams may appear in different places of the text.
+            if (word.size() > 3) {
+                checked.push_back(word);
+            }
+        }
+    }
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    for (auto trigram : trigrams) {
+        auto postings = this->m_postings.find(trigram);
+
+        if (postings == this->m_postings.end()) {
+            return profiles;
+        }
+
+        lists.push_back(&postings->second);
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const Postings *a, const Postings *b) { return a->size < b->size; });
+
+    // The shortest list is decoded whole, the others only where they overlap.
+    std::vector<uint32_t> buffer;
+
+    docs.reserve(lists[0]->size);
+
+    for (auto &block : lists[0]->blocks) {
+        decode(block, buffer);
+        docs.insert(docs.end(), buffer.begin(), buffer.end());
+    }
+
+    for (std::size_t i = 1; i < lists.size() && !docs.empty(); ++i) {
+        intersect(docs, *lists[i]);
+    }
+
+    profiles.reserve(docs.size());
+
+    for (auto doc : docs) {
+        std::string_view doc_text = this->m_texts[doc];
+
+        if (std::all_of(checked.begin(), checked.end(), [doc_text](std::string_view word) { return doc_text.find(word) != std::string_view::npos; })) {
+            profiles.push_back(this->m_profiles[doc]);
+        }
+    }
+
+    return profiles;
+}
+
+} // DOSBoxGTK
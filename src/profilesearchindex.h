@@ -0,0 +1,101 @@
+/**
+ * @file
+ * ProfileSearchIndex class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef PROFILESEARCHINDEX_H
+#define PROFILESEARCHINDEX_H
+
+#define PROFILE_SEARCH_BLOCK_SIZE 128 ///< Documents per compressed postings block.
+
+#include "profilelibrary.h"
+#include <glibmm/ustring.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Trigram inverted index of the profiles text, for searching as the user
+ * types.
+ * The title, developer, publisher, genre, year and notes of every profile are
+ * normalized into lowercase words without accents. Each profile is a
+ * document, and each trigram of its words, padded with two leading spaces,
+ * points to the documents holding it. Searched words of one or two
+ * characters match the beginning of a word, longer ones match anywhere in a
+ * word. Every searched word must match.
+ * The documents of each trigram are kept sorted in blocks of
+ * PROFILE_SEARCH_BLOCK_SIZE, encoded as variable length gaps. Searching
+ * intersects the lists from the shortest one, skipping the blocks out of the
+ * range of the remaining documents and comparing four documents against four
+ * at once with vector instructions.
+ * Documents are numbered in insertion order, so new documents are always
+ * appended to the blocks. A changed profile is removed and added again as a
+ * new document, and the index is renumbered once most documents are free.
+ * Instances must be used from a single thread.
+ */
+class ProfileSearchIndex final
+{
+private:
+    /**
+     * Compressed block of documents.
+     */
+    struct Block
+    {
+        uint32_t first = 0,        ///< First document.
+                 last  = 0,        ///< Last document.
+                 count = 0;        ///< Number of documents.
+        std::vector<uint8_t> gaps; ///< Gaps between the documents after the first one, as varints.
+    };
+
+    /**
+     * Sorted documents holding a trigram.
+     */
+    struct Postings
+    {
+        std::vector<Block> blocks; ///< Blocks, in document order.
+        std::size_t size = 0;      ///< Number of documents.
+    };
+
+    std::unordered_map<uint32_t, Postings> m_postings; ///< Documents by trigram.
+    std::vector<ProfilePtr> m_profiles;                ///< Profile of each document, null for free ones.
+    std::vector<std::string> m_texts;                  ///< Normalized text of each document.
+    std::unordered_map<std::string, uint32_t> m_docs;  ///< Document of each profile ID.
+    std::size_t m_free = 0;                            ///< Number of free documents.
+
+    static std::string normalize(const Glib::ustring &text);
+    static void add_trigrams(std::string_view word, std::vector<uint32_t> &trigrams);
+    static std::vector<uint32_t> get_trigrams(std::string_view text);
+    static void decode(const Block &block, std::vector<uint32_t> &docs);
+    static void encode(const uint32_t *docs, std::size_t count, Block &block);
+    static void append(Postings &postings, uint32_t doc);
+    static void erase(Postings &postings, uint32_t doc);
+    static void intersect(std::vector<uint32_t> &docs, const Postings &postings);
+    static void intersect(const uint32_t *a, std::size_t na, const uint32_t *b, std::size_t nb, std::vector<uint32_t> &result);
+    void add_document(const ProfilePtr &profile);
+    void remove_document(uint32_t doc);
+    void compact();
+
+public:
+    void clear();
+    void sync(const ProfileSnapshotPtr &snapshot);
+    void update(const ProfilePtr &profile);
+    void remove(const Glib::ustring &id);
+    std::size_t size() const;
+    bool empty() const;
+    std::vector<ProfilePtr> search(const Glib::ustring &query) const;
+};
+
+} // DOSBoxGTK
+
+#endif // PROFILESEARCHINDEX_H
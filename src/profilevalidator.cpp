@@ -0,0 +1,356 @@
+/**
+ * @file
+ * ProfileValidator class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profilevalidator.h"
+#include "config.h"
+#include "autoexec.h"
+#include "mountcommand.h"
+#include "imgmountcommand.h"
+#include "metrics.hpp"
+#include "allocaccounting.hpp"
+#include <glibmm/i18n.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/keyfile.h>
+#include <glibmm/miscutils.h>
+#include <glib/gstdio.h>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+static auto &s_cache_hits   = Tools::Metrics::get_counter("dosboxgtk_validator_cache_hits_total", "File kind and config file lookups served from the validator cache."); ///< Validator cache hits counter.
+static auto &s_cache_misses = Tools::Metrics::get_counter("dosboxgtk_validator_cache_misses_total", "File kind and config file lookups missing the validator cache.");   ///< Validator cache misses counter.
+
+/**
+ * Gets a short label for the kind of issue.
+ * @return Issue label.
+ */
+Glib::ustring ProfileIssue::get_label() const
+{
+    Glib::ustring label;
+
+    switch (this->type) {
+    case ProfileIssueType::MISSING_CONFIG:
+        label = _("Missing config file");
+        break;
+    case ProfileIssueType::MISSING_PROGRAM:
+        label = _("Missing program");
+        break;
+    case ProfileIssueType::UNMOUNTED_PROGRAM:
+        label = _("Unmounted program drive");
+        break;
+    case ProfileIssueType::MISSING_MOUNT_DIR:
+        label = _("Missing mounted directory");
+        break;
+    case ProfileIssueType::MISSING_IMAGE:
+        label = _("Missing mounted image");
+        break;
+    case ProfileIssueType::MISSING_BOOT_IMAGE:
+        label = _("Missing boot image");
+        break;
+    case ProfileIssueType::MISSING_MAPPER_FILE:
+        label = _("Missing mapper file");
+        break;
+    case ProfileIssueType::MISSING_LANGUAGE_FILE:
+        label = _("Missing language file");
+        break;
+    case ProfileIssueType::MISSING_CAPTURES_DIR:
+        label = _("Missing captures directory");
+        break;
+    }
+
+    return label;
+}
+
+/**
+ * Gets a human readable description of the issue.
+ * @return Issue description.
+ */
+Glib::ustring ProfileIssue::describe() const
+{
+    return Glib::ustring::compose("%1: %2", this->get_label(), this->path);
+}
+
+/**
+ * Constructor.
+ * @param profiles_path Directory containing the profiles config files.
+ */
+ProfileValidator::ProfileValidator(const Glib::ustring &profiles_path) :
+    m_profiles_path(profiles_path)
+{}
+
+/**
+ * Gets the kind of a file system entry.
+ * @param path Path of the entry.
+ * @param mtime If not @c nullptr, it receives the modification time.
+ * @return File kind.
+ */
+ProfileValidator::FileKind ProfileValidator::stat(const std::string &path, gint64 *mtime)
+{
+    GStatBuf buf;
+    auto kind = FileKind::NONE;
+
+    if (g_stat(path.c_str(), &buf) == 0) {
+        kind = S_ISREG(buf.st_mode) ? FileKind::REGULAR : S_ISDIR(buf.st_mode) ? FileKind::DIR : FileKind::OTHER;
+
+        if (mtime != nullptr) {
+            *mtime = buf.st_mtime;
+        }
+    }
+
+    return kind;
+}
+
+/**
+ * Gets the file kind of every path of the given checks. Paths alredy stat'ed
+ * in the current pass are taken from the cache. Checks expecting
+ * FileKind::NONE always fail and are not stat'ed.
+ * @param checks Pending checks.
+ * @param kinds Map receiving the file kind of each path.
+ */
+void ProfileValidator::stat_batch(const std::vector<Check> &checks, std::map<std::string, FileKind> &kinds)
+{
+    std::vector<std::string> missing;
+
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+
+        for (auto &check : checks) {
+            for (auto path : {check.path, check.alt_path}) {
+                if (check.kind == FileKind::NONE || path.empty() || kinds.find(path) != kinds.end()) {
+                    continue;
+                }
+
+                auto iter = this->m_stat_cache.find(path);
+
+                if (iter != this->m_stat_cache.end()) {
+                    kinds[path] = iter->second;
+                    s_cache_hits.add();
+                } else {
+                    kinds[path] = FileKind::NONE;
+                    missing.push_back(path);
+                }
+            }
+        }
+    }
+
+    s_cache_misses.add(missing.size());
+
+    for (auto &path : missing) {
+        kinds[path] = ProfileValidator::stat(path);
+    }
+
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+
+    for (auto &path : missing) {
+        this->m_stat_cache[path] = kinds[path];
+    }
+}
+
+/**
+ * Gets the information of a config file, parsing it only if it has changed
+ * since the last time.
+ * @param filename Config file.
+ * @param for_setup Whether it is a setup config file.
+ * @return Config file information.
+ */
+ProfileValidator::ConfigEntry ProfileValidator::get_config_entry(const std::string &filename, bool for_setup)
+{
+    gint64 mtime = 0;
+
+    if (ProfileValidator::stat(filename, &mtime) != FileKind::REGULAR) {
+        return ConfigEntry();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        auto iter = this->m_config_cache.find(filename);
+
+        if (iter != this->m_config_cache.end() && iter->second.mtime == mtime) {
+            s_cache_hits.add();
+            return iter->second;
+        }
+    }
+
+    s_cache_misses.add();
+
+    auto entry = this->parse_config(filename, for_setup);
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+
+    entry.mtime = mtime;
+    this->m_config_cache[filename] = entry;
+
+    return entry;
+}
+
+/**
+ * Parses a config file to collect the paths it references and its
+ * emulation settings.
+ * @param filename Config file.
+ * @param for_setup If @c TRUE only the setup program is collected.
+ * @return Config file information.
+ */
+ProfileValidator::ConfigEntry ProfileValidator::parse_config(const std::string &filename, bool for_setup) const
+{
+    ALLOC_SCOPE(Tools::AllocTag::CONFIG);
+    ConfigEntry entry;
+    Glib::ustring contents;
+
+    try {
+        contents = Glib::file_get_contents(filename);
+    } catch (const Glib::FileError &) {
+        return entry;
+    }
+
+    auto parts = Autoexec::split(contents);
+
+    entry.readable = true;
+
+    if (!for_setup) {
+        Glib::KeyFile config;
+
+        try {
+            config.load_from_data(parts[0]);
+
+            // Missing keys take the DOSBox default values.
+            entry.settings.machine = config.has_key("dosbox", "machine") ? config.get_value("dosbox", "machine") : "svga_s3";
+            entry.settings.core    = config.has_key("cpu", "core") ? config.get_value("cpu", "core") : "auto";
+            entry.settings.sbtype  = config.has_key("sblaster", "sbtype") ? config.get_value("sblaster", "sbtype") : "sb16";
+
+            if (config.has_key("sdl", "mapperfile") && !config.get_value("sdl", "mapperfile").empty()) {
+                auto mapper_file = config.get_value("sdl", "mapperfile");
+                auto alt_mapper_file = Glib::build_filename(Glib::get_user_data_dir(), PROJECT_NAME, Glib::path_get_basename(mapper_file));
+
+                entry.checks.push_back({ProfileIssueType::MISSING_MAPPER_FILE, mapper_file, FileKind::REGULAR, alt_mapper_file});
+            }
+
+            if (config.has_key("dosbox", "language") && !config.get_value("dosbox", "language").empty()) {
+                entry.checks.push_back({ProfileIssueType::MISSING_LANGUAGE_FILE, config.get_value("dosbox", "language"), FileKind::REGULAR, std::string()});
+            }
+
+            if (config.has_key("dosbox", "captures") && !config.get_value("dosbox", "captures").empty()) {
+                entry.checks.push_back({ProfileIssueType::MISSING_CAPTURES_DIR, config.get_value("dosbox", "captures"), FileKind::DIR, std::string()});
+            }
+        } catch (const Glib::KeyFileError &) {
+            // A malformed config is handled by DOSBox itself, only the
+            // autoexec group matters from here.
+        }
+    }
+
+    if (parts.size() > 1) {
+        auto info = Autoexec::parse(parts[1], for_setup);
+
+        for (auto command : info.mount_commands) {
+            MountCommand m_command(command);
+
+            if (m_command.get_letter() != '\0') {
+                entry.mounts.insert({Glib::ustring(1, m_command.get_letter()), m_command.get_host_dir()});
+                entry.checks.push_back({ProfileIssueType::MISSING_MOUNT_DIR, m_command.get_host_dir(), FileKind::DIR, std::string()});
+            } else {
+                ImgmountCommand im_command(command);
+
+                if (im_command.get_letter() != '\0') {
+                    entry.mounts.insert({Glib::ustring(1, im_command.get_letter()), Glib::ustring()});
+                }
+
+                for (auto image : im_command.get_images()) {
+                    entry.checks.push_back({ProfileIssueType::MISSING_IMAGE, image, FileKind::REGULAR, std::string()});
+                }
+            }
+        }
+
+        if (!for_setup) {
+            entry.settings.has_booter  = info.has_booter;
+            entry.settings.has_program = info.has_program && !info.has_booter;
+        }
+
+        if (info.has_booter) {
+            for (auto image : info.boot_images) {
+                entry.checks.push_back({ProfileIssueType::MISSING_BOOT_IMAGE, image, FileKind::REGULAR, std::string()});
+            }
+        } else if (info.has_program) {
+            entry.check_program = true;
+            entry.drive_letter  = info.drive_letter.uppercase();
+            entry.path          = info.path;
+            entry.program       = info.program;
+        }
+    }
+
+    return entry;
+}
+
+/**
+ * Starts a new validation pass. The file kinds cached by the previous pass
+ * are discarded, the parsed config files are kept.
+ */
+void ProfileValidator::begin_pass()
+{
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+
+    this->m_stat_cache.clear();
+}
+
+/**
+ * Validates a game profile.
+ * @param id Profile ID.
+ * @param settings Where the emulation settings found in the config file are
+ * stored, if not null.
+ * @return std::vector with the issues found, empty if the profile is fine.
+ */
+std::vector<ProfileIssue> ProfileValidator::validate(const Glib::ustring &id, ProfileSettings *settings)
+{
+    auto config_filename = Glib::build_filename(this->m_profiles_path, Glib::ustring::compose("%1.conf", id)),
+         setup_filename  = Glib::build_filename(this->m_profiles_path, Glib::ustring::compose("%1_setup.conf", id));
+    std::vector<ProfileIssue> issues;
+    std::vector<Check> checks;
+    std::map<std::string, FileKind> kinds;
+    auto config = this->get_config_entry(config_filename, false);
+
+    if (settings) {
+        *settings = config.settings;
+    }
+
+    if (!config.readable) {
+        issues.push_back({ProfileIssueType::MISSING_CONFIG, config_filename});
+
+        return issues;
+    }
+
+    auto setup = this->get_config_entry(setup_filename, true);
+
+    checks = config.checks;
+
+    // The programs are resolved with the mounting points of the main config.
+    for (auto entry : {&config, &setup}) {
+        if (entry->check_program) {
+            auto iter = config.mounts.find(entry->drive_letter);
+
+            if (iter == config.mounts.end()) {
+                checks.push_back({ProfileIssueType::UNMOUNTED_PROGRAM, entry->drive_letter, FileKind::NONE, std::string()});
+            } else if (!iter->second.empty()) {
+                checks.push_back({ProfileIssueType::MISSING_PROGRAM, Glib::build_filename(iter->second, entry->path, entry->program), FileKind::REGULAR, std::string()});
+            }
+        }
+    }
+
+    this->stat_batch(checks, kinds);
+
+    for (auto &check : checks) {
+        auto passed = check.kind != FileKind::NONE && (kinds[check.path] == check.kind || (!check.alt_path.empty() && kinds[check.alt_path] == check.kind));
+
+        if (!passed) {
+            issues.push_back({check.issue, check.path});
+        }
+    }
+
+    return issues;
+}
+
+} // DOSBoxGTK
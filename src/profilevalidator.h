@@ -0,0 +1,134 @@
+/**
+ * @file
+ * ProfileValidator class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef PROFILEVALIDATOR_H
+#define PROFILEVALIDATOR_H
+
+#include <glibmm/ustring.h>
+#include <glib.h>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Kinds of problems a game profile can have.
+ */
+enum class ProfileIssueType
+{
+    MISSING_CONFIG,        ///< The profile's config file can not be read.
+    MISSING_PROGRAM,       ///< The program executable does not exist.
+    UNMOUNTED_PROGRAM,     ///< The program drive letter is not mounted.
+    MISSING_MOUNT_DIR,     ///< A mounted host directory does not exist.
+    MISSING_IMAGE,         ///< An IMGMOUNT image does not exist.
+    MISSING_BOOT_IMAGE,    ///< A BOOT image does not exist.
+    MISSING_MAPPER_FILE,   ///< The keyboard mapper file does not exist.
+    MISSING_LANGUAGE_FILE, ///< The language file does not exist.
+    MISSING_CAPTURES_DIR   ///< The captures directory does not exist.
+};
+
+/**
+ * A problem found in a game profile.
+ */
+struct ProfileIssue
+{
+    ProfileIssueType type; ///< Kind of problem.
+    Glib::ustring path;    ///< Path related to the problem.
+
+    Glib::ustring get_label() const;
+    Glib::ustring describe() const;
+};
+
+/**
+ * Emulation settings of a game profile, read from its config file.
+ */
+struct ProfileSettings
+{
+    Glib::ustring machine,    ///< Emulated machine type, empty if unknown.
+                  core,       ///< CPU core, empty if unknown.
+                  sbtype;     ///< Sound Blaster type, empty if unknown.
+    bool has_program = false, ///< Whether the game is run from a program.
+         has_booter  = false; ///< Whether the game boots from a disk image.
+};
+
+/**
+ * Checks the files referenced by game profiles.
+ * Every referenced path is collected before touching the file system, so each
+ * path is stat'ed only once per validation pass no matter how many profiles
+ * share it. The parsed config files are cached by modification time, so
+ * validating an unchanged library again does not parse any config file.
+ * The class does not use any widget and its methods can be called from
+ * several worker threads at the same time.
+ */
+class ProfileValidator final
+{
+private:
+    /**
+     * Type of a file system entry.
+     */
+    enum class FileKind
+    {
+        NONE,    ///< The path does not exist.
+        REGULAR, ///< Regular file.
+        DIR,     ///< Directory.
+        OTHER    ///< Any other kind of file.
+    };
+
+    /**
+     * Pending check over a path.
+     */
+    struct Check
+    {
+        ProfileIssueType issue; ///< Issue reported if the check fails.
+        std::string path;       ///< Path to check.
+        FileKind kind;          ///< Expected file kind.
+        std::string alt_path;   ///< Path also accepted, if not empty.
+    };
+
+    /**
+     * Information collected from a config file.
+     */
+    struct ConfigEntry
+    {
+        gint64 mtime       = 0;                        ///< Config file modification time.
+        bool readable      = false,                    ///< Whether the config file could be read.
+             check_program = false;                    ///< Whether there is a program to check.
+        std::vector<Check> checks;                     ///< Checks that do not depend on the mounting points.
+        std::map<Glib::ustring, Glib::ustring> mounts; ///< Mounted host directories by drive letter.
+        Glib::ustring drive_letter,                    ///< Drive letter the program is run from.
+                      path,                            ///< Program directory inside the drive.
+                      program;                         ///< Program executable name.
+        ProfileSettings settings;                      ///< Emulation settings, only for the main config.
+    };
+
+    Glib::ustring m_profiles_path;                     ///< Directory containing the profiles config files.
+    std::mutex m_mutex;                                ///< Protects the caches.
+    std::map<std::string, FileKind> m_stat_cache;      ///< File kinds by path for the current pass.
+    std::map<std::string, ConfigEntry> m_config_cache; ///< Parsed config files by filename.
+
+    static FileKind stat(const std::string &path, gint64 *mtime = nullptr);
+    void stat_batch(const std::vector<Check> &checks, std::map<std::string, FileKind> &kinds);
+    ConfigEntry get_config_entry(const std::string &filename, bool for_setup);
+    ConfigEntry parse_config(const std::string &filename, bool for_setup) const;
+
+public:
+    ProfileValidator(const Glib::ustring &profiles_path);
+
+    void begin_pass();
+    std::vector<ProfileIssue> validate(const Glib::ustring &id, ProfileSettings *settings = nullptr);
+};
+
+} // DOSBoxGTK
+
+#endif // PROFILEVALIDATOR_H
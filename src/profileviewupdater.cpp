@@ -0,0 +1,256 @@
+/**
+ * @file
+ * ProfileViewUpdater class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profileviewupdater.h"
+#include "allocaccounting.hpp"
+#include <limits>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Constructor.
+ * @param view Profiles TreeView. Its model must be a Gtk::ListStore.
+ * @param rows Rows of the view by profile ID, updated with the appended rows.
+ */
+ProfileViewUpdater::ProfileViewUpdater(Gtk::TreeView &view, std::map<Glib::ustring, Gtk::TreeIter> &rows) :
+    m_view(view), m_store(Glib::RefPtr<Gtk::ListStore>::cast_static(view.get_model())), m_rows(rows)
+{}
+
+/**
+ * Destructor.
+ */
+ProfileViewUpdater::~ProfileViewUpdater()
+{
+    this->m_idle.disconnect();
+
+    if (this->m_tick_id != 0) {
+        this->m_view.remove_tick_callback(this->m_tick_id);
+    }
+}
+
+/**
+ * Schedules the drain once the updates pushed in this main loop iteration
+ * have been merged.
+ * @return @c FALSE, so the idle callback is removed.
+ */
+bool ProfileViewUpdater::on_idle()
+{
+    if (this->m_tick_id != 0) {
+        return false;
+    }
+
+    // Without frames there is nothing to pace, so everything is applied now.
+    if (this->m_view.get_mapped()) {
+        this->m_tick_id = this->m_view.add_tick_callback(sigc::mem_fun(*this, &ProfileViewUpdater::on_tick));
+    } else {
+        this->flush();
+    }
+
+    return false;
+}
+
+/**
+ * Applies the updates of a frame.
+ * @param frame_clock View's frame clock.
+ * @return @c TRUE to keep the tick callback or @c FALSE to remove it.
+ */
+bool ProfileViewUpdater::on_tick(const Glib::RefPtr<Gdk::FrameClock> &frame_clock)
+{
+    if (this->drain(PROFILE_VIEW_UPDATES_PER_FRAME)) {
+        return true;
+    }
+
+    this->m_tick_id = 0;
+
+    return false;
+}
+
+/**
+ * Applies pending updates.
+ * @param max_updates Maximum number of updates to apply.
+ * @return @c TRUE if there are updates left or @c FALSE otherwise.
+ */
+bool ProfileViewUpdater::drain(unsigned max_updates)
+{
+    ALLOC_SCOPE(Tools::AllocTag::UI);
+    std::vector<ProfileRowUpdate> appended;
+
+    for (unsigned i = 0; i < max_updates && !this->m_order.empty(); ++i) {
+        auto pending = this->m_pending.find(this->m_order.front());
+        auto update = std::move(pending->second);
+
+        this->m_pending.erase(pending);
+        this->m_order.pop_front();
+
+        if (this->m_rows.find(update.id) != this->m_rows.end()) {
+            this->apply(update);
+        } else if (update.fields & ProfileRowUpdate::TITLE) {
+            appended.push_back(std::move(update));
+        }
+    }
+
+    this->append(appended);
+
+    return !this->m_order.empty();
+}
+
+/**
+ * Updates an existing row.
+ * @param update Row update.
+ */
+void ProfileViewUpdater::apply(const ProfileRowUpdate &update)
+{
+    auto &row = this->m_rows[update.id];
+
+    if (update.fields & ProfileRowUpdate::TITLE) {
+        row->set_value(0, update.title);
+    }
+
+    if (update.fields & ProfileRowUpdate::STATUS) {
+        row->set_value(2, update.icon_name);
+        row->set_value(3, update.tooltip);
+    }
+}
+
+/**
+ * Appends new rows. Large batches are appended with the model detached from
+ * the view and unsorted, restoring the sorting, selection and scrolling
+ * afterwards.
+ * @param updates Updates of the new rows.
+ */
+void ProfileViewUpdater::append(const std::vector<ProfileRowUpdate> &updates)
+{
+    bool bulk = updates.size() >= PROFILE_VIEW_BULK_APPEND,
+         sorted = false;
+    int sort_column = 0;
+    Gtk::SortType sort_order = Gtk::SORT_ASCENDING;
+    std::vector<Glib::ustring> selected_ids;
+    Glib::ustring first_visible_id;
+
+    if (updates.empty()) {
+        return;
+    }
+
+    if (bulk) {
+        Gtk::TreeModel::Path start, end;
+
+        for (auto &path : this->m_view.get_selection()->get_selected_rows()) {
+            Glib::ustring id;
+
+            this->m_store->get_iter(path)->get_value(1, id);
+            selected_ids.push_back(id);
+        }
+
+        if (this->m_view.get_visible_range(start, end)) {
+            this->m_store->get_iter(start)->get_value(1, first_visible_id);
+        }
+
+        sorted = this->m_store->get_sort_column_id(sort_column, sort_order);
+
+        if (sorted) {
+            this->m_store->set_sort_column(GTK_TREE_SORTABLE_UNSORTED_SORT_COLUMN_ID, Gtk::SORT_ASCENDING);
+        }
+
+        this->m_view.unset_model();
+    }
+
+    for (auto &update : updates) {
+        auto iter = this->m_store->append();
+
+        iter->set_value(0, update.title);
+        iter->set_value(1, update.id);
+
+        if (update.fields & ProfileRowUpdate::STATUS) {
+            iter->set_value(2, update.icon_name);
+            iter->set_value(3, update.tooltip);
+        }
+
+        this->m_rows[update.id] = iter;
+    }
+
+    if (bulk) {
+        this->m_view.set_model(this->m_store);
+
+        if (sorted) {
+            this->m_store->set_sort_column(sort_column, sort_order);
+        }
+
+        for (auto &id : selected_ids) {
+            this->m_view.get_selection()->select(this->m_rows[id]);
+        }
+
+        if (!first_visible_id.empty()) {
+            this->m_view.scroll_to_row(this->m_store->get_path(this->m_rows[first_visible_id]), 0.0);
+        }
+    }
+}
+
+/**
+ * Queues a row update, merging it with the pending update to the same
+ * profile. Main thread only.
+ * @param update Row update.
+ */
+void ProfileViewUpdater::push(ProfileRowUpdate update)
+{
+    auto iter = this->m_pending.find(update.id);
+
+    if (iter == this->m_pending.end()) {
+        this->m_order.push_back(update.id);
+        this->m_pending.emplace(update.id, std::move(update));
+    } else {
+        auto &pending = iter->second;
+
+        if (update.fields & ProfileRowUpdate::TITLE) {
+            pending.title = std::move(update.title);
+        }
+
+        if (update.fields & ProfileRowUpdate::STATUS) {
+            pending.icon_name = std::move(update.icon_name);
+            pending.tooltip   = std::move(update.tooltip);
+        }
+
+        pending.fields |= update.fields;
+    }
+
+    if (this->m_tick_id == 0 && !this->m_idle.connected()) {
+        this->m_idle = Glib::signal_idle().connect(sigc::mem_fun(*this, &ProfileViewUpdater::on_idle));
+    }
+}
+
+/**
+ * Applies every pending update right now. Main thread only.
+ */
+void ProfileViewUpdater::flush()
+{
+    while (this->drain(std::numeric_limits<unsigned>::max())) {}
+}
+
+/**
+ * Discards the pending updates. Main thread only.
+ */
+void ProfileViewUpdater::clear()
+{
+    this->m_pending.clear();
+    this->m_order.clear();
+}
+
+/**
+ * Checks whether every update pushed so far has been applied. Main thread
+ * only.
+ * @return @c TRUE if there is nothing left to apply or @c FALSE otherwise.
+ */
+bool ProfileViewUpdater::is_idle() const
+{
+    return !this->m_idle.connected() && this->m_tick_id == 0 && this->m_pending.empty();
+}
+
+} // DOSBoxGTK
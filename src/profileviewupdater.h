@@ -0,0 +1,91 @@
+/**
+ * @file
+ * ProfileViewUpdater class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef PROFILEVIEWUPDATER_H
+#define PROFILEVIEWUPDATER_H
+
+#define PROFILE_VIEW_UPDATES_PER_FRAME 1000 ///< Maximum number of rows changed per frame.
+#define PROFILE_VIEW_BULK_APPEND 64         ///< Minimum number of new rows appended with the model detached.
+
+#include <glibmm/main.h>
+#include <gtkmm/liststore.h>
+#include <gtkmm/treeview.h>
+#include <deque>
+#include <map>
+#include <unordered_map>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Change of a row of the profiles TreeView.
+ */
+struct ProfileRowUpdate
+{
+    /**
+     * Fields of the row being changed.
+     */
+    enum Field
+    {
+        TITLE  = 1 << 0, ///< Title column. Rows not in the view are appended.
+        STATUS = 1 << 1  ///< Status icon and tooltip columns.
+    };
+
+    Glib::ustring id;        ///< Profile ID.
+    unsigned fields = 0;     ///< Combination of Field values.
+    Glib::ustring title,     ///< Profile title.
+                  icon_name, ///< Status icon name.
+                  tooltip;   ///< Status tooltip markup.
+};
+
+/**
+ * Applies row updates to the profiles TreeView, paced by the frame clock so
+ * the window keeps redrawing during long imports.
+ * Updates are pushed on the main thread, the results of the worker threads
+ * having already been delivered there by Tools::MainLoopDispatcher. Updates
+ * to the same profile are merged as they are pushed, and once per frame at
+ * most PROFILE_VIEW_UPDATES_PER_FRAME of them are applied. Large batches of
+ * new rows are appended with the model detached from the view and unsorted,
+ * so the view is not updated once per row.
+ * The frame clock tick callback is only installed while there are pending
+ * updates.
+ * Instances must be created and used from the main thread.
+ */
+class ProfileViewUpdater final
+{
+private:
+    Gtk::TreeView &m_view;                              ///< Profiles TreeView.
+    Glib::RefPtr<Gtk::ListStore> m_store;               ///< Profiles model.
+    std::map<Glib::ustring, Gtk::TreeIter> &m_rows;     ///< Rows by profile ID.
+    std::unordered_map<std::string, ProfileRowUpdate> m_pending; ///< Merged updates not applied yet.
+    std::deque<Glib::ustring> m_order;                  ///< Pending profile IDs, oldest first.
+    sigc::connection m_idle;                            ///< Idle callback scheduling the drain.
+    guint m_tick_id = 0;                                ///< Tick callback ID, 0 if not installed.
+
+    bool on_idle();
+    bool on_tick(const Glib::RefPtr<Gdk::FrameClock> &frame_clock);
+    bool drain(unsigned max_updates);
+    void apply(const ProfileRowUpdate &update);
+    void append(const std::vector<ProfileRowUpdate> &updates);
+
+public:
+    ProfileViewUpdater(Gtk::TreeView &view, std::map<Glib::ustring, Gtk::TreeIter> &rows);
+    ~ProfileViewUpdater();
+
+    void push(ProfileRowUpdate update);
+    void flush();
+    void clear();
+    bool is_idle() const;
+};
+
+} // DOSBoxGTK
+
+#endif // PROFILEVIEWUPDATER_H
@@ -0,0 +1,483 @@
+/**
+ * @file
+ * RoaringBitmap class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "roaringbitmap.hpp"
+#include <algorithm>
+#include <iterator>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Checks whether the container is a bitmap.
+ * @return @c TRUE for bitmap containers or @c FALSE for array ones.
+ */
+bool RoaringBitmap::Container::is_bitmap() const
+{
+    return !this->bits.empty();
+}
+
+/**
+ * Checks whether the container holds a value.
+ * @param value Low 16 bits of the value.
+ * @return @c TRUE if the value is in the container or @c FALSE otherwise.
+ */
+bool RoaringBitmap::Container::contains(uint16_t value) const
+{
+    if (this->is_bitmap()) {
+        return (this->bits[value >> 6] >> (value & 63)) & 1;
+    }
+
+    return std::binary_search(this->values.begin(), this->values.end(), value);
+}
+
+/**
+ * Turns an array container into a bitmap container.
+ * @param container Array container.
+ */
+void RoaringBitmap::to_bitmap(Container &container)
+{
+    container.bits.assign(ROARING_BITMAP_WORDS, 0);
+
+    for (auto value : container.values) {
+        container.bits[value >> 6] |= uint64_t(1) << (value & 63);
+    }
+
+    std::vector<uint16_t>().swap(container.values);
+}
+
+/**
+ * Turns a bitmap container into an array container.
+ * @param container Bitmap container.
+ */
+void RoaringBitmap::to_array(Container &container)
+{
+    container.values.clear();
+    container.values.reserve(container.cardinality);
+
+    for (unsigned word = 0; word < ROARING_BITMAP_WORDS; ++word) {
+        // Each iteration takes the lowest set bit out of the word.
+        for (auto bits = container.bits[word]; bits != 0; bits &= bits - 1) {
+            container.values.push_back(static_cast<uint16_t>(word * 64 + __builtin_ctzll(bits)));
+        }
+    }
+
+    std::vector<uint64_t>().swap(container.bits);
+}
+
+/**
+ * Makes a container take the kind fitting its cardinality.
+ * @param container Container.
+ */
+void RoaringBitmap::normalize(Container &container)
+{
+    if (container.is_bitmap() && container.cardinality <= ROARING_ARRAY_MAX) {
+        to_array(container);
+    } else if (!container.is_bitmap() && container.cardinality > ROARING_ARRAY_MAX) {
+        to_bitmap(container);
+    }
+}
+
+/**
+ * Intersects two containers.
+ * @param a First container.
+ * @param b Second container.
+ * @return Intersection, possibly empty.
+ */
+RoaringBitmap::Container RoaringBitmap::intersect(const Container &a, const Container &b)
+{
+    Container result;
+
+    if (a.is_bitmap() && b.is_bitmap()) {
+        result.bits.resize(ROARING_BITMAP_WORDS);
+
+        for (unsigned word = 0; word < ROARING_BITMAP_WORDS; ++word) {
+            result.bits[word] = a.bits[word] & b.bits[word];
+            result.cardinality += __builtin_popcountll(result.bits[word]);
+        }
+
+        normalize(result);
+    } else if (a.is_bitmap() || b.is_bitmap()) {
+        auto &array  = a.is_bitmap() ? b : a,
+             &bitmap = a.is_bitmap() ? a : b;
+
+        std::copy_if(array.values.begin(), array.values.end(), std::back_inserter(result.values),
+                     [&bitmap](uint16_t value) { return bitmap.contains(value); });
+        result.cardinality = result.values.size();
+    } else {
+        std::set_intersection(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(result.values));
+        result.cardinality = result.values.size();
+    }
+
+    return result;
+}
+
+/**
+ * Unites two containers.
+ * @param a First container.
+ * @param b Second container.
+ * @return Union.
+ */
+RoaringBitmap::Container RoaringBitmap::unite(const Container &a, const Container &b)
+{
+    Container result;
+
+    if (a.is_bitmap() || b.is_bitmap()) {
+        auto &other = a.is_bitmap() ? b : a;
+
+        result = a.is_bitmap() ? a : b;
+
+        if (other.is_bitmap()) {
+            result.cardinality = 0;
+
+            for (unsigned word = 0; word < ROARING_BITMAP_WORDS; ++word) {
+                result.bits[word] |= other.bits[word];
+                result.cardinality += __builtin_popcountll(result.bits[word]);
+            }
+        } else {
+            for (auto value : other.values) {
+                auto &word = result.bits[value >> 6];
+                auto bit = uint64_t(1) << (value & 63);
+
+                result.cardinality += !(word & bit);
+                word |= bit;
+            }
+        }
+    } else {
+        result.values.reserve(a.values.size() + b.values.size());
+        std::set_union(a.values.begin(), a.values.end(), b.values.begin(), b.values.end(), std::back_inserter(result.values));
+        result.cardinality = result.values.size();
+        normalize(result);
+    }
+
+    return result;
+}
+
+/**
+ * Counts the values common to two containers.
+ * @param a First container.
+ * @param b Second container.
+ * @return Cardinality of the intersection.
+ */
+uint32_t RoaringBitmap::intersect_cardinality(const Container &a, const Container &b)
+{
+    uint32_t count = 0;
+
+    if (a.is_bitmap() && b.is_bitmap()) {
+        for (unsigned word = 0; word < ROARING_BITMAP_WORDS; ++word) {
+            count += __builtin_popcountll(a.bits[word] & b.bits[word]);
+        }
+    } else if (a.is_bitmap() || b.is_bitmap()) {
+        auto &array  = a.is_bitmap() ? b : a,
+             &bitmap = a.is_bitmap() ? a : b;
+
+        for (auto value : array.values) {
+            count += (bitmap.bits[value >> 6] >> (value & 63)) & 1;
+        }
+    } else {
+        auto i = a.values.begin(),
+             j = b.values.begin();
+
+        while (i != a.values.end() && j != b.values.end()) {
+            if (*i < *j) {
+                ++i;
+            } else if (*j < *i) {
+                ++j;
+            } else {
+                ++count;
+                ++i;
+                ++j;
+            }
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Adds a value.
+ * @param value Value.
+ * @return @c TRUE if the value was not in the set or @c FALSE otherwise.
+ */
+bool RoaringBitmap::add(uint32_t value)
+{
+    uint16_t key = value >> 16,
+             low = value & 0xffff;
+    std::size_t pos = std::lower_bound(this->m_keys.begin(), this->m_keys.end(), key) - this->m_keys.begin();
+
+    if (pos == this->m_keys.size() || this->m_keys[pos] != key) {
+        this->m_keys.insert(this->m_keys.begin() + pos, key);
+        this->m_containers.emplace(this->m_containers.begin() + pos);
+    }
+
+    auto &container = this->m_containers[pos];
+
+    if (container.is_bitmap()) {
+        auto &word = container.bits[low >> 6];
+        auto bit = uint64_t(1) << (low & 63);
+
+        if (word & bit) {
+            return false;
+        }
+
+        word |= bit;
+    } else {
+        auto iter = std::lower_bound(container.values.begin(), container.values.end(), low);
+
+        if (iter != container.values.end() && *iter == low) {
+            return false;
+        }
+
+        container.values.insert(iter, low);
+    }
+
+    ++container.cardinality;
+    normalize(container);
+
+    return true;
+}
+
+/**
+ * Removes a value.
+ * @param value Value.
+ * @return @c TRUE if the value was in the set or @c FALSE otherwise.
+ */
+bool RoaringBitmap::remove(uint32_t value)
+{
+    uint16_t key = value >> 16,
+             low = value & 0xffff;
+    auto key_iter = std::lower_bound(this->m_keys.begin(), this->m_keys.end(), key);
+
+    if (key_iter == this->m_keys.end() || *key_iter != key) {
+        return false;
+    }
+
+    auto pos = key_iter - this->m_keys.begin();
+    auto &container = this->m_containers[pos];
+
+    if (container.is_bitmap()) {
+        auto &word = container.bits[low >> 6];
+        auto bit = uint64_t(1) << (low & 63);
+
+        if (!(word & bit)) {
+            return false;
+        }
+
+        word &= ~bit;
+    } else {
+        auto iter = std::lower_bound(container.values.begin(), container.values.end(), low);
+
+        if (iter == container.values.end() || *iter != low) {
+            return false;
+        }
+
+        container.values.erase(iter);
+    }
+
+    if (--container.cardinality == 0) {
+        this->m_keys.erase(key_iter);
+        this->m_containers.erase(this->m_containers.begin() + pos);
+    } else {
+        normalize(container);
+    }
+
+    return true;
+}
+
+/**
+ * Checks whether the set holds a value.
+ * @param value Value.
+ * @return @c TRUE if the value is in the set or @c FALSE otherwise.
+ */
+bool RoaringBitmap::contains(uint32_t value) const
+{
+    uint16_t key = value >> 16;
+    auto key_iter = std::lower_bound(this->m_keys.begin(), this->m_keys.end(), key);
+
+    if (key_iter == this->m_keys.end() || *key_iter != key) {
+        return false;
+    }
+
+    return this->m_containers[key_iter - this->m_keys.begin()].contains(value & 0xffff);
+}
+
+/**
+ * Gets the number of values.
+ * @return Cardinality of the set.
+ */
+std::size_t RoaringBitmap::cardinality() const
+{
+    std::size_t count = 0;
+
+    for (auto &container : this->m_containers) {
+        count += container.cardinality;
+    }
+
+    return count;
+}
+
+/**
+ * Checks whether the set is empty.
+ * @return @c TRUE if there are no values or @c FALSE otherwise.
+ */
+bool RoaringBitmap::empty() const
+{
+    return this->m_containers.empty();
+}
+
+/**
+ * Removes every value.
+ */
+void RoaringBitmap::clear()
+{
+    this->m_keys.clear();
+    this->m_containers.clear();
+}
+
+/**
+ * Gets the values.
+ * @return Sorted values.
+ */
+std::vector<uint32_t> RoaringBitmap::to_vector() const
+{
+    std::vector<uint32_t> result;
+
+    result.reserve(this->cardinality());
+
+    for (std::size_t i = 0; i < this->m_keys.size(); ++i) {
+        auto high = static_cast<uint32_t>(this->m_keys[i]) << 16;
+        auto &container = this->m_containers[i];
+
+        if (container.is_bitmap()) {
+            for (unsigned word = 0; word < ROARING_BITMAP_WORDS; ++word) {
+                for (auto bits = container.bits[word]; bits != 0; bits &= bits - 1) {
+                    result.push_back(high | (word * 64 + __builtin_ctzll(bits)));
+                }
+            }
+        } else {
+            for (auto value : container.values) {
+                result.push_back(high | value);
+            }
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Counts the values common to this set and another one without building
+ * their intersection.
+ * @param other Other set.
+ * @return Cardinality of the intersection.
+ */
+std::size_t RoaringBitmap::and_cardinality(const RoaringBitmap &other) const
+{
+    std::size_t count = 0,
+                i     = 0,
+                j     = 0;
+
+    while (i < this->m_keys.size() && j < other.m_keys.size()) {
+        if (this->m_keys[i] < other.m_keys[j]) {
+            ++i;
+        } else if (other.m_keys[j] < this->m_keys[i]) {
+            ++j;
+        } else {
+            count += intersect_cardinality(this->m_containers[i++], other.m_containers[j++]);
+        }
+    }
+
+    return count;
+}
+
+/**
+ * Intersects this set with another one.
+ * @param other Other set.
+ * @return Intersection.
+ */
+RoaringBitmap RoaringBitmap::operator&(const RoaringBitmap &other) const
+{
+    RoaringBitmap result;
+    std::size_t i = 0,
+                j = 0;
+
+    while (i < this->m_keys.size() && j < other.m_keys.size()) {
+        if (this->m_keys[i] < other.m_keys[j]) {
+            ++i;
+        } else if (other.m_keys[j] < this->m_keys[i]) {
+            ++j;
+        } else {
+            auto container = intersect(this->m_containers[i], other.m_containers[j]);
+
+            if (container.cardinality > 0) {
+                result.m_keys.push_back(this->m_keys[i]);
+                result.m_containers.push_back(std::move(container));
+            }
+
+            ++i;
+            ++j;
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Unites this set with another one.
+ * @param other Other set.
+ * @return Union.
+ */
+RoaringBitmap RoaringBitmap::operator|(const RoaringBitmap &other) const
+{
+    RoaringBitmap result;
+    std::size_t i = 0,
+                j = 0;
+
+    while (i < this->m_keys.size() || j < other.m_keys.size()) {
+        if (j == other.m_keys.size() || (i < this->m_keys.size() && this->m_keys[i] < other.m_keys[j])) {
+            result.m_keys.push_back(this->m_keys[i]);
+            result.m_containers.push_back(this->m_containers[i++]);
+        } else if (i == this->m_keys.size() || other.m_keys[j] < this->m_keys[i]) {
+            result.m_keys.push_back(other.m_keys[j]);
+            result.m_containers.push_back(other.m_containers[j++]);
+        } else {
+            result.m_keys.push_back(this->m_keys[i]);
+            result.m_containers.push_back(unite(this->m_containers[i++], other.m_containers[j++]));
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Intersects this set with another one, in place.
+ * @param other Other set.
+ * @return This set.
+ */
+RoaringBitmap &RoaringBitmap::operator&=(const RoaringBitmap &other)
+{
+    *this = *this & other;
+
+    return *this;
+}
+
+/**
+ * Unites this set with another one, in place.
+ * @param other Other set.
+ * @return This set.
+ */
+RoaringBitmap &RoaringBitmap::operator|=(const RoaringBitmap &other)
+{
+    *this = *this | other;
+
+    return *this;
+}
+
+} // Tools
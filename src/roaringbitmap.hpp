@@ -0,0 +1,82 @@
+/**
+ * @file
+ * RoaringBitmap class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef ROARINGBITMAP_HPP
+#define ROARINGBITMAP_HPP
+
+#define ROARING_ARRAY_MAX    4096 ///< Most values an array container holds before becoming a bitmap.
+#define ROARING_BITMAP_WORDS 1024 ///< 64 bit words of a bitmap container, one bit per low 16 bits value.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Compressed set of 32 bit integers, after the Roaring bitmaps of Chambi,
+ * Lemire et al.
+ * Values are split by their high 16 bits into containers holding their low
+ * 16 bits. Sparse containers are sorted arrays of up to ROARING_ARRAY_MAX
+ * values and dense ones are plain 65536 bit bitmaps, so no container takes
+ * more than 8 KiB. Containers switch kind as values are added and removed.
+ * Intersections and unions walk both sets of containers at once, merging
+ * arrays, testing the array values in bitmaps, or combining whole bitmap
+ * words. Intersections can be counted without building them.
+ * Run containers are not implemented: the sets are document numbers handed
+ * out densely, which the other two kinds already store well.
+ */
+class RoaringBitmap final
+{
+private:
+    /**
+     * Values sharing their high 16 bits.
+     */
+    struct Container
+    {
+        std::vector<uint16_t> values; ///< Sorted values, for array containers.
+        std::vector<uint64_t> bits;   ///< ROARING_BITMAP_WORDS words, for bitmap containers. Empty for array ones.
+        uint32_t cardinality = 0;     ///< Number of values.
+
+        bool is_bitmap() const;
+        bool contains(uint16_t value) const;
+    };
+
+    std::vector<uint16_t> m_keys;        ///< High 16 bits of the values of each container, sorted.
+    std::vector<Container> m_containers; ///< Containers, in key order. None is empty.
+
+    static void to_bitmap(Container &container);
+    static void to_array(Container &container);
+    static void normalize(Container &container);
+    static Container intersect(const Container &a, const Container &b);
+    static Container unite(const Container &a, const Container &b);
+    static uint32_t intersect_cardinality(const Container &a, const Container &b);
+
+public:
+    bool add(uint32_t value);
+    bool remove(uint32_t value);
+    bool contains(uint32_t value) const;
+    std::size_t cardinality() const;
+    bool empty() const;
+    void clear();
+    std::vector<uint32_t> to_vector() const;
+    std::size_t and_cardinality(const RoaringBitmap &other) const;
+
+    RoaringBitmap operator&(const RoaringBitmap &other) const;
+    RoaringBitmap operator|(const RoaringBitmap &other) const;
+    RoaringBitmap &operator&=(const RoaringBitmap &other);
+    RoaringBitmap &operator|=(const RoaringBitmap &other);
+};
+
+} // Tools
+
+#endif // ROARINGBITMAP_HPP
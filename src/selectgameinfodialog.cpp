@@ -18,13 +18,10 @@
 
 #include "selectgameinfodialog.h"
 #include "config.h"
-#include "htmltools.hpp"
-#include <glibmm/regex.h>
+#include "allocaccounting.hpp"
+#include "metrics.hpp"
 #include <gtkmm/liststore.h>
 #include <glibmm/convert.h>
-#include <curlpp/cURLpp.hpp>
-#include <curlpp/Easy.hpp>
-#include <curlpp/Options.hpp>
 
 /**
  * DOSBocGTK namespace.
@@ -32,6 +29,8 @@
 namespace DOSBoxGTK
 {
 
+static auto &s_first_result_latency = Tools::Metrics::get_histogram("dosboxgtk_search_first_result_seconds", "Time from a game search request until its first result is shown."); ///< First search result latency histogram.
+
 /**
  * Process response and closes dialog window.
  * @param response_id Dialog response value;
@@ -59,67 +58,84 @@ void SelectGameInfoDialog::on_games_tv_selection_changed()
  * @param builder Gtk::Builder used to retrieve the child widgets.
  */
 SelectGameInfoDialog::SelectGameInfoDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder) :
-    Gtk::Dialog(cobject), m_base_url("http://www.mobygames.com")
+    Gtk::Dialog(cobject)
 {
     builder->set_translation_domain(PROJECT_NAME);
 
     builder->get_widget("GamesTV", this->m_games_tv);
     builder->get_widget("AcceptButton", this->m_accept_button);
 
+    // The games most similar to the searched title go first, wherever they are found.
+    Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_games_tv->get_model())->set_sort_column(4, Gtk::SORT_DESCENDING);
+
     // Signals
     this->m_games_tv->get_selection()->signal_changed().connect(sigc::mem_fun(*this, &SelectGameInfoDialog::on_games_tv_selection_changed));
 }
 
 /**
- * Searchs the info about the provided game title on MobyGames website.
+ * Destructor.
+ */
+SelectGameInfoDialog::~SelectGameInfoDialog()
+{
+    this->m_async_token.cancel();
+}
+
+/**
+ * Adds a game found by the search to the games TreeView.
+ * @param result Game.
+ */
+void SelectGameInfoDialog::add_game(const GameSearchResult &result)
+{
+    ALLOC_SCOPE(Tools::AllocTag::NETWORK);
+    auto games_ls = Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_games_tv->get_model());
+
+    if (games_ls->children().empty()) {
+        s_first_result_latency.observe(std::chrono::duration<double>(std::chrono::steady_clock::now() - this->m_search_start).count());
+    }
+
+    auto iter = games_ls->append();
+
+    iter->set_value(0, result.title);
+    iter->set_value(1, result.year);
+    iter->set_value(2, result.href);
+    iter->set_value(3, result.provider);
+    iter->set_value(4, this->m_matcher->score(TitleMatcher::normalize(result.title)));
+}
+
+/**
+ * Searchs the info about the provided game title on every metadata provider.
+ * The dialog can be shown meanwhile. The games found by the fastest provider
+ * are added as soon as they are parsed, so the first games show up before the
+ * slower providers, which are cancelled, or even the fastest one finish. They
+ * are sorted by their similarity to the searched title.
  * @param title Title of the game.
  */
 void SelectGameInfoDialog::search_game_info(const Glib::ustring &title)
 {
-    curlpp::initialize();
-    curlpp::Easy request;
-    std::stringstream os;
-    Glib::MatchInfo m_info;
-    auto post_fields = Glib::ustring::compose("game=%1&p=2&search=go", curlpp::escape(title));
-    auto games_ls = Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_games_tv->get_model());
-    auto regex = Glib::Regex::create("Game:\\s*<a\\s+href=\"(?'href'.+?)\">\\s*(?'title'.+?)\\s*<\\/a>\\s*.+?\\s*DOS\\s*\\(<em>\\s*(?'year'.+?)\\s*<\\/em>\\)");
-
-    request.setOpt<curlpp::options::Url>(this->m_base_url + "/search/quick");
-    request.setOpt<curlpp::options::PostFields>(post_fields);
-    request.setOpt<curlpp::options::WriteStream>(&os);
-
-    request.perform();
-    curlpp::terminate();
-    regex->match(os.str(), 0, m_info);
-
-    do {
-        auto title = Tools::html_entities_decode(m_info.fetch_named("title"));
-        auto href  = m_info.fetch_named("href"),
-             year  = m_info.fetch_named("year");
-        auto iter = games_ls->append();
-
-        iter->set_value(0, title);
-        iter->set_value(1, year);
-        iter->set_value(2, href);
-    } while (m_info.next());
+    this->m_search_start = std::chrono::steady_clock::now();
+    this->m_matcher      = std::make_unique<TitleMatcher>(title);
+    MetadataService::get_default().search(this->m_async_token, title, sigc::mem_fun(*this, &SelectGameInfoDialog::add_game), nullptr);
 }
 
 /**
- * Gets the selected HREF of the game selected in the TreeView.
- * @return String with the HREF of the selected game.
+ * Gets the game selected in the TreeView.
+ * @return Selected game, empty if there is none.
  */
-Glib::ustring SelectGameInfoDialog::get_selected_href() const
+GameSearchResult SelectGameInfoDialog::get_selected_result() const
 {
     auto selection = this->m_games_tv->get_selection();
-    Glib::ustring href;
+    GameSearchResult result;
 
     if (selection->count_selected_rows() > 0) {
         auto iter = selection->get_selected();
 
-        iter->get_value(2, href);
+        iter->get_value(0, result.title);
+        iter->get_value(1, result.year);
+        iter->get_value(2, result.href);
+        iter->get_value(3, result.provider);
     }
 
-    return this->m_base_url + href;
+    return result;
 }
 
 } // DOSBoxGTK
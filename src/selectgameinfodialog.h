@@ -19,9 +19,13 @@
 #ifndef SELECTGAMEINFODIALOG_H
 #define SELECTGAMEINFODIALOG_H
 
+#include "metadataservice.h"
+#include "titlematcher.h"
 #include <gtkmm/dialog.h>
 #include <gtkmm/builder.h>
 #include <gtkmm/treeview.h>
+#include <chrono>
+#include <memory>
 
 /**
  * DOSBocGTK namespace.
@@ -37,16 +41,20 @@ class SelectGameInfoDialog final : public Gtk::Dialog
 private:
     Gtk::TreeView *m_games_tv    = nullptr;
     Gtk::Button *m_accept_button = nullptr;
-    Glib::ustring m_base_url;
+    Tools::CancellationToken m_async_token; ///< Cancelled when the dialog is destroyed.
+    std::chrono::steady_clock::time_point m_search_start; ///< Time the current search was started.
+    std::unique_ptr<TitleMatcher> m_matcher;              ///< Scores the games found against the searched title.
 
     void on_response(int response_id);
     void on_games_tv_selection_changed();
+    void add_game(const GameSearchResult &result);
 
 public:
     SelectGameInfoDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder);
+    ~SelectGameInfoDialog();
 
     void search_game_info(const Glib::ustring &title);
-    Glib::ustring get_selected_href() const;
+    GameSearchResult get_selected_result() const;
 };
 
 } // DOSBoxGTK
@@ -0,0 +1,168 @@
+/**
+ * @file
+ * CancellationToken and TaskGroup classes implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "taskgroup.hpp"
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Constructor.
+ */
+CancellationToken::CancellationToken() :
+    m_cancelled(std::make_shared<std::atomic<bool>>(false))
+{}
+
+/**
+ * Creates a token which is cancelled when this one is.
+ * @return Child token.
+ */
+CancellationToken CancellationToken::create_child() const
+{
+    CancellationToken child;
+
+    child.m_parent = std::make_shared<const CancellationToken>(*this);
+
+    return child;
+}
+
+/**
+ * Cancels the work using this token and its children.
+ */
+void CancellationToken::cancel() const
+{
+    *this->m_cancelled = true;
+}
+
+/**
+ * Checks whether the work has been cancelled.
+ * @return @c TRUE if the token or any of its ancestors has been cancelled or
+ * @c FALSE otherwise.
+ */
+bool CancellationToken::is_cancelled() const
+{
+    return *this->m_cancelled || (this->m_parent && this->m_parent->is_cancelled());
+}
+
+/**
+ * Constructor.
+ * @param pool Pool running the tasks.
+ */
+TaskGroup::TaskGroup(ThreadPool &pool) :
+    m_pool(pool), m_done(0), m_total(0)
+{}
+
+/**
+ * Destructor. Cancels the pending tasks and waits for the running ones.
+ */
+TaskGroup::~TaskGroup()
+{
+    this->cancel();
+}
+
+/**
+ * Runs a task on a worker thread.
+ * @param task Task to be run.
+ * @param token Token the task was pushed with.
+ */
+void TaskGroup::run(const Task &task, const CancellationToken &token)
+{
+    if (!token.is_cancelled()) {
+        task(token);
+    }
+
+    ++this->m_done;
+
+    // Notified with the mutex held because the group may be destroyed as
+    // soon as wait() returns.
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+
+    if (--this->m_pending == 0) {
+        this->m_cv.notify_all();
+    }
+}
+
+/**
+ * Queues a task. It can be called from any thread, including the tasks of
+ * the group.
+ * @param task Task to be run by the pool.
+ */
+void TaskGroup::push(Task task)
+{
+    CancellationToken token;
+
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+
+        token = this->m_token;
+        ++this->m_pending;
+    }
+
+    ++this->m_total;
+    this->m_pool.push(std::bind(&TaskGroup::run, this, std::move(task), token));
+}
+
+/**
+ * Cancels the pending tasks and waits for the running ones to finish.
+ * Tasks pushed afterwards are run normally.
+ */
+void TaskGroup::cancel()
+{
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+
+    this->m_token.cancel();
+    this->m_token = CancellationToken();
+    this->m_cv.wait(lock, [this] { return this->m_pending == 0; });
+    this->m_done  = 0;
+    this->m_total = 0;
+}
+
+/**
+ * Blocks until every task of the group has been run. It must not be called
+ * from a task of the group.
+ */
+void TaskGroup::wait()
+{
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+
+    this->m_cv.wait(lock, [this] { return this->m_pending == 0; });
+}
+
+/**
+ * Checks whether the group has no queued or running tasks.
+ * @return @c TRUE if every task has been run or @c FALSE otherwise.
+ */
+bool TaskGroup::is_idle()
+{
+    std::lock_guard<std::mutex> lock(this->m_mutex);
+
+    return this->m_pending == 0;
+}
+
+/**
+ * Gets the number of tasks finished since the last cancel().
+ * @return Finished tasks.
+ */
+unsigned TaskGroup::get_done() const
+{
+    return this->m_done;
+}
+
+/**
+ * Gets the number of tasks pushed since the last cancel().
+ * @return Pushed tasks.
+ */
+unsigned TaskGroup::get_total() const
+{
+    return this->m_total;
+}
+
+} // Tools
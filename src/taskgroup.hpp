@@ -0,0 +1,86 @@
+/**
+ * @file
+ * CancellationToken and TaskGroup classes declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef TASKGROUP_HPP
+#define TASKGROUP_HPP
+
+#include "threadpool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Shared cancellation flag. Copies refer to the same flag, so a task can
+ * keep its own copy and check it while the owner cancels the work.
+ * A child token is cancelled along with its parent but can also be cancelled
+ * alone, which stops part of the work without affecting the rest.
+ */
+class CancellationToken final
+{
+private:
+    std::shared_ptr<std::atomic<bool>> m_cancelled;    ///< Shared flag.
+    std::shared_ptr<const CancellationToken> m_parent; ///< Token this one was created from, if any.
+
+public:
+    CancellationToken();
+
+    CancellationToken create_child() const;
+    void cancel() const;
+    bool is_cancelled() const;
+};
+
+/**
+ * Set of related tasks run by a ThreadPool, which can be waited for and
+ * cancelled together without affecting the rest of the pool's tasks.
+ * Tasks receive the group's CancellationToken so long tasks can stop
+ * early. Tasks still queued when the group is cancelled are skipped.
+ * The group keeps count of the pushed and finished tasks for progress
+ * reporting. Destroying the group cancels it.
+ */
+class TaskGroup final
+{
+public:
+    typedef std::function<void(const CancellationToken&)> Task;
+
+private:
+    ThreadPool &m_pool;              ///< Pool running the tasks.
+    CancellationToken m_token;       ///< Token of the current tasks.
+    std::mutex m_mutex;              ///< Protects m_pending and m_token.
+    std::condition_variable m_cv;    ///< Signaled when there are no pending tasks.
+    unsigned m_pending = 0;          ///< Tasks queued or running.
+    std::atomic<unsigned> m_done,    ///< Tasks finished since the last cancel().
+                          m_total;   ///< Tasks pushed since the last cancel().
+
+    void run(const Task &task, const CancellationToken &token);
+
+public:
+    TaskGroup(ThreadPool &pool = ThreadPool::get_default());
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup &operator=(const TaskGroup&) = delete;
+
+    void push(Task task);
+    void cancel();
+    void wait();
+    bool is_idle();
+    unsigned get_done() const;
+    unsigned get_total() const;
+};
+
+} // Tools
+
+#endif // TASKGROUP_HPP
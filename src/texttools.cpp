@@ -0,0 +1,69 @@
+/**
+ * @file
+ * Definition of helper functions for comparing texts.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "texttools.hpp"
+#include <glib.h>
+#include <algorithm>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Splits a text into lowercase words without accents, separated by single
+ * spaces. Anything but letters and digits separates words, but apostrophes.
+ * Plain ASCII texts, the most usual ones, skip the Unicode decomposition.
+ * @param text Text.
+ * @return Folded words.
+ */
+std::string fold_words(const Glib::ustring &text)
+{
+    auto &raw = text.raw();
+    std::string result;
+    auto separate = [&result] {
+        if (!result.empty() && result.back() != ' ') {
+            result += ' ';
+        }
+    };
+
+    result.reserve(raw.size());
+
+    if (std::all_of(raw.begin(), raw.end(), [](char c) { return static_cast<unsigned char>(c) < 0x80; })) {
+        for (auto c : raw) {
+            if (g_ascii_isalnum(c)) {
+                result += g_ascii_tolower(c);
+            } else if (c != '\'') {
+                separate();
+            }
+        }
+    } else {
+        for (auto c : text.normalize(Glib::NORMALIZE_NFKD).lowercase()) {
+            if (c < 0x80 && g_ascii_isalnum(c)) {
+                result += static_cast<char>(c);
+            } else if (g_unichar_ismark(c) || c == '\'' || c == 0x2019) {
+                // Accents and apostrophes do not split words.
+            } else if (g_unichar_isalnum(c)) {
+                char utf8[6];
+
+                result.append(utf8, g_unichar_to_utf8(c, utf8));
+            } else {
+                separate();
+            }
+        }
+    }
+
+    if (!result.empty() && result.back() == ' ') {
+        result.pop_back();
+    }
+
+    return result;
+}
+
+} // Tools
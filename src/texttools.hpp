@@ -0,0 +1,25 @@
+/**
+ * @file
+ * Declaration of helper functions for comparing texts.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef TEXTTOOLS_HPP
+#define TEXTTOOLS_HPP
+
+#include <glibmm/ustring.h>
+#include <string>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+std::string fold_words(const Glib::ustring &text);
+
+} // Tools
+
+#endif // TEXTTOOLS_HPP
@@ -0,0 +1,197 @@
+/**
+ * @file
+ * ThreadPool class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "threadpool.hpp"
+#include <algorithm>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+static thread_local ThreadPool *t_pool = nullptr; ///< Pool the current thread works for.
+static thread_local unsigned t_index   = 0;       ///< Queue of the current worker thread.
+
+/**
+ * Constructor.
+ * @param n_threads Number of worker threads. If it is 0 one thread per
+ * hardware thread is used.
+ */
+ThreadPool::ThreadPool(unsigned n_threads) :
+    m_queued(0), m_busy(0), m_next_queue(0)
+{
+    if (n_threads == 0) {
+        n_threads = std::max(2u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < n_threads; ++i) {
+        this->m_queues.emplace_back(new WorkerQueue());
+    }
+
+    for (unsigned i = 0; i < n_threads; ++i) {
+        this->m_threads.push_back(std::thread(&ThreadPool::worker, this, i));
+    }
+}
+
+/**
+ * Destructor. Waits for the running tasks and discards the queued ones.
+ */
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+
+        this->m_stopping = true;
+    }
+
+    for (auto &queue : this->m_queues) {
+        std::lock_guard<std::mutex> lock(queue->mutex);
+
+        queue->tasks.clear();
+    }
+
+    this->m_task_cv.notify_all();
+
+    for (auto &thread : this->m_threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Gets the pool shared by the whole application.
+ * @return The shared pool.
+ */
+ThreadPool &ThreadPool::get_default()
+{
+    static ThreadPool pool;
+
+    return pool;
+}
+
+/**
+ * Takes a task from the worker's own queue or steals one from another worker.
+ * @param index Queue of the worker.
+ * @param task Where the task is stored.
+ * @return @c TRUE if a task has been taken or @c FALSE otherwise.
+ */
+bool ThreadPool::take(unsigned index, std::function<void()> &task)
+{
+    auto n_queues = this->m_queues.size();
+
+    for (unsigned i = 0; i < n_queues; ++i) {
+        auto &queue = *this->m_queues[(index + i) % n_queues];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+
+        if (queue.tasks.empty()) {
+            continue;
+        }
+
+        // Newest task from the own queue, oldest one from the others.
+        if (i == 0) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+
+        // m_busy is increased first so wait() never sees the pool idle
+        // while the task is changing hands. push() counts the task before
+        // publishing it, but m_queued is never taken below 0 anyway.
+        ++this->m_busy;
+
+        auto queued = this->m_queued.load();
+
+        while (queued > 0 && !this->m_queued.compare_exchange_weak(queued, queued - 1)) {
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * Worker threads body.
+ * @param index Queue of the worker.
+ */
+void ThreadPool::worker(unsigned index)
+{
+    t_pool  = this;
+    t_index = index;
+
+    std::function<void()> task;
+
+    while (true) {
+        if (this->take(index, task)) {
+            task();
+            task = nullptr;
+
+            if (--this->m_busy == 0 && this->m_queued == 0) {
+                std::lock_guard<std::mutex> lock(this->m_mutex);
+
+                this->m_idle_cv.notify_all();
+            }
+
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->m_mutex);
+
+        this->m_task_cv.wait(lock, [this] { return this->m_stopping || this->m_queued > 0; });
+
+        if (this->m_stopping) {
+            break;
+        }
+    }
+}
+
+/**
+ * Queues a task. It can be called from any thread, including the workers.
+ * @param task Task to be run by a worker thread.
+ */
+void ThreadPool::push(std::function<void()> task)
+{
+    auto index = t_pool == this ? t_index : this->m_next_queue++ % this->m_queues.size();
+    auto &queue = *this->m_queues[index];
+
+    // Counted under m_mutex so a worker going to sleep can not miss it, and
+    // before the task is published so no worker can take it uncounted.
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+        std::lock_guard<std::mutex> queue_lock(queue.mutex);
+
+        ++this->m_queued;
+        queue.tasks.push_back(std::move(task));
+    }
+
+    this->m_task_cv.notify_one();
+}
+
+/**
+ * Blocks until every queued task has been run. It must not be called from a
+ * worker thread.
+ */
+void ThreadPool::wait()
+{
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+
+    this->m_idle_cv.wait(lock, [this] { return this->m_busy == 0 && this->m_queued == 0; });
+}
+
+/**
+ * Gets the number of worker threads.
+ * @return Number of worker threads.
+ */
+unsigned ThreadPool::size() const
+{
+    return this->m_threads.size();
+}
+
+} // Tools
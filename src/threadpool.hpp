@@ -0,0 +1,75 @@
+/**
+ * @file
+ * ThreadPool class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Fixed size work-stealing pool of worker threads.
+ * Each worker has its own task queue. Tasks pushed from a worker thread go to
+ * the back of that worker's queue and are run in LIFO order, so related work
+ * stays on the same thread. Tasks pushed from any other thread are spread
+ * among the workers. A worker whose queue is empty steals the oldest task of
+ * another worker.
+ * Most code should use get_default() through a TaskGroup instead of creating
+ * its own pool.
+ */
+class ThreadPool final
+{
+private:
+    /**
+     * Task queue of a worker thread.
+     */
+    struct WorkerQueue
+    {
+        std::mutex mutex;                        ///< Protects tasks.
+        std::deque<std::function<void()>> tasks; ///< Queued tasks.
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues; ///< Task queues, one per worker.
+    std::vector<std::thread> m_threads;                 ///< Worker threads.
+    std::mutex m_mutex;                                 ///< Serializes sleeping and waking up.
+    std::condition_variable m_task_cv,                  ///< Signaled when a task is queued.
+                            m_idle_cv;                  ///< Signaled when the pool becomes idle.
+    std::atomic<unsigned> m_queued,                     ///< Number of queued tasks.
+                          m_busy,                       ///< Number of tasks being run.
+                          m_next_queue;                 ///< Queue for the next task pushed from outside the pool.
+    bool m_stopping = false;                            ///< Set to stop the workers.
+
+    void worker(unsigned index);
+    bool take(unsigned index, std::function<void()> &task);
+
+public:
+    ThreadPool(unsigned n_threads = 0);
+    ~ThreadPool();
+
+    static ThreadPool &get_default();
+
+    void push(std::function<void()> task);
+    void wait();
+    unsigned size() const;
+};
+
+} // Tools
+
+#endif // THREADPOOL_HPP
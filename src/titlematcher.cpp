@@ -0,0 +1,630 @@
+/**
+ * @file
+ * TitleMatcher class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "titlematcher.h"
+#include "htmltools.hpp"
+#include "texttools.hpp"
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__has_attribute)
+#if __has_attribute(target_clones)
+#define TITLE_MATCHER_CLONES __attribute__((target_clones("avx2", "default"))) ///< Builds the kernel for AVX2 too, chosen at run time.
+#endif
+#endif
+
+#ifndef TITLE_MATCHER_CLONES
+#define TITLE_MATCHER_CLONES
+#endif
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+typedef uint64_t U64x4 __attribute__((vector_size(32))); ///< Four 64 bit lanes, an AVX2 register.
+typedef int64_t I64x4 __attribute__((vector_size(32)));  ///< Four signed 64 bit lanes, for the comparisons.
+
+static const std::size_t LANES = sizeof(U64x4) / sizeof(uint64_t); ///< Candidates scored at once.
+
+/**
+ * Gets the value of a roman numeral made of I, V and X, the only letters of
+ * the sequel numbers. Non-canonical numerals like "iiii" are not numerals.
+ * @param word Lowercase word.
+ * @return Numeral value, from 1 to 39, or 0 if the word is not a numeral.
+ */
+static unsigned get_roman_value(const std::string &word)
+{
+    static const char *const units[] = {"", "i", "ii", "iii", "iv", "v", "vi", "vii", "viii", "ix"};
+    unsigned tens = 0;
+    std::size_t pos = 0;
+
+    while (pos < word.size() && word[pos] == 'x' && tens < 3) {
+        ++tens;
+        ++pos;
+    }
+
+    auto rest = word.substr(pos);
+
+    for (unsigned unit = 0; unit < 10; ++unit) {
+        if (rest == units[unit]) {
+            return tens * 10 + unit;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Computes the edit distance from one pattern to several texts at once, a
+ * text per vector lane, with Myers' algorithm. The pattern bits of the bytes
+ * of a batch are looked up first, so the main loop only has vector
+ * operations. The texts of a batch are walked up to the longest of them, the
+ * shorter ones reading no matches and keeping their score once finished, so
+ * the texts should come sorted by length.
+ * @param peq Bits of the pattern positions holding each byte.
+ * @param m Pattern length, from 1 to 64.
+ * @param texts Texts.
+ * @param count Number of texts.
+ * @param distances Where the distances are stored, one per text.
+ */
+TITLE_MATCHER_CLONES
+static void edit_distances_simd(const uint64_t *peq, std::size_t m, const std::string_view *texts, std::size_t count, unsigned *distances)
+{
+    const U64x4 zero = {},
+                one  = zero + 1;
+    const unsigned shift = m - 1;
+    std::vector<uint64_t> eqs; // Not a vector of U64x4, whose functions would not be built for AVX2.
+    std::size_t i = 0;
+
+    for (; i + LANES <= count; i += LANES) {
+        U64x4 pv = ~zero,
+              mv = zero,
+              score = zero + m;
+        I64x4 lengths;
+        std::size_t max_length = 0;
+
+        for (std::size_t lane = 0; lane < LANES; ++lane) {
+            lengths[lane] = texts[i + lane].size();
+            max_length    = std::max(max_length, texts[i + lane].size());
+        }
+
+        eqs.assign(max_length * LANES, 0);
+
+        for (std::size_t lane = 0; lane < LANES; ++lane) {
+            auto &text = texts[i + lane];
+
+            for (std::size_t j = 0; j < text.size(); ++j) {
+                eqs[j * LANES + lane] = peq[static_cast<unsigned char>(text[j])];
+            }
+        }
+
+        for (std::size_t j = 0; j < max_length; ++j) {
+            U64x4 eq;
+
+            std::memcpy(&eq, &eqs[j * LANES], sizeof(eq));
+
+            U64x4 active = (U64x4)((I64x4{} + static_cast<int64_t>(j)) < lengths),
+                  xv = eq | mv,
+                  xh = (((eq & pv) + pv) ^ pv) | eq,
+                  ph = mv | ~(xh | pv),
+                  mh = pv & xh;
+
+            score += (ph >> shift) & one & active;
+            score -= (mh >> shift) & one & active;
+            ph = (ph << 1) | one;
+            mh = mh << 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+
+        for (std::size_t lane = 0; lane < LANES; ++lane) {
+            distances[i + lane] = score[lane];
+        }
+    }
+
+    const uint64_t last = uint64_t(1) << shift;
+
+    for (; i < count; ++i) {
+        uint64_t pv = ~uint64_t(0),
+                 mv = 0;
+        unsigned score = m;
+
+        for (auto c : texts[i]) {
+            uint64_t eq = peq[static_cast<unsigned char>(c)],
+                     xv = eq | mv,
+                     xh = (((eq & pv) + pv) ^ pv) | eq,
+                     ph = mv | ~(xh | pv),
+                     mh = pv & xh;
+
+            score += (ph & last) != 0;
+            score -= (mh & last) != 0;
+            ph = (ph << 1) | 1;
+            mh = mh << 1;
+            pv = mh | ~(xv | ph);
+            mv = ph & xv;
+        }
+
+        distances[i] = score;
+    }
+}
+
+/**
+ * Fills the pattern bits of each byte.
+ * @param pattern Pattern, up to 64 bytes.
+ * @param peq Where the bits are stored, 256 words.
+ */
+static void build_peq(std::string_view pattern, uint64_t *peq)
+{
+    std::memset(peq, 0, 256 * sizeof(uint64_t));
+
+    for (std::size_t i = 0; i < pattern.size(); ++i) {
+        peq[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+    }
+}
+
+/**
+ * Computes the edit distance from a pattern to a text with Myers'
+ * algorithm.
+ * @param peq Bits of the pattern positions holding each byte.
+ * @param m Pattern length, up to 64.
+ * @param text Text.
+ * @return Edit distance.
+ */
+unsigned TitleMatcher::edit_distance(const uint64_t *peq, std::size_t m, std::string_view text)
+{
+    unsigned distance = text.size();
+
+    if (m > 0) {
+        edit_distances_simd(peq, m, &text, 1, &distance);
+    }
+
+    return distance;
+}
+
+/**
+ * Computes the Jaro-Winkler similarity of a pattern and a text. Each text
+ * byte takes the first unmatched pattern position of its window holding it,
+ * found at once among the bits of the pattern positions.
+ * @param peq Bits of the pattern positions holding each byte.
+ * @param pattern Pattern, up to 64 bytes.
+ * @param text Text.
+ * @return Similarity, from 0 to 1.
+ */
+double TitleMatcher::jaro_winkler(const uint64_t *peq, std::string_view pattern, std::string_view text)
+{
+    std::size_t m = pattern.size(),
+                n = text.size();
+
+    if (m == 0 || n == 0) {
+        return m == n ? 1.0 : 0.0;
+    }
+
+    std::ptrdiff_t window = std::max<std::ptrdiff_t>(std::max(m, n) / 2 - 1, 0);
+    uint64_t matched = 0;
+    char text_matches[65];
+    unsigned matches = 0,
+             transpositions = 0;
+
+    for (std::size_t j = 0; j < n; ++j) {
+        std::ptrdiff_t low  = static_cast<std::ptrdiff_t>(j) - window,
+                       high = static_cast<std::ptrdiff_t>(j) + window;
+
+        if (low >= static_cast<std::ptrdiff_t>(m)) {
+            break;
+        }
+
+        uint64_t mask = high >= 63 ? ~uint64_t(0) : (uint64_t(1) << (high + 1)) - 1;
+
+        if (low > 0) {
+            mask &= ~((uint64_t(1) << low) - 1);
+        }
+
+        uint64_t bits   = peq[static_cast<unsigned char>(text[j])] & mask & ~matched,
+                 lowest = bits & -bits;
+
+        // Without branches, as whether a byte matches is unpredictable.
+        matched |= lowest;
+        text_matches[matches] = text[j];
+        matches += lowest != 0;
+    }
+
+    if (matches == 0) {
+        return 0.0;
+    }
+
+    for (unsigned k = 0; matched != 0; ++k, matched &= matched - 1) {
+        transpositions += pattern[__builtin_ctzll(matched)] != text_matches[k];
+    }
+
+    double jaro = (static_cast<double>(matches) / m + static_cast<double>(matches) / n + (matches - transpositions / 2.0) / matches) / 3.0;
+
+    return winkler(jaro, pattern, text);
+}
+
+/**
+ * Computes the edit distance of two strings of any length, with the
+ * dynamic programming algorithm.
+ * @param a First string.
+ * @param b Second string.
+ * @return Edit distance.
+ */
+unsigned TitleMatcher::edit_distance_dp(std::string_view a, std::string_view b)
+{
+    std::vector<unsigned> row(b.size() + 1);
+
+    for (std::size_t j = 0; j <= b.size(); ++j) {
+        row[j] = j;
+    }
+
+    for (std::size_t i = 1; i <= a.size(); ++i) {
+        unsigned diagonal = row[0];
+
+        row[0] = i;
+
+        for (std::size_t j = 1; j <= b.size(); ++j) {
+            unsigned above = row[j];
+
+            row[j]   = std::min({above + 1, row[j - 1] + 1, diagonal + (a[i - 1] != b[j - 1])});
+            diagonal = above;
+        }
+    }
+
+    return row[b.size()];
+}
+
+/**
+ * Computes the Jaro-Winkler similarity of two strings of any length.
+ * @param a First string.
+ * @param b Second string.
+ * @return Similarity, from 0 to 1.
+ */
+double TitleMatcher::jaro_winkler_dp(std::string_view a, std::string_view b)
+{
+    if (a.empty() || b.empty()) {
+        return a.size() == b.size() ? 1.0 : 0.0;
+    }
+
+    std::size_t window = std::max<std::size_t>(std::max(a.size(), b.size()) / 2, 1) - 1;
+    std::vector<bool> a_matched(a.size()), b_matched(b.size());
+    unsigned matches = 0,
+             transpositions = 0;
+
+    for (std::size_t j = 0; j < b.size(); ++j) {
+        std::size_t low  = j > window ? j - window : 0,
+                    high = std::min(j + window + 1, a.size());
+
+        for (std::size_t i = low; i < high; ++i) {
+            if (!a_matched[i] && a[i] == b[j]) {
+                a_matched[i] = b_matched[j] = true;
+                ++matches;
+                break;
+            }
+        }
+    }
+
+    if (matches == 0) {
+        return 0.0;
+    }
+
+    for (std::size_t i = 0, j = 0; i < a.size(); ++i) {
+        if (a_matched[i]) {
+            while (!b_matched[j]) {
+                ++j;
+            }
+
+            transpositions += a[i] != b[j++];
+        }
+    }
+
+    double jaro = (static_cast<double>(matches) / a.size() + static_cast<double>(matches) / b.size() + (matches - transpositions / 2.0) / matches) / 3.0;
+
+    return winkler(jaro, a, b);
+}
+
+/**
+ * Adds the Winkler bonus of the common prefix, up to 4 bytes, to a Jaro
+ * similarity above 0.7.
+ * @param jaro Jaro similarity.
+ * @param a First string.
+ * @param b Second string.
+ * @return Jaro-Winkler similarity.
+ */
+double TitleMatcher::winkler(double jaro, std::string_view a, std::string_view b)
+{
+    std::size_t prefix = 0;
+
+    while (prefix < 4 && prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix]) {
+        ++prefix;
+    }
+
+    return jaro > 0.7 ? jaro + prefix * 0.1 * (1.0 - jaro) : jaro;
+}
+
+/**
+ * Combines the similarities of two titles into their score.
+ * @param distance Edit distance.
+ * @param m Length of the first title.
+ * @param n Length of the second title.
+ * @param jaro_winkler Jaro-Winkler similarity.
+ * @return Score, from 0 to 1.
+ */
+double TitleMatcher::combine(unsigned distance, std::size_t m, std::size_t n, double jaro_winkler)
+{
+    auto length = std::max(m, n);
+    double levenshtein = length == 0 ? 1.0 : 1.0 - static_cast<double>(distance) / length;
+
+    return (levenshtein + jaro_winkler) / 2.0;
+}
+
+/**
+ * Computes the edit distance from the pattern to some candidates.
+ * @param candidates Normalized titles.
+ * @param indexes Indexes of the candidates to compute.
+ * @param distances Where the distances are stored, one per index.
+ */
+void TitleMatcher::edit_distances(const std::vector<std::string> &candidates, const std::vector<std::size_t> &indexes, std::vector<unsigned> &distances) const
+{
+    distances.resize(indexes.size());
+
+    if (this->m_pattern.empty() || this->m_pattern.size() > 64) {
+        for (std::size_t i = 0; i < indexes.size(); ++i) {
+            distances[i] = edit_distance(this->m_pattern, candidates[indexes[i]]);
+        }
+    } else {
+        std::vector<std::size_t> order(indexes.size()),
+                                 starts;
+        std::vector<std::string_view> texts(indexes.size());
+        std::vector<unsigned> sorted_distances(indexes.size());
+
+        // Counting sort by length, so the texts of each batch take about as long.
+        for (auto index : indexes) {
+            auto length = candidates[index].size();
+
+            if (length >= starts.size()) {
+                starts.resize(length + 1);
+            }
+
+            ++starts[length];
+        }
+
+        for (std::size_t length = 0, start = 0; length < starts.size(); ++length) {
+            std::swap(starts[length], start);
+            start += starts[length];
+        }
+
+        for (std::size_t i = 0; i < indexes.size(); ++i) {
+            auto &candidate = candidates[indexes[i]];
+            auto position = starts[candidate.size()]++;
+
+            order[position] = i;
+            texts[position] = candidate;
+        }
+
+        edit_distances_simd(this->m_peq, this->m_pattern.size(), texts.data(), texts.size(), sorted_distances.data());
+
+        for (std::size_t position = 0; position < order.size(); ++position) {
+            distances[order[position]] = sorted_distances[position];
+        }
+    }
+}
+
+/**
+ * Constructor.
+ * @param title Searched title, not normalized.
+ */
+TitleMatcher::TitleMatcher(const Glib::ustring &title) :
+    m_pattern(normalize(title))
+{
+    build_peq(this->m_pattern.size() <= 64 ? std::string_view(this->m_pattern) : std::string_view(), this->m_peq);
+}
+
+/**
+ * Normalizes a game title for fuzzy matching: HTML entities decoded,
+ * lowercase, without accents, punctuation or articles, "&" spelled "and",
+ * and the roman numerals after the first word written in arabic numerals, as
+ * "i" only when it is the last word. Words are separated by single spaces.
+ * @param title Game title.
+ * @return Normalized title.
+ */
+std::string TitleMatcher::normalize(const Glib::ustring &title)
+{
+    auto text = title;
+
+    // The entities decoder compiles regular expressions, so it is only used when needed.
+    if (text.find('&') != Glib::ustring::npos && text.find(';') != Glib::ustring::npos) {
+        text = Tools::html_entities_decode(text);
+    }
+
+    // "&" is spelled as a word of its own, like the separators around it.
+    if (text.find('&') != Glib::ustring::npos) {
+        std::string spelled;
+
+        for (auto c : text.raw()) {
+            if (c == '&') {
+                spelled += " and ";
+            } else {
+                spelled += c;
+            }
+        }
+
+        text = spelled;
+    }
+
+    auto folded = Tools::fold_words(text);
+    std::vector<std::string> words;
+    std::string result;
+
+    for (std::size_t start = 0; start < folded.size();) {
+        auto end = std::min(folded.find(' ', start), folded.size());
+
+        words.push_back(folded.substr(start, end - start));
+        start = end + 1;
+    }
+
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        auto &current = words[i];
+
+        if (words.size() > 1 && (current == "the" || current == "a" || current == "an")) {
+            continue;
+        }
+
+        if (i > 0 && (current != "i" || i + 1 == words.size())) {
+            if (auto value = get_roman_value(current)) {
+                current = std::to_string(value);
+            }
+        }
+
+        if (!result.empty()) {
+            result += ' ';
+        }
+
+        result += current;
+    }
+
+    return result;
+}
+
+/**
+ * Computes the edit distance of two strings.
+ * @param a First string.
+ * @param b Second string.
+ * @return Edit distance, in bytes.
+ */
+unsigned TitleMatcher::edit_distance(std::string_view a, std::string_view b)
+{
+    if (a.size() > b.size()) {
+        std::swap(a, b);
+    }
+
+    if (a.size() > 64) {
+        return edit_distance_dp(a, b);
+    }
+
+    uint64_t peq[256];
+
+    build_peq(a, peq);
+
+    return edit_distance(peq, a.size(), b);
+}
+
+/**
+ * Computes the Jaro-Winkler similarity of two strings.
+ * @param a First string.
+ * @param b Second string.
+ * @return Similarity, from 0 to 1.
+ */
+double TitleMatcher::jaro_winkler(std::string_view a, std::string_view b)
+{
+    if (a.size() > b.size()) {
+        std::swap(a, b);
+    }
+
+    if (a.size() > 64) {
+        return jaro_winkler_dp(a, b);
+    }
+
+    uint64_t peq[256];
+
+    build_peq(a, peq);
+
+    return jaro_winkler(peq, a, b);
+}
+
+/**
+ * Scores two normalized titles.
+ * @param a First title.
+ * @param b Second title.
+ * @return Score, from 0 to 1.
+ */
+double TitleMatcher::similarity(std::string_view a, std::string_view b)
+{
+    return combine(edit_distance(a, b), a.size(), b.size(), jaro_winkler(a, b));
+}
+
+/**
+ * Gets the normalized searched title.
+ * @return Normalized title.
+ */
+const std::string &TitleMatcher::get_pattern() const
+{
+    return this->m_pattern;
+}
+
+/**
+ * Scores a candidate.
+ * @param candidate Normalized title.
+ * @return Score, from 0 to 1.
+ */
+double TitleMatcher::score(std::string_view candidate) const
+{
+    if (this->m_pattern.size() > 64) {
+        return similarity(this->m_pattern, candidate);
+    }
+
+    return combine(edit_distance(this->m_peq, this->m_pattern.size(), candidate), this->m_pattern.size(), candidate.size(),
+                   jaro_winkler(this->m_peq, this->m_pattern, candidate));
+}
+
+/**
+ * Scores several candidates. Those that can not reach the minimum score by
+ * their length alone are discarded first, then the edit distance of the
+ * rest is computed in batches, and the Jaro-Winkler similarity only of those
+ * still able to reach it.
+ * @param candidates Normalized titles.
+ * @param min_score Minimum score of the results.
+ * @param max_results Maximum number of results.
+ * @return Best candidates, by descending score and then by index.
+ */
+std::vector<TitleMatcher::Match> TitleMatcher::rank(const std::vector<std::string> &candidates, double min_score, std::size_t max_results) const
+{
+    std::size_t m = this->m_pattern.size();
+    std::vector<std::size_t> indexes;
+    std::vector<unsigned> distances;
+    std::vector<Match> matches;
+
+    // The edit distance is at least the length difference, and the Jaro-Winkler similarity at most 1.
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        if (combine(std::max(m, candidates[i].size()) - std::min(m, candidates[i].size()), m, candidates[i].size(), 1.0) >= min_score) {
+            indexes.push_back(i);
+        }
+    }
+
+    this->edit_distances(candidates, indexes, distances);
+
+    for (std::size_t i = 0; i < indexes.size(); ++i) {
+        auto &candidate = candidates[indexes[i]];
+
+        if (combine(distances[i], m, candidate.size(), 1.0) < min_score) {
+            continue;
+        }
+
+        double jaro_winkler = m > 64 ? TitleMatcher::jaro_winkler(this->m_pattern, candidate) : TitleMatcher::jaro_winkler(this->m_peq, this->m_pattern, candidate),
+               score = combine(distances[i], m, candidate.size(), jaro_winkler);
+
+        if (score >= min_score) {
+            matches.push_back(Match{indexes[i], score});
+        }
+    }
+
+    auto by_score = [](const Match &a, const Match &b) {
+        return a.score > b.score || (a.score == b.score && a.index < b.index);
+    };
+
+    if (matches.size() > max_results) {
+        std::partial_sort(matches.begin(), matches.begin() + max_results, matches.end(), by_score);
+        matches.resize(max_results);
+    } else {
+        std::sort(matches.begin(), matches.end(), by_score);
+    }
+
+    return matches;
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,82 @@
+/**
+ * @file
+ * TitleMatcher class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef TITLEMATCHER_H
+#define TITLEMATCHER_H
+
+#define TITLE_MATCH_THRESHOLD     0.85 ///< Minimum score of a fuzzy title match.
+#define TITLE_DUPLICATE_THRESHOLD 0.92 ///< Minimum score of a possible duplicate profile.
+
+#include <glibmm/ustring.h>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Fuzzy game title matcher.
+ * Titles are compared once normalized by normalize(), so "Prince of Persia
+ * II: The Shadow & The Flame" and "prince of persia 2 shadow and flame"
+ * are the same title. Their score is the mean of their Levenshtein similarity
+ * and their Jaro-Winkler similarity, from 0 to 1.
+ * Both similarities are bit-parallel: each pattern character is a bit of a
+ * machine word, so a whole column of the distance matrix is computed at once
+ * (Myers' algorithm for the edit distance). When ranking, the edit distance of
+ * several candidates is computed at once in the lanes of a vector register,
+ * using AVX2 when the processor has it. Patterns longer than 64 bytes fall
+ * back to the dynamic programming algorithms.
+ * Normalizing is much slower than scoring, so the candidates are given
+ * already normalized and should be kept that way by the callers.
+ * Instances can be used from any thread.
+ */
+class TitleMatcher final
+{
+public:
+    /**
+     * Candidate scored by rank().
+     */
+    struct Match
+    {
+        std::size_t index; ///< Candidate index.
+        double score;      ///< Score, from 0 to 1.
+    };
+
+private:
+    std::string m_pattern; ///< Normalized searched title.
+    uint64_t m_peq[256];   ///< Bits of the pattern positions holding each byte.
+
+    static unsigned edit_distance(const uint64_t *peq, std::size_t m, std::string_view text);
+    static double jaro_winkler(const uint64_t *peq, std::string_view pattern, std::string_view text);
+    static unsigned edit_distance_dp(std::string_view a, std::string_view b);
+    static double jaro_winkler_dp(std::string_view a, std::string_view b);
+    static double winkler(double jaro, std::string_view a, std::string_view b);
+    static double combine(unsigned distance, std::size_t m, std::size_t n, double jaro_winkler);
+    void edit_distances(const std::vector<std::string> &candidates, const std::vector<std::size_t> &indexes, std::vector<unsigned> &distances) const;
+
+public:
+    explicit TitleMatcher(const Glib::ustring &title);
+
+    static std::string normalize(const Glib::ustring &title);
+    static unsigned edit_distance(std::string_view a, std::string_view b);
+    static double jaro_winkler(std::string_view a, std::string_view b);
+    static double similarity(std::string_view a, std::string_view b);
+
+    const std::string &get_pattern() const;
+    double score(std::string_view candidate) const;
+    std::vector<Match> rank(const std::vector<std::string> &candidates, double min_score = TITLE_MATCH_THRESHOLD, std::size_t max_results = SIZE_MAX) const;
+};
+
+} // DOSBoxGTK
+
+#endif // TITLEMATCHER_H
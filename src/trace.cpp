@@ -0,0 +1,181 @@
+/**
+ * @file
+ * Trace class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "trace.hpp"
+#include "log.hpp"
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+std::atomic<bool> Trace::s_enabled(false);
+
+/**
+ * Writes a string as a JSON string literal.
+ * @param file Output file.
+ * @param text String to be written.
+ */
+static void write_json_string(std::FILE *file, const char *text)
+{
+    std::fputc('"', file);
+
+    for (auto c = text; *c != '\0'; ++c) {
+        if (*c == '"' || *c == '\\') {
+            std::fputc('\\', file);
+            std::fputc(*c, file);
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            std::fprintf(file, "\\u%04x", *c);
+        } else {
+            std::fputc(*c, file);
+        }
+    }
+
+    std::fputc('"', file);
+}
+
+/**
+ * Gets the trace instance, creating it the first time.
+ * @return The trace.
+ */
+Trace &Trace::get_instance()
+{
+    static Trace instance;
+
+    return instance;
+}
+
+/**
+ * Looks for the trace option in the command line and removes it, so it does
+ * not reach Gtk::Application. The option is "--trace" or "--trace=FILE".
+ * @param argc Number of arguments. It is updated if the option is removed.
+ * @param argv Arguments array. It is updated if the option is removed.
+ * @return Trace file, or an empty string if the option is not present.
+ */
+std::string Trace::parse_options(int &argc, char **argv)
+{
+    auto option_length = std::strlen(TRACE_OPTION);
+    std::string filename;
+    int n_args = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], TRACE_OPTION) == 0) {
+            filename = TRACE_DEFAULT_FILENAME;
+        } else if (std::strncmp(argv[i], TRACE_OPTION "=", option_length + 1) == 0) {
+            filename = argv[i] + option_length + 1;
+        } else {
+            argv[n_args++] = argv[i];
+        }
+    }
+
+    argv[n_args] = nullptr;
+    argc = n_args;
+
+    return filename;
+}
+
+/**
+ * Starts recording spans. The calling thread is named "main" in the trace.
+ * @param filename Chrome trace JSON file written by stop().
+ */
+void Trace::start(const std::string &filename)
+{
+    auto &instance = get_instance();
+
+    {
+        std::lock_guard<std::mutex> lock(instance.m_mutex);
+
+        instance.m_filename = filename;
+        instance.m_start = std::chrono::steady_clock::now();
+        instance.m_main_thread = get_thread_id();
+        instance.m_events.clear();
+    }
+
+    s_enabled.store(true, std::memory_order_release);
+    LOG_INFO(LogCategory::GENERAL, "Tracing to %1", filename);
+}
+
+/**
+ * Stops recording spans and writes the trace file. Spans still open are not
+ * written.
+ */
+void Trace::stop()
+{
+    if (!s_enabled.exchange(false)) {
+        return;
+    }
+
+    auto &instance = get_instance();
+    std::lock_guard<std::mutex> lock(instance.m_mutex);
+    auto file = std::fopen(instance.m_filename.c_str(), "w");
+    auto pid = static_cast<long>(getpid());
+
+    if (file == nullptr) {
+        LOG_WARNING(LogCategory::GENERAL, "Can not open trace file %1", instance.m_filename);
+        return;
+    }
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    std::fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%u,\"args\":{\"name\":\"main\"}}",
+                 pid, instance.m_main_thread);
+
+    for (const auto &event : instance.m_events) {
+        std::fprintf(file, ",\n{\"name\":");
+        write_json_string(file, event.name);
+        std::fprintf(file, ",\"ph\":\"X\",\"pid\":%ld,\"tid\":%u,\"ts\":%lld,\"dur\":%lld}",
+                     pid, event.thread, static_cast<long long>(event.start), static_cast<long long>(event.duration));
+    }
+
+    std::fprintf(file, "\n]}\n");
+    std::fclose(file);
+    LOG_INFO(LogCategory::GENERAL, "Trace with %1 spans written to %2", instance.m_events.size(), instance.m_filename);
+    instance.m_events.clear();
+}
+
+/**
+ * Gets the trace time. Only meaningful while a trace is running.
+ * @return Microseconds since the trace started.
+ */
+int64_t Trace::now()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - get_instance().m_start).count();
+}
+
+/**
+ * Gets the calling thread's trace ID. IDs are small numbers assigned in the
+ * order threads ask for them.
+ * @return Trace thread ID.
+ */
+unsigned Trace::get_thread_id()
+{
+    static std::atomic<unsigned> next_id(1);
+    thread_local unsigned id = next_id++;
+
+    return id;
+}
+
+/**
+ * Records a finished span.
+ * @param name String literal naming the span.
+ * @param start Start time in microseconds since the trace started.
+ * @param duration Duration in microseconds.
+ */
+void Trace::add_span(const char *name, int64_t start, int64_t duration)
+{
+    auto &instance = get_instance();
+    auto thread = get_thread_id();
+    std::lock_guard<std::mutex> lock(instance.m_mutex);
+
+    instance.m_events.push_back({name, start, duration, thread});
+}
+
+} // Tools
@@ -0,0 +1,140 @@
+/**
+ * @file
+ * Trace class declaration and tracing macros.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include "watchdog.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#define TRACE_ENV_VAR "DOSBOXGTK_TRACE"               ///< Environment variable with the trace file.
+#define TRACE_OPTION "--trace"                        ///< Command line option enabling the trace, optionally followed by "=FILE".
+#define TRACE_DEFAULT_FILENAME "dosboxgtk-trace.json" ///< Trace file used when the option has no file.
+
+#ifndef TRACE_DISABLED
+/**
+ * Records the rest of the enclosing scope as a trace span. It is also the
+ * watchdog's active span while it lasts.
+ * @param name String literal naming the span.
+ */
+#   define TRACE_SCOPE(name) Tools::TraceScope WATCHDOG_CONCAT(trace_scope_, __LINE__)(name)
+#else
+#   define TRACE_SCOPE(name) WATCHDOG_SPAN(name)
+#endif // TRACE_DISABLED
+
+/**
+ * Evaluates an expression inside a trace span.
+ * @param name String literal naming the span.
+ * @param ... Expression. Its value is the value of the macro.
+ */
+#define TRACE_CALL(name, ...) ([&]() -> decltype(auto) { TRACE_SCOPE(name); return __VA_ARGS__; }())
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Collects trace spans and writes them as a Chrome trace JSON file, which can
+ * be opened with chrome://tracing or Perfetto. Spans are only recorded between
+ * start() and stop(); otherwise a span costs a single atomic load.
+ */
+class Trace final
+{
+private:
+    /**
+     * Finished span.
+     */
+    struct Event
+    {
+        const char *name;  ///< Span name.
+        int64_t start;     ///< Microseconds since the trace started.
+        int64_t duration;  ///< Duration in microseconds.
+        unsigned thread;   ///< Trace thread ID.
+    };
+
+    static std::atomic<bool> s_enabled;            ///< Whether spans are being recorded.
+
+    std::mutex m_mutex;                            ///< Protects m_events.
+    std::vector<Event> m_events;                   ///< Recorded spans.
+    std::string m_filename;                        ///< Trace file.
+    std::chrono::steady_clock::time_point m_start; ///< Trace start time.
+    unsigned m_main_thread = 0;                    ///< Trace ID of the thread that started the trace.
+
+    Trace() {}
+
+    static Trace &get_instance();
+
+public:
+    Trace(const Trace&) = delete;
+    Trace &operator=(const Trace&) = delete;
+
+    static std::string parse_options(int &argc, char **argv);
+    static void start(const std::string &filename);
+    static void stop();
+
+    /**
+     * Checks whether spans are being recorded.
+     * @return @c TRUE if a trace is running or @c FALSE otherwise.
+     */
+    static inline bool is_enabled()
+    {
+        return s_enabled.load(std::memory_order_acquire);
+    }
+
+    static int64_t now();
+    static unsigned get_thread_id();
+    static void add_span(const char *name, int64_t start, int64_t duration);
+};
+
+/**
+ * Scope guard recording a trace span.
+ */
+class TraceScope final
+{
+private:
+    WatchdogSpan m_watchdog_span; ///< Watchdog span with the same name.
+    const char *m_name;           ///< Span name.
+    int64_t m_start = -1;         ///< Start time, or -1 if it is not being recorded.
+
+public:
+    /**
+     * Constructor. Starts the span.
+     * @param name String literal naming the span.
+     */
+    explicit TraceScope(const char *name) :
+        m_watchdog_span(name), m_name(name)
+    {
+        if (Trace::is_enabled()) {
+            this->m_start = Trace::now();
+        }
+    }
+
+    /**
+     * Destructor. Records the span.
+     */
+    ~TraceScope()
+    {
+        if (this->m_start >= 0) {
+            Trace::add_span(this->m_name, this->m_start, Trace::now() - this->m_start);
+        }
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope &operator=(const TraceScope&) = delete;
+};
+
+} // Tools
+
+#endif // TRACE_HPP
@@ -0,0 +1,301 @@
+/**
+ * @file
+ * UiBench class definition.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "uibench.h"
+#include "editmountdialog.h"
+#include "editprofiledialog.h"
+#include "log.hpp"
+#include <glibmm/main.h>
+#include <glibmm/miscutils.h>
+#include <gtkmm/container.h>
+#include <gtkmm/liststore.h>
+#include <gtkmm/toolbutton.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Looks for a visible top level window of the given class.
+ * @return The window or @c nullptr if there is none.
+ */
+template<typename T> T *UiBench::find_dialog()
+{
+    for (auto window : Gtk::Window::list_toplevels()) {
+        auto dialog = dynamic_cast<T*>(window);
+
+        if (dialog != nullptr && dialog->get_mapped()) {
+            return dialog;
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * Looks for a widget by its builder ID.
+ * @param widget Widget tree root.
+ * @param name Builder ID.
+ * @return The widget or @c nullptr if it is not in the tree.
+ */
+Gtk::Widget *UiBench::find_widget(Gtk::Widget *widget, const Glib::ustring &name)
+{
+    auto buildable_name = gtk_buildable_get_name(GTK_BUILDABLE(widget->gobj()));
+
+    if (buildable_name != nullptr && name == buildable_name) {
+        return widget;
+    }
+
+    auto container = dynamic_cast<Gtk::Container*>(widget);
+
+    if (container != nullptr) {
+        for (auto child : container->get_children()) {
+            auto found = find_widget(child, name);
+
+            if (found != nullptr) {
+                return found;
+            }
+        }
+    }
+
+    return nullptr;
+}
+
+/**
+ * Selects a range of rows of the profiles list, like a shift click.
+ * @param first First row, wrapped around the number of rows.
+ * @param count Number of rows.
+ */
+void UiBench::select_rows(unsigned first, unsigned count)
+{
+    auto rows = this->m_profiles_tv->get_model()->children().size();
+    auto selection = this->m_profiles_tv->get_selection();
+
+    selection->unselect_all();
+
+    if (rows == 0) {
+        return;
+    }
+
+    first %= rows;
+    count = std::min<unsigned>(count, rows - first);
+    selection->select(Gtk::TreePath(Glib::ustring::compose("%1", first)),
+                      Gtk::TreePath(Glib::ustring::compose("%1", first + count - 1)));
+}
+
+/**
+ * Builds the scenario.
+ * @param rounds Number of profiles edited.
+ */
+void UiBench::create_scenario(unsigned rounds)
+{
+    auto view_idle = [this] {
+        return !this->m_window.is_updating_view();
+    };
+
+    this->m_steps.push_back({"startup", [] {}, [this, view_idle] {
+        return this->m_window.get_mapped() && view_idle();
+    }});
+
+    for (unsigned i = 0; i < rounds; ++i) {
+        this->m_steps.push_back({"select_profile", [this, i] {
+            this->select_rows(i * 7, 1);
+        }, [this] {
+            return this->m_main_ag->get_action("Edit")->get_sensitive();
+        }});
+        this->m_steps.push_back({"open_edit_profile", [this] {
+            this->m_main_ag->get_action("Edit")->activate();
+        }, [] {
+            return find_dialog<EditProfileDialog>() != nullptr;
+        }});
+        // The mount dialog runs a nested main loop, so the check is scheduled
+        // by run_step() before the button is clicked.
+        this->m_steps.push_back({"open_edit_mount", [] {
+            auto dialog = find_dialog<EditProfileDialog>();
+            auto button = dialog != nullptr ? dynamic_cast<Gtk::ToolButton*>(find_widget(dialog, "AddMountToolButton")) : nullptr;
+
+            if (button != nullptr) {
+                button->clicked();
+            }
+        }, [] {
+            return find_dialog<EditMountDialog>() != nullptr;
+        }});
+        this->m_steps.push_back({"close_edit_mount", [] {
+            auto dialog = find_dialog<EditMountDialog>();
+
+            if (dialog != nullptr) {
+                dialog->response(Gtk::RESPONSE_CANCEL);
+            }
+        }, [] {
+            return find_dialog<EditMountDialog>() == nullptr;
+        }});
+        this->m_steps.push_back({"accept_edit_profile", [] {
+            auto dialog = find_dialog<EditProfileDialog>();
+
+            if (dialog != nullptr) {
+                dialog->response(Gtk::RESPONSE_ACCEPT);
+            }
+        }, [view_idle] {
+            return find_dialog<EditProfileDialog>() == nullptr && view_idle();
+        }});
+    }
+
+    for (auto order : {Gtk::SORT_DESCENDING, Gtk::SORT_ASCENDING}) {
+        this->m_steps.push_back({"sort_profiles", [this, order] {
+            Glib::RefPtr<Gtk::ListStore>::cast_static(this->m_profiles_tv->get_model())->set_sort_column(0, order);
+        }, view_idle});
+    }
+
+    for (unsigned i = 0; i < rounds; ++i) {
+        this->m_steps.push_back({"delete_profiles", [this, i] {
+            this->select_rows(i * UI_BENCH_DELETE_BATCH, UI_BENCH_DELETE_BATCH);
+            this->m_main_ag->get_action("Remove")->activate();
+        }, view_idle});
+    }
+}
+
+/**
+ * Runs the current step and starts polling for its completion.
+ */
+void UiBench::run_step()
+{
+    if (this->m_current >= this->m_steps.size()) {
+        this->finish();
+        return;
+    }
+
+    auto &step = this->m_steps[this->m_current];
+
+    this->m_start = std::chrono::steady_clock::now();
+    Glib::signal_timeout().connect_once(sigc::mem_fun(*this, &UiBench::check_step), UI_BENCH_POLL_INTERVAL, Glib::PRIORITY_LOW);
+    step.action();
+}
+
+/**
+ * Records the latency of the current step once it has completed and moves
+ * to the next one. The check runs at low priority, so it only runs once the
+ * events, redraws and idle handlers queued by the action have been
+ * dispatched.
+ */
+void UiBench::check_step()
+{
+    auto &step = this->m_steps[this->m_current];
+
+    if (!step.done()) {
+        Glib::signal_timeout().connect_once(sigc::mem_fun(*this, &UiBench::check_step), UI_BENCH_POLL_INTERVAL, Glib::PRIORITY_LOW);
+        return;
+    }
+
+    auto latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->m_start).count();
+
+    if (this->m_latencies.find(step.name) == this->m_latencies.end()) {
+        this->m_order.push_back(step.name);
+    }
+
+    this->m_latencies[step.name].push_back(latency);
+    ++this->m_current;
+    Glib::signal_timeout().connect_once(sigc::mem_fun(*this, &UiBench::run_step), UI_BENCH_SETTLE_TIME);
+}
+
+/**
+ * Writes the results and closes the main window, quitting the application.
+ */
+void UiBench::finish()
+{
+    std::ofstream file(this->m_filename);
+
+    file << "action,samples,mean_ms,p50_ms,p95_ms,max_ms" << std::endl;
+
+    for (auto &name : this->m_order) {
+        auto latencies = this->m_latencies[name];
+        double sum = 0;
+
+        std::sort(latencies.begin(), latencies.end());
+
+        for (auto latency : latencies) {
+            sum += latency;
+        }
+
+        file << name << ',' << latencies.size() << ',' << sum / latencies.size() << ','
+             << latencies[latencies.size() / 2] << ',' << latencies[(latencies.size() * 95) / 100] << ','
+             << latencies.back() << std::endl;
+    }
+
+    if (!file) {
+        LOG_ERROR(Tools::LogCategory::GENERAL, "Can not write UI benchmark results to %1", this->m_filename);
+    } else {
+        LOG_INFO(Tools::LogCategory::GENERAL, "UI benchmark results written to %1", this->m_filename);
+    }
+
+    this->m_window.hide();
+}
+
+/**
+ * Constructor.
+ * @param window Main window to be driven.
+ * @param builder Main window builder.
+ * @param filename Results CSV file.
+ */
+UiBench::UiBench(MainWindow &window, const Glib::RefPtr<Gtk::Builder> &builder, const std::string &filename)
+    : m_window(window),
+      m_filename(filename)
+{
+    auto rounds = Glib::getenv(UI_BENCH_ROUNDS_ENV_VAR);
+
+    builder->get_widget("ProfilesTV", this->m_profiles_tv);
+    this->m_main_ag = Glib::RefPtr<Gtk::ActionGroup>::cast_dynamic(builder->get_object("MainActionGroup"));
+    this->create_scenario(rounds.empty() ? UI_BENCH_DEFAULT_ROUNDS : std::max(1l, std::atol(rounds.c_str())));
+}
+
+/**
+ * Removes the UI benchmark option from the command line arguments, so they
+ * can be passed to Gtk::Application.
+ * @param argc Number of arguments. Updated.
+ * @param argv Arguments array. Updated.
+ * @return Results file name or an empty string if the option is not present.
+ */
+std::string UiBench::parse_options(int &argc, char **argv)
+{
+    auto option_length = std::strlen(UI_BENCH_OPTION);
+    std::string filename;
+    int n_args = 1;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], UI_BENCH_OPTION) == 0) {
+            filename = UI_BENCH_DEFAULT_FILENAME;
+        } else if (std::strncmp(argv[i], UI_BENCH_OPTION "=", option_length + 1) == 0) {
+            filename = argv[i] + option_length + 1;
+        } else {
+            argv[n_args++] = argv[i];
+        }
+    }
+
+    argv[n_args] = nullptr;
+    argc = n_args;
+
+    return filename;
+}
+
+/**
+ * Starts the scenario. Called before running the application, so the
+ * startup action measures the time until the main window shows the
+ * profiles.
+ */
+void UiBench::start()
+{
+    LOG_INFO(Tools::LogCategory::GENERAL, "Running the UI benchmark, %1 actions", this->m_steps.size());
+    this->run_step();
+}
+
+} // DOSBoxGTK
@@ -0,0 +1,86 @@
+/**
+ * @file
+ * UiBench class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef UIBENCH_H
+#define UIBENCH_H
+
+#define UI_BENCH_OPTION "--ui-bench"                        ///< Command line option running the benchmark, optionally followed by "=FILE".
+#define UI_BENCH_DEFAULT_FILENAME "dosboxgtk-ui.csv"        ///< Results file used when the option has no file.
+#define UI_BENCH_ROUNDS_ENV_VAR "DOSBOXGTK_UI_BENCH_ROUNDS" ///< Environment variable with the number of profiles edited.
+#define UI_BENCH_DEFAULT_ROUNDS 10                          ///< Default number of profiles edited.
+#define UI_BENCH_DELETE_BATCH 10                            ///< Profiles removed by each delete action.
+#define UI_BENCH_SETTLE_TIME 50                             ///< Milliseconds waited between actions.
+#define UI_BENCH_POLL_INTERVAL 1                            ///< Milliseconds between idle checks.
+
+#include "mainwindow.h"
+#include <gtkmm/builder.h>
+#include <gtkmm/treeview.h>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Scripted UI latency benchmark. It drives the real main window and dialogs
+ * through a fixed scenario and records the input-to-idle latency of each
+ * action: the time from the action until the expected window state is reached
+ * and the main loop has nothing left to do but low priority work. It is
+ * meant to be run on a generated library under a virtual display, see
+ * bench/ui-bench.sh, and it quits the application when finished.
+ * The scenario selects and edits a profile per round, opening the
+ * EditProfileDialog, an EditMountDialog and accepting the changes, then sorts
+ * the profiles list and removes batches of profiles.
+ */
+class UiBench final
+{
+private:
+    /**
+     * Scenario action.
+     */
+    struct Step
+    {
+        Glib::ustring name;           ///< Action name in the results.
+        std::function<void()> action; ///< Simulated input.
+        std::function<bool()> done;   ///< Checks whether the action has completed.
+    };
+
+    MainWindow &m_window;                                     ///< Window being driven.
+    Gtk::TreeView *m_profiles_tv = nullptr;                   ///< Profiles list.
+    Glib::RefPtr<Gtk::ActionGroup> m_main_ag;                 ///< Main window actions.
+    std::string m_filename;                                   ///< Results CSV file.
+    std::vector<Step> m_steps;                                ///< Scenario.
+    std::size_t m_current = 0;                                ///< Step being run.
+    std::chrono::steady_clock::time_point m_start;            ///< Current step start time.
+    std::map<Glib::ustring, std::vector<double>> m_latencies; ///< Latencies in milliseconds by action.
+    std::vector<Glib::ustring> m_order;                       ///< Action names in the order they are first run.
+
+    template<typename T> static T *find_dialog();
+    static Gtk::Widget *find_widget(Gtk::Widget *widget, const Glib::ustring &name);
+    void select_rows(unsigned first, unsigned count);
+    void create_scenario(unsigned rounds);
+    void run_step();
+    void check_step();
+    void finish();
+
+public:
+    UiBench(MainWindow &window, const Glib::RefPtr<Gtk::Builder> &builder, const std::string &filename);
+
+    static std::string parse_options(int &argc, char **argv);
+    void start();
+};
+
+} // DOSBoxGTK
+
+#endif // UIBENCH_H
@@ -0,0 +1,164 @@
+/**
+ * @file
+ * VerifyLibraryDialog class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "verifylibrarydialog.h"
+#include "config.h"
+#include <glibmm/i18n.h>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Shows the number of profiles with problems.
+ */
+void VerifyLibraryDialog::update_summary()
+{
+    if (this->m_broken_profiles == 0) {
+        this->m_summary_label->set_text(_("No problems found."));
+    } else {
+        this->m_summary_label->set_text(Glib::ustring::compose(_("%1 of %2 profiles have problems."), this->m_broken_profiles, this->m_titles.size()));
+    }
+}
+
+/**
+ * Stops listening to the validator and closes the dialog.
+ * The validation keeps running for the main window.
+ * @param response_id Dialog response value.
+ */
+void VerifyLibraryDialog::on_response(int response_id)
+{
+    for (auto &connection : this->m_connections) {
+        connection.disconnect();
+    }
+
+    this->m_connections.clear();
+    Gtk::Dialog::on_response(response_id);
+    this->hide();
+}
+
+/**
+ * Validates the library again.
+ */
+void VerifyLibraryDialog::on_verify_button_clicked()
+{
+    std::vector<Glib::ustring> ids;
+
+    for (auto &title : this->m_titles) {
+        ids.push_back(title.first);
+    }
+
+    this->m_issues_ls->clear();
+    this->m_broken_profiles = 0;
+    this->m_verify_button->set_sensitive(false);
+    this->m_verify_pb->set_fraction(0);
+    this->m_verify_pb->set_text(_("Verifying..."));
+    this->m_summary_label->set_text(Glib::ustring());
+    this->m_validator->start(this->m_profiles_path, ids);
+}
+
+/**
+ * Adds the problems of a validated profile to the report.
+ * @param id ID of the validated profile.
+ * @param issues Problems found in the profile.
+ */
+void VerifyLibraryDialog::on_profile_validated(const Glib::ustring &id, const std::vector<ProfileIssue> &issues)
+{
+    auto title = this->m_titles.find(id);
+
+    if (title == this->m_titles.end() || issues.empty()) {
+        return;
+    }
+
+    for (auto &issue : issues) {
+        auto iter = this->m_issues_ls->append();
+
+        iter->set_value(0, title->second);
+        iter->set_value(1, issue.get_label());
+        iter->set_value(2, issue.path);
+        iter->set_value(3, id);
+    }
+
+    ++this->m_broken_profiles;
+}
+
+/**
+ * Updates the progress bar.
+ * @param done Profiles validated.
+ * @param total Profiles to validate.
+ */
+void VerifyLibraryDialog::on_progress(unsigned done, unsigned total)
+{
+    this->m_verify_pb->set_fraction(static_cast<double>(done) / total);
+    this->m_verify_pb->set_text(Glib::ustring::compose(_("%1 of %2 profiles verified"), done, total));
+}
+
+/**
+ * Shows the summary when the validation ends.
+ */
+void VerifyLibraryDialog::on_finished()
+{
+    this->m_verify_pb->set_fraction(1);
+    this->m_verify_pb->set_text(_("Done"));
+    this->m_verify_button->set_sensitive(true);
+    this->update_summary();
+}
+
+/**
+ * Constructor.
+ * @param cobject Underlying C object for the Base Class constructor.
+ * @param builder Gtk::Builder used to retrieve the child widgets.
+ */
+VerifyLibraryDialog::VerifyLibraryDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder) :
+    Gtk::Dialog(cobject)
+{
+    builder->set_translation_domain(PACKAGE);
+
+    this->m_issues_ls = Glib::RefPtr<Gtk::ListStore>::cast_dynamic(builder->get_object("IssuesLS"));
+    builder->get_widget("VerifyPB", this->m_verify_pb);
+    builder->get_widget("SummaryLabel", this->m_summary_label);
+    builder->get_widget("VerifyButton", this->m_verify_button);
+
+    this->m_issues_ls->set_sort_column(0, Gtk::SORT_ASCENDING);
+
+    // Signals
+    this->m_verify_button->signal_clicked().connect(sigc::mem_fun(*this, &VerifyLibraryDialog::on_verify_button_clicked));
+}
+
+/**
+ * Destructor.
+ */
+VerifyLibraryDialog::~VerifyLibraryDialog()
+{
+    for (auto &connection : this->m_connections) {
+        connection.disconnect();
+    }
+}
+
+/**
+ * Starts validating the library and reporting its problems.
+ * @param validator Validator used to check the profiles.
+ * @param profiles_path Directory containing the profiles config files.
+ * @param titles Game titles by profile ID.
+ */
+void VerifyLibraryDialog::verify(LibraryValidator &validator, const Glib::ustring &profiles_path, const std::map<Glib::ustring, Glib::ustring> &titles)
+{
+    this->m_validator     = &validator;
+    this->m_profiles_path = profiles_path;
+    this->m_titles        = titles;
+
+    this->m_connections.push_back(validator.signal_profile_validated().connect(sigc::mem_fun(*this, &VerifyLibraryDialog::on_profile_validated)));
+    this->m_connections.push_back(validator.signal_progress().connect(sigc::mem_fun(*this, &VerifyLibraryDialog::on_progress)));
+    this->m_connections.push_back(validator.signal_finished().connect(sigc::mem_fun(*this, &VerifyLibraryDialog::on_finished)));
+
+    this->on_verify_button_clicked();
+}
+
+} // DOSBoxGTK
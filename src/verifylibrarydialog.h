@@ -0,0 +1,62 @@
+/**
+ * @file
+ * VerifyLibraryDialog class declaration.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef VERIFYLIBRARYDIALOG_H
+#define VERIFYLIBRARYDIALOG_H
+
+#include "libraryvalidator.h"
+#include <gtkmm/dialog.h>
+#include <gtkmm/builder.h>
+#include <gtkmm/button.h>
+#include <gtkmm/label.h>
+#include <gtkmm/liststore.h>
+#include <gtkmm/progressbar.h>
+#include <map>
+
+/**
+ * DOSBoxGTK namespace.
+ */
+namespace DOSBoxGTK
+{
+
+/**
+ * Dialog showing the problems found in every game profile of the library.
+ */
+class VerifyLibraryDialog final : public Gtk::Dialog
+{
+private:
+    Glib::RefPtr<Gtk::ListStore> m_issues_ls;
+    Gtk::ProgressBar *m_verify_pb = nullptr;
+    Gtk::Label *m_summary_label   = nullptr;
+    Gtk::Button *m_verify_button  = nullptr;
+
+    LibraryValidator *m_validator = nullptr;          ///< Validator shared with the main window.
+    Glib::ustring m_profiles_path;                    ///< Directory containing the profiles config files.
+    std::map<Glib::ustring, Glib::ustring> m_titles;  ///< Game titles by profile ID.
+    unsigned m_broken_profiles = 0;                   ///< Profiles with problems found so far.
+    std::vector<sigc::connection> m_connections;      ///< Connections to the validator signals.
+
+    void update_summary();
+
+protected:
+    virtual void on_response(int response_id) override;
+    void on_verify_button_clicked();
+    void on_profile_validated(const Glib::ustring &id, const std::vector<ProfileIssue> &issues);
+    void on_progress(unsigned done, unsigned total);
+    void on_finished();
+
+public:
+    VerifyLibraryDialog(BaseObjectType *cobject, const Glib::RefPtr<Gtk::Builder> &builder);
+    virtual ~VerifyLibraryDialog();
+
+    void verify(LibraryValidator &validator, const Glib::ustring &profiles_path, const std::map<Glib::ustring, Glib::ustring> &titles);
+};
+
+} // DOSBoxGTK
+
+#endif // VERIFYLIBRARYDIALOG_H
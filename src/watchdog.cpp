@@ -0,0 +1,265 @@
+/**
+ * @file
+ * Watchdog class implementation.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "watchdog.hpp"
+#include "config.h"
+#include "log.hpp"
+#include <glib.h>
+#include <glibmm/main.h>
+#include <glibmm/miscutils.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <execinfo.h>
+#include <semaphore.h>
+#include <signal.h>
+
+#define WATCHDOG_SIGNAL SIGUSR2      ///< Signal used to capture the main thread's stack.
+#define WATCHDOG_CAPTURE_TIMEOUT 200 ///< Milliseconds to wait for the main thread to capture its stack.
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+thread_local bool Watchdog::t_main_thread = false;
+std::atomic<const char*> Watchdog::s_span(nullptr);
+
+/**
+ * Stack captured by the signal handler. Only async-signal-safe operations are
+ * used on it from the handler.
+ */
+static void *s_frames[WATCHDOG_MAX_FRAMES];
+static int s_n_frames = 0;
+static std::atomic<bool> s_capture_requested(false); ///< Cleared by whoever gets first, the handler or a timed out request.
+static sem_t s_captured;                             ///< Posted when the handler has written the stack.
+
+/**
+ * Signal handler run on the main thread. Captures its stack.
+ * @param signum Received signal.
+ */
+static void on_capture_signal(int signum)
+{
+    auto saved_errno = errno;
+
+    if (s_capture_requested.exchange(false, std::memory_order_acquire)) {
+        s_n_frames = backtrace(s_frames, WATCHDOG_MAX_FRAMES);
+        sem_post(&s_captured);
+    }
+
+    errno = saved_errno;
+}
+
+/**
+ * Gets the current steady clock time.
+ * @return Ticks of std::chrono::steady_clock.
+ */
+static std::chrono::steady_clock::rep now()
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+/**
+ * Constructor. Starts the heartbeat and the watchdog thread.
+ * @param threshold Main loop blocking time considered a stall.
+ * @param log_filename File the stalls are appended to.
+ */
+Watchdog::Watchdog(std::chrono::milliseconds threshold, const std::string &log_filename) :
+    m_threshold(threshold), m_log_filename(log_filename), m_main_thread(pthread_self()), m_last_beat(now())
+{
+    struct sigaction action = {};
+    void *frame = nullptr;
+
+    // backtrace() may load libgcc the first time, which is not safe inside a
+    // signal handler.
+    backtrace(&frame, 1);
+
+    sem_init(&s_captured, 0, 0);
+    action.sa_handler = on_capture_signal;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(WATCHDOG_SIGNAL, &action, nullptr);
+
+    t_main_thread = true;
+
+    auto interval = std::max<long>(this->m_threshold.count() / 4, 10);
+
+    this->m_heartbeat = Glib::signal_timeout().connect(sigc::mem_fun(*this, &Watchdog::on_heartbeat), interval, Glib::PRIORITY_HIGH);
+    this->m_thread = std::thread(&Watchdog::run, this);
+}
+
+/**
+ * Destructor. Stops the heartbeat and the watchdog thread.
+ */
+Watchdog::~Watchdog()
+{
+    this->m_heartbeat.disconnect();
+
+    {
+        std::lock_guard<std::mutex> lock(this->m_mutex);
+
+        this->m_stopping = true;
+    }
+
+    this->m_cv.notify_one();
+    this->m_thread.join();
+    signal(WATCHDOG_SIGNAL, SIG_DFL);
+    sem_destroy(&s_captured);
+}
+
+/**
+ * Gets the stall log file used when none is configured.
+ * @return Path of stalls.log in the user's cache directory.
+ */
+std::string Watchdog::get_default_log_filename()
+{
+    auto dirname = Glib::build_filename(Glib::get_user_cache_dir(), PACKAGE);
+
+    g_mkdir_with_parents(dirname.c_str(), 0700);
+
+    return Glib::build_filename(dirname, "stalls.log");
+}
+
+/**
+ * Gets the active span of the main thread.
+ * @return Span name or @c nullptr if there is none.
+ */
+const char *Watchdog::get_active_span()
+{
+    return s_span.load(std::memory_order_relaxed);
+}
+
+/**
+ * Updates the heartbeat. Run by the main loop.
+ * @return Always @c TRUE to keep the timeout.
+ */
+bool Watchdog::on_heartbeat()
+{
+    this->m_last_beat.store(now(), std::memory_order_relaxed);
+
+    return true;
+}
+
+/**
+ * Watchdog thread body. Each stall is reported once, when it exceeds the
+ * threshold, and its total duration is reported when the main loop recovers.
+ */
+void Watchdog::run()
+{
+    std::unique_lock<std::mutex> lock(this->m_mutex);
+    auto check_interval = std::max(this->m_threshold / 2, std::chrono::milliseconds(10));
+    std::chrono::steady_clock::rep stalled_beat = 0;
+    bool stalled = false;
+
+    while (!this->m_cv.wait_for(lock, check_interval, [this] { return this->m_stopping; })) {
+        auto last_beat = this->m_last_beat.load(std::memory_order_relaxed);
+        auto blocked = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::duration(now() - last_beat));
+
+        if (stalled) {
+            if (last_beat != stalled_beat) {
+                auto total = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::duration(last_beat - stalled_beat));
+
+                LOG_WARNING(LogCategory::UI, "Main loop recovered after %1 ms", total.count());
+                stalled = false;
+            }
+        } else if (blocked > this->m_threshold) {
+            auto span = get_active_span();
+
+            lock.unlock();
+            auto stack = this->capture_main_stack();
+
+            this->write_stall(blocked, span, stack);
+            LOG_WARNING(LogCategory::UI, "Main loop stalled for %1 ms in %2", blocked.count(), span != nullptr ? span : "unknown span");
+            lock.lock();
+
+            stalled = true;
+            stalled_beat = last_beat;
+        }
+    }
+}
+
+/**
+ * Captures the stack of the main thread. Interrupts it with a signal and waits
+ * for the handler.
+ * @return Symbolized frames, one per line, or an empty string if the main
+ * thread did not answer in time.
+ */
+std::string Watchdog::capture_main_stack()
+{
+    std::string stack;
+    struct timespec deadline;
+
+    s_capture_requested.store(true, std::memory_order_release);
+
+    if (pthread_kill(this->m_main_thread, WATCHDOG_SIGNAL) != 0) {
+        s_capture_requested.store(false, std::memory_order_relaxed);
+        return stack;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += WATCHDOG_CAPTURE_TIMEOUT * 1000000L;
+    deadline.tv_sec  += deadline.tv_nsec / 1000000000L;
+    deadline.tv_nsec %= 1000000000L;
+
+    while (sem_timedwait(&s_captured, &deadline) != 0) {
+        // If the request is still there the handler has not started and it
+        // will not touch the frames. Otherwise it is already writing them.
+        if (errno != EINTR && s_capture_requested.exchange(false, std::memory_order_relaxed)) {
+            return stack;
+        }
+    }
+
+    auto n_frames = s_n_frames;
+    auto symbols = backtrace_symbols(s_frames, n_frames);
+
+    // Frame 0 is the signal handler itself.
+    for (int i = 1; i < n_frames; ++i) {
+        char line[32];
+
+        std::snprintf(line, sizeof(line), "  #%-2d ", i - 1);
+        stack += line;
+        stack += symbols != nullptr ? symbols[i] : "??";
+        stack += '\n';
+    }
+
+    std::free(symbols);
+
+    return stack;
+}
+
+/**
+ * Appends a stall report to the stall log.
+ * @param blocked Time the main loop had been blocked when detected.
+ * @param span Active span or @c nullptr.
+ * @param stack Main thread's stack.
+ */
+void Watchdog::write_stall(std::chrono::milliseconds blocked, const char *span, const std::string &stack)
+{
+    auto file = std::fopen(this->m_log_filename.c_str(), "a");
+
+    if (file == nullptr) {
+        LOG_WARNING(LogCategory::UI, "Can not open stall log %1", this->m_log_filename);
+        return;
+    }
+
+    char timestamp[32];
+    auto time = std::time(nullptr);
+    struct tm local_time;
+
+    localtime_r(&time, &local_time);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &local_time);
+    std::fprintf(file, "%s stall blocked_ms=%lld span=%s\n", timestamp, static_cast<long long>(blocked.count()), span != nullptr ? span : "-");
+    std::fputs(stack.empty() ? "  (stack not captured)\n" : stack.c_str(), file);
+    std::fputc('\n', file);
+    std::fclose(file);
+}
+
+} // Tools
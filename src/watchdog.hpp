@@ -0,0 +1,122 @@
+/**
+ * @file
+ * Watchdog class declaration and span markers.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#ifndef WATCHDOG_HPP
+#define WATCHDOG_HPP
+
+#include <sigc++/connection.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <pthread.h>
+
+#define WATCHDOG_THRESHOLD_ENV_VAR "DOSBOXGTK_STALL_THRESHOLD" ///< Environment variable with the stall threshold in milliseconds. 0 disables the watchdog.
+#define WATCHDOG_LOG_ENV_VAR "DOSBOXGTK_STALL_LOG"             ///< Environment variable with the stall log file.
+#define WATCHDOG_DEFAULT_THRESHOLD 1000                        ///< Default stall threshold in milliseconds.
+#define WATCHDOG_MAX_FRAMES 64                                 ///< Maximum number of stack frames captured on a stall.
+
+#define WATCHDOG_CONCAT_IMPL(a, b) a##b
+#define WATCHDOG_CONCAT(a, b) WATCHDOG_CONCAT_IMPL(a, b)
+
+/**
+ * Marks the rest of the enclosing scope as a span. If the main loop stalls
+ * inside it, the span name is written to the stall log.
+ * @param name String literal naming the span.
+ */
+#define WATCHDOG_SPAN(name) Tools::WatchdogSpan WATCHDOG_CONCAT(watchdog_span_, __LINE__)(name)
+
+/**
+ * Namespace used for miscelaneous tools and utilities.
+ */
+namespace Tools
+{
+
+/**
+ * Detects stalls of the GLib main loop.
+ * A timeout on the main context updates a heartbeat. A watchdog thread checks
+ * it and, when the main loop has not beaten for longer than the threshold,
+ * interrupts the main thread with a signal to capture its stack. The stack and
+ * the active span are appended to the stall log and reported to the log.
+ * Only one watchdog may exist at a time and it must be created from the thread
+ * running the main loop.
+ */
+class Watchdog final
+{
+private:
+    static thread_local bool t_main_thread;        ///< Set on the thread watched by the watchdog.
+    static std::atomic<const char*> s_span;        ///< Active span of the main thread.
+
+    std::chrono::milliseconds m_threshold;         ///< Main loop blocking time considered a stall.
+    std::string m_log_filename;                    ///< Stall log file.
+    pthread_t m_main_thread;                       ///< Thread running the main loop.
+    std::atomic<std::chrono::steady_clock::rep> m_last_beat; ///< Time of the last heartbeat.
+    sigc::connection m_heartbeat;                  ///< Heartbeat timeout.
+    std::thread m_thread;                          ///< Watchdog thread.
+    std::mutex m_mutex;                            ///< Protects m_stopping.
+    std::condition_variable m_cv;                  ///< Signaled to stop the watchdog thread.
+    bool m_stopping = false;                       ///< Set to stop the watchdog thread.
+
+    bool on_heartbeat();
+    void run();
+    std::string capture_main_stack();
+    void write_stall(std::chrono::milliseconds blocked, const char *span, const std::string &stack);
+
+    friend class WatchdogSpan;
+
+public:
+    Watchdog(std::chrono::milliseconds threshold, const std::string &log_filename);
+    ~Watchdog();
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog &operator=(const Watchdog&) = delete;
+
+    static std::string get_default_log_filename();
+    static const char *get_active_span();
+};
+
+/**
+ * Scope guard setting the active span of the main thread. It does nothing on
+ * any other thread, so it can be used in code run from the thread pool too.
+ */
+class WatchdogSpan final
+{
+private:
+    const char *m_previous = nullptr; ///< Span active before this one.
+
+public:
+    /**
+     * Constructor. Makes the given span the active one.
+     * @param name String literal naming the span.
+     */
+    explicit WatchdogSpan(const char *name)
+    {
+        if (Watchdog::t_main_thread) {
+            this->m_previous = Watchdog::s_span.exchange(name, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Destructor. Restores the previous span.
+     */
+    ~WatchdogSpan()
+    {
+        if (Watchdog::t_main_thread) {
+            Watchdog::s_span.store(this->m_previous, std::memory_order_relaxed);
+        }
+    }
+
+    WatchdogSpan(const WatchdogSpan&) = delete;
+    WatchdogSpan &operator=(const WatchdogSpan&) = delete;
+};
+
+} // Tools
+
+#endif // WATCHDOG_HPP
@@ -0,0 +1,150 @@
+/**
+ * @file
+ * Tests of the HTTP client against a local stand-in server.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "httpclient.hpp"
+#include "httpstandin.hpp"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace Tools;
+
+/**
+ * Creates a page body.
+ * @param size Size in bytes.
+ * @return Body.
+ */
+static std::string get_body(std::size_t size)
+{
+    std::string body(size, ' ');
+
+    for (std::size_t i = 0; i < size; ++i) {
+        body[i] = 'a' + i % 26;
+    }
+
+    return body;
+}
+
+/**
+ * Fetching a page again revalidates it by its ETag and takes the body from
+ * the cache on a 304.
+ */
+TEST(HttpClientTest, RevalidateETag)
+{
+    Bench::HttpStandIn server("<html>Zork</html>");
+    HttpClient client;
+    CancellationToken token;
+    auto first = client.fetch(token, server.get_url("/zork"));
+
+    EXPECT_EQ(first.status, 200);
+    EXPECT_EQ(first.body, "<html>Zork</html>");
+    EXPECT_FALSE(first.from_cache);
+
+    auto second = client.fetch(token, server.get_url("/zork"));
+
+    EXPECT_EQ(second.status, 200);
+    EXPECT_EQ(second.body, "<html>Zork</html>");
+    EXPECT_TRUE(second.from_cache);
+
+    // POST requests are neither revalidated nor cached.
+    EXPECT_FALSE(client.fetch(token, server.get_url("/zork"), "q=zork").from_cache);
+    EXPECT_FALSE(client.fetch(token, server.get_url("/doom")).from_cache);
+
+    client.clear_cache();
+
+    EXPECT_FALSE(client.fetch(token, server.get_url("/zork")).from_cache);
+    EXPECT_EQ(server.get_requests(), 5u);
+}
+
+/**
+ * Pages without an ETag are revalidated by their Last-Modified date.
+ */
+TEST(HttpClientTest, RevalidateLastModified)
+{
+    Bench::HttpStandIn server("<html>Doom</html>", false);
+    HttpClient client;
+    CancellationToken token;
+
+    EXPECT_FALSE(client.fetch(token, server.get_url()).from_cache);
+
+    auto response = client.fetch(token, server.get_url());
+
+    EXPECT_EQ(response.status, 200);
+    EXPECT_EQ(response.body, "<html>Doom</html>");
+    EXPECT_TRUE(response.from_cache);
+}
+
+/**
+ * Going over HTTP_CACHE_MAX_SIZE evicts the least recently used pages, and
+ * bodies over the budget are not cached at all.
+ */
+TEST(HttpClientTest, EvictLeastRecentlyUsed)
+{
+    auto body = get_body(HTTP_CACHE_MAX_SIZE * 3 / 8);
+    Bench::HttpStandIn server(body);
+    HttpClient client;
+    CancellationToken token;
+
+    client.fetch(token, server.get_url("/a"));
+    client.fetch(token, server.get_url("/b"));
+
+    // Revalidating "a" makes "b" the least recently used.
+    EXPECT_TRUE(client.fetch(token, server.get_url("/a")).from_cache);
+    EXPECT_FALSE(client.fetch(token, server.get_url("/c")).from_cache);
+
+    // Fetching "b" again evicts "a", used before "c".
+    EXPECT_FALSE(client.fetch(token, server.get_url("/b")).from_cache);
+    EXPECT_TRUE(client.fetch(token, server.get_url("/c")).from_cache);
+
+    auto response = client.fetch(token, server.get_url("/a"));
+
+    EXPECT_FALSE(response.from_cache);
+    EXPECT_EQ(response.body, body);
+
+    Bench::HttpStandIn large_server(get_body(HTTP_CACHE_MAX_SIZE + 1));
+
+    client.fetch(token, large_server.get_url());
+
+    EXPECT_FALSE(client.fetch(token, large_server.get_url()).from_cache);
+    EXPECT_TRUE(client.fetch(token, server.get_url("/c")).from_cache);
+}
+
+/**
+ * Cancelling the token while the body arrives aborts the transfer, and the
+ * client keeps working for the next requests.
+ */
+TEST(HttpClientTest, CancelTransfer)
+{
+    auto body = get_body(HTTP_CACHE_MAX_SIZE);
+    Bench::HttpStandIn server(body);
+    HttpClient client;
+    std::size_t received = 0;
+    CancellationToken token;
+
+    EXPECT_THROW(client.fetch_stream(token, server.get_url(), std::string(), [&token, &received](const char*, std::size_t size) {
+        received += size;
+        token.cancel();
+    }), std::runtime_error);
+    EXPECT_GT(received, 0u);
+    EXPECT_LT(received, body.size());
+
+    EXPECT_THROW(client.fetch(token, server.get_url()), std::runtime_error);
+
+    std::vector<HttpRequest> requests(4, HttpRequest{server.get_url(), std::string()});
+    std::vector<std::size_t> finished;
+    CancellationToken batch_token;
+
+    client.fetch_all(batch_token, requests, 1, 0, [&batch_token, &finished](std::size_t index, HttpResponse &response) {
+        finished.push_back(index);
+        batch_token.cancel();
+    });
+
+    EXPECT_EQ(finished, std::vector<std::size_t>{0});
+    EXPECT_EQ(client.fetch(CancellationToken(), server.get_url()).body, body);
+}
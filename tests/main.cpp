@@ -0,0 +1,25 @@
+/**
+ * @file
+ * Unit tests entry point.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include <glibmm/init.h>
+#include <gtest/gtest.h>
+
+/**
+ * Runs the tests selected in the command line. See "--help" for the Google
+ * Test options, like "--gtest_filter=PATTERN".
+ * @param argc Number of arguments.
+ * @param argv Arguments array.
+ * @return Process status.
+ */
+int main(int argc, char **argv)
+{
+    Glib::init();
+    testing::InitGoogleTest(&argc, argv);
+
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,348 @@
+/**
+ * @file
+ * Tests of the offline metadata index and its importer.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "metadataimporter.h"
+#include "metadataindex.h"
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <glibmm/error.h>
+#include <glibmm/fileutils.h>
+#include <glibmm/miscutils.h>
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+using namespace DOSBoxGTK;
+
+#define HEADER_SIZE 16 ///< Size of the index file header: the magic and two 32 bit counts.
+
+/**
+ * Fixture giving each test a temporary directory for its files.
+ */
+class MetadataTest : public testing::Test
+{
+protected:
+    std::string m_dir;                ///< Temporary directory.
+    std::vector<std::string> m_files; ///< Files created in the directory.
+
+    /**
+     * Creates the temporary directory.
+     */
+    void SetUp() override
+    {
+        GError *error = nullptr;
+        auto dir = g_dir_make_tmp("dosboxgtk-tests-XXXXXX", &error);
+
+        if (dir == nullptr) {
+            Glib::Error::throw_exception(error);
+        }
+
+        this->m_dir = dir;
+        g_free(dir);
+    }
+
+    /**
+     * Removes the temporary directory and its files.
+     */
+    void TearDown() override
+    {
+        for (auto &file : this->m_files) {
+            g_remove(file.c_str());
+        }
+
+        g_rmdir(this->m_dir.c_str());
+    }
+
+    /**
+     * Gets the path of a file in the temporary directory.
+     * @param name File name.
+     * @return File path.
+     */
+    std::string get_filename(const std::string &name)
+    {
+        auto filename = Glib::build_filename(this->m_dir, name);
+
+        this->m_files.push_back(filename);
+
+        return filename;
+    }
+
+    /**
+     * Writes a file in the temporary directory.
+     * @param name File name.
+     * @param contents File contents.
+     * @return File path.
+     */
+    std::string write_file(const std::string &name, const std::string &contents)
+    {
+        auto filename = this->get_filename(name);
+
+        Glib::file_set_contents(filename, contents);
+
+        return filename;
+    }
+
+    /**
+     * Writes an index with a few games.
+     * @param name File name.
+     * @return File path.
+     */
+    std::string write_index(const std::string &name)
+    {
+        auto filename = this->get_filename(name);
+        std::vector<GameInfo> games(4);
+
+        games[0].title       = "The Secret of Monkey Island";
+        games[0].year        = "1990";
+        games[0].developer   = "Lucasfilm Games";
+        games[0].publisher   = "Lucasfilm Games";
+        games[0].genre       = "Adventure";
+        games[0].description = "Guybrush wants to be a pirate.";
+        games[1].title       = "Monkey Island 2: LeChuck's Revenge";
+        games[1].year        = "1991";
+        games[1].description = "The sequel.";
+        games[2].title       = "Doom";
+        games[2].year        = "1993";
+        games[2].description = "Demons on Mars.";
+        games[3].year        = "1994"; // Left out, as it has no title.
+
+        EXPECT_EQ(MetadataIndex::write(filename, games), 3u);
+
+        return filename;
+    }
+};
+
+/**
+ * An index written and opened again finds its games by the start of any
+ * title word, the ones whose title starts with it going first.
+ */
+TEST_F(MetadataTest, IndexRoundTrip)
+{
+    MetadataIndex index(this->write_index("games.idx"));
+
+    ASSERT_EQ(index.size(), 3u);
+
+    auto results = index.search("monkey");
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].title, "Monkey Island 2: LeChuck's Revenge");
+    EXPECT_EQ(results[0].year, "1991");
+    EXPECT_EQ(results[1].title, "The Secret of Monkey Island");
+
+    auto game = index.get_game(std::stoul(results[1].href));
+
+    EXPECT_EQ(game.title, "The Secret of Monkey Island");
+    EXPECT_EQ(game.year, "1990");
+    EXPECT_EQ(game.developer, "Lucasfilm Games");
+    EXPECT_EQ(game.publisher, "Lucasfilm Games");
+    EXPECT_EQ(game.genre, "Adventure");
+    EXPECT_EQ(game.description, "Guybrush wants to be a pirate.");
+
+    EXPECT_EQ(index.search("DOO").size(), 1u);
+    EXPECT_EQ(index.search("lechuck").size(), 1u);
+    EXPECT_TRUE(index.search("island monkey").empty());
+    EXPECT_TRUE(index.search("   ").empty());
+    EXPECT_EQ(index.search("i", 1).size(), 1u);
+    EXPECT_THROW(index.get_game(3), std::out_of_range);
+}
+
+/**
+ * The games whose title starts with the searched title are not cut off by
+ * the results limit when other titles match it first in word order.
+ */
+TEST_F(MetadataTest, IndexSearchLimit)
+{
+    auto filename = this->get_filename("limit.idx");
+    std::vector<GameInfo> games(3);
+
+    games[0].title = "Zork";
+    games[1].title = "Beyond Zork";
+    games[2].title = "Another Zork";
+    MetadataIndex::write(filename, games);
+
+    MetadataIndex index(filename);
+    auto results = index.search("zork", 2);
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].title, "Zork");
+    EXPECT_EQ(results[1].title, "Another Zork");
+    EXPECT_EQ(index.search("zork").size(), 3u);
+}
+
+/**
+ * The index keys are normalized like the fuzzy matching, so the sequel
+ * numbers are found written either way.
+ */
+TEST_F(MetadataTest, IndexSearchNormalized)
+{
+    auto filename = this->get_filename("sequels.idx");
+    std::vector<GameInfo> games(2);
+
+    games[0].title = "Prince of Persia II: The Shadow & The Flame";
+    games[1].title = "Ultima 7";
+    MetadataIndex::write(filename, games);
+
+    MetadataIndex index(filename);
+
+    ASSERT_EQ(index.search("Prince of Persia 2").size(), 1u);
+    EXPECT_EQ(index.search("prince of persia 2")[0].title, "Prince of Persia II: The Shadow & The Flame");
+    EXPECT_EQ(index.search("shadow and flame").size(), 1u);
+    EXPECT_EQ(index.search("Ultima VII").size(), 1u);
+}
+
+/**
+ * A missing file can not be mapped.
+ */
+TEST_F(MetadataTest, IndexMissingFile)
+{
+    EXPECT_THROW(MetadataIndex(this->get_filename("missing.idx")), Glib::Error);
+}
+
+/**
+ * Files cut anywhere, in the header or in the strings area, are rejected.
+ */
+TEST_F(MetadataTest, IndexTruncatedFile)
+{
+    auto contents = Glib::file_get_contents(this->write_index("games.idx"));
+
+    for (auto size : {std::size_t(0), std::size_t(HEADER_SIZE - 1), std::size_t(HEADER_SIZE), contents.size() - 1}) {
+        auto filename = this->write_file("truncated.idx", contents.substr(0, size));
+
+        EXPECT_THROW(MetadataIndex index(filename), std::runtime_error) << "Size: " << size;
+    }
+}
+
+/**
+ * Files with a wrong magic or an offset out of the file are rejected.
+ */
+TEST_F(MetadataTest, IndexCorruptFile)
+{
+    auto contents = Glib::file_get_contents(this->write_index("games.idx"));
+    uint32_t value = UINT32_MAX;
+    auto patch = [&contents](std::size_t offset, uint32_t value) {
+        auto patched = contents;
+
+        std::memcpy(&patched[offset], &value, sizeof(value));
+
+        return patched;
+    };
+
+    // First record title offset, and then its length.
+    EXPECT_THROW(MetadataIndex(this->write_file("offset.idx", patch(HEADER_SIZE + 8, value))), std::runtime_error);
+    EXPECT_THROW(MetadataIndex(this->write_file("length.idx", patch(HEADER_SIZE + 12, value))), std::runtime_error);
+
+    // Number of records and of words.
+    EXPECT_THROW(MetadataIndex(this->write_file("records.idx", patch(8, value))), std::runtime_error);
+    EXPECT_THROW(MetadataIndex(this->write_file("words.idx", patch(12, value))), std::runtime_error);
+
+    contents[0] = 'X';
+    EXPECT_THROW(MetadataIndex(this->write_file("magic.idx", contents)), std::runtime_error);
+}
+
+/**
+ * Games are read from CSV files, following the column names.
+ */
+TEST_F(MetadataTest, ImportCsv)
+{
+    auto games = MetadataImporter::read(this->write_file("games.csv",
+        "Name,Released,Genre,Notes\r\n"
+        "Doom,1993-12-10,Action,\"Demons, \"\"on\"\" Mars\"\r\n"
+        ",1994,,\r\n"
+        "\"Monkey Island\",1990,Adventure,\"Two\nlines\"\r\n"));
+
+    ASSERT_EQ(games.size(), 2u);
+    EXPECT_EQ(games[0].title, "Doom");
+    EXPECT_EQ(games[0].year, "1993");
+    EXPECT_EQ(games[0].genre, "Action");
+    EXPECT_EQ(games[0].description, "Demons, \"on\" Mars");
+    EXPECT_EQ(games[1].title, "Monkey Island");
+    EXPECT_EQ(games[1].description, "Two\nlines");
+
+    EXPECT_THROW(MetadataImporter::read(this->write_file("notitle.csv", "Year,Genre\n1993,Action\n")), std::runtime_error);
+}
+
+/**
+ * Games are read from XML files as elements or attributes.
+ */
+TEST_F(MetadataTest, ImportXml)
+{
+    auto games = MetadataImporter::read(this->write_file("games.xml",
+        "<?xml version=\"1.0\"?>\n"
+        "<games>\n"
+        "  <game><title>Doom</title><year>1993</year><developer>id Software</developer></game>\n"
+        "  <game title=\"Monkey Island\" year=\"1990\"/>\n"
+        "  <game><year>1994</year></game>\n"
+        "</games>\n"));
+
+    ASSERT_EQ(games.size(), 2u);
+    EXPECT_EQ(games[0].title, "Doom");
+    EXPECT_EQ(games[0].year, "1993");
+    EXPECT_EQ(games[0].developer, "id Software");
+    EXPECT_EQ(games[1].title, "Monkey Island");
+    EXPECT_EQ(games[1].year, "1990");
+
+    EXPECT_THROW(MetadataImporter::read(this->write_file("invalid.xml", "<games><game>")), std::runtime_error);
+}
+
+/**
+ * Games are read from JSON files wherever they are.
+ */
+TEST_F(MetadataTest, ImportJson)
+{
+    auto games = MetadataImporter::read(this->write_file("games.json",
+        "\xEF\xBB\xBF{\"data\": {\"items\": [\n"
+        "  {\"Title\": \"Doom\", \"year\": 1993, \"tags\": [\"fps\"], \"developer\": \"id Software\"},\n"
+        "  {\"name\": \"Monkey \\u00cdsland\", \"released\": \"1990-10-01\", \"publisher\": null}\n"
+        "]}}"));
+
+    ASSERT_EQ(games.size(), 2u);
+    EXPECT_EQ(games[0].title, "Doom");
+    EXPECT_EQ(games[0].year, "1993");
+    EXPECT_EQ(games[0].developer, "id Software");
+    EXPECT_EQ(games[1].title, "Monkey \xC3\x8Dsland");
+    EXPECT_EQ(games[1].year, "1990");
+    EXPECT_EQ(games[1].publisher, "");
+
+    EXPECT_THROW(MetadataImporter::read(this->write_file("invalid.json", "[{\"title\": \"Doom\"")), std::runtime_error);
+}
+
+/**
+ * JSON files nested deeper than METADATA_IMPORT_MAX_DEPTH are rejected
+ * instead of overflowing the stack, and the ones right at the limit are read.
+ */
+TEST_F(MetadataTest, ImportJsonDepthLimit)
+{
+    // The game members are nested one level deeper than the arrays around it.
+    auto nest = [](unsigned arrays) {
+        return std::string(arrays, '[') + "{\"title\": \"Doom\"}" + std::string(arrays, ']');
+    };
+
+    auto games = MetadataImporter::read(this->write_file("limit.json", nest(METADATA_IMPORT_MAX_DEPTH - 1)));
+
+    ASSERT_EQ(games.size(), 1u);
+    EXPECT_EQ(games[0].title, "Doom");
+
+    EXPECT_THROW(MetadataImporter::read(this->write_file("deep.json", nest(METADATA_IMPORT_MAX_DEPTH))), std::runtime_error);
+    EXPECT_THROW(MetadataImporter::read(this->write_file("deeper.json", std::string(100000, '['))), std::runtime_error);
+}
+
+/**
+ * Importing builds an index that can be searched.
+ */
+TEST_F(MetadataTest, Import)
+{
+    auto filename = this->write_file("games.csv", "title,year\nDoom,1993\nDoom II,1994\n");
+    auto index_filename = this->get_filename("games.idx");
+
+    EXPECT_EQ(MetadataImporter::import(filename, index_filename), 2u);
+
+    MetadataIndex index(index_filename);
+
+    EXPECT_EQ(index.search("doom").size(), 2u);
+}
@@ -0,0 +1,228 @@
+/**
+ * @file
+ * Tests of the profile facets index.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profilefacetindex.h"
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace DOSBoxGTK;
+
+/**
+ * Indexed data of a profile, for the reference counts.
+ */
+struct ReferenceProfile
+{
+    std::string genre;   ///< Genre key.
+    std::string machine; ///< Machine key.
+    std::string mode;    ///< Mode key.
+};
+
+/**
+ * Creates a profile.
+ * @param id Profile ID.
+ * @param genre Game genre.
+ * @param year Release year.
+ * @return Profile.
+ */
+static ProfilePtr get_profile(const Glib::ustring &id, const Glib::ustring &genre, const Glib::ustring &year = "")
+{
+    auto profile = std::make_shared<Profile>();
+
+    profile->id = id;
+    profile->title = id;
+    profile->genre = genre;
+    profile->year = year;
+
+    return profile;
+}
+
+/**
+ * Creates the settings of a profile.
+ * @param machine Machine type.
+ * @param has_booter Whether the game boots from a disk image.
+ * @param has_program Whether the game is run from a program.
+ * @return Settings.
+ */
+static ProfileSettings get_settings(const Glib::ustring &machine, bool has_booter, bool has_program)
+{
+    ProfileSettings settings;
+
+    settings.machine = machine;
+    settings.has_booter = has_booter;
+    settings.has_program = has_program;
+
+    return settings;
+}
+
+/**
+ * Gets the counts of a facet by value key.
+ * @param index Facets index.
+ * @param facet Facet.
+ * @param filter Filter.
+ * @return Number of profiles by value key.
+ */
+static std::map<std::string, std::size_t> get_counts(const ProfileFacetIndex &index, ProfileFacet facet, const ProfileFacetFilter &filter)
+{
+    std::map<std::string, std::size_t> counts;
+
+    for (auto &count : index.count(facet, filter)) {
+        counts[count.key] = count.count;
+    }
+
+    return counts;
+}
+
+/**
+ * Values are folded and counted for the other facets of the filter, and the
+ * counts follow the settings and the removed profiles. Values left without
+ * profiles are dropped, and reused documents do not keep old settings.
+ */
+TEST(ProfileFacetIndexTest, CountsAfterSettingsAndRemove)
+{
+    ProfileFacetIndex index;
+    ProfileFacetFilter filter;
+    int first,
+        last;
+
+    index.sync(std::make_shared<ProfileSnapshot>()->with_profiles({get_profile("1", "Action", "1993"),
+                                                                   get_profile("2", " action ", "1990"),
+                                                                   get_profile("3", "RPG", "1995")}));
+    index.set_settings("1", get_settings("svga_s3", false, true));
+    index.set_settings("2", get_settings("tandy", true, false));
+    index.set_settings("3", get_settings("svga_s3", false, true));
+    index.set_settings("4", get_settings("cga", true, false));
+
+    auto genres = index.count(ProfileFacet::GENRE, filter);
+
+    ASSERT_EQ(genres.size(), 2u);
+    EXPECT_EQ(genres[0].key, "action");
+    EXPECT_EQ(genres[0].label, "Action");
+    EXPECT_EQ(genres[0].count, 2u);
+    EXPECT_EQ(get_counts(index, ProfileFacet::MACHINE, filter), (std::map<std::string, std::size_t>{{"svga_s3", 2}, {"tandy", 1}}));
+    EXPECT_EQ(get_counts(index, ProfileFacet::MODE, filter), (std::map<std::string, std::size_t>{{"booter", 1}, {"program", 2}}));
+    EXPECT_TRUE(index.get_year_range(first, last));
+    EXPECT_EQ(first, 1990);
+    EXPECT_EQ(last, 1995);
+
+    // A chosen value still counts the other values of its own facet.
+    filter.values[static_cast<int>(ProfileFacet::MACHINE)].insert("svga_s3");
+
+    EXPECT_EQ(get_counts(index, ProfileFacet::GENRE, filter), (std::map<std::string, std::size_t>{{"action", 1}, {"rpg", 1}}));
+    EXPECT_EQ(get_counts(index, ProfileFacet::MACHINE, filter), (std::map<std::string, std::size_t>{{"svga_s3", 2}, {"tandy", 1}}));
+    EXPECT_EQ(index.evaluate(filter).cardinality(), 2u);
+
+    index.set_settings("1", get_settings("tandy", true, false));
+
+    EXPECT_EQ(get_counts(index, ProfileFacet::GENRE, filter), (std::map<std::string, std::size_t>{{"action", 0}, {"rpg", 1}}));
+    EXPECT_EQ(get_counts(index, ProfileFacet::MACHINE, filter), (std::map<std::string, std::size_t>{{"svga_s3", 1}, {"tandy", 2}}));
+    EXPECT_EQ(get_counts(index, ProfileFacet::MODE, filter), (std::map<std::string, std::size_t>{{"booter", 0}, {"program", 1}}));
+
+    index.set_settings("3", ProfileSettings());
+
+    EXPECT_EQ(get_counts(index, ProfileFacet::MACHINE, filter), (std::map<std::string, std::size_t>{{"tandy", 2}}));
+    EXPECT_TRUE(index.evaluate(filter).empty());
+
+    index.remove("2");
+    filter = ProfileFacetFilter();
+
+    EXPECT_EQ(get_counts(index, ProfileFacet::GENRE, filter), (std::map<std::string, std::size_t>{{"action", 1}, {"rpg", 1}}));
+    EXPECT_EQ(get_counts(index, ProfileFacet::MACHINE, filter), (std::map<std::string, std::size_t>{{"tandy", 1}}));
+    EXPECT_EQ(get_counts(index, ProfileFacet::MODE, filter), (std::map<std::string, std::size_t>{{"booter", 1}}));
+    EXPECT_TRUE(index.get_year_range(first, last));
+    EXPECT_EQ(first, 1993);
+
+    // The new profile takes the free document.
+    index.update(get_profile("5", "Action"));
+
+    EXPECT_EQ(get_counts(index, ProfileFacet::GENRE, filter), (std::map<std::string, std::size_t>{{"action", 2}, {"rpg", 1}}));
+    EXPECT_EQ(get_counts(index, ProfileFacet::MODE, filter), (std::map<std::string, std::size_t>{{"booter", 1}}));
+    EXPECT_EQ(index.evaluate(filter).cardinality(), 3u);
+
+    index.remove("1");
+    index.remove("3");
+    index.remove("5");
+
+    EXPECT_TRUE(index.count(ProfileFacet::GENRE, filter).empty());
+    EXPECT_TRUE(index.count(ProfileFacet::MACHINE, filter).empty());
+    EXPECT_FALSE(index.get_year_range(first, last));
+}
+
+/**
+ * Random updates, settings and removals of thousands of profiles, so the
+ * frequent values move between array and bitmap containers, give the counts
+ * and matches of checking every profile.
+ */
+TEST(ProfileFacetIndexTest, CountsMatchReference)
+{
+    static const char *genres[]   = {"Action", "RPG", "Adventure"},
+                      *machines[] = {"svga_s3", "tandy", "cga"};
+    std::mt19937 random(6);
+    std::map<std::string, ReferenceProfile> profiles;
+    ProfileFacetIndex index;
+
+    for (int i = 0; i < 40000; ++i) {
+        auto id = std::to_string(random() % 9000);
+        auto operation = random() % 10;
+
+        if (operation < 6) {
+            auto genre = genres[random() % 10 < 7 ? 0 : 1 + random() % 2];
+
+            index.update(get_profile(id, genre));
+            profiles[id].genre = Glib::ustring(genre).casefold().raw();
+        } else if (operation < 9) {
+            auto machine = machines[random() % 3];
+            auto settings = get_settings(machine, random() % 2 == 0, random() % 2 == 0);
+            auto profile = profiles.find(id);
+
+            index.set_settings(id, settings);
+
+            if (profile != profiles.end()) {
+                profile->second.machine = machine;
+                profile->second.mode = settings.has_booter ? "booter" : settings.has_program ? "program" : "";
+            }
+        } else {
+            index.remove(id);
+            profiles.erase(id);
+        }
+
+        if (i % 4000 != 3999) {
+            continue;
+        }
+
+        ProfileFacetFilter filter;
+
+        filter.values[static_cast<int>(ProfileFacet::GENRE)] = {"action", "rpg"};
+        filter.values[static_cast<int>(ProfileFacet::MODE)] = {"booter"};
+
+        auto docs = index.evaluate(filter);
+        std::map<std::string, std::size_t> genre_counts,
+                                           machine_counts;
+        std::size_t matches = 0;
+
+        for (auto &profile : profiles) {
+            auto &data = profile.second;
+            bool genre_matches = data.genre != "adventure",
+                 mode_matches  = data.mode == "booter";
+
+            ASSERT_EQ(index.contains(docs, profile.first), genre_matches && mode_matches) << profile.first;
+            matches += genre_matches && mode_matches;
+            genre_counts[data.genre] += mode_matches;
+
+            if (!data.machine.empty()) {
+                machine_counts[data.machine] += genre_matches && mode_matches;
+            }
+        }
+
+        ASSERT_EQ(docs.cardinality(), matches);
+        ASSERT_EQ(get_counts(index, ProfileFacet::GENRE, filter), genre_counts);
+        ASSERT_EQ(get_counts(index, ProfileFacet::MACHINE, filter), machine_counts);
+    }
+}
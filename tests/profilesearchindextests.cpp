@@ -0,0 +1,225 @@
+/**
+ * @file
+ * Tests of the profiles search index.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "profilesearchindex.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace DOSBoxGTK;
+
+/**
+ * Creates a profile.
+ * @param id Profile ID.
+ * @param title Game title.
+ * @param developer Game developer.
+ * @return Profile.
+ */
+static ProfilePtr get_profile(const Glib::ustring &id, const Glib::ustring &title, const Glib::ustring &developer = "")
+{
+    auto profile = std::make_shared<Profile>();
+
+    profile->id = id;
+    profile->title = title;
+    profile->developer = developer;
+
+    return profile;
+}
+
+/**
+ * Gets the sorted IDs of some profiles.
+ * @param profiles Profiles.
+ * @return Profile IDs.
+ */
+static std::vector<std::string> get_ids(const std::vector<ProfilePtr> &profiles)
+{
+    std::vector<std::string> ids;
+
+    for (auto &profile : profiles) {
+        ids.push_back(profile->id.raw());
+    }
+
+    std::sort(ids.begin(), ids.end());
+
+    return ids;
+}
+
+/**
+ * Looks for the profiles matching a query by checking every word of every
+ * profile. The titles must be lowercase ASCII words, already normalized.
+ * @param profiles Profiles.
+ * @param query Searched words, lowercase ASCII.
+ * @return Sorted IDs of the matching profiles.
+ */
+static std::vector<std::string> reference_search(const std::vector<ProfilePtr> &profiles, const std::string &query)
+{
+    std::vector<std::string> ids;
+
+    for (auto &profile : profiles) {
+        std::istringstream queried(query);
+        std::string searched;
+        bool found = true;
+
+        while (found && queried >> searched) {
+            std::istringstream title(profile->title.raw());
+            std::string word;
+
+            found = false;
+
+            while (!found && title >> word) {
+                found = searched.size() < 3 ? word.starts_with(searched) : word.find(searched) != std::string::npos;
+            }
+        }
+
+        if (found) {
+            ids.push_back(profile->id.raw());
+        }
+    }
+
+    std::sort(ids.begin(), ids.end());
+
+    return ids;
+}
+
+/**
+ * Syncing indexes the new and changed profiles and drops the missing ones,
+ * and updating and removing single profiles change what is found.
+ */
+TEST(ProfileSearchIndexTest, SyncUpdateRemove)
+{
+    ProfileSearchIndex index;
+    auto doom = get_profile("1", "Doom", "id Software");
+    auto keen = get_profile("2", "Commander Keen", "id Software");
+    auto zork = get_profile("3", "Zork", "Infocom");
+
+    index.sync(std::make_shared<ProfileSnapshot>()->with_profiles({doom, keen, zork}));
+
+    EXPECT_EQ(index.size(), 3u);
+    EXPECT_EQ(get_ids(index.search("software")), (std::vector<std::string>{"1", "2"}));
+    EXPECT_EQ(get_ids(index.search("INFOCOM")), std::vector<std::string>{"3"});
+    EXPECT_EQ(get_ids(index.search("")), (std::vector<std::string>{"1", "2", "3"}));
+
+    index.update(get_profile("1", "Doom II", "Raven Software"));
+
+    EXPECT_EQ(index.size(), 3u);
+    EXPECT_EQ(get_ids(index.search("raven")), std::vector<std::string>{"1"});
+    EXPECT_EQ(get_ids(index.search("id software")), std::vector<std::string>{"2"});
+
+    index.remove("2");
+
+    EXPECT_EQ(index.size(), 2u);
+    EXPECT_TRUE(index.search("keen").empty());
+    EXPECT_TRUE(index.search("software id").empty());
+
+    index.sync(std::make_shared<ProfileSnapshot>()->with_profiles({doom, keen}));
+
+    EXPECT_EQ(index.size(), 2u);
+    EXPECT_EQ(get_ids(index.search("software")), (std::vector<std::string>{"1", "2"}));
+    EXPECT_TRUE(index.search("zork").empty());
+    EXPECT_TRUE(index.search("raven").empty());
+
+    index.clear();
+
+    EXPECT_TRUE(index.empty());
+    EXPECT_TRUE(index.search("doom").empty());
+}
+
+/**
+ * Words shorter than a trigram match the beginning of a word, longer ones
+ * match anywhere in a word, and the query is normalized as the profiles.
+ */
+TEST(ProfileSearchIndexTest, ShortQueries)
+{
+    ProfileSearchIndex index;
+
+    index.sync(std::make_shared<ProfileSnapshot>()->with_profiles({get_profile("1", "Prince of Persia"),
+                                                                   get_profile("2", "Sprint Racer"),
+                                                                   get_profile("3", "Pok\xC3\xA9mon"),
+                                                                   get_profile("4", "Red Baron")}));
+
+    EXPECT_EQ(get_ids(index.search("p")), (std::vector<std::string>{"1", "3"}));
+    EXPECT_EQ(get_ids(index.search("pr")), std::vector<std::string>{"1"});
+    EXPECT_EQ(get_ids(index.search("pri")), (std::vector<std::string>{"1", "2"}));
+    EXPECT_EQ(get_ids(index.search("r")), (std::vector<std::string>{"2", "4"}));
+    EXPECT_EQ(get_ids(index.search("o p")), std::vector<std::string>{"1"});
+    EXPECT_EQ(get_ids(index.search("  POKE ")), std::vector<std::string>{"3"});
+    EXPECT_EQ(get_ids(index.search("Pok\xC3\xA9")), std::vector<std::string>{"3"});
+    EXPECT_TRUE(index.search("d").empty());
+    EXPECT_TRUE(index.search("pr x").empty());
+}
+
+/**
+ * Intersecting a frequent word with rare ones, whose postings have a few
+ * documents with gaps needing several varint bytes, across many blocks and
+ * after removals and the renumbering, finds the same profiles as checking
+ * every profile.
+ */
+TEST(ProfileSearchIndexTest, UnevenIntersection)
+{
+    static const std::vector<std::string> queries = {"adventure", "adventure zork", "zork adventure", "quest zork",
+                                                     "adventure quest", "ure est", "wizardry", "adventure wiz",
+                                                     "ad wi", "z", "zo quest", "space", "venture space ork", "xyz"};
+    std::mt19937 random(4);
+    std::vector<ProfilePtr> profiles;
+    ProfileSearchIndex index;
+
+    for (int i = 0; i < 3000; ++i) {
+        std::string title;
+
+        if (random() % 10 != 0) {
+            title += "adventure ";
+        }
+
+        if (random() % 2 == 0) {
+            title += "quest ";
+        }
+
+        if (i % 311 == 7) {
+            title += "zork ";
+        }
+
+        if (random() % 97 == 0) {
+            title += "wizardry ";
+        }
+
+        if (i >= 1000 && i < 1300) {
+            title += "space ";
+        }
+
+        profiles.push_back(get_profile(std::to_string(i), title + "game" + std::to_string(i)));
+    }
+
+    index.sync(std::make_shared<ProfileSnapshot>()->with_profiles(profiles));
+
+    for (auto &query : queries) {
+        ASSERT_EQ(get_ids(index.search(query)), reference_search(profiles, query)) << query;
+    }
+
+    // Removing most of the profiles leaves uneven gaps and then renumbers.
+    for (std::size_t removed : {1u, 2u}) {
+        std::vector<ProfilePtr> kept;
+
+        for (std::size_t i = 0; i < profiles.size(); ++i) {
+            if (i % 3 == removed || random() % 4 == 0) {
+                index.remove(profiles[i]->id);
+            } else {
+                kept.push_back(profiles[i]);
+            }
+        }
+
+        profiles = kept;
+
+        ASSERT_EQ(index.size(), profiles.size());
+
+        for (auto &query : queries) {
+            ASSERT_EQ(get_ids(index.search(query)), reference_search(profiles, query)) << query;
+        }
+    }
+}
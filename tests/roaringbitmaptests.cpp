@@ -0,0 +1,164 @@
+/**
+ * @file
+ * Tests of the compressed integer sets.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "roaringbitmap.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <set>
+#include <vector>
+
+using namespace Tools;
+
+/**
+ * Creates a random set whose containers are of every kind: sparse and full
+ * arrays, bitmaps just over the array limit and dense bitmaps.
+ * @param random Random numbers generator.
+ * @param values Where the values are stored too.
+ * @return Set.
+ */
+static RoaringBitmap get_random_bitmap(std::mt19937 &random, std::set<uint32_t> &values)
+{
+    static const uint32_t sizes[] = {1, 100, ROARING_ARRAY_MAX - 1, ROARING_ARRAY_MAX, ROARING_ARRAY_MAX + 1, 30000};
+    RoaringBitmap bitmap;
+
+    for (uint32_t key = 0; key < 6; ++key) {
+        // Some containers are left out, so the keys do not always match.
+        if (random() % 4 == 0) {
+            continue;
+        }
+
+        std::vector<uint16_t> lows(65536);
+
+        std::iota(lows.begin(), lows.end(), 0);
+        std::shuffle(lows.begin(), lows.end(), random);
+        lows.resize(sizes[random() % std::size(sizes)]);
+
+        for (auto low : lows) {
+            bitmap.add(key << 16 | low);
+            values.insert(key << 16 | low);
+        }
+    }
+
+    return bitmap;
+}
+
+/**
+ * Adding and removing values around ROARING_ARRAY_MAX turns an array
+ * container into a bitmap and back without losing values.
+ */
+TEST(RoaringBitmapTest, ArrayBitmapConversion)
+{
+    RoaringBitmap bitmap;
+    std::vector<uint32_t> values;
+
+    for (uint32_t value = 0; value < 2 * ROARING_ARRAY_MAX; value += 2) {
+        values.push_back(0x30000 | value);
+        ASSERT_TRUE(bitmap.add(0x30000 | value));
+    }
+
+    ASSERT_EQ(bitmap.cardinality(), ROARING_ARRAY_MAX);
+    EXPECT_EQ(bitmap.to_vector(), values);
+    EXPECT_FALSE(bitmap.add(0x30000));
+
+    // One more value makes it a bitmap.
+    ASSERT_TRUE(bitmap.add(0x3ffff));
+    values.push_back(0x3ffff);
+
+    EXPECT_EQ(bitmap.cardinality(), ROARING_ARRAY_MAX + 1u);
+    EXPECT_EQ(bitmap.to_vector(), values);
+    EXPECT_TRUE(bitmap.contains(0x3ffff));
+    EXPECT_TRUE(bitmap.contains(0x30002));
+    EXPECT_FALSE(bitmap.contains(0x30001));
+    EXPECT_FALSE(bitmap.contains(0x2ffff));
+    EXPECT_FALSE(bitmap.add(0x3ffff));
+    EXPECT_FALSE(bitmap.remove(0x30001));
+
+    // One less makes it an array again.
+    ASSERT_TRUE(bitmap.remove(0x30000));
+    values.erase(values.begin());
+
+    EXPECT_EQ(bitmap.cardinality(), ROARING_ARRAY_MAX);
+    EXPECT_EQ(bitmap.to_vector(), values);
+    EXPECT_TRUE(bitmap.contains(0x3ffff));
+    EXPECT_FALSE(bitmap.contains(0x30000));
+
+    for (auto value : values) {
+        ASSERT_TRUE(bitmap.remove(value));
+    }
+
+    EXPECT_TRUE(bitmap.empty());
+    EXPECT_EQ(bitmap.cardinality(), 0u);
+    EXPECT_FALSE(bitmap.remove(0x3ffff));
+}
+
+/**
+ * Intersections, unions and their counts match the ones of ordered sets for
+ * every pair of container kinds, including array unions growing into
+ * bitmaps and bitmap intersections shrinking into arrays. The results keep
+ * working as the values are removed again, which is how a facet value loses
+ * its documents.
+ */
+TEST(RoaringBitmapTest, SetOperations)
+{
+    std::mt19937 random(5);
+
+    for (int i = 0; i < 24; ++i) {
+        std::set<uint32_t> a_values,
+                           b_values;
+        std::vector<uint32_t> both,
+                              any;
+        auto a = get_random_bitmap(random, a_values),
+             b = get_random_bitmap(random, b_values);
+
+        std::set_intersection(a_values.begin(), a_values.end(), b_values.begin(), b_values.end(), std::back_inserter(both));
+        std::set_union(a_values.begin(), a_values.end(), b_values.begin(), b_values.end(), std::back_inserter(any));
+
+        auto intersection = a & b,
+             united = a | b;
+
+        ASSERT_EQ(intersection.to_vector(), both);
+        ASSERT_EQ(intersection.cardinality(), both.size());
+        ASSERT_EQ(a.and_cardinality(b), both.size());
+        ASSERT_EQ(b.and_cardinality(a), both.size());
+        ASSERT_EQ((b & a).to_vector(), both);
+        ASSERT_EQ(united.to_vector(), any);
+        ASSERT_EQ(united.cardinality(), any.size());
+        ASSERT_EQ((b | a).to_vector(), any);
+
+        // Removing the values of one set from the union leaves the rest.
+        for (auto value : a_values) {
+            ASSERT_TRUE(united.remove(value));
+        }
+
+        std::vector<uint32_t> rest;
+
+        std::set_difference(b_values.begin(), b_values.end(), a_values.begin(), a_values.end(), std::back_inserter(rest));
+
+        ASSERT_EQ(united.to_vector(), rest);
+        ASSERT_EQ(united.cardinality(), rest.size());
+
+        for (auto value : rest) {
+            ASSERT_TRUE(united.contains(value));
+        }
+
+        a &= b;
+        b |= a;
+
+        ASSERT_EQ(a.to_vector(), both);
+        ASSERT_EQ(b.to_vector(), std::vector<uint32_t>(b_values.begin(), b_values.end()));
+    }
+
+    RoaringBitmap empty;
+
+    EXPECT_TRUE((empty & empty).empty());
+    EXPECT_TRUE((empty | empty).empty());
+    EXPECT_EQ(empty.and_cardinality(empty), 0u);
+}
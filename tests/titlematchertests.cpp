@@ -0,0 +1,267 @@
+/**
+ * @file
+ * Tests of the fuzzy title matcher.
+ * @author Javier Campón Pichardo
+ * @date 2014
+ * @copyright GNU Public License Version 3
+ */
+
+#include "titlematcher.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace DOSBoxGTK;
+
+/**
+ * Computes the edit distance of two strings with the textbook dynamic
+ * programming algorithm, the full matrix included.
+ * @param a First string.
+ * @param b Second string.
+ * @return Edit distance.
+ */
+static unsigned reference_edit_distance(const std::string &a, const std::string &b)
+{
+    std::vector<std::vector<unsigned>> d(a.size() + 1, std::vector<unsigned>(b.size() + 1));
+
+    for (std::size_t i = 0; i <= a.size(); ++i) {
+        d[i][0] = i;
+    }
+
+    for (std::size_t j = 0; j <= b.size(); ++j) {
+        d[0][j] = j;
+    }
+
+    for (std::size_t i = 1; i <= a.size(); ++i) {
+        for (std::size_t j = 1; j <= b.size(); ++j) {
+            d[i][j] = std::min({d[i - 1][j] + 1, d[i][j - 1] + 1, d[i - 1][j - 1] + (a[i - 1] != b[j - 1])});
+        }
+    }
+
+    return d[a.size()][b.size()];
+}
+
+/**
+ * Computes the Jaro-Winkler similarity of a pattern and a text by the
+ * definition: each text byte matches the first unmatched equal pattern byte
+ * within the window.
+ * @param a Pattern.
+ * @param b Text.
+ * @return Similarity, from 0 to 1.
+ */
+static double reference_jaro_winkler(const std::string &a, const std::string &b)
+{
+    if (a.empty() || b.empty()) {
+        return a.size() == b.size() ? 1.0 : 0.0;
+    }
+
+    long window = std::max<long>(std::max(a.size(), b.size()) / 2 - 1, 0);
+    std::vector<bool> a_matched(a.size()), b_matched(b.size());
+    std::string a_matches, b_matches;
+    std::size_t prefix = 0;
+
+    for (long j = 0; j < static_cast<long>(b.size()); ++j) {
+        for (long i = std::max(j - window, 0L); i <= std::min(j + window, static_cast<long>(a.size()) - 1); ++i) {
+            if (!a_matched[i] && a[i] == b[j]) {
+                a_matched[i] = b_matched[j] = true;
+                break;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a_matched[i]) {
+            a_matches += a[i];
+        }
+    }
+
+    for (std::size_t j = 0; j < b.size(); ++j) {
+        if (b_matched[j]) {
+            b_matches += b[j];
+        }
+    }
+
+    if (a_matches.empty()) {
+        return 0.0;
+    }
+
+    double matches = a_matches.size(),
+           transpositions = 0;
+
+    for (std::size_t k = 0; k < a_matches.size(); ++k) {
+        transpositions += a_matches[k] != b_matches[k];
+    }
+
+    double jaro = (matches / a.size() + matches / b.size() + (matches - transpositions / 2) / matches) / 3;
+
+    while (prefix < 4 && prefix < a.size() && prefix < b.size() && a[prefix] == b[prefix]) {
+        ++prefix;
+    }
+
+    return jaro > 0.7 ? jaro + prefix * 0.1 * (1 - jaro) : jaro;
+}
+
+/**
+ * Scores a candidate against a pattern from the reference similarities.
+ * @param pattern Normalized searched title.
+ * @param candidate Normalized title.
+ * @return Score, from 0 to 1.
+ */
+static double reference_score(const std::string &pattern, const std::string &candidate)
+{
+    auto length = std::max(pattern.size(), candidate.size());
+    double levenshtein = length == 0 ? 1.0 : 1.0 - static_cast<double>(reference_edit_distance(pattern, candidate)) / length;
+
+    return (levenshtein + reference_jaro_winkler(pattern, candidate)) / 2;
+}
+
+/**
+ * Creates a random string over a small alphabet, so there are many matches
+ * and transpositions. The alphabet has no article nor roman numeral letter,
+ * so the strings are already normalized.
+ * @param random Random numbers generator.
+ * @param max_length Maximum length.
+ * @return String.
+ */
+static std::string get_random_string(std::mt19937 &random, std::size_t max_length)
+{
+    static const char alphabet[] = "bcdeh";
+    std::string result(std::uniform_int_distribution<std::size_t>(0, max_length)(random), ' ');
+
+    for (auto &c : result) {
+        c = alphabet[random() % (sizeof(alphabet) - 1)];
+    }
+
+    return result;
+}
+
+/**
+ * Titles differing in case, punctuation, articles, accents, entities, "&"
+ * and sequel numerals are the same once normalized.
+ */
+TEST(TitleMatcherTest, Normalize)
+{
+    EXPECT_EQ(TitleMatcher::normalize("Prince of Persia II: The Shadow & The Flame"), "prince of persia 2 shadow and flame");
+    EXPECT_EQ(TitleMatcher::normalize("prince of persia 2 shadow and flame"), "prince of persia 2 shadow and flame");
+    EXPECT_EQ(TitleMatcher::normalize("Ultima VII"), "ultima 7");
+    EXPECT_EQ(TitleMatcher::normalize("Civilization I"), "civilization 1");
+    EXPECT_EQ(TitleMatcher::normalize("I Have No Mouth, and I Must Scream"), "i have no mouth and i must scream");
+    EXPECT_EQ(TitleMatcher::normalize("Tom &amp; Jerry"), "tom and jerry");
+    EXPECT_EQ(TitleMatcher::normalize("Pok\xC3\xA9mon"), "pokemon");
+    EXPECT_EQ(TitleMatcher::normalize("Sam & Max Hit the Road"), "sam and max hit road");
+    EXPECT_EQ(TitleMatcher::normalize("Lemmings 2: The Tribes"), "lemmings 2 tribes");
+    EXPECT_EQ(TitleMatcher::normalize("The"), "the");
+    EXPECT_EQ(TitleMatcher::normalize("  "), "");
+}
+
+/**
+ * Myers' edit distance matches the dynamic programming one, both for the
+ * patterns up to 64 bytes and for the longer ones falling back to it.
+ */
+TEST(TitleMatcherTest, EditDistance)
+{
+    std::mt19937 random(1);
+
+    for (int i = 0; i < 2000; ++i) {
+        auto a = get_random_string(random, 80),
+             b = get_random_string(random, 80);
+
+        ASSERT_EQ(TitleMatcher::edit_distance(a, b), reference_edit_distance(a, b)) << a << " / " << b;
+    }
+
+    EXPECT_EQ(TitleMatcher::edit_distance("kitten", "sitting"), 3u);
+    EXPECT_EQ(TitleMatcher::edit_distance("", "doom"), 4u);
+    EXPECT_EQ(TitleMatcher::edit_distance(std::string(64, 'b'), std::string(64, 'b')), 0u);
+    EXPECT_EQ(TitleMatcher::edit_distance(std::string(64, 'b'), std::string(63, 'b') + 'c'), 1u);
+}
+
+/**
+ * The bit-parallel Jaro-Winkler similarity matches the definition.
+ */
+TEST(TitleMatcherTest, JaroWinkler)
+{
+    std::mt19937 random(2);
+
+    for (int i = 0; i < 2000; ++i) {
+        auto a = get_random_string(random, 80),
+             b = get_random_string(random, 80);
+        auto &shorter = a.size() <= b.size() ? a : b,
+             &longer  = a.size() <= b.size() ? b : a;
+
+        ASSERT_DOUBLE_EQ(TitleMatcher::jaro_winkler(a, b), reference_jaro_winkler(shorter, longer)) << a << " / " << b;
+    }
+
+    EXPECT_NEAR(TitleMatcher::jaro_winkler("martha", "marhta"), 0.961, 0.001);
+    EXPECT_NEAR(TitleMatcher::jaro_winkler("dwayne", "duane"), 0.84, 0.001);
+    EXPECT_DOUBLE_EQ(TitleMatcher::jaro_winkler("doom", "doom"), 1.0);
+    EXPECT_DOUBLE_EQ(TitleMatcher::jaro_winkler("bbb", "ccc"), 0.0);
+}
+
+/**
+ * Scoring one candidate and ranking many of them give the reference scores.
+ * Ranking computes the edit distances in batches of vector lanes, with AVX2
+ * where the processor has it, so the candidates have many lengths and their
+ * number is not a multiple of the lanes.
+ */
+TEST(TitleMatcherTest, RankMatchesReference)
+{
+    std::mt19937 random(3);
+
+    for (std::size_t length : {1, 2, 7, 31, 63, 64}) {
+        std::string pattern;
+        std::vector<std::string> candidates;
+
+        while (pattern.size() != length) {
+            pattern = get_random_string(random, length);
+        }
+
+        TitleMatcher matcher(pattern);
+
+        ASSERT_EQ(matcher.get_pattern(), pattern);
+
+        for (int i = 0; i < 203; ++i) {
+            auto candidate = get_random_string(random, 70);
+
+            // Bytes out of ASCII, as in the UTF-8 titles.
+            if (i % 7 == 0) {
+                candidate += "\xC3\xA9\xFF";
+            }
+
+            candidates.push_back(candidate);
+            ASSERT_DOUBLE_EQ(matcher.score(candidate), reference_score(pattern, candidate)) << pattern << " / " << candidate;
+        }
+
+        auto matches = matcher.rank(candidates, 0.0);
+
+        ASSERT_EQ(matches.size(), candidates.size());
+
+        for (std::size_t i = 0; i < matches.size(); ++i) {
+            ASSERT_DOUBLE_EQ(matches[i].score, reference_score(pattern, candidates[matches[i].index])) << pattern << " / " << candidates[matches[i].index];
+
+            if (i > 0) {
+                ASSERT_TRUE(matches[i - 1].score > matches[i].score || (matches[i - 1].score == matches[i].score && matches[i - 1].index < matches[i].index));
+            }
+        }
+    }
+}
+
+/**
+ * Ranking drops the candidates under the minimum score and keeps the best
+ * ones.
+ */
+TEST(TitleMatcherTest, RankFilters)
+{
+    TitleMatcher matcher("Prince of Persia II");
+    std::vector<std::string> candidates = {TitleMatcher::normalize("Prince of Persia"),
+                                           TitleMatcher::normalize("Prince of Persia 2: The Shadow and the Flame"),
+                                           TitleMatcher::normalize("Prince of Persia 2"),
+                                           TitleMatcher::normalize("Doom")};
+    auto matches = matcher.rank(candidates);
+
+    ASSERT_FALSE(matches.empty());
+    EXPECT_EQ(matches[0].index, 2u);
+    EXPECT_DOUBLE_EQ(matches[0].score, 1.0);
+    EXPECT_TRUE(std::none_of(matches.begin(), matches.end(), [](const TitleMatcher::Match &match) { return match.index == 3; }));
+    EXPECT_EQ(matcher.rank(candidates, 0.0, 2).size(), 2u);
+}